@@ -0,0 +1,36 @@
+#pragma once
+#include <stdbool.h>
+
+/**
+ * Called with the files that changed on disk. A burst of changes, like a branch switch, is reported in
+ * one call once it's over.
+ *
+ * @param[in] pp_paths Changed files, pooled.
+ * @param[in] count Number of changed files.
+ */
+typedef void (*file_watcher_callback_t)(const char * const * pp_paths, unsigned count, void * p_args);
+
+/**
+ * Start watching files for changes made outside the editor. Linux uses inotify on the directories of the
+ * watched files. Files inotify can't watch, and all files on other platforms, are polled for changes to
+ * their edit time instead.
+ *
+ * @param[in] callback Called from the watcher's thread with every burst of changes.
+ * @param[in] p_args Arguments to pass to the callback.
+ */
+void file_watcher_init(file_watcher_callback_t callback, void * p_args);
+
+/**
+ * Stop the watcher. Changes that haven't been reported yet are dropped.
+ */
+void file_watcher_free(void);
+
+/**
+ * Watch a file for changes. Files that are already watched are ignored.
+ */
+void file_watcher_add(const char * p_path);
+
+/**
+ * Report a change to a file as if the watcher had seen it, to be debounced with the others.
+ */
+void file_watcher_notify(const char * p_path);
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdbool.h>
+
+/**
+ * Index of the include directories, for completing #include paths. Each directory is kept as a tree of
+ * its sorted listing and the listings of its subdirectories, which is filled in the background the first
+ * time the directory is searched. A listing is only read again when the edit time of its directory
+ * changes.
+ */
+
+/**
+ * Callback for include_index_find.
+ *
+ * @param[in] p_path Include path of the match, relative to the include directory it was found in.
+ * @param[in] directory Whether the match is a directory.
+ *
+ * @returns false to stop the search.
+ */
+typedef bool (*include_index_cb_t)(const char * p_path, bool directory, void * p_args);
+
+void include_index_init(void);
+void include_index_free(void);
+
+/**
+ * Find the files and directories an include path could be completed with. Only the directory level the
+ * path is in is searched, so the include path is completed one directory at a time.
+ *
+ * @param[in] pp_directories Include directories, in the order they're searched.
+ * @param[in] directory_count Number of include directories.
+ * @param[in] p_prefix Include path typed so far.
+ * @param[in] callback Called for every match, once per include path, for the first directory it's in.
+ * @param[in] p_args Arguments to pass to the callback.
+ *
+ * @returns Whether all matches were passed to the callback.
+ */
+bool include_index_find(const char * const * pp_directories,
+                        unsigned directory_count,
+                        const char * p_prefix,
+                        include_index_cb_t callback,
+                        void * p_args);
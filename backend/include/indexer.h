@@ -2,6 +2,7 @@
 #include "structures.h"
 #include "unit.h"
 #include "hashtable.h"
+#include "string_pool.h"
 
 typedef enum
 {
@@ -9,38 +10,160 @@ typedef enum
     INDEX_SCOPE_GLOBAL
 } index_scope_t;
 
+/** Row in the declaration store. */
+typedef uint32_t index_decl_id_t;
+
+#define INDEX_DECL_NONE UINT32_MAX
+
 typedef struct
 {
-    const char * p_USR;
-    char * p_name;
-    location_t location;
+    string_id_t name;
+    string_id_t file;
+    uint32_t line;
+    uint32_t character;
     index_scope_t scope;
     symbol_kind_t kind;
 } index_declaration_t;
 
+/**
+ * Declarations stored column by column, so that scans only touch the fields they need.
+ *
+ * Rows with the same USR, and rows from the same unit, are linked into lists through the next columns.
+ * Removed rows are kept on a free list, linked through the unit column, and reused.
+ */
+typedef struct
+{
+    uint32_t count;
+    uint32_t capacity;
+    index_decl_id_t free_list;
+    string_id_t * p_USRs;
+    string_id_t * p_names;
+    string_id_t * p_files;
+    uint32_t * p_lines;
+    uint32_t * p_characters;
+    uint8_t * p_kinds;
+    uint8_t * p_scopes;
+    index_decl_id_t * p_next_with_USR;
+    index_decl_id_t * p_next_in_unit;
+} index_decl_store_t;
+
+/** File a unit's index depends on, with a hash of its contents at the time it was indexed. */
+typedef struct
+{
+    const char * p_path;
+    uint64_t hash;
+} index_dependency_t;
+
+typedef struct index_shard index_shard_t;
+
 typedef struct
 {
-    HashTable * p_table;
+    index_decl_store_t decls;
+    HashTable * p_table; ///< First declaration of each USR.
     HashTable * p_header_map;
+    HashTable * p_shards; ///< Shards loaded from disk, by unit filename.
+    HashTable * p_shard_symbols; ///< First shard symbol of each USR, over all loaded shards.
+    HashTable * p_file_hashes; ///< Content hashes of dependencies, by path.
     mutex_t mut;
+    mutex_t hash_mut;
 } index_t;
 
+/**
+ * Called for every declaration of a USR. The name and location are only valid for the duration of the call.
+ */
+typedef void (*index_decl_callback_t)(const char * p_name, const location_t * p_location, symbol_kind_t kind, void * p_args);
+
 
 void index_init(index_t * p_index);
 void index_free(index_t * p_index);
 
-void index_declaration_add(index_t * p_index, const char * p_USR, index_declaration_t * p_decl);
+/**
+ * Add a declaration to the store.
+ *
+ * @param[in] p_index Index to add to.
+ * @param[in] p_USR USR of the declared symbol.
+ * @param[in] p_decl Declaration to copy into the store.
+ * @param[in,out] p_unit_decls First declaration of the unit the declaration was found in.
+ */
+void index_declaration_add(index_t * p_index, const char * p_USR, const index_declaration_t * p_decl, index_decl_id_t * p_unit_decls);
 void index_header_set(index_t * p_index, const char * p_sourcefile, const char * p_headerfile);
 
-Array * index_decls_get(index_t * p_index, const char * p_USR);
+/**
+ * Get all declarations of the given USR, both from the units indexed in this session, and from the
+ * shards loaded from disk.
+ */
+void index_decls_get(index_t * p_index, const char * p_USR, index_decl_callback_t callback, void * p_args);
+
+/**
+ * Drop the loaded shard of the given unit, as it's being indexed again.
+ */
+void index_unit_supersede(index_t * p_index, const char * p_unit);
+
+/**
+ * Remove all declarations of a unit, and reset its list.
+ */
+void index_unit_decls_remove(index_t * p_index, index_decl_id_t * p_unit_decls);
 
-void index_decl_remove(index_t * p_index, const char * p_USR, index_declaration_t * p_decl);
+/**
+ * Call the callback for every declaration of a unit.
+ */
+void index_unit_decls_get(index_t * p_index, index_decl_id_t unit_decls, index_decl_callback_t callback, void * p_args);
 void index_header_remove(index_t * p_index, const char * p_sourcefile);
 
 const char * index_header_for_source(index_t * p_index, const char * p_sourcefile);
 const char * index_source_for_header(index_t * p_index, const char * p_header);
 
-void index_decl_free(index_declaration_t * p_decl);
 
-bool index_save(index_t * p_index, const char * p_location, time_t timestamp);
-bool index_load(index_t * p_index, const char * p_location, time_t * p_timestamp);
\ No newline at end of file
+/**
+ * Hash the contents of a file. Hashes are cached for as long as the file's modification time stays
+ * the same.
+ */
+bool index_file_hash(index_t * p_index, const char * p_path, uint64_t * p_hash);
+
+/**
+ * Get the location of the given unit's shard in the index directory. Must be freed by the caller.
+ */
+char * index_shard_location(const char * p_directory, const char * p_unit);
+
+/**
+ * Save the index of a single unit in the binary shard format.
+ *
+ * The file holds a string table with every USR, name and path stored once, and fixed size records that
+ * refer to it by offset. Symbols are sorted by USR, with the declarations of each stored next to each
+ * other, so that the file is used where it is mapped into memory, without parsing it first.
+ *
+ * @param[in] p_index Index the unit's declarations are stored in.
+ * @param[in] p_location Shard file to write.
+ * @param[in] p_unit Main file of the unit.
+ * @param[in] unit_decls First declaration of the unit.
+ * @param[in] p_main_header Header file of the unit, or NULL.
+ * @param[in] p_dependencies Files the index was built from, including the main file.
+ * @param[in] dependency_count Number of dependencies.
+ */
+bool index_shard_save(index_t * p_index,
+                      const char * p_location,
+                      const char * p_unit,
+                      index_decl_id_t unit_decls,
+                      const char * p_main_header,
+                      const index_dependency_t * p_dependencies,
+                      size_t dependency_count);
+
+/**
+ * Called for each file a loaded shard was built from.
+ */
+typedef void (*index_dependency_callback_t)(const char * p_path, void * p_args);
+
+/**
+ * Map the shard of a unit, if all the files it was built from still have the same contents.
+ *
+ * Declarations are read from the mapping when they're looked up, until the unit is indexed again. The
+ * shard's symbols are added to a table shared by all loaded shards, so a lookup doesn't visit each one.
+ *
+ * @param[in] callback Called with each file the shard was built from, if it's loaded.
+ * @param[in] p_args Arguments to pass to the callback.
+ */
+bool index_shard_load(index_t * p_index,
+                      const char * p_location,
+                      const char * p_unit,
+                      index_dependency_callback_t callback,
+                      void * p_args);
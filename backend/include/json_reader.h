@@ -0,0 +1,87 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <jansson.h>
+
+typedef enum
+{
+    JSON_READER_TYPE_INVALID,
+    JSON_READER_TYPE_OBJECT,
+    JSON_READER_TYPE_ARRAY,
+    JSON_READER_TYPE_STRING,
+    JSON_READER_TYPE_NUMBER,
+    JSON_READER_TYPE_BOOLEAN,
+    JSON_READER_TYPE_NULL,
+} json_reader_type_t;
+
+/**
+ * Pull parser that reads JSON values one at a time, straight from the buffer the message was read into.
+ *
+ * Strings are unescaped in place and terminated where they end, so they can be handed out without
+ * copying them. This means that every value can only be read once, and that the strings are only valid
+ * for as long as the buffer is. Values of an unexpected type are skipped, so that the caller can carry on
+ * with the next one. Syntax errors stop the reader, and are reported by json_reader_error.
+ */
+typedef struct
+{
+    char * p_c;
+    char * p_end;
+    bool error;
+} json_reader_t;
+
+void json_reader_init(json_reader_t * p_reader, char * p_data, size_t size);
+bool json_reader_error(const json_reader_t * p_reader);
+
+/**
+ * Get the type of the next value, without reading it.
+ */
+json_reader_type_t json_reader_peek(json_reader_t * p_reader);
+
+/**
+ * Enter an object. Its members are read by calling json_reader_object_next until it returns false, and
+ * reading or skipping the value of each key in between.
+ *
+ * @returns False if the next value isn't an object. The value is skipped.
+ */
+bool json_reader_object_start(json_reader_t * p_reader);
+
+/**
+ * Go to the next member of the current object.
+ *
+ * @param[in] p_reader Reader to go on with.
+ * @param[out] pp_key Key of the member.
+ *
+ * @returns False at the end of the object.
+ */
+bool json_reader_object_next(json_reader_t * p_reader, const char ** pp_key);
+
+/**
+ * Enter an array. Its elements are read by calling json_reader_array_next until it returns false, and
+ * reading or skipping each element in between.
+ *
+ * @returns False if the next value isn't an array. The value is skipped.
+ */
+bool json_reader_array_start(json_reader_t * p_reader);
+bool json_reader_array_next(json_reader_t * p_reader);
+
+/**
+ * Read a string, unescaping it in place.
+ *
+ * @returns The string, or NULL if the next value isn't a string.
+ */
+char * json_reader_string(json_reader_t * p_reader);
+bool json_reader_integer(json_reader_t * p_reader, int64_t * p_value);
+bool json_reader_boolean(json_reader_t * p_reader, bool * p_value);
+
+/**
+ * Skip the next value, including everything nested in it.
+ */
+void json_reader_skip(json_reader_t * p_reader);
+
+/**
+ * Parse the next value into a Jansson value, for the few places that keep JSON around as it is.
+ *
+ * @returns New reference to the value, or NULL if it couldn't be parsed.
+ */
+json_t * json_reader_json(json_reader_t * p_reader);
@@ -2,6 +2,9 @@
 #include <jansson.h>
 #include <stdio.h>
 #include <stdint.h>
+#include "json_writer.h"
+#include "json_reader.h"
+#include "utils.h"
 
 #define JSON_RPC_ERROR_PARSE_ERROR      (-32700)
 #define JSON_RPC_ERROR_INVALID_REQUEST  (-32600)
@@ -9,6 +12,7 @@
 #define JSON_RPC_ERROR_INVALID_PARAMS   (-32602)
 #define JSON_RPC_ERROR_INTERNAL_ERROR   (-32603)
 #define JSON_RPC_ERROR_NO_RESPONSE      (-32000)
+#define JSON_RPC_ERROR_REQUEST_CANCELLED (-32800)
 
 typedef enum
 {
@@ -32,21 +36,98 @@ typedef union
 
 typedef int64_t json_rpc_request_id_t;
 
-typedef void (*json_rpc_request_handler_t)(const char * p_method, json_t * p_params, json_t * p_response);
+/**
+ * Decode the params of a message. Called on the thread that reads the input, before the handler for
+ * the message is queued. Strings in the params may point into the input buffer, which is kept until the
+ * params are freed.
+ *
+ * @param[in] p_params Reader positioned at the params of the message.
+ * @param[out] pp_document Path of the document the message is about, or NULL if it may touch all of them.
+ *      Messages about the same document are handled one at a time, in the order they came in, while
+ *      messages about different documents may be handled at the same time.
+ *
+ * @returns The decoded params, or NULL if they're invalid.
+ */
+typedef void * (*json_rpc_params_reader_t)(json_reader_t * p_params, const char ** pp_document);
+typedef void (*json_rpc_params_free_t)(void * p_params);
+
+/**
+ * Handlers run on the worker threads, once every earlier message about the same document has been
+ * handled.
+ */
+typedef void (*json_rpc_request_handler_t)(const char * p_method, void * p_params, json_t * p_response);
 typedef void (*json_rpc_response_handler_t)(json_rpc_request_id_t id, json_rpc_result_t result, const json_rpc_response_params_t * p_params);
-typedef void (*json_rpc_notification_handler_t)(const char * p_method, json_t * p_params);
+typedef void (*json_rpc_notification_handler_t)(const char * p_method, void * p_params);
 
 
+/**
+ * Set up the message handling, and start the thread that writes all outgoing messages.
+ */
 void json_rpc_init(void);
-void json_rpc_request_handler_add(const char * p_method, json_rpc_request_handler_t request_handler);
-void json_rpc_notification_handler_add(const char * p_method, json_rpc_notification_handler_t notification_handler);
+
+/**
+ * Write out all messages that have been sent, then stop the writer thread.
+ */
+void json_rpc_free(void);
+
+void json_rpc_request_handler_add(const char * p_method,
+                                  json_rpc_params_reader_t params_reader,
+                                  json_rpc_request_handler_t request_handler,
+                                  json_rpc_params_free_t params_free);
+void json_rpc_notification_handler_add(const char * p_method,
+                                       json_rpc_params_reader_t params_reader,
+                                       json_rpc_notification_handler_t notification_handler,
+                                       json_rpc_params_free_t params_free);
+
+/**
+ * Give the handler of a method a limited time to respond, counted from when the request comes in. The
+ * handler is expected to check the cancellation token, and return what it has got when the time is up.
+ * Must be called after the handler has been added.
+ */
+void json_rpc_request_deadline_set(const char * p_method, unsigned milliseconds);
+
+/**
+ * Get the cancellation token of the message being handled on this thread. Requests are cancelled by the
+ * client with $/cancelRequest, or when their deadline passes. Requests that are cancelled before their
+ * handler runs get a RequestCancelled error instead.
+ *
+ * @returns The token, or NULL outside of a handler.
+ */
+cancel_token_t * json_rpc_cancel_token(void);
+
+/**
+ * Get the arena of the handler running on this thread. Everything allocated in it is released after the
+ * handler returns, so results built in it must be sent before then.
+ */
+arena_t * json_rpc_arena(void);
 
 void json_rpc_response_send(json_t * p_response, json_t * p_result);
 void json_rpc_error_response_send(json_t * p_response, int code, const char * p_message, json_t * p_data);
 
+/**
+ * Start a response whose result is written straight into the output buffer, without building it as a
+ * Jansson tree first.
+ *
+ * Exactly one value must be written to the returned writer before the response is sent with
+ * json_rpc_response_end. Must be called from a request handler.
+ */
+json_writer_t * json_rpc_response_begin(json_t * p_response);
+void json_rpc_response_end(json_writer_t * p_writer);
+
 json_rpc_request_id_t json_rpc_request_send(const char * p_method, json_t * p_params, json_rpc_response_handler_t response_handler);
 void json_rpc_notification_send(const char * p_method, json_t * p_params);
 
+/**
+ * Start a notification whose params are written straight into the output buffer. Every thread has a
+ * buffer of its own, so notifications can be sent from any thread.
+ */
+json_writer_t * json_rpc_notification_begin(const char * p_method);
+void json_rpc_notification_end(json_writer_t * p_writer);
+
+/**
+ * Read messages from the stream and queue up their handlers, until it ends. Returns once all handlers
+ * of the messages that were read have run.
+ */
 void json_rpc_listen(FILE * stream);
 void json_rpc_stop(void);
 
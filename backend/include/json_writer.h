@@ -0,0 +1,53 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <jansson.h>
+
+/**
+ * Growable buffer that JSON text is written straight into, without building a Jansson tree first.
+ *
+ * The writer puts the commas in by itself: it remembers whether the last thing written was a value, and
+ * if so, puts a comma in front of the next key or array element. The buffer is kept between messages,
+ * so once it has grown to fit the largest one, writing doesn't allocate.
+ */
+typedef struct
+{
+    char * p_data;
+    size_t length;
+    size_t capacity;
+    bool needs_comma;
+} json_writer_t;
+
+/**
+ * Empty the writer, keeping its buffer.
+ *
+ * @param[in] p_writer Writer to reset.
+ * @param[in] reserved Number of bytes to leave free at the start of the buffer, for a header that's
+ *      filled in once the length of the body is known.
+ */
+void json_writer_reset(json_writer_t * p_writer, size_t reserved);
+void json_writer_free(json_writer_t * p_writer);
+
+void json_writer_object_start(json_writer_t * p_writer);
+void json_writer_object_end(json_writer_t * p_writer);
+void json_writer_array_start(json_writer_t * p_writer);
+void json_writer_array_end(json_writer_t * p_writer);
+
+/**
+ * Write an object key. Keys are written as they are, so they must not need escaping.
+ */
+void json_writer_key(json_writer_t * p_writer, const char * p_key);
+
+/**
+ * Write an escaped string value, or null if the string is NULL.
+ */
+void json_writer_string(json_writer_t * p_writer, const char * p_string);
+void json_writer_integer(json_writer_t * p_writer, int64_t value);
+void json_writer_boolean(json_writer_t * p_writer, bool value);
+void json_writer_null(json_writer_t * p_writer);
+
+/**
+ * Write a Jansson value, or null if the value is NULL.
+ */
+void json_writer_json(json_writer_t * p_writer, const json_t * p_json);
@@ -20,26 +20,21 @@
         safe_puts(LOG_FILE, g_log_buf);\
     } while (0)
 
-#define OUTPUT(_str)                  \
+#define OUTPUT(_data, _size)              \
     do                                    \
     {                                     \
-        printf("%s", _str);                   \
-        fflush(stdout); \
-        safe_puts(OUT_FILE, _str);\
+        output_write(_data, _size);       \
+        safe_write(OUT_FILE, _data, _size);\
     } while (0)
 #else
 #define LOG(fmt, ...)
 
-#define OUTPUT(_str)                  \
-    do                                \
-    {                                 \
-        printf("%s", _str);           \
-        fflush(stdout);               \
-    } while (0)
+#define OUTPUT(_data, _size) output_write(_data, _size)
 #endif
 
 void log_init(void);
 void safe_puts(const char * p_filename, const char * p_string);
+void safe_write(const char * p_filename, const void * p_data, size_t size);
 void json_rpc_log(const char * p_message);
 void assert_handler(const char * p_file, unsigned line);
 
@@ -40,6 +40,11 @@ void path_get_files(const char * p_directory, path_file_cb_t callback, bool recu
 
 bool path_last_edit(const char * p_path, time_t * p_time);
 
+/**
+ * Create a directory and all its missing parents.
+ */
+bool path_create_directory(const char * p_path);
+
 
 /**
  * Give a score for how likely it is that the files are a header/sourcefile pair.
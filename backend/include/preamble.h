@@ -0,0 +1,57 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <clang-c/Index.h>
+#include "unit.h"
+
+/**
+ * Precompiled header built from the #include lines a file starts with. Files that start with the same
+ * includes under the same flags share one, and it's kept on disk, so that it outlives the session.
+ */
+typedef struct preamble preamble_t;
+
+typedef void (*preamble_dependency_callback_t)(const char * p_path, void * p_args);
+
+/**
+ * Start the preamble cache.
+ *
+ * @param[in] index Index to build the precompiled headers in.
+ * @param[in] p_directory Directory to keep the precompiled headers in.
+ */
+void preamble_init(CXIndex index, const char * p_directory);
+void preamble_free(void);
+
+/**
+ * Get the preamble for the file's include prefix, building it if there's no up to date one on disk.
+ * Units parsing at the same time with the same prefix wait for the one building it.
+ *
+ * @param[in] p_filename Main file of the unit.
+ * @param[in] p_flags Compile flags of the unit.
+ * @param[in] p_unsaved_files Contents of the open documents.
+ * @param[in] unsaved_file_count Number of open documents.
+ * @param[out] p_generation Build of the precompiled header, which changes every time it's written again
+ *      at the same location.
+ *
+ * @returns The preamble, or NULL if the file doesn't start with any includes, the prefix doesn't compile
+ *      on its own, or one of the files it includes has unsaved changes.
+ */
+preamble_t * preamble_get(const char * p_filename,
+                          const compile_flags_t * p_flags,
+                          struct CXUnsavedFile * p_unsaved_files,
+                          uint32_t unsaved_file_count,
+                          uint32_t * p_generation);
+
+/**
+ * Get the precompiled header file to pass to clang with -include-pch.
+ */
+const char * preamble_location(const preamble_t * p_preamble);
+
+/**
+ * Call the callback for every file the precompiled header includes, directly or not. Units parsed with
+ * the header don't see these files while indexing, so they have to get them from here.
+ *
+ * @param[in] p_preamble Preamble to get the files of.
+ * @param[in] callback Called with the pooled path of every file.
+ * @param[in] p_args Arguments to pass to the callback.
+ */
+void preamble_dependencies_get(preamble_t * p_preamble, preamble_dependency_callback_t callback, void * p_args);
@@ -16,116 +16,209 @@ typedef enum
 decoder_error_t decoder_error(void);
 
 /*******************************************************************************
- * Decoders
+ * Readers
  ******************************************************************************/
-static inline message_type_t decode_message_type(json_t * p_json)
+static inline bool read_message_type(json_reader_t * p_reader, message_type_t * p_value)
 {
-    return (message_type_t) decode_number(p_json);
+    int64_t value;
+    bool valid = json_reader_integer(p_reader, &value);
+    *p_value = (message_type_t) value;
+    return valid;
 }
 
-static inline file_change_type_t decode_file_change_type(json_t * p_json)
+static inline bool read_file_change_type(json_reader_t * p_reader, file_change_type_t * p_value)
 {
-    return (file_change_type_t) decode_number(p_json);
+    int64_t value;
+    bool valid = json_reader_integer(p_reader, &value);
+    *p_value = (file_change_type_t) value;
+    return valid;
 }
 
-static inline watch_kind_t decode_watch_kind(json_t * p_json)
+static inline bool read_watch_kind(json_reader_t * p_reader, watch_kind_t * p_value)
 {
-    return (watch_kind_t) decode_number(p_json);
+    int64_t value;
+    bool valid = json_reader_integer(p_reader, &value);
+    *p_value = (watch_kind_t) value;
+    return valid;
 }
 
-static inline text_document_sync_kind_t decode_text_document_sync_kind(json_t * p_json)
+static inline bool read_text_document_sync_kind(json_reader_t * p_reader, text_document_sync_kind_t * p_value)
 {
-    return (text_document_sync_kind_t) decode_number(p_json);
+    int64_t value;
+    bool valid = json_reader_integer(p_reader, &value);
+    *p_value = (text_document_sync_kind_t) value;
+    return valid;
 }
 
-static inline diagnostic_severity_t decode_diagnostic_severity(json_t * p_json)
+static inline bool read_diagnostic_severity(json_reader_t * p_reader, diagnostic_severity_t * p_value)
 {
-    return (diagnostic_severity_t) decode_number(p_json);
+    int64_t value;
+    bool valid = json_reader_integer(p_reader, &value);
+    *p_value = (diagnostic_severity_t) value;
+    return valid;
 }
 
-static inline completion_item_kind_t decode_completion_item_kind(json_t * p_json)
+static inline bool read_completion_item_kind(json_reader_t * p_reader, completion_item_kind_t * p_value)
 {
-    return (completion_item_kind_t) decode_number(p_json);
+    int64_t value;
+    bool valid = json_reader_integer(p_reader, &value);
+    *p_value = (completion_item_kind_t) value;
+    return valid;
 }
 
-static inline insert_text_format_t decode_insert_text_format(json_t * p_json)
+static inline bool read_insert_text_format(json_reader_t * p_reader, insert_text_format_t * p_value)
 {
-    return (insert_text_format_t) decode_number(p_json);
+    int64_t value;
+    bool valid = json_reader_integer(p_reader, &value);
+    *p_value = (insert_text_format_t) value;
+    return valid;
 }
 
-static inline document_highlight_kind_t decode_document_highlight_kind(json_t * p_json)
+static inline bool read_document_highlight_kind(json_reader_t * p_reader, document_highlight_kind_t * p_value)
 {
-    return (document_highlight_kind_t) decode_number(p_json);
+    int64_t value;
+    bool valid = json_reader_integer(p_reader, &value);
+    *p_value = (document_highlight_kind_t) value;
+    return valid;
 }
 
-static inline symbol_kind_t decode_symbol_kind(json_t * p_json)
+static inline bool read_symbol_kind(json_reader_t * p_reader, symbol_kind_t * p_value)
 {
-    return (symbol_kind_t) decode_number(p_json);
+    int64_t value;
+    bool valid = json_reader_integer(p_reader, &value);
+    *p_value = (symbol_kind_t) value;
+    return valid;
 }
 
-static inline text_document_save_reason_t decode_text_document_save_reason(json_t * p_json)
+static inline bool read_text_document_save_reason(json_reader_t * p_reader, text_document_save_reason_t * p_value)
 {
-    return (text_document_save_reason_t) decode_number(p_json);
+    int64_t value;
+    bool valid = json_reader_integer(p_reader, &value);
+    *p_value = (text_document_save_reason_t) value;
+    return valid;
 }
-/* Common parameter JSON decoders */
-compilation_database_params_t decode_compilation_database_params(json_t * p_json);
-initialization_options_t decode_initialization_options(json_t * p_json);
-workspace_client_capabilities_t decode_workspace_client_capabilities(json_t * p_json);
-text_document_client_capabilities_t decode_text_document_client_capabilities(json_t * p_json);
-client_capabilities_t decode_client_capabilities(json_t * p_json);
-completion_options_t decode_completion_options(json_t * p_json);
-signature_help_options_t decode_signature_help_options(json_t * p_json);
-code_lens_options_t decode_code_lens_options(json_t * p_json);
-save_options_t decode_save_options(json_t * p_json);
-text_document_sync_options_t decode_text_document_sync_options(json_t * p_json);
-server_capabilities_t decode_server_capabilities(json_t * p_json);
-markup_content_t decode_markup_content(json_t * p_json);
-marked_string_t decode_marked_string(json_t * p_json);
-message_action_item_t decode_message_action_item(json_t * p_json);
-position_t decode_position(json_t * p_json);
-range_t decode_range(json_t * p_json);
-text_edit_t decode_text_edit(json_t * p_json);
-location_t decode_location(json_t * p_json);
-diagnostic_related_information_t decode_diagnostic_related_information(json_t * p_json);
-diagnostic_t decode_diagnostic(json_t * p_json);
-text_document_item_t decode_text_document_item(json_t * p_json);
-text_document_content_change_event_t decode_text_document_content_change_event(json_t * p_json);
-text_document_identifier_t decode_text_document_identifier(json_t * p_json);
-versioned_text_document_identifier_t decode_versioned_text_document_identifier(json_t * p_json);
-file_event_t decode_file_event(json_t * p_json);
-text_document_position_params_t decode_text_document_position_params(json_t * p_json);
-command_t decode_command(json_t * p_json);
-completion_item_t decode_completion_item(json_t * p_json);
-parameter_information_t decode_parameter_information(json_t * p_json);
-signature_information_t decode_signature_information(json_t * p_json);
-reference_context_t decode_reference_context(json_t * p_json);
-completion_list_t decode_completion_list(json_t * p_json);
-code_action_context_t decode_code_action_context(json_t * p_json);
-/* Server command parameter JSON decoders */
-initialize_params_t decode_initialize_params(json_t * p_json);
-reference_params_t decode_reference_params(json_t * p_json);
-document_symbol_params_t decode_document_symbol_params(json_t * p_json);
-workspace_symbol_params_t decode_workspace_symbol_params(json_t * p_json);
-document_link_params_t decode_document_link_params(json_t * p_json);
-code_action_params_t decode_code_action_params(json_t * p_json);
-/* Client command parameter JSON decoders */
-show_message_request_params_t decode_show_message_request_params(json_t * p_json);
-signature_help_t decode_signature_help(json_t * p_json);
-/* Command response parameter JSON decoders */
-initialize_result_t decode_initialize_result(json_t * p_json);
-symbol_information_t decode_symbol_information(json_t * p_json);
-document_link_t decode_document_link(json_t * p_json);
-hover_t decode_hover(json_t * p_json);
-/* Client notification parameter JSON decoders */
-show_message_params_t decode_show_message_params(json_t * p_json);
-log_message_params_t decode_log_message_params(json_t * p_json);
-publish_diagnostics_params_t decode_publish_diagnostics_params(json_t * p_json);
-/* Server notification parameter JSON decoders */
-did_open_text_document_params_t decode_did_open_text_document_params(json_t * p_json);
-did_change_text_document_params_t decode_did_change_text_document_params(json_t * p_json);
-did_save_text_document_params_t decode_did_save_text_document_params(json_t * p_json);
-did_close_text_document_params_t decode_did_close_text_document_params(json_t * p_json);
-did_change_watched_files_params_t decode_did_change_watched_files_params(json_t * p_json);
+/* Common parameter JSON readers */
+bool read_compilation_database_params(json_reader_t * p_reader, compilation_database_params_t * p_value);
+bool read_initialization_options(json_reader_t * p_reader, initialization_options_t * p_value);
+bool read_workspace_client_capabilities(json_reader_t * p_reader, workspace_client_capabilities_t * p_value);
+bool read_text_document_client_capabilities(json_reader_t * p_reader, text_document_client_capabilities_t * p_value);
+bool read_client_capabilities(json_reader_t * p_reader, client_capabilities_t * p_value);
+bool read_completion_options(json_reader_t * p_reader, completion_options_t * p_value);
+bool read_signature_help_options(json_reader_t * p_reader, signature_help_options_t * p_value);
+bool read_code_lens_options(json_reader_t * p_reader, code_lens_options_t * p_value);
+bool read_save_options(json_reader_t * p_reader, save_options_t * p_value);
+bool read_text_document_sync_options(json_reader_t * p_reader, text_document_sync_options_t * p_value);
+bool read_server_capabilities(json_reader_t * p_reader, server_capabilities_t * p_value);
+bool read_markup_content(json_reader_t * p_reader, markup_content_t * p_value);
+bool read_marked_string(json_reader_t * p_reader, marked_string_t * p_value);
+bool read_message_action_item(json_reader_t * p_reader, message_action_item_t * p_value);
+bool read_position(json_reader_t * p_reader, position_t * p_value);
+bool read_range(json_reader_t * p_reader, range_t * p_value);
+bool read_text_edit(json_reader_t * p_reader, text_edit_t * p_value);
+bool read_location(json_reader_t * p_reader, location_t * p_value);
+bool read_diagnostic_related_information(json_reader_t * p_reader, diagnostic_related_information_t * p_value);
+bool read_diagnostic(json_reader_t * p_reader, diagnostic_t * p_value);
+bool read_text_document_item(json_reader_t * p_reader, text_document_item_t * p_value);
+bool read_text_document_content_change_event(json_reader_t * p_reader, text_document_content_change_event_t * p_value);
+bool read_text_document_identifier(json_reader_t * p_reader, text_document_identifier_t * p_value);
+bool read_versioned_text_document_identifier(json_reader_t * p_reader, versioned_text_document_identifier_t * p_value);
+bool read_file_event(json_reader_t * p_reader, file_event_t * p_value);
+bool read_text_document_position_params(json_reader_t * p_reader, text_document_position_params_t * p_value);
+bool read_command(json_reader_t * p_reader, command_t * p_value);
+bool read_completion_item(json_reader_t * p_reader, completion_item_t * p_value);
+bool read_parameter_information(json_reader_t * p_reader, parameter_information_t * p_value);
+bool read_signature_information(json_reader_t * p_reader, signature_information_t * p_value);
+bool read_reference_context(json_reader_t * p_reader, reference_context_t * p_value);
+bool read_completion_list(json_reader_t * p_reader, completion_list_t * p_value);
+bool read_code_action_context(json_reader_t * p_reader, code_action_context_t * p_value);
+/* Server command parameter JSON readers */
+bool read_initialize_params(json_reader_t * p_reader, initialize_params_t * p_value);
+bool read_reference_params(json_reader_t * p_reader, reference_params_t * p_value);
+bool read_document_symbol_params(json_reader_t * p_reader, document_symbol_params_t * p_value);
+bool read_workspace_symbol_params(json_reader_t * p_reader, workspace_symbol_params_t * p_value);
+bool read_document_link_params(json_reader_t * p_reader, document_link_params_t * p_value);
+bool read_code_action_params(json_reader_t * p_reader, code_action_params_t * p_value);
+/* Client command parameter JSON readers */
+bool read_show_message_request_params(json_reader_t * p_reader, show_message_request_params_t * p_value);
+bool read_signature_help(json_reader_t * p_reader, signature_help_t * p_value);
+/* Command response parameter JSON readers */
+bool read_initialize_result(json_reader_t * p_reader, initialize_result_t * p_value);
+bool read_symbol_information(json_reader_t * p_reader, symbol_information_t * p_value);
+bool read_document_link(json_reader_t * p_reader, document_link_t * p_value);
+bool read_hover(json_reader_t * p_reader, hover_t * p_value);
+/* Client notification parameter JSON readers */
+bool read_show_message_params(json_reader_t * p_reader, show_message_params_t * p_value);
+bool read_log_message_params(json_reader_t * p_reader, log_message_params_t * p_value);
+bool read_publish_diagnostics_params(json_reader_t * p_reader, publish_diagnostics_params_t * p_value);
+/* Server notification parameter JSON readers */
+bool read_did_open_text_document_params(json_reader_t * p_reader, did_open_text_document_params_t * p_value);
+bool read_did_change_text_document_params(json_reader_t * p_reader, did_change_text_document_params_t * p_value);
+bool read_did_save_text_document_params(json_reader_t * p_reader, did_save_text_document_params_t * p_value);
+bool read_did_close_text_document_params(json_reader_t * p_reader, did_close_text_document_params_t * p_value);
+bool read_did_change_watched_files_params(json_reader_t * p_reader, did_change_watched_files_params_t * p_value);
+
+/*******************************************************************************
+ * Releasers
+ ******************************************************************************/
+/* Common parameter structure releasers */
+void release_compilation_database_params(compilation_database_params_t * p_value);
+void release_initialization_options(initialization_options_t * p_value);
+void release_workspace_client_capabilities(workspace_client_capabilities_t * p_value);
+void release_text_document_client_capabilities(text_document_client_capabilities_t * p_value);
+void release_client_capabilities(client_capabilities_t * p_value);
+void release_completion_options(completion_options_t * p_value);
+void release_signature_help_options(signature_help_options_t * p_value);
+void release_code_lens_options(code_lens_options_t * p_value);
+void release_save_options(save_options_t * p_value);
+void release_text_document_sync_options(text_document_sync_options_t * p_value);
+void release_server_capabilities(server_capabilities_t * p_value);
+void release_markup_content(markup_content_t * p_value);
+void release_marked_string(marked_string_t * p_value);
+void release_message_action_item(message_action_item_t * p_value);
+void release_position(position_t * p_value);
+void release_range(range_t * p_value);
+void release_text_edit(text_edit_t * p_value);
+void release_location(location_t * p_value);
+void release_diagnostic_related_information(diagnostic_related_information_t * p_value);
+void release_diagnostic(diagnostic_t * p_value);
+void release_text_document_item(text_document_item_t * p_value);
+void release_text_document_content_change_event(text_document_content_change_event_t * p_value);
+void release_text_document_identifier(text_document_identifier_t * p_value);
+void release_versioned_text_document_identifier(versioned_text_document_identifier_t * p_value);
+void release_file_event(file_event_t * p_value);
+void release_text_document_position_params(text_document_position_params_t * p_value);
+void release_command(command_t * p_value);
+void release_completion_item(completion_item_t * p_value);
+void release_parameter_information(parameter_information_t * p_value);
+void release_signature_information(signature_information_t * p_value);
+void release_reference_context(reference_context_t * p_value);
+void release_completion_list(completion_list_t * p_value);
+void release_code_action_context(code_action_context_t * p_value);
+/* Server command parameter structure releasers */
+void release_initialize_params(initialize_params_t * p_value);
+void release_reference_params(reference_params_t * p_value);
+void release_document_symbol_params(document_symbol_params_t * p_value);
+void release_workspace_symbol_params(workspace_symbol_params_t * p_value);
+void release_document_link_params(document_link_params_t * p_value);
+void release_code_action_params(code_action_params_t * p_value);
+/* Client command parameter structure releasers */
+void release_show_message_request_params(show_message_request_params_t * p_value);
+void release_signature_help(signature_help_t * p_value);
+/* Command response parameter structure releasers */
+void release_initialize_result(initialize_result_t * p_value);
+void release_symbol_information(symbol_information_t * p_value);
+void release_document_link(document_link_t * p_value);
+void release_hover(hover_t * p_value);
+/* Client notification parameter structure releasers */
+void release_show_message_params(show_message_params_t * p_value);
+void release_log_message_params(log_message_params_t * p_value);
+void release_publish_diagnostics_params(publish_diagnostics_params_t * p_value);
+/* Server notification parameter structure releasers */
+void release_did_open_text_document_params(did_open_text_document_params_t * p_value);
+void release_did_change_text_document_params(did_change_text_document_params_t * p_value);
+void release_did_save_text_document_params(did_save_text_document_params_t * p_value);
+void release_did_close_text_document_params(did_close_text_document_params_t * p_value);
+void release_did_change_watched_files_params(did_change_watched_files_params_t * p_value);
 
 /*******************************************************************************
  * Freers
@@ -115,3 +115,112 @@ json_t * encode_did_change_text_document_params(did_change_text_document_params_
 json_t * encode_did_save_text_document_params(did_save_text_document_params_t value);
 json_t * encode_did_close_text_document_params(did_close_text_document_params_t value);
 json_t * encode_did_change_watched_files_params(did_change_watched_files_params_t value);
+
+static inline void write_message_type(json_writer_t * p_writer, message_type_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+
+static inline void write_file_change_type(json_writer_t * p_writer, file_change_type_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+
+static inline void write_watch_kind(json_writer_t * p_writer, watch_kind_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+
+static inline void write_text_document_sync_kind(json_writer_t * p_writer, text_document_sync_kind_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+
+static inline void write_diagnostic_severity(json_writer_t * p_writer, diagnostic_severity_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+
+static inline void write_completion_item_kind(json_writer_t * p_writer, completion_item_kind_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+
+static inline void write_insert_text_format(json_writer_t * p_writer, insert_text_format_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+
+static inline void write_document_highlight_kind(json_writer_t * p_writer, document_highlight_kind_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+
+static inline void write_symbol_kind(json_writer_t * p_writer, symbol_kind_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+
+static inline void write_text_document_save_reason(json_writer_t * p_writer, text_document_save_reason_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+/* Common parameter JSON writers */
+void write_compilation_database_params(json_writer_t * p_writer, const compilation_database_params_t * p_value);
+void write_initialization_options(json_writer_t * p_writer, const initialization_options_t * p_value);
+void write_workspace_client_capabilities(json_writer_t * p_writer, const workspace_client_capabilities_t * p_value);
+void write_text_document_client_capabilities(json_writer_t * p_writer, const text_document_client_capabilities_t * p_value);
+void write_client_capabilities(json_writer_t * p_writer, const client_capabilities_t * p_value);
+void write_completion_options(json_writer_t * p_writer, const completion_options_t * p_value);
+void write_signature_help_options(json_writer_t * p_writer, const signature_help_options_t * p_value);
+void write_code_lens_options(json_writer_t * p_writer, const code_lens_options_t * p_value);
+void write_save_options(json_writer_t * p_writer, const save_options_t * p_value);
+void write_text_document_sync_options(json_writer_t * p_writer, const text_document_sync_options_t * p_value);
+void write_server_capabilities(json_writer_t * p_writer, const server_capabilities_t * p_value);
+void write_markup_content(json_writer_t * p_writer, const markup_content_t * p_value);
+void write_marked_string(json_writer_t * p_writer, const marked_string_t * p_value);
+void write_message_action_item(json_writer_t * p_writer, const message_action_item_t * p_value);
+void write_position(json_writer_t * p_writer, const position_t * p_value);
+void write_range(json_writer_t * p_writer, const range_t * p_value);
+void write_text_edit(json_writer_t * p_writer, const text_edit_t * p_value);
+void write_location(json_writer_t * p_writer, const location_t * p_value);
+void write_diagnostic_related_information(json_writer_t * p_writer, const diagnostic_related_information_t * p_value);
+void write_diagnostic(json_writer_t * p_writer, const diagnostic_t * p_value);
+void write_text_document_item(json_writer_t * p_writer, const text_document_item_t * p_value);
+void write_text_document_content_change_event(json_writer_t * p_writer, const text_document_content_change_event_t * p_value);
+void write_text_document_identifier(json_writer_t * p_writer, const text_document_identifier_t * p_value);
+void write_versioned_text_document_identifier(json_writer_t * p_writer, const versioned_text_document_identifier_t * p_value);
+void write_file_event(json_writer_t * p_writer, const file_event_t * p_value);
+void write_text_document_position_params(json_writer_t * p_writer, const text_document_position_params_t * p_value);
+void write_command(json_writer_t * p_writer, const command_t * p_value);
+void write_completion_item(json_writer_t * p_writer, const completion_item_t * p_value);
+void write_parameter_information(json_writer_t * p_writer, const parameter_information_t * p_value);
+void write_signature_information(json_writer_t * p_writer, const signature_information_t * p_value);
+void write_reference_context(json_writer_t * p_writer, const reference_context_t * p_value);
+void write_completion_list(json_writer_t * p_writer, const completion_list_t * p_value);
+void write_code_action_context(json_writer_t * p_writer, const code_action_context_t * p_value);
+/* Server command parameter JSON writers */
+void write_initialize_params(json_writer_t * p_writer, const initialize_params_t * p_value);
+void write_reference_params(json_writer_t * p_writer, const reference_params_t * p_value);
+void write_document_symbol_params(json_writer_t * p_writer, const document_symbol_params_t * p_value);
+void write_workspace_symbol_params(json_writer_t * p_writer, const workspace_symbol_params_t * p_value);
+void write_document_link_params(json_writer_t * p_writer, const document_link_params_t * p_value);
+void write_code_action_params(json_writer_t * p_writer, const code_action_params_t * p_value);
+/* Client command parameter JSON writers */
+void write_show_message_request_params(json_writer_t * p_writer, const show_message_request_params_t * p_value);
+void write_signature_help(json_writer_t * p_writer, const signature_help_t * p_value);
+/* Command response parameter JSON writers */
+void write_initialize_result(json_writer_t * p_writer, const initialize_result_t * p_value);
+void write_symbol_information(json_writer_t * p_writer, const symbol_information_t * p_value);
+void write_document_link(json_writer_t * p_writer, const document_link_t * p_value);
+void write_hover(json_writer_t * p_writer, const hover_t * p_value);
+/* Client notification parameter JSON writers */
+void write_show_message_params(json_writer_t * p_writer, const show_message_params_t * p_value);
+void write_log_message_params(json_writer_t * p_writer, const log_message_params_t * p_value);
+void write_publish_diagnostics_params(json_writer_t * p_writer, const publish_diagnostics_params_t * p_value);
+/* Server notification parameter JSON writers */
+void write_did_open_text_document_params(json_writer_t * p_writer, const did_open_text_document_params_t * p_value);
+void write_did_change_text_document_params(json_writer_t * p_writer, const did_change_text_document_params_t * p_value);
+void write_did_save_text_document_params(json_writer_t * p_writer, const did_save_text_document_params_t * p_value);
+void write_did_close_text_document_params(json_writer_t * p_writer, const did_close_text_document_params_t * p_value);
+void write_did_change_watched_files_params(json_writer_t * p_writer, const did_change_watched_files_params_t * p_value);
@@ -58,6 +58,7 @@ typedef enum
     COMPLETION_ITEM_KIND_COLOR = 16,
     COMPLETION_ITEM_KIND_FILE = 17,
     COMPLETION_ITEM_KIND_REFERENCE = 18,
+    COMPLETION_ITEM_KIND_FOLDER = 19,
 } completion_item_kind_t;
 
 typedef enum
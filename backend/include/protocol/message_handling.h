@@ -17,6 +17,25 @@
 #define LSP_NOTIFICATION_TELEMETRY_EVENT "telemetry/event"
 #define LSP_REQUEST_WINDOW_SHOW_MESSAGE_REQUEST "window/showMessageRequest"
 
+/*******************************************************************************
+ * Incoming messages
+ ******************************************************************************/
+#define LSP_REQUEST_INITIALIZE "initialize"
+#define LSP_REQUEST_WORKSPACE_SYMBOL "workspace/symbol"
+#define LSP_REQUEST_TEXT_DOCUMENT_DOCUMENT_SYMBOL "textDocument/documentSymbol"
+#define LSP_REQUEST_TEXT_DOCUMENT_COMPLETION "textDocument/completion"
+#define LSP_REQUEST_COMPLETION_ITEM_RESOLVE "completionItem/resolve"
+#define LSP_REQUEST_TEXT_DOCUMENT_SIGNATURE_HELP "textDocument/signatureHelp"
+#define LSP_REQUEST_TEXT_DOCUMENT_DEFINITION "textDocument/definition"
+#define LSP_REQUEST_TEXT_DOCUMENT_REFERENCES "textDocument/references"
+#define LSP_REQUEST_TEXT_DOCUMENT_DOCUMENT_LINK "textDocument/documentLink"
+#define LSP_REQUEST_TEXT_DOCUMENT_HOVER "textDocument/hover"
+#define LSP_REQUEST_TEXT_DOCUMENT_CODE_ACTION "textDocument/codeAction"
+#define LSP_NOTIFICATION_TEXT_DOCUMENT_DID_OPEN "textDocument/didOpen"
+#define LSP_NOTIFICATION_TEXT_DOCUMENT_DID_CHANGE "textDocument/didChange"
+#define LSP_NOTIFICATION_TEXT_DOCUMENT_DID_SAVE "textDocument/didSave"
+#define LSP_NOTIFICATION_TEXT_DOCUMENT_DID_CLOSE "textDocument/didClose"
+
 /*******************************************************************************
  * Request handler types
  ******************************************************************************/
@@ -24,6 +43,7 @@ typedef void (*lsp_request_handler_initialize_t)(const initialize_params_t * p_p
 typedef void (*lsp_request_handler_workspace_symbol_t)(const workspace_symbol_params_t * p_params, json_t * p_response);
 typedef void (*lsp_request_handler_text_document_document_symbol_t)(const document_symbol_params_t * p_params, json_t * p_response);
 typedef void (*lsp_request_handler_text_document_completion_t)(const text_document_position_params_t * p_params, json_t * p_response);
+typedef void (*lsp_request_handler_completion_item_resolve_t)(const completion_item_t * p_params, json_t * p_response);
 typedef void (*lsp_request_handler_text_document_signature_help_t)(const text_document_position_params_t * p_params, json_t * p_response);
 typedef void (*lsp_request_handler_text_document_definition_t)(const text_document_position_params_t * p_params, json_t * p_response);
 typedef void (*lsp_request_handler_text_document_references_t)(const reference_params_t * p_params, json_t * p_response);
@@ -46,6 +66,7 @@ void lsp_request_handler_initialize_register(lsp_request_handler_initialize_t ha
 void lsp_request_handler_workspace_symbol_register(lsp_request_handler_workspace_symbol_t handler);
 void lsp_request_handler_text_document_document_symbol_register(lsp_request_handler_text_document_document_symbol_t handler);
 void lsp_request_handler_text_document_completion_register(lsp_request_handler_text_document_completion_t handler);
+void lsp_request_handler_completion_item_resolve_register(lsp_request_handler_completion_item_resolve_t handler);
 void lsp_request_handler_text_document_signature_help_register(lsp_request_handler_text_document_signature_help_t handler);
 void lsp_request_handler_text_document_definition_register(lsp_request_handler_text_document_definition_t handler);
 void lsp_request_handler_text_document_references_register(lsp_request_handler_text_document_references_t handler);
@@ -6,41 +6,55 @@
 #include "uri.h"
 #include "assert.h"
 #include "utils.h"
+#include "json_writer.h"
+#include "json_reader.h"
 /**
  * @file Parsing of native types from json
  */
 
 
-static inline uri_t decode_uri(json_t * p_json)
+static inline bool read_uri(json_reader_t * p_reader, uri_t * p_value)
 {
-#ifdef PROTOCOL_DEBUG
-    ASSERT(json_is_string(p_json));
-#endif
-    return uri_decode(json_string_value(p_json));
+    const char * p_string = json_reader_string(p_reader);
+    if (p_string)
+    {
+        *p_value = uri_decode(p_string);
+    }
+    return (p_string != NULL);
 }
 
-static inline char * decode_string(json_t * p_json)
+/** Strings are left in the buffer they were read from, and aren't copied. */
+static inline bool read_string(json_reader_t * p_reader, char ** p_value)
 {
-#ifdef PROTOCOL_DEBUG
-    ASSERT(json_is_string(p_json));
-#endif
-    return STRDUP(json_string_value(p_json));
+    *p_value = json_reader_string(p_reader);
+    return (*p_value != NULL);
 }
 
-static inline int64_t decode_number(json_t * p_json)
+static inline bool read_number(json_reader_t * p_reader, int64_t * p_value)
 {
-#ifdef PROTOCOL_DEBUG
-    ASSERT(json_is_integer(p_json));
-#endif
-    return json_integer_value(p_json);
+    return json_reader_integer(p_reader, p_value);
 }
 
-static inline bool decode_boolean(json_t * p_json)
+static inline bool read_boolean(json_reader_t * p_reader, bool * p_value)
 {
-#ifdef PROTOCOL_DEBUG
-    ASSERT(json_is_boolean(p_json));
-#endif
-    return json_boolean_value(p_json);
+    return json_reader_boolean(p_reader, p_value);
+}
+
+/**
+ * Make room for one more element in an array that's being read, doubling its size whenever it's full.
+ */
+static inline void * read_array_reserve(void * p_array, uint32_t count, size_t element_size)
+{
+    if (count == 0 || (count >= 4 && (count & (count - 1)) == 0))
+    {
+        p_array = REALLOC(p_array, element_size * (count == 0 ? 4 : count * 2));
+    }
+    return p_array;
+}
+
+static inline void release_uri(uri_t * p_uri)
+{
+    uri_free_members(p_uri);
 }
 
 static inline json_t * encode_uri(uri_t value)
@@ -66,6 +80,28 @@ static inline json_t * encode_boolean(bool value)
     return json_boolean(value);
 }
 
+static inline void write_uri(json_writer_t * p_writer, uri_t value)
+{
+    char * p_encoded = uri_encode(&value);
+    json_writer_string(p_writer, p_encoded);
+    free(p_encoded);
+}
+
+static inline void write_string(json_writer_t * p_writer, char * value)
+{
+    json_writer_string(p_writer, value);
+}
+
+static inline void write_number(json_writer_t * p_writer, int64_t value)
+{
+    json_writer_integer(p_writer, value);
+}
+
+static inline void write_boolean(json_writer_t * p_writer, bool value)
+{
+    json_writer_boolean(p_writer, value);
+}
+
 static inline void free_uri(uri_t uri)
 {
     uri_free_members(&uri);
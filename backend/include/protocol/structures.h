@@ -28,8 +28,10 @@ typedef enum
 {
     INITIALIZATION_OPTIONS_FIELD_FLAGS                = (1 << 0),
     INITIALIZATION_OPTIONS_FIELD_COMPILATION_DATABASE = (1 << 1),
+    INITIALIZATION_OPTIONS_FIELD_WORKER_THREADS       = (1 << 2),
+    INITIALIZATION_OPTIONS_FIELD_MEMORY_BUDGET        = (1 << 3),
 
-    INITIALIZATION_OPTIONS_FIELD_ALL = (0x3),
+    INITIALIZATION_OPTIONS_FIELD_ALL = (0xf),
 } initialization_options_fields_t;
 
 typedef enum
@@ -565,6 +567,8 @@ typedef struct
     uint32_t flags_count;
     compilation_database_params_t * p_compilation_database;
     uint32_t compilation_database_count;
+    int64_t worker_threads;
+    int64_t memory_budget;
 } initialization_options_t;
 
 typedef struct
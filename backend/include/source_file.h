@@ -2,26 +2,64 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "structures.h"
+#include "utils.h"
 
+typedef struct source_file_chunk source_file_chunk_t;
+
+/**
+ * Immutable, reference counted copy of a source file's contents at a given version.
+ */
 typedef struct
 {
+    char * p_filename;
     char * p_contents;
     size_t size;
+    uint32_t version;
+    atomic_counter_t refs;
+} source_file_snapshot_t;
+
+typedef struct
+{
+    char * p_filename;
+    source_file_chunk_t * p_root; ///< Rope of text chunks, indexed by byte offset and line.
+    source_file_snapshot_t * p_snapshot; ///< Snapshot of the current version, or NULL if it hasn't been made yet.
+    size_t size;
+    uint32_t version;
     bool unsaved;
 } source_file_t;
 
 
 
-source_file_t * source_file_create(const char * p_contents);
+source_file_t * source_file_create(const char * p_filename, const char * p_contents);
 void source_file_contents_set(source_file_t * p_source_file, const char * p_new_contents);
 
 void source_file_free(source_file_t * p_source_file);
-void source_file_patch(source_file_t * p_source_file, const char * p_new_contents, const position_t * p_start_pos, size_t old_len);
+void source_file_patch(source_file_t * p_source_file, const char * p_new_contents, const range_t * p_range);
 
-// bool source_file_unload(const source_file_t * p_source_file);
+/**
+ * Get the contents of the source file as a single, zero terminated string.
+ *
+ * The flat copy is built lazily on the first call after an edit, and is owned by the source file.
+ * It is invalidated by the next call to source_file_patch or source_file_contents_set.
+ */
+const char * source_file_contents_get(source_file_t * p_source_file);
+
+/**
+ * Take a reference to a snapshot of the current version of the file.
+ *
+ * All callers get the same snapshot until the file changes, so this only copies the contents once per
+ * version. The snapshot stays valid after the file changes, until it's released.
+ */
+source_file_snapshot_t * source_file_snapshot_get(source_file_t * p_source_file);
+
+void source_file_snapshot_release(source_file_snapshot_t * p_snapshot);
 
-// const char * source_file_contents_get(source_file_t * p_source_file);
-// const char * source_file_line_get(const source_file_t * p_source_file, uint32_t line);
+/**
+ * Get a copy of the given line, without the line ending. Returns NULL if the line is out of range.
+ */
+char * source_file_line_get(const source_file_t * p_source_file, uint32_t line);
+
+// bool source_file_unload(const source_file_t * p_source_file);
 
 // bool source_file_edit_apply(const source_file_t * p_source_file, const text_edit_t * p_edit);
 
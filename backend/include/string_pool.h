@@ -0,0 +1,44 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Id of an interned string. Ids are never reused, and the string stays valid until the pool is freed.
+ */
+typedef uint32_t string_id_t;
+
+#define STRING_ID_NONE 0
+
+/**
+ * Start the process wide string pool.
+ *
+ * Strings are copied into large arena blocks and deduplicated through a hash table, so every distinct
+ * path, USR and name is only stored once, no matter how many units and declarations refer to it.
+ */
+void string_pool_init(void);
+
+/**
+ * Get the id of the given string, adding it to the pool if it's not there already.
+ *
+ * @param[in] p_string String to intern, or NULL.
+ *
+ * @returns The string's id, or STRING_ID_NONE for NULL.
+ */
+string_id_t string_pool_intern(const char * p_string);
+
+/**
+ * Get the pooled copy of the given string. Pooled strings can be compared by pointer.
+ */
+const char * string_pool_string(const char * p_string);
+
+/**
+ * Get the string with the given id, or NULL for STRING_ID_NONE. Does not take any locks.
+ */
+const char * string_pool_get(string_id_t id);
+
+/**
+ * Number of strings and bytes of string data in the pool.
+ */
+void string_pool_stats(uint32_t * p_count, size_t * p_size);
+
+void string_pool_free(void);
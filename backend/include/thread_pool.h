@@ -0,0 +1,88 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils.h"
+
+/**
+ * Task priorities, highest first. Workers always take the highest priority task available, from any
+ * worker, before looking at the next level. Background tasks have workers of their own.
+ */
+typedef enum
+{
+    THREAD_POOL_PRIORITY_INTERACTIVE, ///< Requests the user is waiting for, like completion and hover.
+    THREAD_POOL_PRIORITY_ACTIVE,      ///< Reparsing after changes to the open documents.
+    THREAD_POOL_PRIORITY_BACKGROUND,  ///< Indexing.
+
+    THREAD_POOL_PRIORITY_COUNT
+} thread_pool_priority_t;
+
+/** Time spent waiting in the queue for one priority level. */
+typedef struct
+{
+    uint64_t count;
+    uint64_t wait_total; ///< Nanoseconds
+    uint64_t wait_max;   ///< Nanoseconds
+} thread_pool_stats_t;
+
+typedef void (*thread_pool_task_t)(void * p_args);
+typedef void (*thread_pool_group_callback_t)(void * p_args);
+
+/**
+ * Set of tasks that complete as one. The callback is called from the worker that finishes the last
+ * task, after the group has been closed.
+ */
+typedef struct
+{
+    atomic_counter_t pending;
+    thread_pool_group_callback_t callback;
+    void * p_args;
+} thread_pool_group_t;
+
+/**
+ * Start the process wide worker pool.
+ *
+ * Every worker has its own task deque. Tasks submitted from a worker go on its own deque and are run
+ * newest first, while idle workers steal the oldest tasks from the others.
+ *
+ * Foreground workers run the interactive and active tasks at the normal thread priority, and as many
+ * background workers run the background tasks at a low one, so indexing neither keeps requests waiting
+ * for a worker nor slows them down once they have one.
+ *
+ * @param[in] thread_count Number of workers of each kind, or 0 to use one per hardware thread.
+ */
+void thread_pool_init(unsigned thread_count);
+
+unsigned thread_pool_thread_count(void);
+
+/**
+ * Queue a task for the pool.
+ *
+ * @param[in] task Function to run.
+ * @param[in] p_args Arguments to pass to the function.
+ * @param[in] priority Priority of the task.
+ * @param[in] p_group Group to add the task to, or NULL.
+ */
+void thread_pool_submit(thread_pool_task_t task, void * p_args, thread_pool_priority_t priority, thread_pool_group_t * p_group);
+
+void thread_pool_group_init(thread_pool_group_t * p_group, thread_pool_group_callback_t callback, void * p_args);
+
+/**
+ * Stop adding tasks to the group. The callback is called once all of its tasks are done, which may
+ * be right away.
+ */
+void thread_pool_group_close(thread_pool_group_t * p_group);
+
+/**
+ * Add a queue wait time to the stats of the given priority.
+ *
+ * Called by the pool for its own tasks, and by anyone else scheduling work of the same class outside
+ * of it.
+ */
+void thread_pool_stats_record(thread_pool_priority_t priority, uint64_t wait_time);
+
+void thread_pool_stats_get(thread_pool_priority_t priority, thread_pool_stats_t * p_stats);
+
+/**
+ * Wait for all queued tasks to complete, then stop the workers.
+ */
+void thread_pool_free(void);
@@ -25,25 +25,40 @@ typedef struct
     range_t range;
 } fixit_t;
 
+typedef struct completion_cache completion_cache_t;
+
 typedef struct
 {
     char * p_filename;
     compile_flags_t flags;
 
-    CXTranslationUnit tu;
+    CXTranslationUnit tu; ///< Published generation, which requests read from. Guarded by mutex.
+    CXTranslationUnit next_tu; ///< Spare generation for the next reparse to go into, or NULL. Guarded by reparse_mutex.
+    uint64_t tu_memory; ///< Bytes held by the published generation. Guarded by reparse_mutex.
+    uint64_t next_tu_memory; ///< Bytes held by the spare generation. Guarded by reparse_mutex.
     bool active;
     HashTable * diag_files;
+    completion_cache_t * p_completion_cache; ///< Candidates of the last completion, for the published translation unit. Guarded by mutex.
 
     fixit_t * p_fixits;
     unsigned fixit_count;
 
-    mutex_t mutex;
+    mutex_t mutex; ///< Held while reading the published translation unit.
+    mutex_t reparse_mutex; ///< Held while a new generation is built. Only taken without holding mutex.
     mutex_t decl_mutex;
 
-    Array * p_declarations;
+    /* Reparse scheduling, guarded by the unit storage. */
+    uint32_t changes_scheduled; ///< Changes to the unit's documents so far.
+    uint32_t changes_parsed; ///< Changes the translation unit has been parsed with. Guarded by reparse_mutex.
+    profile_time_t reparse_time; ///< When the scheduled reparse may start, or 0 if none is scheduled.
+
+    struct preamble * p_preamble; ///< Precompiled header the translation units were parsed with, or NULL. Guarded by reparse_mutex.
+    uint32_t preamble_generation; ///< Build of p_preamble the translation units were parsed with. Guarded by reparse_mutex.
+
+    uint32_t first_declaration; ///< Head of the unit's list in the declaration store
     Array * p_references;
     HashTable * p_included_files;
-    char * p_main_header;
+    const char * p_main_header; ///< Pooled
     unsigned main_header_score;
 } unit_t;
 
@@ -52,7 +67,9 @@ typedef struct
     uint32_t completion_priority_max;
     uint32_t completion_results_max;
     uint32_t diagnostics_max;
-    char * p_index_file;
+    char * p_index_directory; ///< Directory for the index shards, one per unit.
+    uint32_t spare_units_max; ///< Units that may keep a second translation unit to reparse into, so requests never wait for the reparse.
+    char * p_preamble_directory; ///< Directory for the precompiled headers shared by units with the same includes, or NULL to not share them.
 } unit_config_t;
 
 typedef enum
@@ -81,14 +98,33 @@ unit_t * unit_create(const char * p_filename,
                      const compile_flags_t * p_flags);
 
 
+/**
+ * Parse the unit from scratch, and publish the result once it's done. Must be called with the unit's
+ * reparse mutex taken, and may be called while the unit is open.
+ */
 bool unit_parse(unit_t * p_unit,
                 struct CXUnsavedFile * p_unsaved_files,
                 uint32_t unsaved_file_count);
 
 void unit_free(unit_t * p_unit);
 
+/**
+ * Dispose of the unit's translation units to free their memory. The unit's symbols stay in the index,
+ * and the unit is parsed again the next time it's needed. Must be called with the unit's reparse mutex taken.
+ */
 void unit_suspend(unit_t * p_unit);
 
+/**
+ * Get the memory held by the unit's translation units, including the spare. Must be called with the
+ * unit's reparse mutex taken.
+ */
+uint64_t unit_memory_usage(unit_t * p_unit);
+
+/**
+ * Bring an open unit up to date. The new generation is built in the spare translation unit while the
+ * published one keeps serving requests, unless the unit is over the spare budget and is reparsed in
+ * place. Failing to reparse in place closes the unit. Must be called with the unit's reparse mutex taken.
+ */
 bool unit_reparse(unit_t * p_unit,
                   struct CXUnsavedFile * p_unsaved_files,
                   uint32_t unsaved_file_count);
@@ -99,7 +135,25 @@ bool unit_code_completion(unit_t * p_unit,
                           struct CXUnsavedFile * p_unsaved_files,
                           uint32_t unsaved_file_count,
                           unit_completion_result_callback_t callback,
-                          void * p_args);
+                          void * p_args,
+                          arena_t * p_arena,
+                          cancel_token_t * p_token);
+
+/**
+ * Fill in the detail and documentation of a completion item, which are left out of completion responses.
+ * Must be called with the unit's mutex taken.
+ *
+ * @param[in] cache_id ID of the completion the item came from.
+ * @param[in] candidate Index of the item's candidate in that completion.
+ * @param[in,out] p_item Item to fill in. The new strings are allocated in the arena.
+ *
+ * @returns false if the completion the item came from has been replaced since.
+ */
+bool unit_completion_resolve(unit_t * p_unit,
+                             uint32_t cache_id,
+                             unsigned candidate,
+                             completion_item_t * p_item,
+                             arena_t * p_arena);
 
 void unit_references_get(unit_t *p_unit, const reference_params_t *p_params,
                          unit_reference_callback_t callback, void *p_args);
@@ -107,7 +161,9 @@ void unit_references_get(unit_t *p_unit, const reference_params_t *p_params,
 unsigned unit_function_signature_get(unit_t *p_unit,
                                      const text_document_position_params_t *p_position,
                                      unit_signature_callback_t callback,
-                                     void *p_args);
+                                     void *p_args,
+                                     arena_t *p_arena,
+                                     cancel_token_t *p_token);
 
 void unit_definition_get(unit_t *p_unit,
                          const text_document_position_params_t *p_position,
@@ -116,7 +172,8 @@ void unit_definition_get(unit_t *p_unit,
 
 bool unit_hover_get(unit_t * p_unit,
                     const text_document_position_params_t * p_position,
-                    hover_t * p_hover);
+                    hover_t * p_hover,
+                    arena_t * p_arena);
 
 unsigned unit_diagnostics_get(unit_t *p_unit,
                               unit_diagnostics_callback_t diag_callback,
@@ -127,10 +184,22 @@ void unit_fixits_resolve(unit_t * p_unit, const char * p_filename, const range_t
 
 bool unit_includes_file(unit_t * p_unit, const char * p_file);
 
+/**
+ * Get the units that included the given file the last time they were parsed or indexed.
+ *
+ * @param[in] p_file Absolute path of the included file.
+ * @param[out] p_count Number of units found.
+ *
+ * @returns Array of units, to be freed by the caller, or NULL if no unit includes the file.
+ */
+unit_t ** unit_dependents_get(const char * p_file, size_t * p_count);
+
 void unit_symbols_get(unit_t * p_unit, unit_symbol_callback_t callback, void * p_args);
 
-bool unit_index_load(time_t * p_timestamp);
-void unit_index_save(time_t timestamp);
+/**
+ * Load the unit's index shard, if none of the files it was built from have changed since it was saved.
+ */
+bool unit_index_load(unit_t * p_unit);
 void unit_index_free(void);
 
 const char * unit_index_source_for_header(const char * p_header);
@@ -8,6 +8,44 @@
 void unit_storage_init(const compile_flags_t * p_base_flags, unit_diagnostics_callback_t diag_callback);
 void unit_storage_wait_for_completion(void);
 void unit_storage_notify_change(const char * p_filename);
+
+/**
+ * Set the memory the open units' translation units may hold, as reported by libclang. The least recently
+ * used units are suspended when a parse takes them over it. 0 means no limit.
+ */
+void unit_storage_memory_budget_set(uint64_t budget);
+
+/**
+ * Make the unit the most recently used one, so that it's the last to be suspended to stay in the memory
+ * budget.
+ */
+void unit_storage_unit_used(unit_t * p_unit);
+
+/**
+ * Bring the units that depend on the files up to date after the files changed on disk. Open units are
+ * reparsed, unless the files are open in the editor, and closed units are indexed again.
+ *
+ * @param[in] pp_paths Changed files, pooled.
+ * @param[in] count Number of changed files.
+ */
+void unit_storage_files_changed(const char * const * pp_paths, unsigned count);
+
+/**
+ * Note that the unit's documents have changed, and reparse it once they have been quiet for a while.
+ * Every change that comes in before then is covered by the same reparse.
+ */
+void unit_storage_change_schedule(unit_t * p_unit);
+
+/**
+ * Bring the unit's translation unit up to date with every change scheduled so far, parsing it if it
+ * isn't open. Publishes the diagnostics if the unit was parsed. Waits for any reparse of the unit that's
+ * already running. Must not be called with the unit's mutex taken, as publishing the new translation
+ * unit takes it.
+ *
+ * @returns false if the unit couldn't be parsed. The unit may still be open, with an older translation
+ *      unit.
+ */
+bool unit_storage_unit_refresh(unit_t * p_unit);
 bool unit_storage_compilation_database_load(const compilation_database_params_t * p_params);
 
 void unit_storage_add(unit_t * p_unit);
@@ -2,10 +2,12 @@
 #include <stdbool.h>
 #include <clang-c/Index.h>
 #include "structures.h"
+#include "source_file.h"
 
 typedef struct
 {
     struct CXUnsavedFile * p_list;
+    source_file_snapshot_t ** pp_snapshots; ///< The snapshots p_list points into, released with the list.
     unsigned count;
 } unsaved_files_t;
 
@@ -13,6 +15,6 @@ void unsaved_files_init(void);
 unsaved_files_t * unsaved_files_get(void);
 void unsaved_file_set(const char * p_filename, const char * p_contents);
 bool unsaved_file_remove(const char * p_filename);
-void unsaved_file_patch(const char * p_filename, const char * p_new_contents, const position_t * p_start_pos, size_t old_len);
+void unsaved_file_patch(const char * p_filename, const char * p_new_contents, const range_t * p_range);
 void unsaved_files_release(unsaved_files_t * p_unsaved_files);
 void unsaved_files_free(void);
\ No newline at end of file
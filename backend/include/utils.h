@@ -1,29 +1,40 @@
 #pragma once
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <time.h>
 #ifdef _WIN32
 #include <crtdbg.h>
 #include <Windows.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
 #endif
 
 #include "log.h"
 
 #define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
 
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325ULL
+
+#ifdef _WIN32
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
 #define MALLOC(SIZE) utils_malloc(SIZE, __FILE__, __LINE__)
 #define CALLOC(SIZE, NUM) utils_calloc(SIZE, NUM, __FILE__, __LINE__)
 #define FREE(MEM) free(MEM)
 #define REALLOC(MEM, SIZE) utils_realloc(MEM, SIZE, __FILE__, __LINE__)
-#if _WIN32
 #define STRDUP(STR) utils_strdup(STR, __FILE__, __LINE__)
-#else
-#define STRDUP(STR) strdup(STR)
-#endif
 
 #ifndef min
 #define min(a, b) (((a) < (b)) ? (a) : (b))
 #endif
+#ifndef max
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
 
 static inline void * utils_malloc(size_t size, const char * p_filename, unsigned line)
 {
@@ -57,7 +68,11 @@ static inline void * utils_realloc(void * p_data, size_t size, const char * p_fi
 }
 static inline char * utils_strdup(const char * p_string, const char * p_filename, unsigned line)
 {
+#ifdef _WIN32
     char * p_data = _strdup(p_string);
+#else
+    char * p_data = strdup(p_string);
+#endif
     if (p_data == NULL && p_string != NULL)
     {
         LOG("Malloc failed at %s:%u (string: %s)\n", p_filename, line, p_string);
@@ -89,17 +104,66 @@ typedef struct
 {
     LONG value;
 } atomic_counter_t;
+#else
+typedef struct
+{
+    pthread_mutex_t mutex;
+} mutex_t;
+
+typedef struct
+{
+    sem_t sem;
+} semaphore_t;
+
+typedef struct
+{
+    int value;
+} atomic_counter_t;
+#endif
 
-typedef DWORD profile_time_t;
+/** Read only memory mapping of a whole file. */
+typedef struct
+{
+    const void * p_data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
 #endif
+} mapped_file_t;
+
+typedef struct arena_block arena_block_t;
+
+/**
+ * Bump pointer allocator, for memory that's all released at the same time. Zero initialized arenas are
+ * empty and ready for use.
+ */
+typedef struct
+{
+    arena_block_t * p_blocks; ///< Newest first.
+    size_t used; ///< Bytes handed out since the last reset.
+    size_t peak; ///< Most bytes handed out between two resets.
+    uint32_t allocations; ///< Allocations since the last reset.
+} arena_t;
+
+/** Timestamp in nanoseconds, from a monotonic clock. */
+typedef uint64_t profile_time_t;
 
 typedef struct
 {
     mutex_t mut;
-    mutex_t owner_mut;
+    mutex_t gate; ///< Held by the owner while it waits, so that new borrowers queue up behind it.
+    semaphore_t owner_sem; ///< Not a mutex, as the last borrower to leave may not be the one that took it.
     unsigned users;
 } shared_resource_t;
 
+/** Cancellation flag for long running work, which is expected to poll it and stop early. */
+typedef struct
+{
+    atomic_counter_t cancelled;
+    profile_time_t deadline; ///< Time after which the work should stop, or 0 for no deadline.
+} cancel_token_t;
+
 typedef enum
 {
     THREAD_PRIO_LOW,
@@ -118,6 +182,7 @@ void line_array_free(line_array_t * p_line_array);
 thread_t * thread_start(thread_function_t function, void * p_args, thread_priority_t priority);
 
 void thread_join(thread_t * p_thread);
+unsigned thread_hardware_concurrency(void);
 void thread_cancel(thread_t * p_thread);
 
 void mutex_init(mutex_t *  p_mut);
@@ -128,10 +193,23 @@ void mutex_free(mutex_t * p_mut);
 
 void semaphore_init(semaphore_t * p_sem, unsigned max_count);
 void semaphore_wait(semaphore_t * p_sem);
+
+/**
+ * Wait for the semaphore, giving up after the timeout.
+ *
+ * @returns Whether the semaphore was taken.
+ */
+bool semaphore_wait_timeout(semaphore_t * p_sem, uint64_t timeout_ns);
 void semaphore_signal(semaphore_t * p_sem);
 
+/**
+ * Atomically increment or decrement the counter.
+ *
+ * @returns The new value of the counter.
+ */
 int atomic_get_and_add(atomic_counter_t * p_counter);
 int atomic_get_and_sub(atomic_counter_t * p_counter);
+int atomic_get(atomic_counter_t * p_counter);
 
 void shared_resource_init(shared_resource_t * p_resource);
 void shared_resource_borrow(shared_resource_t * p_resource);
@@ -139,7 +217,88 @@ void shared_resource_release(shared_resource_t * p_resource);
 void shared_resource_lock(shared_resource_t * p_resource);
 void shared_resource_unlock(shared_resource_t * p_resource);
 
+/**
+ * Initialize a cancellation token.
+ *
+ * @param[in] timeout_ns Time from now until the deadline passes, or 0 for no deadline.
+ */
+void cancel_token_init(cancel_token_t * p_token, uint64_t timeout_ns);
+void cancel_token_cancel(cancel_token_t * p_token);
+
+/**
+ * Check whether the token has been explicitly cancelled. Passing deadlines don't count.
+ */
+bool cancel_token_is_cancelled(cancel_token_t * p_token);
+
+/**
+ * Check whether the work should stop, because the token is cancelled or the deadline has passed.
+ * A NULL token never stops.
+ */
+bool cancel_token_should_stop(cancel_token_t * p_token);
+
+bool mapped_file_open(mapped_file_t * p_file, const char * p_path);
+void mapped_file_close(mapped_file_t * p_file);
+
+/**
+ * Allocate memory in the arena. It stays valid until the arena is reset or freed.
+ */
+void * arena_alloc(arena_t * p_arena, size_t size);
+char * arena_strdup(arena_t * p_arena, const char * p_string);
+char * arena_sprintf(arena_t * p_arena, const char * p_format, ...);
+
+/**
+ * Release everything allocated in the arena at once. The first block is kept for the next allocations.
+ */
+void arena_reset(arena_t * p_arena);
+void arena_free(arena_t * p_arena);
+
+/**
+ * Write the whole buffer to stdout, bypassing the stdio buffers.
+ */
+bool output_write(const void * p_data, size_t size);
+
 bool string_fuzzy_match(const char * p_string, const char * p_pattern);
 
+/**
+ * Get a bitmap of the characters in the string, ignoring case. A string can only fuzzy match a pattern
+ * if it has all of the pattern's characters, so comparing the bitmaps rejects most candidates in a
+ * single instruction, before scoring them.
+ *
+ * The bitmap is built with a plain loop over the bytes rather than with vector instructions: completion
+ * candidates get theirs once, when they are cached, and only the pattern's is built per keystroke, so
+ * the loop only ever runs over short identifiers, where the setup and tail handling of a vector loop would
+ * cost more than they save.
+ */
+uint64_t string_char_mask(const char * p_string);
+
+static inline bool string_char_mask_covers(uint64_t string_mask, uint64_t pattern_mask)
+{
+    return ((pattern_mask & ~string_mask) == 0);
+}
+
+/**
+ * Score how well the pattern matches the string as a case insensitive subsequence. Matches at the start
+ * of the string, of snake_case and camelCase segments, and runs of consecutive characters score higher,
+ * and gaps between the matched characters lower the score.
+ *
+ * @param[out] p_score Score of the best match, higher is better.
+ *
+ * @returns Whether the pattern matches at all.
+ */
+bool string_fuzzy_score(const char * p_string, const char * p_pattern, int32_t * p_score);
+
+/**
+ * Continue a 64 bit FNV-1a hash with the given data. Hashes start out as FNV_OFFSET_BASIS.
+ */
+uint64_t hash_fnv1a(uint64_t hash, const void * p_data, size_t size);
+
 profile_time_t profile_start(void);
-unsigned profile_end(profile_time_t start_time);
+
+/**
+ * Get the time since the given start time.
+ *
+ * @returns Elapsed time in nanoseconds.
+ */
+uint64_t profile_end(profile_time_t start_time);
+
+#define PROFILE_NS_TO_MS(ns) ((unsigned) ((ns) / 1000000))
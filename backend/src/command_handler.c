@@ -15,8 +15,12 @@
 #include "decoders.h"
 #include "json_rpc.h"
 #include "path.h"
+#include "thread_pool.h"
+#include "file_watcher.h"
+#include "string_pool.h"
 
-#define REPARSE_RETRIES_MAX 5
+#define COMPLETION_DEADLINE_MS 2000
+#define SIGNATURE_HELP_DEADLINE_MS 1000
 
 static const char * m_base_flags[] = {"-ferror-limit=0"};
 
@@ -24,31 +28,41 @@ static char * m_signature_trigger_characters[] = {"(", ","};
 static char * m_completion_trigger_characters[] = {".", ">", ":"};
 static compile_flags_t m_flags;
 
-static unit_t * mp_current_unit;
+static mutex_t m_units_mut; ///< Handlers for different documents run at the same time, and may share units.
+
+typedef struct
+{
+    compilation_database_params_t params;
+    const char * p_file; ///< Pooled path of the compile_commands.json.
+} compilation_database_t;
+
+/** Databases from the initialization options, loaded again whenever they change. Guarded by m_units_mut. */
+static compilation_database_t * mp_compilation_databases;
+static unsigned m_compilation_database_count;
 
 static void diag_callback(unit_t * p_unit, const publish_diagnostics_params_t * p_diagnostics, void * p_args)
 {
-    json_t * p_params = p_args;
-    json_rpc_notification_send(LSP_NOTIFICATION_TEXT_DOCUMENT_PUBLISH_DIAGNOSTICS,
-                               encode_publish_diagnostics_params(*p_diagnostics));
+    json_writer_t * p_writer = json_rpc_notification_begin(LSP_NOTIFICATION_TEXT_DOCUMENT_PUBLISH_DIAGNOSTICS);
+    write_publish_diagnostics_params(p_writer, p_diagnostics);
+    json_rpc_notification_end(p_writer);
 }
 
 static void completion_callback(const completion_item_t * p_result, unsigned index, void * p_args)
 {
-    json_t * p_response = p_args;
-    json_array_append_new(p_response, encode_completion_item(*p_result));
+    json_writer_t * p_writer = p_args;
+    write_completion_item(p_writer, p_result);
 }
 
 static void signature_callback(const signature_information_t * p_info, unsigned index, void * p_args)
 {
-    json_t * p_info_array = p_args;
-    json_array_append_new(p_info_array, encode_signature_information(*p_info));
+    json_writer_t * p_writer = p_args;
+    write_signature_information(p_writer, p_info);
 }
 
 static void definition_callback(const location_t * p_location, unsigned index, void * p_args, definition_type_t type)
 {
     ASSERT(p_args && p_location);
-    json_t * p_definition_array = p_args;
+    json_writer_t * p_writer = p_args;
 
     LOG("CALLBACK URI:\n\tscheme: %s\n\tauthority: %s\n\tpath: %s\n\tquery: %s\n\tfragment: %s\n\ttype: %s\n",
         p_location->uri.scheme,
@@ -57,12 +71,12 @@ static void definition_callback(const location_t * p_location, unsigned index, v
         p_location->uri.query,
         p_location->uri.fragment,
         (type == DEFINITION_TYPE_DEFINITION ? "DEFINITION" : "REFERENCE"));
-    json_array_append_new(p_definition_array, encode_location(*p_location));
+    write_location(p_writer, p_location);
 }
 
 static void symbol_callback(const location_t * p_location, const char * p_name, symbol_kind_t kind, void * p_args)
 {
-    json_t * p_symbol_array = p_args;
+    json_writer_t * p_writer = p_args;
     symbol_information_t info;
     info.kind = kind;
     info.location = *p_location;
@@ -71,7 +85,7 @@ static void symbol_callback(const location_t * p_location, const char * p_name,
                          SYMBOL_INFORMATION_FIELD_LOCATION |
                          SYMBOL_INFORMATION_FIELD_LOCATION |
                          SYMBOL_INFORMATION_FIELD_NAME);
-    json_array_append_new(p_symbol_array, encode_symbol_information(info));
+    write_symbol_information(p_writer, &info);
 }
 
 static unit_t * add_unit(const char * p_path)
@@ -91,39 +105,180 @@ static unit_t * add_unit(const char * p_path)
     return p_unit;
 }
 
-static unit_t * get_or_create_unit(const char * p_filename)
+/**
+ * Get the unit for the file, adding it if there isn't one yet. The unit isn't locked, and may not be parsed.
+ */
+static unit_t * find_or_add_unit(const char * p_filename)
 {
     char * p_normalized_filename = normalize_path(p_filename);
 
-    /* If this file is represented as a unit, reparse it. */
+    mutex_take(&m_units_mut);
     unit_t * p_unit = unit_storage_get(p_normalized_filename);
 
     if (!p_unit)
     {
         p_unit = add_unit(p_normalized_filename);
     }
+    mutex_release(&m_units_mut);
+    FREE(p_normalized_filename);
+    return p_unit;
+}
+
+/**
+ * Get the unit for the file if it's open, locked like get_or_create_unit.
+ */
+static unit_t * get_open_unit(const char * p_filename)
+{
+    char * p_normalized_filename = normalize_path(p_filename);
+
+    mutex_take(&m_units_mut);
+    unit_t * p_unit = unit_storage_get(p_normalized_filename);
+    mutex_release(&m_units_mut);
     FREE(p_normalized_filename);
 
-    if (!p_unit->active)
+    if (p_unit)
+    {
+        mutex_take(&p_unit->mutex);
+        if (!p_unit->active)
+        {
+            mutex_release(&p_unit->mutex);
+            p_unit = NULL;
+        }
+    }
+    return p_unit;
+}
+
+/**
+ * Get the unit for the file, parsing it if it isn't open yet. The unit is locked, and must be given back
+ * with put_unit once the handler is done with it. Its translation unit stays the same while it's locked,
+ * as reparses publish theirs when the unit is given back.
+ *
+ * @param[in] refresh Reparse the unit first if it has changes that haven't been parsed yet. Otherwise the
+ *      last good translation unit is used, without waiting for a reparse that's running.
+ */
+static unit_t * get_or_create_unit(const char * p_filename, bool refresh)
+{
+    unit_t * p_unit = find_or_add_unit(p_filename);
+
+    unit_storage_unit_used(p_unit);
+
+    mutex_take(&p_unit->mutex);
+    if (refresh || !p_unit->active)
     {
-        unsaved_files_t * p_unsaved_files = unsaved_files_get();
-        if (!unit_parse(p_unit, p_unsaved_files->p_list, p_unsaved_files->count))
+        /* Another unit's parse may suspend this one to stay in the memory budget before it's locked. */
+        bool parsed;
+        do
+        {
+            mutex_release(&p_unit->mutex);
+            parsed = unit_storage_unit_refresh(p_unit);
+            mutex_take(&p_unit->mutex);
+        } while (parsed && !p_unit->active);
+
+        if (!p_unit->active)
         {
             LOG("Failed parsing unit\n");
             compile_flags_print(&p_unit->flags);
+            mutex_take(&m_units_mut);
             unit_storage_remove(p_unit->p_filename);
+            mutex_release(&m_units_mut);
+            mutex_release(&p_unit->mutex);
             return NULL;
         }
-        unsaved_files_release(p_unsaved_files);
+        else if (!parsed)
+        {
+            LOG("Failed reparsing unit, using the last good one\n");
+        }
     }
-    mp_current_unit = p_unit;
     return p_unit;
 }
+
+static void put_unit(unit_t * p_unit)
+{
+    mutex_release(&p_unit->mutex);
+}
+
+/** Must be called with m_units_mut taken. */
+static void compilation_database_add(const compilation_database_params_t * p_params)
+{
+    mp_compilation_databases = REALLOC(mp_compilation_databases, sizeof(compilation_database_t) * (m_compilation_database_count + 1));
+    compilation_database_t * p_database = &mp_compilation_databases[m_compilation_database_count++];
+
+    p_database->params.valid_fields = p_params->valid_fields;
+    p_database->params.path = STRDUP(p_params->path);
+    p_database->params.additional_arguments_count = p_params->additional_arguments_count;
+    p_database->params.p_additional_arguments = MALLOC(sizeof(char *) * max(1, p_params->additional_arguments_count));
+    for (uint32_t i = 0; i < p_params->additional_arguments_count; ++i)
+    {
+        p_database->params.p_additional_arguments[i] = STRDUP(p_params->p_additional_arguments[i]);
+    }
+
+    char * p_directory = absolute_path(p_params->path, path_cwd());
+    char * p_file = absolute_path("compile_commands.json", p_directory);
+    p_database->p_file = string_pool_string(p_file);
+    FREE(p_file);
+    FREE(p_directory);
+
+    /* Watched even if it failed to load, so that it's loaded once it's there. */
+    file_watcher_add(p_database->p_file);
+}
+
+static void watched_files_changed(const char * const * pp_paths, unsigned count, void * p_args)
+{
+    const char ** pp_sources = MALLOC(sizeof(const char *) * count);
+    unsigned source_count = 0;
+
+    mutex_take(&m_units_mut);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        bool database = false;
+        for (unsigned j = 0; j < m_compilation_database_count; ++j)
+        {
+            if (path_equals(pp_paths[i], mp_compilation_databases[j].p_file))
+            {
+                database = true;
+                bool loaded = unit_storage_compilation_database_load(&mp_compilation_databases[j].params);
+                LOG("Reloading of compilation database at %s %s.\n",
+                    mp_compilation_databases[j].params.path,
+                    loaded ? "was successful" : "FAILED");
+            }
+        }
+
+        if (!database)
+        {
+            pp_sources[source_count++] = pp_paths[i];
+        }
+    }
+    mutex_release(&m_units_mut);
+
+    if (source_count > 0)
+    {
+        unit_storage_files_changed(pp_sources, source_count);
+    }
+    FREE(pp_sources);
+}
+
 /******************************************************************************
  * Message Handlers
  *****************************************************************************/
 static void handle_request_initialize(const initialize_params_t * p_params, json_t * p_response)
 {
+    unsigned worker_threads = 0;
+    if ((p_params->valid_fields & INITIALIZE_PARAMS_FIELD_INITIALIZATION_OPTIONS) &&
+        (p_params->initialization_options.valid_fields & INITIALIZATION_OPTIONS_FIELD_WORKER_THREADS) &&
+        p_params->initialization_options.worker_threads > 0)
+    {
+        worker_threads = (unsigned) p_params->initialization_options.worker_threads;
+    }
+    thread_pool_init(worker_threads);
+    file_watcher_init(watched_files_changed, NULL);
+
+    if ((p_params->valid_fields & INITIALIZE_PARAMS_FIELD_INITIALIZATION_OPTIONS) &&
+        (p_params->initialization_options.valid_fields & INITIALIZATION_OPTIONS_FIELD_MEMORY_BUDGET) &&
+        p_params->initialization_options.memory_budget >= 0)
+    {
+        unit_storage_memory_budget_set((uint64_t) p_params->initialization_options.memory_budget * 1024ULL * 1024ULL);
+    }
+
     if (p_params->valid_fields & INITIALIZE_PARAMS_FIELD_INITIALIZATION_OPTIONS)
     {
         if ((p_params->initialization_options.valid_fields & INITIALIZATION_OPTIONS_FIELD_FLAGS) && p_params->initialization_options.flags_count > 0)
@@ -147,13 +302,18 @@ static void handle_request_initialize(const initialize_params_t * p_params, json
 
         if (p_params->initialization_options.valid_fields & INITIALIZATION_OPTIONS_FIELD_COMPILATION_DATABASE && p_params->initialization_options.compilation_database_count > 0)
         {
+            /* The watcher is already running, and reloads the databases from its own thread as soon as
+             * their files are watched. */
+            mutex_take(&m_units_mut);
             for (unsigned i = 0; i < p_params->initialization_options.compilation_database_count; ++i)
             {
                 bool loaded = unit_storage_compilation_database_load(&p_params->initialization_options.p_compilation_database[i]);
                 LOG("Loading of compilation database at %s %s.\n",
                     p_params->initialization_options.p_compilation_database[i].path,
                     loaded ? "was successful" : "FAILED");
+                compilation_database_add(&p_params->initialization_options.p_compilation_database[i]);
             }
+            mutex_release(&m_units_mut);
         }
     }
 
@@ -163,7 +323,7 @@ static void handle_request_initialize(const initialize_params_t * p_params, json
             .text_document_sync =
             {
                 .open_close = true,
-                .change = TEXT_DOCUMENT_SYNC_KIND_FULL,
+                .change = TEXT_DOCUMENT_SYNC_KIND_INCREMENTAL,
                 .save =
                 {
                     .include_text = false,
@@ -173,7 +333,7 @@ static void handle_request_initialize(const initialize_params_t * p_params, json
             },
             .completion_provider =
             {
-                .resolve_provider = false,
+                .resolve_provider = true,
                 .p_trigger_characters = m_completion_trigger_characters,
                 .trigger_characters_count = ARRAY_SIZE(m_completion_trigger_characters),
                 .valid_fields = COMPLETION_OPTIONS_FIELD_ALL
@@ -199,7 +359,9 @@ static void handle_request_initialize(const initialize_params_t * p_params, json
         },
         .valid_fields = INITIALIZE_RESULT_FIELD_CAPABILITIES
     };
-    json_rpc_response_send(p_response, encode_initialize_result(result));
+    json_writer_t * p_writer = json_rpc_response_begin(p_response);
+    write_initialize_result(p_writer, &result);
+    json_rpc_response_end(p_writer);
 }
 
 static void handle_notification_text_document_did_save(const did_save_text_document_params_t * p_params)
@@ -207,6 +369,12 @@ static void handle_notification_text_document_did_save(const did_save_text_docum
     if (p_params->text_document.uri.path)
     {
         // unsaved_file_remove(p_params->text_document.uri.path);
+
+        /* The closed units that include the file are indexed again from the saved contents. It's
+         * debounced with the watcher's own changes, which may report the same save. */
+        char * p_path = absolute_path(p_params->text_document.uri.path, path_cwd());
+        file_watcher_notify(p_path);
+        FREE(p_path);
     }
 }
 
@@ -216,11 +384,12 @@ static void handle_notification_text_document_did_open(const did_open_text_docum
     {
         unsaved_file_set(p_params->text_document.uri.path, p_params->text_document.text);
 
-        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path);
+        /* Parsing the unit publishes its diagnostics. */
+        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path, true);
 
         if (p_unit)
         {
-            unit_diagnostics_get(p_unit, diag_callback, NULL, NULL);
+            put_unit(p_unit);
         }
 
     }
@@ -234,51 +403,25 @@ static void handle_notification_text_document_did_change(const did_change_text_d
         for (unsigned i = 0; i < p_params->content_changes_count; ++i)
         {
             LOG("Handle change #%u of %u\n", i, p_params->content_changes_count);
-            if (p_params->p_content_changes[i].valid_fields == TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_ALL)
+            /* The deprecated rangeLength counts UTF-16 code units, so the replaced text is taken from the
+             * range alone. Changes without a range replace the whole document. */
+            if (p_params->p_content_changes[i].valid_fields & TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_RANGE)
             {
                 unsaved_file_patch(p_params->text_document.uri.path,
                                    p_params->p_content_changes[i].text,
-                                   &p_params->p_content_changes[i].range.start,
-                                   (size_t) p_params->p_content_changes[i].range_length);
+                                   &p_params->p_content_changes[i].range);
             }
             else
             {
-                ASSERT(p_params->p_content_changes[i].valid_fields == TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_TEXT);
                 unsaved_file_set(p_params->text_document.uri.path, p_params->p_content_changes[i].text);
             }
         }
 
-        LOG("Fetching unit %s (0x%p)\n", p_params->text_document.uri.path, p_params->text_document.uri.path);
-
-        /* If this file is represented as a unit, reparse it. */
-        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path);
-        if (p_unit)
-        {
-            LOG("\tFound file.\n");
-
-            unsaved_files_t * p_unsaved_files = unsaved_files_get();
-            unsigned retries = 0;
-            while (!unit_reparse(p_unit, p_unsaved_files->p_list, p_unsaved_files->count) && retries < REPARSE_RETRIES_MAX)
-            {
-                retries++;
-            }
-            unsaved_files_release(p_unsaved_files);
-
-            if (retries == REPARSE_RETRIES_MAX)
-            {
-                LOG("Reparse of %s failed. Removing unit.\n", p_unit->p_filename);
-                unit_storage_remove(p_unit->p_filename);
-                unit_free(p_unit);
-                p_unit = NULL;
-                mp_current_unit = NULL;
-            }
-            else
-            {
-                LOG("Reparse of %s successful\n", p_params->text_document.uri.path);
-                unit_diagnostics_get(p_unit, diag_callback, NULL, NULL);
-            }
-            unit_storage_notify_change(p_params->text_document.uri.path);
-        }
+        /* The patches are applied right away, so that every request sees them, but the reparse waits for
+         * the document to go quiet. Requests that need the changes parsed get them parsed first. */
+        LOG("Scheduling reparse of %s, version %lld\n", p_params->text_document.uri.path, (long long) p_params->text_document.version);
+        unit_storage_change_schedule(find_or_add_unit(p_params->text_document.uri.path));
+        unit_storage_notify_change(p_params->text_document.uri.path);
     }
 }
 
@@ -290,7 +433,6 @@ static void handle_notification_text_document_did_close(const did_close_text_doc
     //     if (p_unit)
     //     {
     //         unit_free(p_unit);
-    //         mp_current_unit = NULL;
     //     }
     }
 }
@@ -299,27 +441,38 @@ static void handle_request_text_document_completion(const text_document_position
 {
     if (p_params->text_document.uri.path)
     {
-        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path);
+        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path, false);
 
         if (p_unit)
         {
             LOG("Completion at %s:%llu:%llu\n", p_params->text_document.uri.path, p_params->position.line, p_params->position.character);
-            json_t * p_response_params = json_array();
+            /* The items are written as they're produced, so the completion list comes first, and whether
+             * it's complete is only added after it. */
+            json_writer_t * p_writer = json_rpc_response_begin(p_response);
+            json_writer_object_start(p_writer);
+            json_writer_key(p_writer, "items");
+            json_writer_array_start(p_writer);
             unsaved_files_t * p_unsaved_files = unsaved_files_get();
-            bool complete = unit_code_completion(p_unit, p_params, p_unsaved_files->p_list, p_unsaved_files->count, completion_callback, p_response_params);
+            cancel_token_t * p_token = json_rpc_cancel_token();
+            bool complete = unit_code_completion(p_unit, p_params, p_unsaved_files->p_list, p_unsaved_files->count, completion_callback, p_writer, json_rpc_arena(), p_token);
             unsaved_files_release(p_unsaved_files);
+            put_unit(p_unit);
 
-            LOG("Code completion successful (%u results%s)\n", json_array_size(p_response_params), complete ? "" : ", incomplete");
-            if (complete)
+            if (cancel_token_is_cancelled(p_token))
             {
-                json_rpc_response_send(p_response, p_response_params);
+                /* Replaces the partial response in the writer. */
+                json_rpc_error_response_send(p_response, JSON_RPC_ERROR_REQUEST_CANCELLED, "Request cancelled", NULL);
             }
             else
             {
-                json_t * p_response_obj = json_object();
-                json_object_set_new(p_response_obj, "isIncomplete", json_true());
-                json_object_set_new(p_response_obj, "items", p_response_params);
-                json_rpc_response_send(p_response, p_response_obj);
+                /* Results cut short by the deadline are still sent, so the client asks again as the user types. */
+                json_writer_array_end(p_writer);
+                json_writer_key(p_writer, "isIncomplete");
+                json_writer_boolean(p_writer, !complete);
+                json_writer_object_end(p_writer);
+
+                LOG("Code completion successful%s\n", complete ? "" : " (incomplete)");
+                json_rpc_response_end(p_writer);
             }
         }
         else
@@ -333,20 +486,64 @@ static void handle_request_text_document_completion(const text_document_position
     }
 }
 
+static void handle_request_completion_item_resolve(const completion_item_t * p_params, json_t * p_response)
+{
+    completion_item_t item = *p_params;
+    const char * p_filename;
+    json_int_t cache_id;
+    json_int_t candidate;
+
+    /* Items from a completion that has been replaced are sent back as they are. */
+    if (p_params->data && json_unpack(p_params->data, "{s:s, s:I, s:I}",
+                                      "file", &p_filename,
+                                      "cache", &cache_id,
+                                      "candidate", &candidate) == 0)
+    {
+        unit_t * p_unit = get_open_unit(p_filename);
+        if (p_unit)
+        {
+            if (!unit_completion_resolve(p_unit, (uint32_t) cache_id, (unsigned) candidate, &item, json_rpc_arena()))
+            {
+                LOG("Completion item \"%s\" is out of date\n", p_params->label);
+            }
+            put_unit(p_unit);
+        }
+    }
+
+    json_writer_t * p_writer = json_rpc_response_begin(p_response);
+    write_completion_item(p_writer, &item);
+    json_rpc_response_end(p_writer);
+}
+
 static void handle_request_text_document_signature_help(const text_document_position_params_t * p_params, json_t * p_response)
 {
     if (p_params->text_document.uri.path)
     {
-        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path);
+        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path, true);
         if (p_unit)
         {
-            json_t * p_signature_array = json_array();
-            unsigned param_index = unit_function_signature_get(p_unit, p_params, signature_callback, p_signature_array);
-            json_t * p_response_params = json_object();
-            json_object_set_new(p_response_params, "signatures", p_signature_array);
-            json_object_set_new(p_response_params, "activeSignature", json_integer(0));
-            json_object_set_new(p_response_params, "activeParameter", json_integer(param_index));
-            json_rpc_response_send(p_response, p_response_params);
+            cancel_token_t * p_token = json_rpc_cancel_token();
+            json_writer_t * p_writer = json_rpc_response_begin(p_response);
+            json_writer_object_start(p_writer);
+            json_writer_key(p_writer, "signatures");
+            json_writer_array_start(p_writer);
+            unsigned param_index = unit_function_signature_get(p_unit, p_params, signature_callback, p_writer, json_rpc_arena(), p_token);
+            put_unit(p_unit);
+
+            if (cancel_token_is_cancelled(p_token))
+            {
+                json_rpc_error_response_send(p_response, JSON_RPC_ERROR_REQUEST_CANCELLED, "Request cancelled", NULL);
+            }
+            else
+            {
+                json_writer_array_end(p_writer);
+                json_writer_key(p_writer, "activeSignature");
+                json_writer_integer(p_writer, 0);
+                json_writer_key(p_writer, "activeParameter");
+                json_writer_integer(p_writer, param_index);
+                json_writer_object_end(p_writer);
+                json_rpc_response_end(p_writer);
+            }
         }
         else
         {
@@ -363,13 +560,16 @@ static void handle_request_text_document_definition(const text_document_position
 {
     if (p_params->text_document.uri.path)
     {
-        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path);
+        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path, false);
         if (p_unit)
         {
-            json_t * p_location_array = json_array();
-            unit_definition_get(p_unit, p_params, definition_callback, p_location_array);
+            json_writer_t * p_writer = json_rpc_response_begin(p_response);
+            json_writer_array_start(p_writer);
+            unit_definition_get(p_unit, p_params, definition_callback, p_writer);
+            put_unit(p_unit);
+            json_writer_array_end(p_writer);
             LOG("Sending response...\n");
-            json_rpc_response_send(p_response, p_location_array);
+            json_rpc_response_end(p_writer);
         }
         else
         {
@@ -388,13 +588,16 @@ static void handle_request_text_document_hover(const text_document_position_para
 
     if (p_params->text_document.uri.path)
     {
-        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path);
+        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path, false);
         if (p_unit)
         {
-            if (unit_hover_get(p_unit, p_params, &hover))
+            bool found = unit_hover_get(p_unit, p_params, &hover, json_rpc_arena());
+            put_unit(p_unit);
+            if (found)
             {
-                json_rpc_response_send(p_response, encode_hover(hover));
-                free_hover(hover);
+                json_writer_t * p_writer = json_rpc_response_begin(p_response);
+                write_hover(p_writer, &hover);
+                json_rpc_response_end(p_writer);
             }
             else
             {
@@ -414,33 +617,40 @@ static void handle_request_text_document_hover(const text_document_position_para
 
 static void handle_request_text_document_code_action(const code_action_params_t * p_params, json_t * p_response)
 {
-    json_t * p_rsp_args = json_array();
-    if (mp_current_unit)
+    json_writer_t * p_writer = json_rpc_response_begin(p_response);
+    json_writer_array_start(p_writer);
+    unit_t * p_unit = p_params->text_document.uri.path ? get_or_create_unit(p_params->text_document.uri.path, true) : NULL;
+    if (p_unit)
     {
-        unsigned count = mp_current_unit->fixit_count;
+        unsigned count = p_unit->fixit_count;
         command_t * p_commands = malloc(count * sizeof(command_t));
-        unit_fixits_resolve(mp_current_unit, p_params->text_document.uri.path, &p_params->range, p_commands, &count);
+        unit_fixits_resolve(p_unit, p_params->text_document.uri.path, &p_params->range, p_commands, &count);
+        put_unit(p_unit);
         for (unsigned i = 0; i < count; ++i)
         {
-            json_array_append_new(p_rsp_args, encode_command(p_commands[i]));
+            write_command(p_writer, &p_commands[i]);
             free(p_commands[i].title);
+            json_decref(p_commands[i].arguments);
         }
         free(p_commands);
     }
-
-    json_rpc_response_send(p_response, p_rsp_args);
+    json_writer_array_end(p_writer);
+    json_rpc_response_end(p_writer);
 }
 
 static void handle_request_text_document_document_symbol(const document_symbol_params_t * p_params, json_t * p_response)
 {
     if (p_params->text_document.uri.path)
     {
-        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path);
+        unit_t * p_unit = get_or_create_unit(p_params->text_document.uri.path, false);
         if (p_unit)
         {
-            json_t * p_symbol_array = json_array();
-            unit_symbols_get(p_unit, symbol_callback, p_symbol_array);
-            json_rpc_response_send(p_response, p_symbol_array);
+            json_writer_t * p_writer = json_rpc_response_begin(p_response);
+            json_writer_array_start(p_writer);
+            unit_symbols_get(p_unit, symbol_callback, p_writer);
+            put_unit(p_unit);
+            json_writer_array_end(p_writer);
+            json_rpc_response_end(p_writer);
         }
         else
         {
@@ -455,11 +665,14 @@ static void handle_request_text_document_document_symbol(const document_symbol_p
 
 void command_handler_init(void)
 {
+    mutex_init(&m_units_mut);
     unit_config_t config;
     config.completion_priority_max = 10000;
     config.completion_results_max = 500;
     config.diagnostics_max = 1000;
-    config.p_index_file = ".vscode/clang-index.json";
+    config.p_index_directory = ".vscode/clang-index";
+    config.p_preamble_directory = ".vscode/clang-index/preambles";
+    config.spare_units_max = 4;
     unit_init(&config);
     const compile_flags_t base_flags = {
         .pp_array = (char **) m_base_flags,
@@ -474,10 +687,14 @@ void command_handler_init(void)
     lsp_notification_handler_text_document_did_open_register(handle_notification_text_document_did_open);
     lsp_notification_handler_text_document_did_close_register(handle_notification_text_document_did_close);
     lsp_request_handler_text_document_completion_register(handle_request_text_document_completion);
+    lsp_request_handler_completion_item_resolve_register(handle_request_completion_item_resolve);
     lsp_request_handler_text_document_signature_help_register(handle_request_text_document_signature_help);
     lsp_request_handler_text_document_definition_register(handle_request_text_document_definition);
     lsp_request_handler_text_document_hover_register(handle_request_text_document_hover);
     lsp_request_handler_text_document_code_action_register(handle_request_text_document_code_action);
     lsp_request_handler_text_document_document_symbol_register(handle_request_text_document_document_symbol);
+
+    json_rpc_request_deadline_set(LSP_REQUEST_TEXT_DOCUMENT_COMPLETION, COMPLETION_DEADLINE_MS);
+    json_rpc_request_deadline_set(LSP_REQUEST_TEXT_DOCUMENT_SIGNATURE_HELP, SIGNATURE_HELP_DEADLINE_MS);
 }
 
@@ -0,0 +1,396 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "file_watcher.h"
+#include "hashtable.h"
+#include "string_pool.h"
+#include "path.h"
+#include "utils.h"
+#include "log.h"
+
+#ifndef _WIN32
+    #include <sys/inotify.h>
+    #include <poll.h>
+    #include <unistd.h>
+    #include <errno.h>
+    #define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE)
+#endif
+
+#define WATCHER_QUIET_PERIOD_MS  200  ///< Time without changes before a burst is reported.
+#define WATCHER_DELAY_MAX_MS     2000 ///< Longest a change waits for its burst to end.
+#define WATCHER_POLL_INTERVAL_MS 3000
+#define MS_TO_NS(ms) ((uint64_t) (ms) * 1000000ULL)
+
+typedef struct
+{
+    const char * p_path; ///< Pooled
+    time_t last_edit; ///< Only kept for polled files.
+    bool polled;
+} watched_file_t;
+
+static struct
+{
+    mutex_t mut;
+    HashTable * p_files; ///< Watched files, by path.
+    HashTable * p_changed; ///< Changes that haven't been reported yet, by path.
+    profile_time_t first_change;
+    profile_time_t last_change;
+    unsigned polled_count;
+    file_watcher_callback_t callback;
+    void * p_args;
+    bool stopping;
+    thread_t * p_thread;
+#ifdef _WIN32
+    semaphore_t sem; ///< Wakes the thread up.
+#else
+    int inotify_fd; ///< -1 if inotify isn't available.
+    int wake_pipe[2];
+    HashTable * p_directories; ///< Watched directories, by path.
+    const char ** pp_watches; ///< Watched directories, by watch descriptor.
+    unsigned watch_capacity;
+#endif
+} m_watcher;
+
+/** Must be called with the watcher's mutex taken. */
+static void change_add(const char * p_path)
+{
+    profile_time_t now = profile_start();
+    if (hashtable_size(m_watcher.p_changed) == 0)
+    {
+        m_watcher.first_change = now;
+    }
+    m_watcher.last_change = now;
+    if (!hashtable_contains_key(m_watcher.p_changed, (void *) p_path))
+    {
+        ASSERT(hashtable_add(m_watcher.p_changed, (void *) p_path, (void *) p_path) == CC_OK);
+    }
+}
+
+static void watcher_wake(void)
+{
+#ifdef _WIN32
+    semaphore_signal(&m_watcher.sem);
+#else
+    char byte = 0;
+    if (write(m_watcher.wake_pipe[1], &byte, 1) < 0)
+    {
+        LOG("Waking up the file watcher failed\n");
+    }
+#endif
+}
+
+#ifndef _WIN32
+/**
+ * Watch the file's directory with inotify. Must be called with the watcher's mutex taken.
+ *
+ * @returns false if the directory can't be watched, and the file must be polled.
+ */
+static bool directory_watch(const char * p_path)
+{
+    if (m_watcher.inotify_fd < 0)
+    {
+        return false;
+    }
+
+    char * p_directory = STRDUP(p_path);
+    char * p_last_slash = strrchr(p_directory, '/');
+    if (!p_last_slash)
+    {
+        FREE(p_directory);
+        return false;
+    }
+    *p_last_slash = '\0';
+    const char * p_pooled_directory = string_pool_string(p_directory);
+    FREE(p_directory);
+
+    if (hashtable_contains_key(m_watcher.p_directories, (void *) p_pooled_directory))
+    {
+        return true;
+    }
+
+    int wd = inotify_add_watch(m_watcher.inotify_fd, p_pooled_directory, WATCH_EVENTS);
+    if (wd < 0)
+    {
+        LOG("Can't watch %s (errno %d), polling its files instead\n", p_pooled_directory, errno);
+        return false;
+    }
+    if ((unsigned) wd >= m_watcher.watch_capacity)
+    {
+        unsigned capacity = max((unsigned) wd + 1, m_watcher.watch_capacity * 2);
+        m_watcher.pp_watches = REALLOC(m_watcher.pp_watches, sizeof(const char *) * capacity);
+        memset(&m_watcher.pp_watches[m_watcher.watch_capacity], 0, sizeof(const char *) * (capacity - m_watcher.watch_capacity));
+        m_watcher.watch_capacity = capacity;
+    }
+    m_watcher.pp_watches[wd] = p_pooled_directory;
+    ASSERT(hashtable_add(m_watcher.p_directories, (void *) p_pooled_directory, (void *) p_pooled_directory) == CC_OK);
+    return true;
+}
+
+/** Must be called with the watcher's mutex taken. */
+static void all_files_changed(void)
+{
+    HashTableIter iter;
+    hashtable_iter_init(&iter, m_watcher.p_files);
+    TableEntry * p_entry;
+    while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+    {
+        change_add(p_entry->key);
+    }
+}
+
+static void inotify_events_read(void)
+{
+    char buffer[16 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length = read(m_watcher.inotify_fd, buffer, sizeof(buffer));
+    if (length <= 0)
+    {
+        return;
+    }
+
+    mutex_take(&m_watcher.mut);
+    for (char * p_next = buffer; p_next < buffer + length; )
+    {
+        const struct inotify_event * p_event = (const struct inotify_event *) p_next;
+        p_next += sizeof(struct inotify_event) + p_event->len;
+
+        if (p_event->mask & IN_Q_OVERFLOW)
+        {
+            /* Events were lost, so any of the files may have changed. */
+            LOG("File watcher events overflowed, treating all files as changed\n");
+            all_files_changed();
+        }
+        else if (p_event->wd >= 0 && (unsigned) p_event->wd < m_watcher.watch_capacity && m_watcher.pp_watches[p_event->wd])
+        {
+            const char * p_directory = m_watcher.pp_watches[p_event->wd];
+            if (p_event->mask & IN_IGNORED)
+            {
+                /* The directory is gone, it's watched again if a file in it is added again. */
+                hashtable_remove(m_watcher.p_directories, (void *) p_directory, NULL);
+                m_watcher.pp_watches[p_event->wd] = NULL;
+            }
+            else if (p_event->len > 0)
+            {
+                char path[4096];
+                snprintf(path, sizeof(path), "%s/%s", p_directory, p_event->name);
+                watched_file_t * p_file;
+                if (hashtable_get(m_watcher.p_files, path, (void **) &p_file) == CC_OK)
+                {
+                    change_add(p_file->p_path);
+                }
+            }
+        }
+    }
+    mutex_release(&m_watcher.mut);
+}
+#endif
+
+/**
+ * Sleep until the timeout passes, the watcher is woken up, or inotify has events.
+ * Reads the inotify events if there are any.
+ */
+static void watcher_wait(uint64_t timeout_ns)
+{
+#ifdef _WIN32
+    semaphore_wait_timeout(&m_watcher.sem, timeout_ns);
+#else
+    struct pollfd fds[2] = {
+        {.fd = m_watcher.wake_pipe[0], .events = POLLIN},
+        {.fd = m_watcher.inotify_fd, .events = POLLIN},
+    };
+    int count = poll(fds, (m_watcher.inotify_fd >= 0) ? 2 : 1, (int) ((timeout_ns + 999999) / 1000000));
+    if (count > 0 && (fds[0].revents & POLLIN))
+    {
+        char buffer[64];
+        if (read(m_watcher.wake_pipe[0], buffer, sizeof(buffer)) < 0)
+        {
+            LOG("Reading the file watcher's wake up pipe failed\n");
+        }
+    }
+    if (count > 0 && m_watcher.inotify_fd >= 0 && (fds[1].revents & POLLIN))
+    {
+        inotify_events_read();
+    }
+#endif
+}
+
+/** Must be called with the watcher's mutex taken. */
+static void files_poll(void)
+{
+    HashTableIter iter;
+    hashtable_iter_init(&iter, m_watcher.p_files);
+    TableEntry * p_entry;
+    while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+    {
+        watched_file_t * p_file = p_entry->value;
+        if (!p_file->polled)
+        {
+            continue;
+        }
+        time_t last_edit;
+        if (!path_last_edit(p_file->p_path, &last_edit))
+        {
+            last_edit = 0; // Deleted files change again when they're created.
+        }
+        if (last_edit != p_file->last_edit)
+        {
+            p_file->last_edit = last_edit;
+            change_add(p_file->p_path);
+        }
+    }
+}
+
+static void watcher_thread(void * p_args)
+{
+    profile_time_t next_poll = profile_start() + MS_TO_NS(WATCHER_POLL_INTERVAL_MS);
+
+    mutex_take(&m_watcher.mut);
+    while (!m_watcher.stopping)
+    {
+        profile_time_t now = profile_start();
+        if (now >= next_poll)
+        {
+            if (m_watcher.polled_count > 0)
+            {
+                files_poll();
+            }
+            next_poll = now + MS_TO_NS(WATCHER_POLL_INTERVAL_MS);
+        }
+
+        profile_time_t wake_time = next_poll;
+        unsigned change_count = (unsigned) hashtable_size(m_watcher.p_changed);
+        if (change_count > 0)
+        {
+            profile_time_t report_time = min(m_watcher.last_change + MS_TO_NS(WATCHER_QUIET_PERIOD_MS),
+                                             m_watcher.first_change + MS_TO_NS(WATCHER_DELAY_MAX_MS));
+            if (report_time <= now)
+            {
+                const char ** pp_paths = MALLOC(sizeof(const char *) * change_count);
+                unsigned count = 0;
+                HashTableIter iter;
+                hashtable_iter_init(&iter, m_watcher.p_changed);
+                TableEntry * p_entry;
+                while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+                {
+                    pp_paths[count++] = p_entry->key;
+                    hashtable_iter_remove(&iter, NULL);
+                }
+                mutex_release(&m_watcher.mut);
+
+                LOG("%u watched files changed\n", count);
+                m_watcher.callback(pp_paths, count, m_watcher.p_args);
+                FREE(pp_paths);
+
+                mutex_take(&m_watcher.mut);
+                continue;
+            }
+            wake_time = min(wake_time, report_time);
+        }
+        mutex_release(&m_watcher.mut);
+
+        watcher_wait(wake_time - now);
+        mutex_take(&m_watcher.mut);
+    }
+    mutex_release(&m_watcher.mut);
+}
+
+void file_watcher_init(file_watcher_callback_t callback, void * p_args)
+{
+    mutex_init(&m_watcher.mut);
+    ASSERT(hashtable_new(&m_watcher.p_files) == CC_OK);
+    ASSERT(hashtable_new(&m_watcher.p_changed) == CC_OK);
+    m_watcher.callback = callback;
+    m_watcher.p_args = p_args;
+    m_watcher.stopping = false;
+#ifdef _WIN32
+    semaphore_init(&m_watcher.sem, 0x7FFFFFFF);
+#else
+    ASSERT(hashtable_new(&m_watcher.p_directories) == CC_OK);
+    ASSERT(pipe(m_watcher.wake_pipe) == 0);
+    m_watcher.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_watcher.inotify_fd < 0)
+    {
+        LOG("inotify isn't available (errno %d), polling watched files instead\n", errno);
+    }
+#endif
+    m_watcher.p_thread = thread_start(watcher_thread, NULL, THREAD_PRIO_LOW);
+}
+
+void file_watcher_free(void)
+{
+    if (!m_watcher.p_thread)
+    {
+        return;
+    }
+    mutex_take(&m_watcher.mut);
+    m_watcher.stopping = true;
+    mutex_release(&m_watcher.mut);
+    watcher_wake();
+    thread_join(m_watcher.p_thread);
+    m_watcher.p_thread = NULL;
+
+    if (hashtable_size(m_watcher.p_files) > 0)
+    {
+        HashTableIter iter;
+        hashtable_iter_init(&iter, m_watcher.p_files);
+        TableEntry * p_entry;
+        while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+        {
+            watched_file_t * p_file;
+            ASSERT(hashtable_iter_remove(&iter, (void **) &p_file) == CC_OK);
+            FREE(p_file);
+        }
+    }
+    hashtable_destroy(m_watcher.p_files);
+    hashtable_destroy(m_watcher.p_changed);
+#ifndef _WIN32
+    if (m_watcher.inotify_fd >= 0)
+    {
+        close(m_watcher.inotify_fd);
+    }
+    close(m_watcher.wake_pipe[0]);
+    close(m_watcher.wake_pipe[1]);
+    hashtable_destroy(m_watcher.p_directories);
+    FREE(m_watcher.pp_watches);
+    m_watcher.watch_capacity = 0;
+#endif
+    mutex_free(&m_watcher.mut);
+}
+
+void file_watcher_add(const char * p_path)
+{
+    if (!m_watcher.p_thread)
+    {
+        return;
+    }
+    mutex_take(&m_watcher.mut);
+    if (!hashtable_contains_key(m_watcher.p_files, (void *) p_path))
+    {
+        watched_file_t * p_file = MALLOC(sizeof(watched_file_t));
+        p_file->p_path = string_pool_string(p_path);
+#ifdef _WIN32
+        p_file->polled = true;
+#else
+        p_file->polled = !directory_watch(p_file->p_path);
+#endif
+        if (!p_file->polled || !path_last_edit(p_file->p_path, &p_file->last_edit))
+        {
+            p_file->last_edit = 0;
+        }
+        m_watcher.polled_count += p_file->polled;
+        ASSERT(hashtable_add(m_watcher.p_files, (void *) p_file->p_path, p_file) == CC_OK);
+    }
+    mutex_release(&m_watcher.mut);
+}
+
+void file_watcher_notify(const char * p_path)
+{
+    if (!m_watcher.p_thread)
+    {
+        return;
+    }
+    mutex_take(&m_watcher.mut);
+    change_add(string_pool_string(p_path));
+    mutex_release(&m_watcher.mut);
+    watcher_wake();
+}
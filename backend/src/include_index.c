@@ -0,0 +1,405 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "include_index.h"
+#include "hashtable.h"
+#include "thread_pool.h"
+#include "path.h"
+#include "utils.h"
+#include "log.h"
+
+#define INCLUDE_PATH_MAX 4096
+#define INCLUDE_INDEX_DEPTH_MAX 16 ///< Directory levels filled in the background, which also stops symlink loops.
+#define INCLUDE_INDEX_ENTRIES_MAX 200000 ///< Entries filled in the background per include directory.
+
+typedef struct include_dir include_dir_t;
+
+typedef struct
+{
+    char * p_name;
+    bool directory;
+    include_dir_t * p_dir; ///< Subdirectory, once it's been looked into.
+} include_entry_t;
+
+struct include_dir
+{
+    include_entry_t * p_entries; ///< Sorted by name.
+    unsigned count;
+    time_t last_edit; ///< Edit time of the directory when it was listed.
+    bool listed;
+    bool stale; ///< The listing must be read again, as changes to the directory may not show in its edit time.
+};
+
+typedef struct
+{
+    char * p_path;
+    include_dir_t * p_dir;
+} include_root_t;
+
+/** Listing of a directory, read without holding the index. */
+typedef struct
+{
+    include_entry_t * p_entries;
+    unsigned count;
+    unsigned capacity;
+    time_t last_edit;
+    bool stale;
+} listing_t;
+
+static struct
+{
+    HashTable * p_roots; ///< By include directory.
+    mutex_t mut;
+} m_include_index;
+
+static void dir_free(include_dir_t * p_dir);
+
+static void entries_free(include_entry_t * p_entries, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        FREE(p_entries[i].p_name);
+        dir_free(p_entries[i].p_dir);
+    }
+    FREE(p_entries);
+}
+
+static void dir_free(include_dir_t * p_dir)
+{
+    if (p_dir)
+    {
+        entries_free(p_dir->p_entries, p_dir->count);
+        FREE(p_dir);
+    }
+}
+
+static int entry_compare(const void * p_a, const void * p_b)
+{
+    return strcmp(((const include_entry_t *) p_a)->p_name, ((const include_entry_t *) p_b)->p_name);
+}
+
+/** Index of the first entry that doesn't sort before the name. */
+static unsigned dir_lower_bound(const include_dir_t * p_dir, const char * p_name)
+{
+    unsigned low = 0;
+    unsigned high = p_dir->count;
+    while (low < high)
+    {
+        unsigned mid = low + (high - low) / 2;
+        if (strcmp(p_dir->p_entries[mid].p_name, p_name) < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static include_entry_t * dir_find(const include_dir_t * p_dir, const char * p_name)
+{
+    unsigned i = dir_lower_bound(p_dir, p_name);
+    if (i < p_dir->count && strcmp(p_dir->p_entries[i].p_name, p_name) == 0)
+    {
+        return &p_dir->p_entries[i];
+    }
+    return NULL;
+}
+
+static void listing_add(const char * p_filename, path_kind_t kind, void * p_args)
+{
+    listing_t * p_listing = p_args;
+    if (kind == PATH_KIND_UNKNOWN)
+    {
+        return;
+    }
+    if (p_listing->count == p_listing->capacity)
+    {
+        p_listing->capacity = max(16u, p_listing->capacity * 2);
+        p_listing->p_entries = REALLOC(p_listing->p_entries, sizeof(include_entry_t) * p_listing->capacity);
+    }
+    include_entry_t * p_entry = &p_listing->p_entries[p_listing->count++];
+    p_entry->p_name = STRDUP(path_filename(p_filename));
+    p_entry->directory = (kind == PATH_KIND_DIRECTORY);
+    p_entry->p_dir = NULL;
+}
+
+/**
+ * Read the listing of a directory.
+ *
+ * @returns false if there's no such directory.
+ */
+static bool listing_read(const char * p_path, listing_t * p_listing)
+{
+    memset(p_listing, 0, sizeof(listing_t));
+    if (!path_is_directory(p_path))
+    {
+        return false;
+    }
+    time_t now = time(NULL);
+    if (path_last_edit(p_path, &p_listing->last_edit))
+    {
+        /* Edits later in the same second won't change the edit time. */
+        p_listing->stale = (p_listing->last_edit >= now);
+    }
+    else
+    {
+        p_listing->stale = true;
+    }
+    path_get_files(p_path, listing_add, false, p_listing);
+    qsort(p_listing->p_entries, p_listing->count, sizeof(include_entry_t), entry_compare);
+    return true;
+}
+
+/**
+ * Replace the listing of the directory, keeping what's known about the subdirectories that are still there.
+ */
+static void dir_update(include_dir_t * p_dir, listing_t * p_listing)
+{
+    for (unsigned i = 0; i < p_listing->count; ++i)
+    {
+        include_entry_t * p_old = dir_find(p_dir, p_listing->p_entries[i].p_name);
+        if (p_old && p_old->directory && p_listing->p_entries[i].directory)
+        {
+            p_listing->p_entries[i].p_dir = p_old->p_dir;
+            p_old->p_dir = NULL;
+        }
+    }
+    entries_free(p_dir->p_entries, p_dir->count);
+    p_dir->p_entries = p_listing->p_entries;
+    p_dir->count = p_listing->count;
+    p_dir->last_edit = p_listing->last_edit;
+    p_dir->stale = p_listing->stale;
+    p_dir->listed = true;
+}
+
+/**
+ * Make sure the listing of the directory is up to date. Must be called with the index held.
+ *
+ * @returns false if the directory is gone.
+ */
+static bool dir_refresh(include_dir_t * p_dir, const char * p_path)
+{
+    time_t last_edit;
+    if (p_dir->listed && !p_dir->stale && path_last_edit(p_path, &last_edit) && last_edit == p_dir->last_edit)
+    {
+        return true;
+    }
+
+    listing_t listing;
+    bool found = listing_read(p_path, &listing);
+    dir_update(p_dir, &listing);
+    return found;
+}
+
+/**
+ * Find the subdirectory at the relative path, without reading any listings. Must be called with the
+ * index held.
+ *
+ * @returns The subdirectory, or NULL if it isn't in the listings read so far.
+ */
+static include_dir_t * dir_lookup(include_dir_t * p_dir, const char * p_relative_path)
+{
+    char component[INCLUDE_PATH_MAX];
+    const char * p_next = p_relative_path;
+    while (*p_next != '\0')
+    {
+        const char * p_end = strchr(p_next, '/');
+        size_t length = (p_end ? (size_t) (p_end - p_next) : strlen(p_next));
+        if (length >= sizeof(component))
+        {
+            return NULL;
+        }
+        memcpy(component, p_next, length);
+        component[length] = '\0';
+
+        include_entry_t * p_entry = dir_find(p_dir, component);
+        if (!p_entry || !p_entry->directory)
+        {
+            return NULL;
+        }
+        if (!p_entry->p_dir)
+        {
+            p_entry->p_dir = CALLOC(1, sizeof(include_dir_t));
+        }
+        p_dir = p_entry->p_dir;
+        p_next = (p_end ? p_end + 1 : p_next + length);
+    }
+    return p_dir;
+}
+
+/**
+ * Fill in the listings of an include directory and its subdirectories that haven't been read yet.
+ */
+static void root_fill(void * p_args)
+{
+    include_root_t * p_root = p_args;
+    unsigned stack_capacity = 64;
+    unsigned stack_count = 0;
+    char ** pp_stack = MALLOC(sizeof(char *) * stack_capacity);
+    pp_stack[stack_count++] = STRDUP("");
+    unsigned entry_count = 0;
+
+    while (stack_count > 0)
+    {
+        char * p_relative_path = pp_stack[--stack_count];
+        char path[INCLUDE_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", p_root->p_path, p_relative_path);
+
+        listing_t listing;
+        bool found = listing_read(path, &listing);
+
+        mutex_take(&m_include_index.mut);
+        include_dir_t * p_dir = dir_lookup(p_root->p_dir, p_relative_path);
+        if (found && p_dir && !p_dir->listed)
+        {
+            dir_update(p_dir, &listing);
+            entry_count += p_dir->count;
+
+            unsigned depth = 0;
+            for (const char * p_it = p_relative_path; *p_it != '\0'; ++p_it)
+            {
+                depth += (*p_it == '/');
+            }
+            for (unsigned i = 0; i < p_dir->count && depth < INCLUDE_INDEX_DEPTH_MAX && entry_count < INCLUDE_INDEX_ENTRIES_MAX; ++i)
+            {
+                if (p_dir->p_entries[i].directory)
+                {
+                    if (stack_count == stack_capacity)
+                    {
+                        stack_capacity *= 2;
+                        pp_stack = REALLOC(pp_stack, sizeof(char *) * stack_capacity);
+                    }
+                    char relative_path[INCLUDE_PATH_MAX];
+                    snprintf(relative_path, sizeof(relative_path), "%s%s/", p_relative_path, p_dir->p_entries[i].p_name);
+                    pp_stack[stack_count++] = STRDUP(relative_path);
+                }
+            }
+        }
+        else
+        {
+            entries_free(listing.p_entries, listing.count);
+        }
+        mutex_release(&m_include_index.mut);
+        FREE(p_relative_path);
+    }
+    FREE(pp_stack);
+    LOG("Indexed %u entries in include directory %s\n", entry_count, p_root->p_path);
+}
+
+/** Must be called with the index held. */
+static include_root_t * root_get(const char * p_path)
+{
+    include_root_t * p_root;
+    if (hashtable_get(m_include_index.p_roots, (void *) p_path, (void **) &p_root) != CC_OK)
+    {
+        p_root = MALLOC(sizeof(include_root_t));
+        p_root->p_path = STRDUP(p_path);
+        p_root->p_dir = CALLOC(1, sizeof(include_dir_t));
+        ASSERT(hashtable_add(m_include_index.p_roots, p_root->p_path, p_root) == CC_OK);
+        thread_pool_submit(root_fill, p_root, THREAD_POOL_PRIORITY_BACKGROUND, NULL);
+    }
+    return p_root;
+}
+
+void include_index_init(void)
+{
+    ASSERT(hashtable_new(&m_include_index.p_roots) == CC_OK);
+    mutex_init(&m_include_index.mut);
+}
+
+void include_index_free(void)
+{
+    if (hashtable_size(m_include_index.p_roots) > 0)
+    {
+        HashTableIter iter;
+        hashtable_iter_init(&iter, m_include_index.p_roots);
+        TableEntry * p_entry;
+        while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+        {
+            include_root_t * p_root;
+            ASSERT(hashtable_iter_remove(&iter, (void **) &p_root) == CC_OK);
+            dir_free(p_root->p_dir);
+            FREE(p_root->p_path);
+            FREE(p_root);
+        }
+    }
+    hashtable_destroy(m_include_index.p_roots);
+    mutex_free(&m_include_index.mut);
+}
+
+bool include_index_find(const char * const * pp_directories,
+                        unsigned directory_count,
+                        const char * p_prefix,
+                        include_index_cb_t callback,
+                        void * p_args)
+{
+    const char * p_name_prefix = path_filename(p_prefix);
+    size_t name_prefix_length = strlen(p_name_prefix);
+    size_t directory_length = (size_t) (p_name_prefix - p_prefix);
+    if (directory_length >= INCLUDE_PATH_MAX / 2)
+    {
+        return true;
+    }
+    char relative_directory[INCLUDE_PATH_MAX / 2];
+    memcpy(relative_directory, p_prefix, directory_length);
+    relative_directory[directory_length] = '\0';
+
+    /* Names that are in more than one include directory are only found in the first one. */
+    HashTable * p_found;
+    ASSERT(hashtable_new(&p_found) == CC_OK);
+    bool complete = true;
+
+    mutex_take(&m_include_index.mut);
+    for (unsigned i = 0; i < directory_count && complete; ++i)
+    {
+        include_root_t * p_root = root_get(pp_directories[i]);
+        include_dir_t * p_dir = p_root->p_dir;
+        char path[INCLUDE_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/", p_root->p_path);
+
+        /* Every level is checked for changes on the way down, as a changed parent may have dropped the
+         * directory. */
+        const char * p_next = relative_directory;
+        while (p_dir && dir_refresh(p_dir, path) && *p_next != '\0')
+        {
+            const char * p_end = strchr(p_next, '/');
+            size_t path_length = strlen(path);
+            snprintf(&path[path_length], sizeof(path) - path_length, "%.*s/", (int) (p_end - p_next), p_next);
+            p_dir = dir_lookup(p_dir, &path[path_length]);
+            p_next = p_end + 1;
+        }
+        if (!p_dir || *p_next != '\0' || !p_dir->listed)
+        {
+            continue;
+        }
+
+        for (unsigned j = dir_lower_bound(p_dir, p_name_prefix);
+             j < p_dir->count && strncmp(p_dir->p_entries[j].p_name, p_name_prefix, name_prefix_length) == 0;
+             ++j)
+        {
+            const include_entry_t * p_entry = &p_dir->p_entries[j];
+            void * p_dummy;
+            if (hashtable_get(p_found, p_entry->p_name, &p_dummy) == CC_OK)
+            {
+                continue;
+            }
+            ASSERT(hashtable_add(p_found, p_entry->p_name, p_entry->p_name) == CC_OK);
+
+            char include_path[INCLUDE_PATH_MAX];
+            snprintf(include_path, sizeof(include_path), "%s%s", relative_directory, p_entry->p_name);
+            if (!callback(include_path, p_entry->directory, p_args))
+            {
+                complete = false;
+                break;
+            }
+        }
+    }
+    mutex_release(&m_include_index.mut);
+
+    hashtable_destroy(p_found);
+    return complete;
+}
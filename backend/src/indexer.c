@@ -1,83 +1,306 @@
+#include <stdint.h>
+#include <stdio.h>
 #include "indexer.h"
-#include "encoders.h"
-#include "decoders.h"
 #include "path.h"
-#include "jansson.h"
 
+#define INDEX_SHARD_MAGIC   0x58444943 /* "CIDX" */
+#define INDEX_SHARD_VERSION 2
+#define INDEX_NO_STRING     UINT32_MAX
 
+/* On-disk layout. All offsets are in bytes from the start of the file, and strings are referred to by
+ * their offset into the string table. The string table goes last, so the other tables stay aligned. */
 typedef struct
 {
-    char * p_USR;
-    Array * p_declarations;
-} declaration_set_t;
+    uint32_t magic;
+    uint32_t version;
+    uint32_t unit;
+    uint32_t main_header;
+    uint32_t dependency_count;
+    uint32_t dependencies_offset;
+    uint32_t symbol_count;
+    uint32_t symbols_offset;
+    uint32_t decl_count;
+    uint32_t decls_offset;
+    uint32_t strings_size;
+    uint32_t strings_offset;
+} index_shard_header_t;
 
 typedef struct
 {
-    char * p_sourcefile;
-    char * p_headerfile;
+    uint64_t hash;
+    uint32_t path;
+    uint32_t reserved;
+} index_shard_dependency_t;
+
+typedef struct
+{
+    uint32_t USR;
+    uint32_t first_decl; ///< Declarations of a symbol are stored next to each other.
+    uint32_t decl_count;
+} index_shard_symbol_t;
+
+typedef struct
+{
+    uint32_t name;
+    uint32_t file;
+    uint32_t line;
+    uint32_t character;
+    uint8_t scope;
+    uint8_t kind;
+    uint16_t reserved;
+} index_shard_decl_t;
+
+/** Symbol of a loaded shard, chained to the symbols with the same USR in the other shards. */
+typedef struct shard_symbol_ref
+{
+    const index_shard_t * p_shard;
+    const index_shard_symbol_t * p_symbol;
+    struct shard_symbol_ref * p_next;
+} shard_symbol_ref_t;
+
+struct index_shard
+{
+    mapped_file_t map;
+    const index_shard_header_t * p_header;
+    const index_shard_dependency_t * p_dependencies;
+    const index_shard_symbol_t * p_symbols; ///< Sorted by USR.
+    const index_shard_decl_t * p_decls;
+    const char * p_strings;
+    shard_symbol_ref_t * p_refs; ///< One per symbol, linked into the index's USR table while the shard is loaded.
+};
+
+typedef struct
+{
+    char * p_data;
+    size_t size;
+    size_t capacity;
+    HashTable * p_offsets;
+} string_table_t;
+
+typedef struct
+{
+    const char * p_path;
+    time_t last_edit;
+    uint64_t hash;
+} file_hash_t;
+
+typedef struct
+{
+    const char * p_USR;
+    index_decl_id_t row;
+} save_row_t;
+
+typedef struct
+{
+    const char * p_sourcefile; ///< Pooled
+    const char * p_headerfile; ///< Pooled
 } header_map_entry_t;
 
-static declaration_set_t * get_set(index_t * p_index, const char * p_USR)
+static const char * shard_string(const index_shard_t * p_shard, uint32_t offset)
+{
+    /* The string table is zero terminated, so any offset inside it gives a valid string. */
+    return (offset < p_shard->p_header->strings_size) ? &p_shard->p_strings[offset] : "";
+}
+
+static void location_build(location_t * p_location, const char * p_path, uint32_t line, uint32_t character)
+{
+    memset(p_location, 0, sizeof(location_t));
+    p_location->uri.scheme = "file";
+    p_location->uri.path = p_path;
+    p_location->range.start.line = line;
+    p_location->range.start.character = character;
+    p_location->range.start.valid_fields = POSITION_FIELD_ALL;
+    p_location->range.end = p_location->range.start;
+    p_location->range.valid_fields = RANGE_FIELD_ALL;
+    p_location->valid_fields = LOCATION_FIELD_ALL;
+}
+
+static void shard_free(index_shard_t * p_shard)
+{
+    mapped_file_close(&p_shard->map);
+    FREE(p_shard->p_refs);
+    FREE(p_shard);
+}
+
+/* The table keeps the key it already has when a value is replaced, and the keys point into the shards,
+ * so the entry is added again, keyed by the shard of its new first symbol. */
+static void shard_symbols_first_set(index_t * p_index, const char * p_USR, shard_symbol_ref_t * p_first)
 {
-    declaration_set_t * p_set;
-    if (hashtable_get(p_index->p_table, (char *) p_USR, &p_set) == CC_OK)
+    hashtable_remove(p_index->p_shard_symbols, (void *) p_USR, NULL);
+    if (p_first)
     {
-        return p_set;
+        const char * p_key = shard_string(p_first->p_shard, p_first->p_symbol->USR);
+        ASSERT(hashtable_add(p_index->p_shard_symbols, (void *) p_key, p_first) == CC_OK);
     }
-    return NULL;
+}
+
+/** Must be called with the index mutex taken. */
+static void shard_symbols_link(index_t * p_index, index_shard_t * p_shard)
+{
+    p_shard->p_refs = MALLOC(sizeof(shard_symbol_ref_t) * max(p_shard->p_header->symbol_count, 1));
+    for (uint32_t i = 0; i < p_shard->p_header->symbol_count; ++i)
+    {
+        shard_symbol_ref_t * p_ref = &p_shard->p_refs[i];
+        const char * p_USR = shard_string(p_shard, p_shard->p_symbols[i].USR);
+        p_ref->p_shard = p_shard;
+        p_ref->p_symbol = &p_shard->p_symbols[i];
+        if (hashtable_get(p_index->p_shard_symbols, (void *) p_USR, (void **) &p_ref->p_next) != CC_OK)
+        {
+            p_ref->p_next = NULL;
+        }
+        shard_symbols_first_set(p_index, p_USR, p_ref);
+    }
+}
+
+/** Must be called with the index mutex taken. */
+static void shard_symbols_unlink(index_t * p_index, index_shard_t * p_shard)
+{
+    for (uint32_t i = 0; i < p_shard->p_header->symbol_count; ++i)
+    {
+        shard_symbol_ref_t * p_ref = &p_shard->p_refs[i];
+        const char * p_USR = shard_string(p_shard, p_shard->p_symbols[i].USR);
+        shard_symbol_ref_t * p_first;
+        ASSERT(hashtable_get(p_index->p_shard_symbols, (void *) p_USR, (void **) &p_first) == CC_OK);
+        if (p_first == p_ref)
+        {
+            shard_symbols_first_set(p_index, p_USR, p_ref->p_next);
+        }
+        else
+        {
+            shard_symbol_ref_t * p_prev = p_first;
+            while (p_prev->p_next != p_ref)
+            {
+                p_prev = p_prev->p_next;
+            }
+            p_prev->p_next = p_ref->p_next;
+        }
+    }
+}
+
+static index_decl_id_t first_with_USR(index_t * p_index, const char * p_USR)
+{
+    void * p_row;
+    if (hashtable_get(p_index->p_table, (char *) p_USR, &p_row) == CC_OK)
+    {
+        return (index_decl_id_t) (uintptr_t) p_row;
+    }
+    return INDEX_DECL_NONE;
+}
+
+static void store_grow(index_decl_store_t * p_store)
+{
+    p_store->capacity = max(p_store->capacity * 2, 1024);
+    p_store->p_USRs = REALLOC(p_store->p_USRs, sizeof(string_id_t) * p_store->capacity);
+    p_store->p_names = REALLOC(p_store->p_names, sizeof(string_id_t) * p_store->capacity);
+    p_store->p_files = REALLOC(p_store->p_files, sizeof(string_id_t) * p_store->capacity);
+    p_store->p_lines = REALLOC(p_store->p_lines, sizeof(uint32_t) * p_store->capacity);
+    p_store->p_characters = REALLOC(p_store->p_characters, sizeof(uint32_t) * p_store->capacity);
+    p_store->p_kinds = REALLOC(p_store->p_kinds, sizeof(uint8_t) * p_store->capacity);
+    p_store->p_scopes = REALLOC(p_store->p_scopes, sizeof(uint8_t) * p_store->capacity);
+    p_store->p_next_with_USR = REALLOC(p_store->p_next_with_USR, sizeof(index_decl_id_t) * p_store->capacity);
+    p_store->p_next_in_unit = REALLOC(p_store->p_next_in_unit, sizeof(index_decl_id_t) * p_store->capacity);
+}
+
+static index_decl_id_t store_row_alloc(index_decl_store_t * p_store)
+{
+    index_decl_id_t row = p_store->free_list;
+    if (row != INDEX_DECL_NONE)
+    {
+        p_store->free_list = p_store->p_next_in_unit[row];
+        return row;
+    }
+    if (p_store->count == p_store->capacity)
+    {
+        store_grow(p_store);
+    }
+    return p_store->count++;
+}
+
+static void row_location(const index_decl_store_t * p_store, index_decl_id_t row, location_t * p_location)
+{
+    location_build(p_location, string_pool_get(p_store->p_files[row]), p_store->p_lines[row], p_store->p_characters[row]);
 }
 
 void index_init(index_t * p_index)
 {
+    memset(&p_index->decls, 0, sizeof(index_decl_store_t));
+    p_index->decls.free_list = INDEX_DECL_NONE;
     mutex_init(&p_index->mut);
+    mutex_init(&p_index->hash_mut);
     ASSERT(hashtable_new(&p_index->p_table) == CC_OK);
     ASSERT(hashtable_new(&p_index->p_header_map) == CC_OK);
+    ASSERT(hashtable_new(&p_index->p_shards) == CC_OK);
+    ASSERT(hashtable_new(&p_index->p_shard_symbols) == CC_OK);
+    ASSERT(hashtable_new(&p_index->p_file_hashes) == CC_OK);
 }
 
 void index_free(index_t * p_index)
 {
+    LOG("Declaration store: %u rows, %u kB\n",
+        p_index->decls.count,
+        (unsigned) (p_index->decls.capacity * (5 * sizeof(uint32_t) + 2 * sizeof(uint8_t) + 2 * sizeof(index_decl_id_t)) / 1024));
+    FREE(p_index->decls.p_USRs);
+    FREE(p_index->decls.p_names);
+    FREE(p_index->decls.p_files);
+    FREE(p_index->decls.p_lines);
+    FREE(p_index->decls.p_characters);
+    FREE(p_index->decls.p_kinds);
+    FREE(p_index->decls.p_scopes);
+    FREE(p_index->decls.p_next_with_USR);
+    FREE(p_index->decls.p_next_in_unit);
+    memset(&p_index->decls, 0, sizeof(index_decl_store_t));
+    hashtable_destroy(p_index->p_table);
 
-    if (hashtable_size(p_index->p_table) > 0)
+    if (hashtable_size(p_index->p_shards) > 0)
     {
-        json_t * p_declarations = json_object();
         HashTableIter iter;
-        hashtable_iter_init(&iter, p_index->p_table);
+        hashtable_iter_init(&iter, p_index->p_shards);
         TableEntry * p_entry;
         while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
         {
-            declaration_set_t * p_decl_set;
-            hashtable_iter_remove(&iter, &p_decl_set);
-            ArrayIter decl_iter;
-            array_iter_init(&decl_iter, p_decl_set->p_declarations);
-            index_declaration_t * p_decl;
-            while (array_iter_next(&decl_iter, &p_decl) == CC_OK)
-            {
-                index_decl_free(p_decl);
-            }
+            index_shard_t * p_shard;
+            hashtable_iter_remove(&iter, &p_shard);
+            shard_free(p_shard);
+        }
+    }
+    hashtable_destroy(p_index->p_shards);
+    hashtable_destroy(p_index->p_shard_symbols);
 
-            array_destroy(p_decl_set->p_declarations);
-            FREE(p_decl_set->p_USR);
-            FREE(p_decl_set);
+    if (hashtable_size(p_index->p_file_hashes) > 0)
+    {
+        HashTableIter iter;
+        hashtable_iter_init(&iter, p_index->p_file_hashes);
+        TableEntry * p_entry;
+        while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+        {
+            file_hash_t * p_file_hash;
+            hashtable_iter_remove(&iter, &p_file_hash);
+            FREE(p_file_hash);
         }
     }
-    hashtable_destroy(p_index->p_table);
+    hashtable_destroy(p_index->p_file_hashes);
 }
 
-void index_declaration_add(index_t * p_index, const char * p_USR, index_declaration_t * p_decl)
+void index_declaration_add(index_t * p_index, const char * p_USR, const index_declaration_t * p_decl, index_decl_id_t * p_unit_decls)
 {
+    string_id_t USR = string_pool_intern(p_USR);
+
     mutex_take(&p_index->mut);
-    declaration_set_t * p_set;
-    if (hashtable_get(p_index->p_table, (char *) p_USR, &p_set) != CC_OK)
-    {
-        p_set = MALLOC(sizeof(declaration_set_t));
-        ASSERT(p_set);
-        p_set->p_USR = STRDUP(p_USR);
-        ASSERT(array_new(&p_set->p_declarations) == CC_OK);
+    index_decl_store_t * p_store = &p_index->decls;
+    index_decl_id_t row = store_row_alloc(p_store);
+    p_store->p_USRs[row] = USR;
+    p_store->p_names[row] = p_decl->name;
+    p_store->p_files[row] = p_decl->file;
+    p_store->p_lines[row] = p_decl->line;
+    p_store->p_characters[row] = p_decl->character;
+    p_store->p_kinds[row] = (uint8_t) p_decl->kind;
+    p_store->p_scopes[row] = (uint8_t) p_decl->scope;
 
-        ASSERT(hashtable_add(p_index->p_table, p_set->p_USR, p_set) == CC_OK);
-    }
-    p_decl->p_USR = p_set->p_USR;
-    ASSERT(array_add(p_set->p_declarations, p_decl) == CC_OK);
+    p_store->p_next_with_USR[row] = first_with_USR(p_index, p_USR);
+    ASSERT(hashtable_add(p_index->p_table, (char *) string_pool_get(USR), (void *) (uintptr_t) row) == CC_OK);
+
+    p_store->p_next_in_unit[row] = *p_unit_decls;
+    *p_unit_decls = row;
 
     mutex_release(&p_index->mut);
 }
@@ -90,49 +313,119 @@ void index_header_set(index_t * p_index, const char * p_sourcefile, const char *
         header_map_entry_t * p_entry;
         if (hashtable_get(p_index->p_header_map, (void *)p_sourcefile, &p_entry) == CC_OK)
         {
-            FREE(p_entry->p_headerfile);
-            p_entry->p_headerfile = STRDUP(p_headerfile);
+            p_entry->p_headerfile = string_pool_string(p_headerfile);
         }
         else
         {
             p_entry = MALLOC(sizeof(header_map_entry_t));
-            p_entry->p_sourcefile = STRDUP(p_sourcefile);
-            p_entry->p_headerfile = STRDUP(p_headerfile);
-            ASSERT(hashtable_add(p_index->p_header_map, p_entry->p_sourcefile, p_entry) == CC_OK);
+            p_entry->p_sourcefile = string_pool_string(p_sourcefile);
+            p_entry->p_headerfile = string_pool_string(p_headerfile);
+            ASSERT(hashtable_add(p_index->p_header_map, (void *) p_entry->p_sourcefile, p_entry) == CC_OK);
         }
     }
     mutex_release(&p_index->mut);
 }
 
-Array * index_decls_get(index_t * p_index, const char * p_USR)
+static void shard_decls_get(const index_shard_t * p_shard, const index_shard_symbol_t * p_symbol, index_decl_callback_t callback, void * p_args)
 {
-    declaration_set_t * p_set = get_set(p_index, p_USR);
-    if (p_set)
+    for (uint32_t i = 0; i < p_symbol->decl_count; ++i)
     {
-        return p_set->p_declarations;
+        const index_shard_decl_t * p_shard_decl = &p_shard->p_decls[p_symbol->first_decl + i];
+
+        /* The location points straight into the mapped file. */
+        location_t location;
+        location_build(&location, shard_string(p_shard, p_shard_decl->file), p_shard_decl->line, p_shard_decl->character);
+        callback(shard_string(p_shard, p_shard_decl->name), &location, (symbol_kind_t) p_shard_decl->kind, p_args);
     }
-    return NULL;
 }
 
-void index_decl_remove(index_t * p_index, const char * p_USR, index_declaration_t * p_decl)
+void index_decls_get(index_t * p_index, const char * p_USR, index_decl_callback_t callback, void * p_args)
 {
     mutex_take(&p_index->mut);
-    declaration_set_t * p_set = get_set(p_index, p_USR);
-    if (p_set)
+    const index_decl_store_t * p_store = &p_index->decls;
+    for (index_decl_id_t row = first_with_USR(p_index, p_USR); row != INDEX_DECL_NONE; row = p_store->p_next_with_USR[row])
     {
-        array_remove(p_set->p_declarations, p_decl, NULL);
-        p_decl->p_USR = NULL;
-        if (array_size(p_set->p_declarations) == 0)
+        location_t location;
+        row_location(p_store, row, &location);
+        callback(string_pool_get(p_store->p_names[row]), &location, (symbol_kind_t) p_store->p_kinds[row], p_args);
+    }
+
+    shard_symbol_ref_t * p_ref;
+    if (hashtable_get(p_index->p_shard_symbols, (void *) p_USR, (void **) &p_ref) == CC_OK)
+    {
+        for (; p_ref; p_ref = p_ref->p_next)
         {
-            hashtable_remove(p_index->p_table, p_set->p_USR, NULL);
-            array_destroy(p_set->p_declarations);
-            FREE(p_set->p_USR);
-            FREE(p_set);
+            shard_decls_get(p_ref->p_shard, p_ref->p_symbol, callback, p_args);
         }
     }
-    else
+    mutex_release(&p_index->mut);
+}
+
+void index_unit_supersede(index_t * p_index, const char * p_unit)
+{
+    mutex_take(&p_index->mut);
+    index_shard_t * p_shard;
+    if (hashtable_remove(p_index->p_shards, (void *) p_unit, &p_shard) == CC_OK)
+    {
+        shard_symbols_unlink(p_index, p_shard);
+        shard_free(p_shard);
+    }
+    mutex_release(&p_index->mut);
+}
+
+void index_unit_decls_remove(index_t * p_index, index_decl_id_t * p_unit_decls)
+{
+    mutex_take(&p_index->mut);
+    index_decl_store_t * p_store = &p_index->decls;
+    index_decl_id_t row = *p_unit_decls;
+    while (row != INDEX_DECL_NONE)
+    {
+        index_decl_id_t next_in_unit = p_store->p_next_in_unit[row];
+
+        /* Unlink the row from its USR's list. The lists are short, there's rarely more than a handful
+         * of definitions of the same symbol. */
+        const char * p_USR = string_pool_get(p_store->p_USRs[row]);
+        index_decl_id_t first = first_with_USR(p_index, p_USR);
+        if (first == row)
+        {
+            if (p_store->p_next_with_USR[row] == INDEX_DECL_NONE)
+            {
+                hashtable_remove(p_index->p_table, (char *) p_USR, NULL);
+            }
+            else
+            {
+                ASSERT(hashtable_add(p_index->p_table, (char *) p_USR, (void *) (uintptr_t) p_store->p_next_with_USR[row]) == CC_OK);
+            }
+        }
+        else
+        {
+            index_decl_id_t prev = first;
+            while (prev != INDEX_DECL_NONE && p_store->p_next_with_USR[prev] != row)
+            {
+                prev = p_store->p_next_with_USR[prev];
+            }
+            ASSERT(prev != INDEX_DECL_NONE);
+            p_store->p_next_with_USR[prev] = p_store->p_next_with_USR[row];
+        }
+
+        p_store->p_USRs[row] = STRING_ID_NONE;
+        p_store->p_next_in_unit[row] = p_store->free_list;
+        p_store->free_list = row;
+        row = next_in_unit;
+    }
+    *p_unit_decls = INDEX_DECL_NONE;
+    mutex_release(&p_index->mut);
+}
+
+void index_unit_decls_get(index_t * p_index, index_decl_id_t unit_decls, index_decl_callback_t callback, void * p_args)
+{
+    mutex_take(&p_index->mut);
+    const index_decl_store_t * p_store = &p_index->decls;
+    for (index_decl_id_t row = unit_decls; row != INDEX_DECL_NONE; row = p_store->p_next_in_unit[row])
     {
-        LOG("Removing %s failed!\n", p_USR);
+        location_t location;
+        row_location(p_store, row, &location);
+        callback(string_pool_get(p_store->p_names[row]), &location, (symbol_kind_t) p_store->p_kinds[row], p_args);
     }
     mutex_release(&p_index->mut);
 }
@@ -143,8 +436,6 @@ void index_header_remove(index_t * p_index, const char * p_sourcefile)
     header_map_entry_t * p_entry;
     if (hashtable_remove(p_index->p_header_map, (void *) p_sourcefile, &p_entry) == CC_OK)
     {
-        FREE(p_entry->p_sourcefile);
-        FREE(p_entry->p_headerfile);
         FREE(p_entry);
     }
     else
@@ -154,116 +445,327 @@ void index_header_remove(index_t * p_index, const char * p_sourcefile)
     mutex_release(&p_index->mut);
 }
 
-void index_decl_free(index_declaration_t * p_decl)
+bool index_file_hash(index_t * p_index, const char * p_path, uint64_t * p_hash)
 {
-    uri_free_members(&p_decl->location.uri);
-    FREE(p_decl->p_name);
-    FREE(p_decl);
+    time_t last_edit;
+    if (!path_last_edit(p_path, &last_edit))
+    {
+        return false;
+    }
+
+    /* Most headers are included by many units, only hash them again if they've been touched. */
+    mutex_take(&p_index->hash_mut);
+    file_hash_t * p_file_hash;
+    bool cached = (hashtable_get(p_index->p_file_hashes, (void *) p_path, &p_file_hash) == CC_OK &&
+                   p_file_hash->last_edit == last_edit);
+    if (cached)
+    {
+        *p_hash = p_file_hash->hash;
+    }
+    mutex_release(&p_index->hash_mut);
+    if (cached)
+    {
+        return true;
+    }
+
+    FILE * f = fopen(p_path, "rb");
+    if (!f)
+    {
+        return false;
+    }
+    uint64_t hash = FNV_OFFSET_BASIS;
+    char buffer[16 * 1024];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    {
+        hash = hash_fnv1a(hash, buffer, length);
+    }
+    fclose(f);
+
+    mutex_take(&p_index->hash_mut);
+    if (hashtable_get(p_index->p_file_hashes, (void *) p_path, &p_file_hash) != CC_OK)
+    {
+        p_file_hash = MALLOC(sizeof(file_hash_t));
+        p_file_hash->p_path = string_pool_string(p_path);
+        ASSERT(hashtable_add(p_index->p_file_hashes, (void *) p_file_hash->p_path, p_file_hash) == CC_OK);
+    }
+    p_file_hash->last_edit = last_edit;
+    p_file_hash->hash = hash;
+    mutex_release(&p_index->hash_mut);
+
+    *p_hash = hash;
+    return true;
 }
 
-bool index_save(index_t * p_index, const char * p_location, time_t timestamp)
+char * index_shard_location(const char * p_directory, const char * p_unit)
 {
-    json_t * p_root = json_object();
-	json_object_set_new(p_root, "timestamp", json_integer(timestamp));
+    uint64_t hash = hash_fnv1a(FNV_OFFSET_BASIS, p_unit, strlen(p_unit));
+    char * p_location = MALLOC(strlen(p_directory) + 1 + 16 + sizeof(".idx"));
+    sprintf(p_location, "%s/%016llx.idx", p_directory, (unsigned long long) hash);
+    return p_location;
+}
 
-    if (hashtable_size(p_index->p_table) > 0)
+static int save_row_compare(const void * p_a, const void * p_b)
+{
+    const save_row_t * p_row_a = p_a;
+    const save_row_t * p_row_b = p_b;
+    return strcmp(p_row_a->p_USR, p_row_b->p_USR);
+}
+
+static uint32_t string_table_add(string_table_t * p_strings, const char * p_string)
+{
+    void * p_offset;
+    if (hashtable_get(p_strings->p_offsets, (void *) p_string, &p_offset) == CC_OK)
     {
-	    json_t * p_declarations = json_object();
-        HashTableIter iter;
-        hashtable_iter_init(&iter, p_index->p_table);
-        TableEntry * p_entry;
-        while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
-        {
-            declaration_set_t * p_decl_set = p_entry->value;
-            json_t * p_decl_array = json_array();
+        return (uint32_t) (uintptr_t) p_offset;
+    }
 
-            ArrayIter decl_iter;
-            array_iter_init(&decl_iter, p_decl_set->p_declarations);
-            index_declaration_t * p_decl;
-            while (array_iter_next(&decl_iter, &p_decl) == CC_OK)
-            {
-                json_t * p_decl_obj = json_object();
-                json_object_set_new(p_decl_obj, "name", json_string(p_decl->p_name));
-                json_object_set_new(p_decl_obj, "location", encode_location(p_decl->location));
-                json_object_set_new(p_decl_obj, "scope", json_integer(p_decl->scope));
-                json_object_set_new(p_decl_obj, "kind", json_integer(p_decl->kind));
-                json_array_append_new(p_decl_array, p_decl_obj);
-            }
+    size_t length = strlen(p_string) + 1;
+    while (p_strings->size + length > p_strings->capacity)
+    {
+        p_strings->capacity = max(p_strings->capacity * 2, 4096);
+        p_strings->p_data = REALLOC(p_strings->p_data, p_strings->capacity);
+    }
+    uint32_t offset = (uint32_t) p_strings->size;
+    memcpy(&p_strings->p_data[offset], p_string, length);
+    p_strings->size += length;
 
-            json_object_set_new(p_declarations, p_decl_set->p_USR, p_decl_array);
-        }
-        json_object_set_new(p_root, "declarations", p_declarations);
+    /* The key must outlive the table, which the declarations do while the shard is saved. */
+    ASSERT(hashtable_add(p_strings->p_offsets, (void *) p_string, (void *) (uintptr_t) offset) == CC_OK);
+    return offset;
+}
+
+bool index_shard_save(index_t * p_index,
+                      const char * p_location,
+                      const char * p_unit,
+                      index_decl_id_t unit_decls,
+                      const char * p_main_header,
+                      const index_dependency_t * p_dependencies,
+                      size_t dependency_count)
+{
+    mutex_take(&p_index->mut);
+    const index_decl_store_t * p_store = &p_index->decls;
+
+    size_t decl_count = 0;
+    for (index_decl_id_t row = unit_decls; row != INDEX_DECL_NONE; row = p_store->p_next_in_unit[row])
+    {
+        decl_count++;
     }
+    save_row_t * p_rows = MALLOC(sizeof(save_row_t) * max(decl_count, 1));
+    decl_count = 0;
+    for (index_decl_id_t row = unit_decls; row != INDEX_DECL_NONE; row = p_store->p_next_in_unit[row])
+    {
+        p_rows[decl_count].p_USR = string_pool_get(p_store->p_USRs[row]);
+        p_rows[decl_count].row = row;
+        decl_count++;
+    }
+    qsort(p_rows, decl_count, sizeof(save_row_t), save_row_compare);
 
-    if (hashtable_size(p_index->p_header_map) > 0)
+    string_table_t strings = {0};
+    ASSERT(hashtable_new(&strings.p_offsets) == CC_OK);
+
+    index_shard_header_t header = {0};
+    header.magic = INDEX_SHARD_MAGIC;
+    header.version = INDEX_SHARD_VERSION;
+    header.unit = string_table_add(&strings, p_unit);
+    header.main_header = p_main_header ? string_table_add(&strings, p_main_header) : INDEX_NO_STRING;
+
+    index_shard_dependency_t * p_shard_deps = MALLOC(sizeof(index_shard_dependency_t) * max(dependency_count, 1));
+    for (size_t i = 0; i < dependency_count; ++i)
     {
-        json_t * p_headermap = json_object();
-        HashTableIter iter;
-        hashtable_iter_init(&iter, p_index->p_header_map);
-        TableEntry * p_entry;
-        while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+        p_shard_deps[i].hash = p_dependencies[i].hash;
+        p_shard_deps[i].path = string_table_add(&strings, p_dependencies[i].p_path);
+        p_shard_deps[i].reserved = 0;
+    }
+
+    index_shard_decl_t * p_shard_decls = MALLOC(sizeof(index_shard_decl_t) * max(decl_count, 1));
+    index_shard_symbol_t * p_symbols = MALLOC(sizeof(index_shard_symbol_t) * max(decl_count, 1));
+    uint32_t symbol_count = 0;
+    for (size_t i = 0; i < decl_count; ++i)
+    {
+        index_decl_id_t row = p_rows[i].row;
+        /* Pooled strings are unique, so equal USRs have equal pointers. */
+        if (symbol_count == 0 || p_rows[p_symbols[symbol_count - 1].first_decl].p_USR != p_rows[i].p_USR)
         {
-            header_map_entry_t * p_header_entry = p_entry->value;
-            json_object_set_new(p_headermap, p_header_entry->p_sourcefile, json_string(p_header_entry->p_headerfile));
+            p_symbols[symbol_count].USR = string_table_add(&strings, p_rows[i].p_USR);
+            p_symbols[symbol_count].first_decl = (uint32_t) i;
+            p_symbols[symbol_count].decl_count = 0;
+            symbol_count++;
         }
-        json_object_set_new(p_root, "headers", p_headermap);
+        p_symbols[symbol_count - 1].decl_count++;
+
+        index_shard_decl_t * p_shard_decl = &p_shard_decls[i];
+        p_shard_decl->name = string_table_add(&strings, string_pool_get(p_store->p_names[row]));
+        p_shard_decl->file = string_table_add(&strings, string_pool_get(p_store->p_files[row]));
+        p_shard_decl->line = p_store->p_lines[row];
+        p_shard_decl->character = p_store->p_characters[row];
+        p_shard_decl->scope = p_store->p_scopes[row];
+        p_shard_decl->kind = p_store->p_kinds[row];
+        p_shard_decl->reserved = 0;
+    }
+    mutex_release(&p_index->mut);
+
+    header.dependency_count = (uint32_t) dependency_count;
+    header.dependencies_offset = sizeof(index_shard_header_t);
+    header.symbol_count = symbol_count;
+    header.symbols_offset = header.dependencies_offset + header.dependency_count * sizeof(index_shard_dependency_t);
+    header.decl_count = (uint32_t) decl_count;
+    header.decls_offset = header.symbols_offset + symbol_count * sizeof(index_shard_symbol_t);
+    header.strings_size = (uint32_t) strings.size;
+    header.strings_offset = header.decls_offset + header.decl_count * sizeof(index_shard_decl_t);
+
+    /* Write to a temporary file and move it into place, so a crash never leaves a half written shard. */
+    char * p_temp_location = MALLOC(strlen(p_location) + sizeof(".tmp"));
+    sprintf(p_temp_location, "%s.tmp", p_location);
+
+    bool success = false;
+    FILE * f = fopen(p_temp_location, "wb");
+    if (f)
+    {
+        success = (fwrite(&header, sizeof(header), 1, f) == 1);
+        success = success && (fwrite(p_shard_deps, sizeof(index_shard_dependency_t), dependency_count, f) == dependency_count);
+        success = success && (fwrite(p_symbols, sizeof(index_shard_symbol_t), symbol_count, f) == symbol_count);
+        success = success && (fwrite(p_shard_decls, sizeof(index_shard_decl_t), decl_count, f) == decl_count);
+        success = success && (fwrite(strings.p_data, 1, strings.size, f) == strings.size);
+        success = (fclose(f) == 0) && success;
     }
 
-    bool success = (json_dump_file(p_root, p_location, 0) == 0);
-    json_decref(p_root);
+#ifdef _WIN32
+    /* Windows won't rename over an existing file. */
+    if (success)
+    {
+        remove(p_location);
+    }
+#endif
+    success = success && (rename(p_temp_location, p_location) == 0);
+    if (!success)
+    {
+        LOG("Failed writing index shard %s\n", p_location);
+        remove(p_temp_location);
+    }
+
+    FREE(p_temp_location);
+    FREE(p_symbols);
+    FREE(p_shard_decls);
+    FREE(p_shard_deps);
+    FREE(p_rows);
+    FREE(strings.p_data);
+    hashtable_destroy(strings.p_offsets);
     return success;
 }
 
-bool index_load(index_t * p_index, const char * p_location, time_t * p_timestamp)
+static bool table_valid(const mapped_file_t * p_map, uint32_t offset, uint32_t count, size_t entry_size, size_t alignment)
 {
-    json_error_t error;
-    json_t * p_root = json_load_file(p_location, 0, &error);
-    bool success = false;
-    if (p_root)
+    return (offset % alignment == 0) && ((uint64_t) offset + (uint64_t) count * entry_size <= p_map->size);
+}
+
+static bool shard_valid(const index_shard_t * p_shard, const char * p_unit)
+{
+    const index_shard_header_t * p_header = p_shard->p_header;
+    const char * p_base = p_shard->map.p_data;
+    bool valid = (p_shard->map.size >= sizeof(index_shard_header_t) &&
+                  p_header->magic == INDEX_SHARD_MAGIC &&
+                  p_header->version == INDEX_SHARD_VERSION &&
+                  table_valid(&p_shard->map, p_header->dependencies_offset, p_header->dependency_count, sizeof(index_shard_dependency_t), sizeof(uint64_t)) &&
+                  table_valid(&p_shard->map, p_header->symbols_offset, p_header->symbol_count, sizeof(index_shard_symbol_t), sizeof(uint32_t)) &&
+                  table_valid(&p_shard->map, p_header->decls_offset, p_header->decl_count, sizeof(index_shard_decl_t), sizeof(uint32_t)) &&
+                  (uint64_t) p_header->strings_offset + p_header->strings_size <= p_shard->map.size &&
+                  p_header->strings_size > 0 &&
+                  p_base[p_header->strings_offset + p_header->strings_size - 1] == '\0');
+
+    /* Shards are named by a hash of the unit's path, make sure it's not another unit's shard. */
+    valid = valid && (strcmp(shard_string(p_shard, p_header->unit), p_unit) == 0);
+
+    /* Names and paths are only checked when they're looked up, but the symbols must point into the
+     * declaration table. */
+    for (uint32_t i = 0; valid && i < p_header->symbol_count; ++i)
     {
-        json_t * p_json_timestamp = json_object_get(p_root, "timestamp");
-        json_t * p_json_declarations = json_object_get(p_root, "declarations");
-        json_t * p_json_headers = json_object_get(p_root, "headers");
+        valid = ((uint64_t) p_shard->p_symbols[i].first_decl + p_shard->p_symbols[i].decl_count <= p_header->decl_count);
+    }
+    return valid;
+}
 
-        if (p_json_timestamp && p_json_declarations && p_json_headers)
-        {
-            success = true;
-            *p_timestamp = json_integer_value(p_json_timestamp);
+bool index_shard_load(index_t * p_index,
+                      const char * p_location,
+                      const char * p_unit,
+                      index_dependency_callback_t callback,
+                      void * p_args)
+{
+    mutex_take(&p_index->mut);
+    bool loaded = hashtable_contains_key(p_index->p_shards, (void *) p_unit);
+    mutex_release(&p_index->mut);
+    if (loaded)
+    {
+        return true;
+    }
 
-            json_t * p_set;
-            const char * p_USR;
-            json_object_foreach(p_json_declarations, p_USR, p_set)
-            {
-                json_t * p_decl_obj;
-                unsigned i;
-                json_array_foreach(p_set, i, p_decl_obj)
-                {
-                    index_declaration_t * p_decl = MALLOC(sizeof(index_declaration_t));
-                    p_decl->p_name = STRDUP(json_string_value(json_object_get(p_decl_obj, "name")));
-                    p_decl->location = decode_location(json_object_get(p_decl_obj, "location"));
-                    p_decl->scope = (index_scope_t) json_integer_value(json_object_get(p_decl_obj, "scope"));
-                    p_decl->kind = (symbol_kind_t) json_integer_value(json_object_get(p_decl_obj, "kind"));
-                    index_declaration_add(p_index, p_USR, p_decl);
-                }
-            }
+    index_shard_t * p_shard = CALLOC(sizeof(index_shard_t), 1);
+    if (!mapped_file_open(&p_shard->map, p_location))
+    {
+        FREE(p_shard);
+        return false;
+    }
 
-            json_t * p_header;
-            const char * p_source;
-            json_object_foreach(p_json_headers, p_source, p_header)
-            {
-                index_header_set(p_index, p_source, json_string_value(p_header));
-            }
+    const char * p_base = p_shard->map.p_data;
+    const index_shard_header_t * p_header = p_shard->map.p_data;
+    p_shard->p_header = p_header;
+    if (p_shard->map.size >= sizeof(index_shard_header_t))
+    {
+        p_shard->p_dependencies = (const index_shard_dependency_t *) &p_base[p_header->dependencies_offset];
+        p_shard->p_symbols = (const index_shard_symbol_t *) &p_base[p_header->symbols_offset];
+        p_shard->p_decls = (const index_shard_decl_t *) &p_base[p_header->decls_offset];
+        p_shard->p_strings = &p_base[p_header->strings_offset];
+    }
+
+    if (!shard_valid(p_shard, p_unit))
+    {
+        LOG("Index shard %s for %s is invalid or from another version, ignoring it.\n", p_location, p_unit);
+        shard_free(p_shard);
+        return false;
+    }
+
+    /* The shard is only valid if none of the files it was built from have changed. */
+    bool fresh = true;
+    for (uint32_t i = 0; fresh && i < p_header->dependency_count; ++i)
+    {
+        const char * p_path = shard_string(p_shard, p_shard->p_dependencies[i].path);
+        uint64_t hash;
+        fresh = (index_file_hash(p_index, p_path, &hash) && hash == p_shard->p_dependencies[i].hash);
+        if (!fresh)
+        {
+            LOG("%s changed since %s was indexed\n", p_path, p_unit);
         }
-        json_decref(p_root);
     }
 
-    if (!success)
+    if (!fresh)
     {
-        /* Touch the file to wipe it. */
-        FILE * f = fopen(p_location, "w");
-        fclose(f);
+        shard_free(p_shard);
+        return false;
     }
-    return success;
+
+    if (p_header->main_header != INDEX_NO_STRING)
+    {
+        index_header_set(p_index, p_unit, shard_string(p_shard, p_header->main_header));
+    }
+
+    for (uint32_t i = 0; i < p_header->dependency_count; ++i)
+    {
+        callback(shard_string(p_shard, p_shard->p_dependencies[i].path), p_args);
+    }
+
+    /* Another thread may have loaded the same shard meanwhile, and its symbols must only be linked once. */
+    mutex_take(&p_index->mut);
+    if (hashtable_contains_key(p_index->p_shards, (void *) p_unit))
+    {
+        shard_free(p_shard);
+    }
+    else
+    {
+        ASSERT(hashtable_add(p_index->p_shards, (void *) shard_string(p_shard, p_header->unit), p_shard) == CC_OK);
+        shard_symbols_link(p_index, p_shard);
+    }
+    mutex_release(&p_index->mut);
+    return true;
 }
 
 
@@ -0,0 +1,462 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json_reader.h"
+#include "log.h"
+
+#define INTEGER_LENGTH_MAX 24
+
+static void fail(json_reader_t * p_reader)
+{
+    if (!p_reader->error)
+    {
+        LOG("JSON syntax error at \"%.16s\"\n", p_reader->p_c);
+    }
+    p_reader->error = true;
+    p_reader->p_c = p_reader->p_end;
+}
+
+static void skip_whitespace(json_reader_t * p_reader)
+{
+    while (p_reader->p_c < p_reader->p_end &&
+           (*p_reader->p_c == ' ' || *p_reader->p_c == '\n' || *p_reader->p_c == '\r' || *p_reader->p_c == '\t'))
+    {
+        p_reader->p_c++;
+    }
+}
+
+static bool is_delimiter(char c)
+{
+    return (c == ',' || c == ':' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t');
+}
+
+static bool read_hex(json_reader_t * p_reader, uint32_t * p_value)
+{
+    if (p_reader->p_end - p_reader->p_c < 4)
+    {
+        return false;
+    }
+    *p_value = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        char c = *p_reader->p_c++;
+        *p_value <<= 4;
+        if (c >= '0' && c <= '9')
+        {
+            *p_value |= c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            *p_value |= c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            *p_value |= c - 'A' + 10;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static char * utf8_encode(char * p_out, uint32_t codepoint)
+{
+    if (codepoint < 0x80)
+    {
+        *p_out++ = (char) codepoint;
+    }
+    else if (codepoint < 0x800)
+    {
+        *p_out++ = (char) (0xC0 | (codepoint >> 6));
+        *p_out++ = (char) (0x80 | (codepoint & 0x3F));
+    }
+    else if (codepoint < 0x10000)
+    {
+        *p_out++ = (char) (0xE0 | (codepoint >> 12));
+        *p_out++ = (char) (0x80 | ((codepoint >> 6) & 0x3F));
+        *p_out++ = (char) (0x80 | (codepoint & 0x3F));
+    }
+    else
+    {
+        *p_out++ = (char) (0xF0 | (codepoint >> 18));
+        *p_out++ = (char) (0x80 | ((codepoint >> 12) & 0x3F));
+        *p_out++ = (char) (0x80 | ((codepoint >> 6) & 0x3F));
+        *p_out++ = (char) (0x80 | (codepoint & 0x3F));
+    }
+    return p_out;
+}
+
+static bool read_unicode_escape(json_reader_t * p_reader, char ** pp_out)
+{
+    uint32_t codepoint;
+    if (!read_hex(p_reader, &codepoint) || (codepoint >= 0xDC00 && codepoint < 0xE000))
+    {
+        return false;
+    }
+    if (codepoint >= 0xD800 && codepoint < 0xDC00)
+    {
+        uint32_t low;
+        if (p_reader->p_end - p_reader->p_c < 2 || p_reader->p_c[0] != '\\' || p_reader->p_c[1] != 'u')
+        {
+            return false;
+        }
+        p_reader->p_c += 2;
+        if (!read_hex(p_reader, &low) || low < 0xDC00 || low >= 0xE000)
+        {
+            return false;
+        }
+        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+    }
+    /* An escape sequence is always longer than the UTF-8 it stands for, so the output never overtakes
+     * the input. */
+    *pp_out = utf8_encode(*pp_out, codepoint);
+    return true;
+}
+
+/** Unescape the string at the reader in place. */
+static char * unescape_string(json_reader_t * p_reader)
+{
+    char * p_start = ++p_reader->p_c;
+    char * p_out = p_start;
+    while (p_reader->p_c < p_reader->p_end)
+    {
+        /* Move runs of plain characters in one go. Until the first escape, they're already in place. */
+        char * p_run = p_reader->p_c;
+        while (p_reader->p_c < p_reader->p_end && *p_reader->p_c != '"' && *p_reader->p_c != '\\')
+        {
+            p_reader->p_c++;
+        }
+        size_t length = p_reader->p_c - p_run;
+        if (p_out != p_run)
+        {
+            memmove(p_out, p_run, length);
+        }
+        p_out += length;
+
+        if (p_reader->p_c >= p_reader->p_end)
+        {
+            break;
+        }
+        if (*p_reader->p_c == '"')
+        {
+            p_reader->p_c++;
+            *p_out = '\0';
+            return p_start;
+        }
+
+        p_reader->p_c++;
+        if (p_reader->p_c >= p_reader->p_end)
+        {
+            break;
+        }
+        char escape = *p_reader->p_c++;
+        switch (escape)
+        {
+            case '"':
+            case '\\':
+            case '/':
+                *p_out++ = escape;
+                break;
+            case 'b': *p_out++ = '\b'; break;
+            case 'f': *p_out++ = '\f'; break;
+            case 'n': *p_out++ = '\n'; break;
+            case 'r': *p_out++ = '\r'; break;
+            case 't': *p_out++ = '\t'; break;
+            case 'u':
+                if (!read_unicode_escape(p_reader, &p_out))
+                {
+                    fail(p_reader);
+                    return NULL;
+                }
+                break;
+            default:
+                fail(p_reader);
+                return NULL;
+        }
+    }
+    fail(p_reader);
+    return NULL;
+}
+
+/** Skip a string without touching it, so that the value it's in can still be parsed afterwards. */
+static void skip_string(json_reader_t * p_reader)
+{
+    p_reader->p_c++;
+    while (p_reader->p_c < p_reader->p_end)
+    {
+        char c = *p_reader->p_c++;
+        if (c == '"')
+        {
+            return;
+        }
+        if (c == '\\')
+        {
+            p_reader->p_c++;
+        }
+    }
+    fail(p_reader);
+}
+
+void json_reader_init(json_reader_t * p_reader, char * p_data, size_t size)
+{
+    p_reader->p_c = p_data;
+    p_reader->p_end = p_data + size;
+    p_reader->error = false;
+}
+
+bool json_reader_error(const json_reader_t * p_reader)
+{
+    return p_reader->error;
+}
+
+json_reader_type_t json_reader_peek(json_reader_t * p_reader)
+{
+    skip_whitespace(p_reader);
+    if (p_reader->p_c >= p_reader->p_end)
+    {
+        return JSON_READER_TYPE_INVALID;
+    }
+    switch (*p_reader->p_c)
+    {
+        case '{':
+            return JSON_READER_TYPE_OBJECT;
+        case '[':
+            return JSON_READER_TYPE_ARRAY;
+        case '"':
+            return JSON_READER_TYPE_STRING;
+        case 't':
+        case 'f':
+            return JSON_READER_TYPE_BOOLEAN;
+        case 'n':
+            return JSON_READER_TYPE_NULL;
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return JSON_READER_TYPE_NUMBER;
+        default:
+            return JSON_READER_TYPE_INVALID;
+    }
+}
+
+bool json_reader_object_start(json_reader_t * p_reader)
+{
+    if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+    {
+        json_reader_skip(p_reader);
+        return false;
+    }
+    p_reader->p_c++;
+    return true;
+}
+
+bool json_reader_object_next(json_reader_t * p_reader, const char ** pp_key)
+{
+    skip_whitespace(p_reader);
+    if (p_reader->p_c < p_reader->p_end && *p_reader->p_c == ',')
+    {
+        p_reader->p_c++;
+        skip_whitespace(p_reader);
+    }
+    if (p_reader->p_c >= p_reader->p_end)
+    {
+        fail(p_reader);
+        return false;
+    }
+    if (*p_reader->p_c == '}')
+    {
+        p_reader->p_c++;
+        return false;
+    }
+    if (*p_reader->p_c != '"')
+    {
+        fail(p_reader);
+        return false;
+    }
+
+    const char * p_key = unescape_string(p_reader);
+    skip_whitespace(p_reader);
+    if (!p_key || p_reader->p_c >= p_reader->p_end || *p_reader->p_c != ':')
+    {
+        fail(p_reader);
+        return false;
+    }
+    p_reader->p_c++;
+    *pp_key = p_key;
+    return true;
+}
+
+bool json_reader_array_start(json_reader_t * p_reader)
+{
+    if (json_reader_peek(p_reader) != JSON_READER_TYPE_ARRAY)
+    {
+        json_reader_skip(p_reader);
+        return false;
+    }
+    p_reader->p_c++;
+    return true;
+}
+
+bool json_reader_array_next(json_reader_t * p_reader)
+{
+    skip_whitespace(p_reader);
+    if (p_reader->p_c < p_reader->p_end && *p_reader->p_c == ',')
+    {
+        p_reader->p_c++;
+        skip_whitespace(p_reader);
+    }
+    if (p_reader->p_c >= p_reader->p_end)
+    {
+        fail(p_reader);
+        return false;
+    }
+    if (*p_reader->p_c == ']')
+    {
+        p_reader->p_c++;
+        return false;
+    }
+    return true;
+}
+
+char * json_reader_string(json_reader_t * p_reader)
+{
+    if (json_reader_peek(p_reader) != JSON_READER_TYPE_STRING)
+    {
+        json_reader_skip(p_reader);
+        return NULL;
+    }
+    return unescape_string(p_reader);
+}
+
+bool json_reader_integer(json_reader_t * p_reader, int64_t * p_value)
+{
+    if (json_reader_peek(p_reader) != JSON_READER_TYPE_NUMBER)
+    {
+        json_reader_skip(p_reader);
+        return false;
+    }
+
+    char buf[INTEGER_LENGTH_MAX];
+    size_t length = 0;
+    bool integer = true;
+    while (p_reader->p_c < p_reader->p_end && !is_delimiter(*p_reader->p_c))
+    {
+        char c = *p_reader->p_c++;
+        if (c == '.' || c == 'e' || c == 'E' || length == sizeof(buf) - 1)
+        {
+            /* Like Jansson, reals aren't integers, even if they have no fraction. */
+            integer = false;
+        }
+        else
+        {
+            buf[length++] = c;
+        }
+    }
+    buf[length] = '\0';
+
+    char * p_end;
+    *p_value = strtoll(buf, &p_end, 10);
+    return (integer && length > 0 && *p_end == '\0');
+}
+
+bool json_reader_boolean(json_reader_t * p_reader, bool * p_value)
+{
+    if (json_reader_peek(p_reader) != JSON_READER_TYPE_BOOLEAN)
+    {
+        json_reader_skip(p_reader);
+        return false;
+    }
+    size_t remaining = p_reader->p_end - p_reader->p_c;
+    if (remaining >= 4 && memcmp(p_reader->p_c, "true", 4) == 0)
+    {
+        p_reader->p_c += 4;
+        *p_value = true;
+    }
+    else if (remaining >= 5 && memcmp(p_reader->p_c, "false", 5) == 0)
+    {
+        p_reader->p_c += 5;
+        *p_value = false;
+    }
+    else
+    {
+        fail(p_reader);
+        return false;
+    }
+    return true;
+}
+
+void json_reader_skip(json_reader_t * p_reader)
+{
+    unsigned depth = 0;
+    do
+    {
+        skip_whitespace(p_reader);
+        if (p_reader->p_c >= p_reader->p_end)
+        {
+            fail(p_reader);
+            return;
+        }
+
+        char c = *p_reader->p_c;
+        if (c == '"')
+        {
+            skip_string(p_reader);
+        }
+        else if (c == '{' || c == '[')
+        {
+            depth++;
+            p_reader->p_c++;
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (depth == 0)
+            {
+                fail(p_reader);
+                return;
+            }
+            depth--;
+            p_reader->p_c++;
+        }
+        else if (c == ',' || c == ':')
+        {
+            if (depth == 0)
+            {
+                fail(p_reader);
+                return;
+            }
+            p_reader->p_c++;
+        }
+        else
+        {
+            char * p_start = p_reader->p_c;
+            while (p_reader->p_c < p_reader->p_end && !is_delimiter(*p_reader->p_c))
+            {
+                p_reader->p_c++;
+            }
+            if (p_reader->p_c == p_start)
+            {
+                fail(p_reader);
+                return;
+            }
+        }
+    } while (depth > 0 && !p_reader->error);
+}
+
+json_t * json_reader_json(json_reader_t * p_reader)
+{
+    skip_whitespace(p_reader);
+    const char * p_start = p_reader->p_c;
+    json_reader_skip(p_reader);
+    if (p_reader->error)
+    {
+        return NULL;
+    }
+
+    json_error_t err;
+    json_t * p_json = json_loadb(p_start, p_reader->p_c - p_start, JSON_DECODE_ANY, &err);
+    if (!p_json)
+    {
+        LOG("Parsing failed: L%u:%u: %s\n", err.line, err.column, err.text);
+    }
+    return p_json;
+}
@@ -1,21 +1,33 @@
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include "json_rpc.h"
 #include "log.h"
 #include "utils.h"
+#include "thread_pool.h"
+#include "json_writer.h"
+#include "json_reader.h"
 
 #define CONTENT_LENGTH_HEADER   "Content-Length: %u\r\n\r\n"
+#define HEADER_RESERVED         32
+#define OUTPUT_BUFFERS_KEPT     8
+#define CANCEL_REQUEST_METHOD   "$/cancelRequest"
 
 typedef struct
 {
     const char * p_method;
+    json_rpc_params_reader_t params_reader;
     json_rpc_request_handler_t callback;
+    json_rpc_params_free_t params_free;
+    unsigned deadline_ms; ///< Time the handler gets from when the request comes in, or 0 for no limit.
 } request_handler_t;
 
 typedef struct
 {
     const char * p_method;
+    json_rpc_params_reader_t params_reader;
     json_rpc_notification_handler_t callback;
+    json_rpc_params_free_t params_free;
 } notification_handler_t;
 
 typedef struct response_waiter
@@ -25,6 +37,36 @@ typedef struct response_waiter
     struct response_waiter * p_next;
 } response_waiter_t;
 
+/** Input buffer, shared by all the messages of a batch. */
+typedef struct
+{
+    atomic_counter_t users;
+    char data[];
+} input_buffer_t;
+
+/** Message from the client that has been read, waiting for its handler to run. */
+typedef struct job
+{
+    input_buffer_t * p_buffer; ///< Buffer the params point into.
+    const char * p_method;
+    void * p_params;
+    const char * p_document; ///< Document the message is about, or NULL if it may touch any of them.
+    json_t * p_response; ///< NULL for notifications.
+    const request_handler_t * p_request_handler;
+    const notification_handler_t * p_notification_handler;
+    cancel_token_t token;
+    bool started;
+    struct job * p_next;
+} job_t;
+
+/** Message waiting for the writer thread. The writers are swapped in and out, to reuse their buffers. */
+typedef struct output
+{
+    json_writer_t writer;
+    size_t offset; ///< Start of the header, in front of the body.
+    struct output * p_next;
+} output_t;
+
 static struct
 {
     unsigned count;
@@ -39,22 +81,144 @@ static struct
 
 static struct
 {
+    mutex_t mut;
     response_waiter_t * p_head;
     response_waiter_t * p_tail;
 } m_response_waiters;
 
+/** Every job that hasn't finished yet, in the order the messages came in. */
+static struct
+{
+    mutex_t mut;
+    job_t * p_head;
+    job_t * p_tail;
+    bool draining;
+    semaphore_t idle_sem;
+} m_jobs;
+
+static struct
+{
+    mutex_t mut;
+    semaphore_t sem;
+    output_t * p_head;
+    output_t * p_tail;
+    output_t * p_free;
+    unsigned free_count;
+    thread_t * p_thread;
+} m_output;
+
 static bool m_running;
 static json_rpc_request_id_t m_request_id;
-static unsigned m_responses_sent;
 static shared_resource_t m_resource;
+static mutex_t m_handlers_mut;
+static unsigned m_handlers_running;
+static THREAD_LOCAL unsigned m_responses_sent;
+static THREAD_LOCAL cancel_token_t * mp_cancel_token;
+static THREAD_LOCAL arena_t m_request_arena;
+static THREAD_LOCAL json_writer_t m_response_writer;
+static THREAD_LOCAL json_writer_t m_message_writer;
+
+static void message_begin(json_writer_t * p_writer)
+{
+    json_writer_reset(p_writer, HEADER_RESERVED);
+    json_writer_object_start(p_writer);
+    json_writer_key(p_writer, "jsonrpc");
+    json_writer_string(p_writer, "2.0");
+}
 
-static void send_message(json_t * p_message)
+static void message_send(json_writer_t * p_writer)
 {
-    const char * p_value = json_dumps(p_message, 0);
-    char header_buf[128];
-    sprintf(header_buf, "Content-Length: %u\n\n", strlen(p_value));
-    OUTPUT(header_buf);
-    OUTPUT(p_value);
+    json_writer_object_end(p_writer);
+
+    /* The header is put right in front of the body, in the space reserved for it, so that the message
+     * goes out in a single write. */
+    size_t body_length = p_writer->length - HEADER_RESERVED;
+    char header[HEADER_RESERVED + 1];
+    int header_length = snprintf(header, sizeof(header), CONTENT_LENGTH_HEADER, (unsigned) body_length);
+    ASSERT(header_length > 0 && header_length <= HEADER_RESERVED);
+
+    size_t offset = HEADER_RESERVED - header_length;
+    memcpy(&p_writer->p_data[offset], header, header_length);
+
+    mutex_take(&m_output.mut);
+    output_t * p_output = m_output.p_free;
+    if (p_output)
+    {
+        m_output.p_free = p_output->p_next;
+        m_output.free_count--;
+    }
+    mutex_release(&m_output.mut);
+    if (!p_output)
+    {
+        p_output = CALLOC(1, sizeof(output_t));
+    }
+
+    /* Hand the message over to the writer thread, and take the buffer of an earlier message in return. */
+    json_writer_t writer = p_output->writer;
+    p_output->writer = *p_writer;
+    *p_writer = writer;
+    p_output->offset = offset;
+    p_output->p_next = NULL;
+
+    mutex_take(&m_output.mut);
+    if (m_output.p_tail)
+    {
+        m_output.p_tail->p_next = p_output;
+    }
+    else
+    {
+        m_output.p_head = p_output;
+    }
+    m_output.p_tail = p_output;
+    mutex_release(&m_output.mut);
+    semaphore_signal(&m_output.sem);
+}
+
+/**
+ * Write the queued messages to the output, one whole message at a time, so that neither handlers nor
+ * the reader ever block on the client reading its input.
+ */
+static void output_thread(void * p_args)
+{
+    while (true)
+    {
+        semaphore_wait(&m_output.sem);
+        mutex_take(&m_output.mut);
+        output_t * p_output = m_output.p_head;
+        if (p_output)
+        {
+            m_output.p_head = p_output->p_next;
+            if (!m_output.p_head)
+            {
+                m_output.p_tail = NULL;
+            }
+        }
+        mutex_release(&m_output.mut);
+
+        if (!p_output)
+        {
+            /* Signalled without a message: stop. */
+            break;
+        }
+
+        OUTPUT(&p_output->writer.p_data[p_output->offset], p_output->writer.length - p_output->offset);
+
+        mutex_take(&m_output.mut);
+        if (m_output.free_count < OUTPUT_BUFFERS_KEPT)
+        {
+            p_output->p_next = m_output.p_free;
+            m_output.p_free = p_output;
+            m_output.free_count++;
+            p_output = NULL;
+        }
+        mutex_release(&m_output.mut);
+
+        if (p_output)
+        {
+            json_writer_free(&p_output->writer);
+            FREE(p_output);
+        }
+    }
 }
 
 static const request_handler_t * find_request_handler(const char * p_method)
@@ -81,160 +245,517 @@ static const notification_handler_t * find_notification_handler(const char * p_m
     return NULL;
 }
 
-static void handle_incoming(json_t * p_root)
+static void handle_response(json_t * p_id, json_t * p_result, json_t * p_error)
 {
-    if (p_root)
+    json_rpc_request_id_t id = json_integer_value(p_id);
+    while (true)
     {
-        //LOG("%s\n", json_dumps(p_root, 0));
-        if (json_is_array(p_root))
+        // expect in-order responses
+        mutex_take(&m_response_waiters.mut);
+        response_waiter_t * p_waiter = m_response_waiters.p_head;
+        if (p_waiter && p_waiter->id <= id)
         {
-            unsigned index;
-            json_t * p_it;
-            json_array_foreach(p_root, index, p_it)
+            m_response_waiters.p_head = p_waiter->p_next;
+            if (!m_response_waiters.p_head)
             {
-                handle_incoming(p_it);
+                m_response_waiters.p_tail = NULL;
             }
         }
-        else if (json_is_object(p_root))
+        else
         {
-            json_t * p_jsonrpc = json_object_get(p_root, "jsonrpc");
-            json_t * p_method = json_object_get(p_root, "method");
-            json_t * p_params = json_object_get(p_root, "params");
-            json_t * p_id = json_object_get(p_root, "id");
-            json_t * p_result = json_object_get(p_root, "result");
-            json_t * p_error = json_object_get(p_root, "error");
+            p_waiter = NULL;
+        }
+        mutex_release(&m_response_waiters.mut);
+
+        if (!p_waiter)
+        {
+            break;
+        }
 
-            // determine message type
-            if (p_jsonrpc)
+        if (p_waiter->id < id)
+        {
+            json_rpc_response_params_t params;
+            params.error.code = JSON_RPC_ERROR_NO_RESPONSE;
+            params.error.p_data = NULL;
+            params.error.p_message = "No response from client";
+            p_waiter->handler(id, JSON_RPC_RESULT_ERROR, &params);
+        }
+        else if (p_result)
+        {
+            json_rpc_response_params_t params;
+            params.success.p_params = p_result;
+            p_waiter->handler(id, JSON_RPC_RESULT_SUCCESS, &params);
+        }
+        else if (p_error)
+        {
+            json_t * p_code     = json_object_get(p_error, "code");
+            json_t * p_message  = json_object_get(p_error, "message");
+            json_t * p_data     = json_object_get(p_error, "data");
+
+            if (p_code && json_is_integer(p_code) && (!p_message || json_is_string(p_message)))
             {
-                if (p_method)
+                json_rpc_response_params_t params;
+                params.error.code = JSON_RPC_ERROR_NO_RESPONSE;
+                params.error.p_data = p_data;
+                if (p_message)
                 {
-                    // request or notification
-                    bool handled = false;
-                    if (p_id)
-                    {
-                        LOG("GOT REQUEST \"%s\"\n", json_string_value(p_method));
-                        json_t * p_response = json_object();
-                        json_object_set_new(p_response, "jsonrpc", json_string("2.0"));
-                        json_object_set(p_response, "id", p_id);
-
-                        const request_handler_t * p_handler = find_request_handler(json_string_value(p_method));
-                        if (p_handler)
-                        {
-                            unsigned responses_before = m_responses_sent;
-                            shared_resource_lock(&m_resource);
-                            p_handler->callback(p_handler->p_method, p_params, p_response);
-                            shared_resource_unlock(&m_resource);
-
-                            if (p_id)
-                            {
-                                // Must send exactly one response to a message with an ID
-                                ASSERT(m_responses_sent == responses_before + 1);
-                            }
-                        }
-                        else
-                        {
-                            json_rpc_error_response_send(p_response, JSON_RPC_ERROR_METHOD_NOT_FOUND, "No handler registered for method", NULL);
-                        }
-                        json_decref(p_response);
-                    }
-                    else
-                    {
-                        LOG("GOT NOTIFICATION \"%s\"\n", json_string_value(p_method));
-
-                        const notification_handler_t * p_handler = find_notification_handler(json_string_value(p_method));
-                        if (p_handler)
-                        {
-                            unsigned responses_before = m_responses_sent;
-							shared_resource_lock(&m_resource);
-							p_handler->callback(p_handler->p_method, p_params);
-							shared_resource_unlock(&m_resource);
-						}
-                        else
-                        {
-                            LOG("No handler.\n");
-                        }
-                    }
+                    params.error.p_message = json_string_value(p_message);
                 }
-                else if (p_id && json_is_integer(p_id))
+                else
                 {
-                    // response
-                    json_rpc_request_id_t id = json_integer_value(p_id);
-                    if (p_result || p_error)
-                    {
-                        while (m_response_waiters.p_head != NULL)
-                        {
-                            // expect in-order responses
-                            if (m_response_waiters.p_head->id < id)
-                            {
-                                json_rpc_response_params_t params;
-                                params.error.code = JSON_RPC_ERROR_NO_RESPONSE;
-                                params.error.p_data = NULL;
-                                params.error.p_message = "No response from client";
-                                m_response_waiters.p_head->handler(id, JSON_RPC_RESULT_ERROR, &params);
-                            }
-                            else if (m_response_waiters.p_head->id == id)
-                            {
-                                if (p_result)
-                                {
-                                    json_rpc_response_params_t params;
-                                    params.success.p_params = p_params;
-                                    m_response_waiters.p_head->handler(id, JSON_RPC_RESULT_SUCCESS, &params);
-                                }
-                                else if (p_error)
-                                {
-                                    json_t * p_code     = json_object_get(p_error, "code");
-                                    json_t * p_message  = json_object_get(p_error, "message");
-                                    json_t * p_data     = json_object_get(p_error, "data");
-
-                                    if (p_code && json_is_integer(p_code) && (!p_message || json_is_string(p_message)))
-                                    {
-                                        json_rpc_response_params_t params;
-                                        params.error.code = JSON_RPC_ERROR_NO_RESPONSE;
-                                        params.error.p_data = p_data;
-                                        if (p_message)
-                                        {
-                                            params.error.p_message = json_string_value(p_message);
-                                        }
-                                        else
-                                        {
-                                            params.error.p_message = "";
-                                        }
-                                        m_response_waiters.p_head->handler(id, JSON_RPC_RESULT_ERROR, &params);
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                break;
-                            }
-
-                            if (m_response_waiters.p_head == m_response_waiters.p_tail)
-                            {
-                                m_response_waiters.p_tail = NULL;
-                            }
-
-                            response_waiter_t * p_new_head = m_response_waiters.p_head->p_next;
-                            FREE(m_response_waiters.p_head);
-                            m_response_waiters.p_head = p_new_head;
-                        }
-                    }
+                    params.error.p_message = "";
                 }
+                p_waiter->handler(id, JSON_RPC_RESULT_ERROR, &params);
+            }
+        }
+        FREE(p_waiter);
+    }
+}
+
+static void input_buffer_release(input_buffer_t * p_buffer)
+{
+    if (atomic_get_and_sub(&p_buffer->users) == 0)
+    {
+        FREE(p_buffer);
+    }
+}
+
+/**
+ * Keep the request handlers as a group from running at the same time as the background tasks that
+ * borrow the resource. The first handler to start takes it, and the last one to finish gives it back.
+ */
+static void handlers_enter(void)
+{
+    mutex_take(&m_handlers_mut);
+    if (m_handlers_running++ == 0)
+    {
+        shared_resource_lock(&m_resource);
+    }
+    mutex_release(&m_handlers_mut);
+}
+
+static void handlers_leave(void)
+{
+    mutex_take(&m_handlers_mut);
+    if (--m_handlers_running == 0)
+    {
+        shared_resource_unlock(&m_resource);
+    }
+    mutex_release(&m_handlers_mut);
+}
+
+static void job_run(job_t * p_job)
+{
+    mp_cancel_token = &p_job->token;
+    if (p_job->p_response)
+    {
+        unsigned responses_before = m_responses_sent;
+        if (cancel_token_is_cancelled(&p_job->token))
+        {
+            json_rpc_error_response_send(p_job->p_response, JSON_RPC_ERROR_REQUEST_CANCELLED, "Request cancelled", NULL);
+        }
+        else
+        {
+            p_job->p_request_handler->callback(p_job->p_method, p_job->p_params, p_job->p_response);
+        }
+        // Must send exactly one response to a message with an ID
+        ASSERT(m_responses_sent == responses_before + 1);
+    }
+    else
+    {
+        p_job->p_notification_handler->callback(p_job->p_method, p_job->p_params);
+    }
+    mp_cancel_token = NULL;
+    if (m_request_arena.allocations > 0)
+    {
+        LOG("%s: %u arena allocations, %zu bytes (peak %zu)\n",
+            p_job->p_method, m_request_arena.allocations, m_request_arena.used, m_request_arena.peak);
+    }
+    arena_reset(&m_request_arena);
+}
+
+static void job_free(job_t * p_job)
+{
+    if (p_job->p_response)
+    {
+        p_job->p_request_handler->params_free(p_job->p_params);
+        json_decref(p_job->p_response);
+    }
+    else
+    {
+        p_job->p_notification_handler->params_free(p_job->p_params);
+    }
+    input_buffer_release(p_job->p_buffer);
+    FREE(p_job);
+}
+
+/**
+ * Messages about the same document must be handled in the order they came in, and messages that aren't
+ * about a particular document must wait for, and hold up, everything else.
+ */
+static bool jobs_conflict(const job_t * p_a, const job_t * p_b)
+{
+    return (!p_a->p_document || !p_b->p_document || strcmp(p_a->p_document, p_b->p_document) == 0);
+}
+
+static void job_task(void * p_args);
+
+/**
+ * Start every job that doesn't conflict with any job that came in before it. Must be called with the
+ * job mutex taken.
+ */
+static void jobs_dispatch(void)
+{
+    for (job_t * p_job = m_jobs.p_head; p_job; p_job = p_job->p_next)
+    {
+        if (!p_job->started)
+        {
+            bool blocked = false;
+            for (job_t * p_it = m_jobs.p_head; p_it != p_job && !blocked; p_it = p_it->p_next)
+            {
+                blocked = jobs_conflict(p_it, p_job);
+            }
+
+            if (!blocked)
+            {
+                p_job->started = true;
+                thread_pool_submit(job_task,
+                                   p_job,
+                                   p_job->p_response ? THREAD_POOL_PRIORITY_INTERACTIVE : THREAD_POOL_PRIORITY_ACTIVE,
+                                   NULL);
+            }
+        }
+
+        if (!p_job->p_document)
+        {
+            /* Nothing after this one can start before it's done. */
+            break;
+        }
+    }
+}
+
+static void job_task(void * p_args)
+{
+    job_t * p_job = p_args;
+
+    handlers_enter();
+    job_run(p_job);
+    handlers_leave();
+
+    mutex_take(&m_jobs.mut);
+    job_t ** pp_it = &m_jobs.p_head;
+    job_t * p_prev = NULL;
+    while (*pp_it != p_job)
+    {
+        p_prev = *pp_it;
+        pp_it = &(*pp_it)->p_next;
+    }
+    *pp_it = p_job->p_next;
+    if (m_jobs.p_tail == p_job)
+    {
+        m_jobs.p_tail = p_prev;
+    }
+
+    jobs_dispatch();
+    bool idle = (m_jobs.draining && !m_jobs.p_head);
+    if (idle)
+    {
+        m_jobs.draining = false;
+    }
+    mutex_release(&m_jobs.mut);
+
+    /* The document of the job is compared against until it's out of the list. */
+    job_free(p_job);
+
+    if (idle)
+    {
+        semaphore_signal(&m_jobs.idle_sem);
+    }
+}
+
+static void job_submit(job_t * p_job)
+{
+    atomic_get_and_add(&p_job->p_buffer->users);
+
+    /* The workers aren't started until the client has initialized us. */
+    if (thread_pool_thread_count() == 0)
+    {
+        job_run(p_job);
+        job_free(p_job);
+        return;
+    }
+
+    mutex_take(&m_jobs.mut);
+    if (m_jobs.p_tail)
+    {
+        m_jobs.p_tail->p_next = p_job;
+    }
+    else
+    {
+        m_jobs.p_head = p_job;
+    }
+    m_jobs.p_tail = p_job;
+    jobs_dispatch();
+    mutex_release(&m_jobs.mut);
+}
+
+/** Wait for the handlers of all messages that have been read so far. */
+static void jobs_wait(void)
+{
+    mutex_take(&m_jobs.mut);
+    bool busy = (m_jobs.p_head != NULL);
+    m_jobs.draining = busy;
+    mutex_release(&m_jobs.mut);
+
+    if (busy)
+    {
+        semaphore_wait(&m_jobs.idle_sem);
+    }
+}
+
+/**
+ * Cancel the request with the given ID, whether it's waiting or already running. Requests that are done
+ * or unknown are ignored, as the cancellation may cross the response on its way.
+ */
+static void jobs_cancel(json_t * p_id)
+{
+    mutex_take(&m_jobs.mut);
+    for (job_t * p_job = m_jobs.p_head; p_job; p_job = p_job->p_next)
+    {
+        if (p_job->p_response && json_equal(json_object_get(p_job->p_response, "id"), p_id))
+        {
+            LOG("Cancelling request \"%s\"\n", p_job->p_method);
+            cancel_token_cancel(&p_job->token);
+        }
+    }
+    mutex_release(&m_jobs.mut);
+}
+
+/**
+ * Cancellations are handled as soon as they're read, instead of being queued up behind the requests they
+ * are about.
+ */
+static void handle_cancel_request(json_reader_t * p_params)
+{
+    json_t * p_id = NULL;
+
+    if (json_reader_object_start(p_params))
+    {
+        const char * p_key;
+        while (json_reader_object_next(p_params, &p_key))
+        {
+            if (strcmp(p_key, "id") == 0 && !p_id)
+            {
+                p_id = json_reader_json(p_params);
+            }
+            else
+            {
+                json_reader_skip(p_params);
             }
         }
     }
+
+    if (p_id && !json_reader_error(p_params))
+    {
+        jobs_cancel(p_id);
+    }
     else
+    {
+        LOG("Invalid cancel request\n");
+    }
+    json_decref(p_id);
+}
+
+static void handle_message(input_buffer_t * p_buffer, json_reader_t * p_reader)
+{
+    bool has_jsonrpc = false;
+    const char * p_method = NULL;
+    json_t * p_id = NULL;
+    json_t * p_result = NULL;
+    json_t * p_error = NULL;
+
+    /* The params are left alone until the handler for the method reads them, as the method may come after
+     * them. Skipping doesn't touch the buffer, so the copy of the reader can still read them later. */
+    char null_json[] = "null";
+    json_reader_t params;
+    json_reader_init(&params, null_json, sizeof(null_json) - 1);
+
+    if (!json_reader_object_start(p_reader))
+    {
+        LOG("Message isn't an object\n");
+        return;
+    }
+
+    const char * p_key;
+    while (json_reader_object_next(p_reader, &p_key))
+    {
+        if (strcmp(p_key, "jsonrpc") == 0)
+        {
+            has_jsonrpc = true;
+            json_reader_skip(p_reader);
+        }
+        else if (strcmp(p_key, "method") == 0)
+        {
+            p_method = json_reader_string(p_reader);
+        }
+        else if (strcmp(p_key, "params") == 0)
+        {
+            params = *p_reader;
+            json_reader_skip(p_reader);
+        }
+        else if (strcmp(p_key, "id") == 0 && !p_id)
+        {
+            p_id = json_reader_json(p_reader);
+        }
+        else if (strcmp(p_key, "result") == 0 && !p_result)
+        {
+            p_result = json_reader_json(p_reader);
+        }
+        else if (strcmp(p_key, "error") == 0 && !p_error)
+        {
+            p_error = json_reader_json(p_reader);
+        }
+        else
+        {
+            json_reader_skip(p_reader);
+        }
+    }
+
+    // determine message type
+    if (json_reader_error(p_reader))
     {
         LOG("Parsing failed\n");
     }
+    else if (has_jsonrpc)
+    {
+        if (p_method && !p_id && strcmp(p_method, CANCEL_REQUEST_METHOD) == 0)
+        {
+            handle_cancel_request(&params);
+        }
+        else if (p_method)
+        {
+            // request or notification
+            job_t * p_job = CALLOC(1, sizeof(job_t));
+            p_job->p_buffer = p_buffer;
+            p_job->p_method = p_method;
+            if (p_id)
+            {
+                LOG("GOT REQUEST \"%s\"\n", p_method);
+                json_t * p_response = json_object();
+                json_object_set_new(p_response, "jsonrpc", json_string("2.0"));
+                json_object_set(p_response, "id", p_id);
+
+                p_job->p_response = p_response;
+                p_job->p_request_handler = find_request_handler(p_method);
+                if (!p_job->p_request_handler)
+                {
+                    json_rpc_error_response_send(p_response, JSON_RPC_ERROR_METHOD_NOT_FOUND, "No handler registered for method", NULL);
+                }
+                else if (!(p_job->p_params = p_job->p_request_handler->params_reader(&params, &p_job->p_document)))
+                {
+                    json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
+                }
+                else
+                {
+                    cancel_token_init(&p_job->token, (uint64_t) p_job->p_request_handler->deadline_ms * 1000000ULL);
+                    job_submit(p_job);
+                    p_job = NULL;
+                }
+
+                if (p_job)
+                {
+                    json_decref(p_response);
+                }
+            }
+            else
+            {
+                LOG("GOT NOTIFICATION \"%s\"\n", p_method);
+
+                p_job->p_notification_handler = find_notification_handler(p_method);
+                if (!p_job->p_notification_handler)
+                {
+                    LOG("No handler.\n");
+                }
+                else if (!(p_job->p_params = p_job->p_notification_handler->params_reader(&params, &p_job->p_document)))
+                {
+                    LOG("Invalid params.\n");
+                }
+                else
+                {
+                    cancel_token_init(&p_job->token, 0);
+                    job_submit(p_job);
+                    p_job = NULL;
+                }
+            }
+            FREE(p_job);
+        }
+        else if (p_id && json_is_integer(p_id) && (p_result || p_error))
+        {
+            // response
+            handle_response(p_id, p_result, p_error);
+        }
+    }
+
+    json_decref(p_id);
+    json_decref(p_result);
+    json_decref(p_error);
+}
+
+/**
+ * Read a message, or a batch of them, straight from the buffer it was read into, and queue up their
+ * handlers. Strings in the message are unescaped in place, so the buffer can't be read again.
+ */
+static void handle_incoming(input_buffer_t * p_buffer, size_t length)
+{
+    json_reader_t reader;
+    json_reader_init(&reader, p_buffer->data, length);
+    if (json_reader_peek(&reader) == JSON_READER_TYPE_ARRAY)
+    {
+        json_reader_array_start(&reader);
+        while (json_reader_array_next(&reader))
+        {
+            handle_message(p_buffer, &reader);
+        }
+    }
+    else
+    {
+        handle_message(p_buffer, &reader);
+    }
 }
 
 void json_rpc_init(void)
 {
     shared_resource_init(&m_resource);
+    mutex_init(&m_handlers_mut);
+    mutex_init(&m_response_waiters.mut);
+    mutex_init(&m_jobs.mut);
+    semaphore_init(&m_jobs.idle_sem, 1);
+    mutex_init(&m_output.mut);
+    semaphore_init(&m_output.sem, 0x7FFFFFFF);
+    m_output.p_thread = thread_start(output_thread, NULL, THREAD_PRIO_HIGH);
 }
 
-void json_rpc_request_handler_add(const char * p_method, json_rpc_request_handler_t request_handler)
+void json_rpc_free(void)
+{
+    /* An extra signal with nothing queued stops the writer, after everything before it has been written. */
+    semaphore_signal(&m_output.sem);
+    thread_join(m_output.p_thread);
+
+    while (m_output.p_free)
+    {
+        output_t * p_output = m_output.p_free;
+        m_output.p_free = p_output->p_next;
+        json_writer_free(&p_output->writer);
+        FREE(p_output);
+    }
+    json_writer_free(&m_response_writer);
+    json_writer_free(&m_message_writer);
+}
+
+void json_rpc_request_handler_add(const char * p_method,
+                                  json_rpc_params_reader_t params_reader,
+                                  json_rpc_request_handler_t request_handler,
+                                  json_rpc_params_free_t params_free)
 {
     ASSERT(p_method);
     // no duplicate handlers
@@ -242,11 +763,18 @@ void json_rpc_request_handler_add(const char * p_method, json_rpc_request_handle
     LOG("Adding handler for %s\n", p_method);
     m_request_handlers.count++;
     m_request_handlers.p_handlers = REALLOC(m_request_handlers.p_handlers, m_request_handlers.count * sizeof(request_handler_t));
-    m_request_handlers.p_handlers[m_request_handlers.count - 1].p_method = p_method;
-    m_request_handlers.p_handlers[m_request_handlers.count - 1].callback = request_handler;
+    request_handler_t * p_handler = &m_request_handlers.p_handlers[m_request_handlers.count - 1];
+    p_handler->p_method = p_method;
+    p_handler->params_reader = params_reader;
+    p_handler->callback = request_handler;
+    p_handler->params_free = params_free;
+    p_handler->deadline_ms = 0;
 }
 
-void json_rpc_notification_handler_add(const char * p_method, json_rpc_notification_handler_t notification_handler)
+void json_rpc_notification_handler_add(const char * p_method,
+                                       json_rpc_params_reader_t params_reader,
+                                       json_rpc_notification_handler_t notification_handler,
+                                       json_rpc_params_free_t params_free)
 {
     ASSERT(p_method);
     // no duplicate handlers
@@ -254,20 +782,57 @@ void json_rpc_notification_handler_add(const char * p_method, json_rpc_notificat
     LOG("Adding handler for %s\n", p_method);
     m_notification_handlers.count++;
     m_notification_handlers.p_handlers = REALLOC(m_notification_handlers.p_handlers, m_notification_handlers.count * sizeof(notification_handler_t));
-    m_notification_handlers.p_handlers[m_notification_handlers.count - 1].p_method = p_method;
-    m_notification_handlers.p_handlers[m_notification_handlers.count - 1].callback = notification_handler;
+    notification_handler_t * p_handler = &m_notification_handlers.p_handlers[m_notification_handlers.count - 1];
+    p_handler->p_method = p_method;
+    p_handler->params_reader = params_reader;
+    p_handler->callback = notification_handler;
+    p_handler->params_free = params_free;
 }
 
-void json_rpc_response_send(json_t * p_response, json_t * p_result)
+void json_rpc_request_deadline_set(const char * p_method, unsigned milliseconds)
+{
+    request_handler_t * p_handler = (request_handler_t *) find_request_handler(p_method);
+    ASSERT(p_handler);
+    p_handler->deadline_ms = milliseconds;
+}
+
+cancel_token_t * json_rpc_cancel_token(void)
+{
+    return mp_cancel_token;
+}
+
+arena_t * json_rpc_arena(void)
+{
+    return &m_request_arena;
+}
+
+json_writer_t * json_rpc_response_begin(json_t * p_response)
 {
     ASSERT(p_response);
-    ASSERT(p_result);
-    json_object_set_new(p_response, "result", p_result);
-    LOG("Sent response: %s\n", json_dumps(p_response, 0));
-    send_message(p_response);
+    message_begin(&m_response_writer);
+    json_writer_key(&m_response_writer, "id");
+    json_writer_json(&m_response_writer, json_object_get(p_response, "id"));
+    json_writer_key(&m_response_writer, "result");
+    return &m_response_writer;
+}
+
+void json_rpc_response_end(json_writer_t * p_writer)
+{
+    ASSERT(p_writer == &m_response_writer);
+    LOG("Sent response: %u bytes\n", (unsigned) (p_writer->length - HEADER_RESERVED));
+    message_send(p_writer);
     m_responses_sent++;
 }
 
+void json_rpc_response_send(json_t * p_response, json_t * p_result)
+{
+    ASSERT(p_result);
+    json_writer_t * p_writer = json_rpc_response_begin(p_response);
+    json_writer_json(p_writer, p_result);
+    json_decref(p_result);
+    json_rpc_response_end(p_writer);
+}
+
 void json_rpc_error_response_send(json_t * p_response, int code, const char * p_message, json_t * p_data)
 {
     ASSERT(p_response);
@@ -275,26 +840,37 @@ void json_rpc_error_response_send(json_t * p_response, int code, const char * p_
 
     LOG("Sending error response: E %d: %s\n", code, p_message);
 
-    json_t * p_error = json_object();
-    json_object_set_new(p_error, "code", json_integer(code));
-    json_object_set_new(p_error, "message", json_string(p_message));
+    json_writer_t * p_writer = &m_response_writer;
+    message_begin(p_writer);
+    json_writer_key(p_writer, "id");
+    json_writer_json(p_writer, json_object_get(p_response, "id"));
+    json_writer_key(p_writer, "error");
+    json_writer_object_start(p_writer);
+    json_writer_key(p_writer, "code");
+    json_writer_integer(p_writer, code);
+    json_writer_key(p_writer, "message");
+    json_writer_string(p_writer, p_message);
     if (p_data)
     {
-        json_object_set_new(p_error, "data", p_data);
+        json_writer_key(p_writer, "data");
+        json_writer_json(p_writer, p_data);
+        json_decref(p_data);
     }
-    json_object_set_new(p_response, "error", p_error);
-    send_message(p_response);
+    json_writer_object_end(p_writer);
+    message_send(p_writer);
     m_responses_sent++;
 }
 
 json_rpc_request_id_t json_rpc_request_send(const char * p_method, json_t * p_params, json_rpc_response_handler_t response_handler)
 {
+    mutex_take(&m_response_waiters.mut);
+    json_rpc_request_id_t id = m_request_id++;
     if (response_handler)
     {
         response_waiter_t * p_waiter = MALLOC(sizeof(response_waiter_t));
         ASSERT(p_waiter);
 
-        p_waiter->id = m_request_id;
+        p_waiter->id = id;
         p_waiter->handler = response_handler;
         p_waiter->p_next = NULL;
         if (m_response_waiters.p_tail)
@@ -307,35 +883,53 @@ json_rpc_request_id_t json_rpc_request_send(const char * p_method, json_t * p_pa
         }
         m_response_waiters.p_tail = p_waiter;
     }
-
-    json_t * p_request = json_object();
-    ASSERT(p_request);
-    json_object_set_new(p_request, "jsonrpc", json_string("2.0"));
-    json_object_set_new(p_request, "method", json_string(p_method));
-    json_object_set_new(p_request, "id", json_integer(m_request_id));
+    mutex_release(&m_response_waiters.mut);
+
+    json_writer_t * p_writer = &m_message_writer;
+    message_begin(p_writer);
+    json_writer_key(p_writer, "method");
+    json_writer_string(p_writer, p_method);
+    json_writer_key(p_writer, "id");
+    json_writer_integer(p_writer, id);
     if (p_params)
     {
-        json_object_set_new(p_request, "params", p_params);
+        json_writer_key(p_writer, "params");
+        json_writer_json(p_writer, p_params);
+        json_decref(p_params);
     }
+    message_send(p_writer);
+    return id;
+}
 
-    send_message(p_request);
-    json_decref(p_request);
-    return m_request_id++;
+json_writer_t * json_rpc_notification_begin(const char * p_method)
+{
+    json_writer_t * p_writer = &m_message_writer;
+    message_begin(p_writer);
+    json_writer_key(p_writer, "method");
+    json_writer_string(p_writer, p_method);
+    json_writer_key(p_writer, "params");
+    return p_writer;
+}
+
+void json_rpc_notification_end(json_writer_t * p_writer)
+{
+    ASSERT(p_writer == &m_message_writer);
+    message_send(p_writer);
 }
 
 void json_rpc_notification_send(const char * p_method, json_t * p_params)
 {
-    json_t * p_notification = json_object();
-    ASSERT(p_notification);
-    json_object_set_new(p_notification, "jsonrpc", json_string("2.0"));
-    json_object_set_new(p_notification, "method", json_string(p_method));
+    json_writer_t * p_writer = &m_message_writer;
+    message_begin(p_writer);
+    json_writer_key(p_writer, "method");
+    json_writer_string(p_writer, p_method);
     if (p_params)
     {
-        json_object_set_new(p_notification, "params", p_params);
+        json_writer_key(p_writer, "params");
+        json_writer_json(p_writer, p_params);
+        json_decref(p_params);
     }
-
-    send_message(p_notification);
-    json_decref(p_notification);
+    message_send(p_writer);
 }
 
 
@@ -344,41 +938,27 @@ void json_rpc_listen(FILE * stream)
     ASSERT(stream);
     LOG("Listening for incoming rpc\n");
     m_running = true;
-    size_t buffer_size = 1024;
-    char * p_buffer = MALLOC(buffer_size);
     while (m_running)
     {
-        size_t length;
+        unsigned length;
         if (fscanf(stream, CONTENT_LENGTH_HEADER, &length) == 1)
         {
-            if (buffer_size < length)
-            {
-                buffer_size = length + 1;
-                LOG("Increasing buffer size to %u... ", buffer_size);
-                p_buffer = REALLOC(p_buffer, buffer_size);
-                ASSERT(p_buffer);
-                LOG("Done.\n");
-            }
+            /* Every message gets a buffer of its own, as its handlers keep pointing into it until they're
+             * done, long after the next message has been read. */
+            input_buffer_t * p_buffer = MALLOC(sizeof(input_buffer_t) + length + 1);
+            p_buffer->users.value = 1;
 
-            char * p_c = p_buffer;
+            char * p_c = p_buffer->data;
             do
             {
-                size_t count = fread(p_c, 1, min((size_t)(&p_buffer[buffer_size] - p_c), length), stream);
+                size_t count = fread(p_c, 1, length - (size_t)(p_c - p_buffer->data), stream);
                 p_c += count;
-            } while ((size_t)(p_c - p_buffer) < length);
+            } while ((size_t)(p_c - p_buffer->data) < length);
             *p_c = '\0';
 
-            LOG("Handling buffer: %s\n", p_buffer);
-            json_error_t err;
-            json_t * p_json = json_loads(p_buffer, JSON_DISABLE_EOF_CHECK, &err);
-            if (p_json)
-            {
-                handle_incoming(p_json);
-            }
-            else
-            {
-                LOG("Parsing failed: L%u:%u: %s\n", err.line, err.column, err.text);
-            }
+            LOG("Handling buffer: %s\n", p_buffer->data);
+            handle_incoming(p_buffer, length);
+            input_buffer_release(p_buffer);
         }
         else
         {
@@ -386,8 +966,8 @@ void json_rpc_listen(FILE * stream)
             m_running = false;
         }
     }
+    jobs_wait();
     LOG("Exiting\n");
-    FREE(p_buffer);
 }
 
 void json_rpc_stop(void)
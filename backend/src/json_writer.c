@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "json_writer.h"
+#include "utils.h"
+
+#define INITIAL_CAPACITY 4096
+
+static void reserve(json_writer_t * p_writer, size_t size)
+{
+    if (p_writer->length + size > p_writer->capacity)
+    {
+        p_writer->capacity = max(max(p_writer->capacity * 2, p_writer->length + size), INITIAL_CAPACITY);
+        p_writer->p_data = REALLOC(p_writer->p_data, p_writer->capacity);
+    }
+}
+
+static void append(json_writer_t * p_writer, const char * p_data, size_t size)
+{
+    reserve(p_writer, size);
+    memcpy(&p_writer->p_data[p_writer->length], p_data, size);
+    p_writer->length += size;
+}
+
+static void append_char(json_writer_t * p_writer, char c)
+{
+    reserve(p_writer, 1);
+    p_writer->p_data[p_writer->length++] = c;
+}
+
+/** Put a comma in front of a value that follows another one. */
+static void value_start(json_writer_t * p_writer)
+{
+    if (p_writer->needs_comma)
+    {
+        append_char(p_writer, ',');
+    }
+    p_writer->needs_comma = true;
+}
+
+static int dump_callback(const char * p_buffer, size_t size, void * p_data)
+{
+    append(p_data, p_buffer, size);
+    return 0;
+}
+
+void json_writer_reset(json_writer_t * p_writer, size_t reserved)
+{
+    p_writer->length = 0;
+    p_writer->needs_comma = false;
+    reserve(p_writer, reserved);
+    p_writer->length = reserved;
+}
+
+void json_writer_free(json_writer_t * p_writer)
+{
+    FREE(p_writer->p_data);
+    memset(p_writer, 0, sizeof(json_writer_t));
+}
+
+void json_writer_object_start(json_writer_t * p_writer)
+{
+    value_start(p_writer);
+    append_char(p_writer, '{');
+    p_writer->needs_comma = false;
+}
+
+void json_writer_object_end(json_writer_t * p_writer)
+{
+    append_char(p_writer, '}');
+    p_writer->needs_comma = true;
+}
+
+void json_writer_array_start(json_writer_t * p_writer)
+{
+    value_start(p_writer);
+    append_char(p_writer, '[');
+    p_writer->needs_comma = false;
+}
+
+void json_writer_array_end(json_writer_t * p_writer)
+{
+    append_char(p_writer, ']');
+    p_writer->needs_comma = true;
+}
+
+void json_writer_key(json_writer_t * p_writer, const char * p_key)
+{
+    size_t length = strlen(p_key);
+    reserve(p_writer, length + 4);
+    char * p_out = &p_writer->p_data[p_writer->length];
+    if (p_writer->needs_comma)
+    {
+        *p_out++ = ',';
+    }
+    *p_out++ = '"';
+    memcpy(p_out, p_key, length);
+    p_out += length;
+    *p_out++ = '"';
+    *p_out++ = ':';
+    p_writer->length = p_out - p_writer->p_data;
+    /* The value that follows must not get a comma of its own. */
+    p_writer->needs_comma = false;
+}
+
+void json_writer_string(json_writer_t * p_writer, const char * p_string)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    if (!p_string)
+    {
+        json_writer_null(p_writer);
+        return;
+    }
+    value_start(p_writer);
+    append_char(p_writer, '"');
+
+    /* Copy runs of characters that don't need escaping in one go. */
+    const char * p_run = p_string;
+    const char * p_c;
+    for (p_c = p_string; *p_c; ++p_c)
+    {
+        unsigned char c = (unsigned char) *p_c;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        append(p_writer, p_run, p_c - p_run);
+        p_run = p_c + 1;
+
+        char escape[6] = {'\\', 0};
+        switch (c)
+        {
+            case '"':  escape[1] = '"';  break;
+            case '\\': escape[1] = '\\'; break;
+            case '\n': escape[1] = 'n';  break;
+            case '\r': escape[1] = 'r';  break;
+            case '\t': escape[1] = 't';  break;
+            case '\b': escape[1] = 'b';  break;
+            case '\f': escape[1] = 'f';  break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = hex[c >> 4];
+                escape[5] = hex[c & 0xF];
+                append(p_writer, escape, 6);
+                continue;
+        }
+        append(p_writer, escape, 2);
+    }
+    append(p_writer, p_run, p_c - p_run);
+    append_char(p_writer, '"');
+}
+
+void json_writer_integer(json_writer_t * p_writer, int64_t value)
+{
+    char buf[24];
+    int length = snprintf(buf, sizeof(buf), "%" PRId64, value);
+    value_start(p_writer);
+    append(p_writer, buf, (size_t) length);
+}
+
+void json_writer_boolean(json_writer_t * p_writer, bool value)
+{
+    value_start(p_writer);
+    if (value)
+    {
+        append(p_writer, "true", 4);
+    }
+    else
+    {
+        append(p_writer, "false", 5);
+    }
+}
+
+void json_writer_null(json_writer_t * p_writer)
+{
+    value_start(p_writer);
+    append(p_writer, "null", 4);
+}
+
+void json_writer_json(json_writer_t * p_writer, const json_t * p_json)
+{
+    if (!p_json)
+    {
+        json_writer_null(p_writer);
+        return;
+    }
+    value_start(p_writer);
+    json_dump_callback(p_json, dump_callback, p_writer, JSON_ENCODE_ANY | JSON_COMPACT);
+}
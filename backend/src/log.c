@@ -22,6 +22,18 @@ void safe_puts(const char * p_filename, const char * p_string)
     mutex_release(&m_mut);
 }
 
+void safe_write(const char * p_filename, const void * p_data, size_t size)
+{
+    mutex_take(&m_mut);
+    FILE *f = fopen(p_filename, "ab");
+    if (f)
+    {
+        fwrite(p_data, 1, size, f);
+        fclose(f);
+    }
+    mutex_release(&m_mut);
+}
+
 void json_rpc_log(const char * p_message)
 {
     json_t * p_args = json_object();
@@ -15,9 +15,12 @@
     #ifndef getcwd
         #define getcwd _getcwd
     #endif
+    #define make_directory(p_path) _mkdir(p_path)
 #else
     #include <unistd.h>
     #include <dirent.h>
+    #include <limits.h>
+    #define make_directory(p_path) mkdir(p_path, 0755)
 #endif
 
 static inline bool is_path_slash(char c)
@@ -268,6 +271,7 @@ void path_get_files(const char * p_directory, path_file_cb_t callback, bool recu
         LOG("FAILED LOOKING UP %s\n", p_directory);
     }
 #else
+    LOG("Path get files for %s\n", p_directory);
     DIR * p_dir = opendir(p_directory);
     if (p_dir)
     {
@@ -275,9 +279,30 @@ void path_get_files(const char * p_directory, path_file_cb_t callback, bool recu
              p_ent != NULL;
              p_ent = readdir(p_dir))
         {
-            callback(p_ent->d_name, PATH_KIND_UNKNOWN, p_args);
+            if (strcmp(p_ent->d_name, ".") != 0 && strcmp(p_ent->d_name, "..") != 0)
+            {
+                char full_path[PATH_MAX];
+                snprintf(full_path, sizeof(full_path), "%s/%s", p_directory, p_ent->d_name);
+
+                struct stat file_stat;
+                path_kind_t kind = PATH_KIND_UNKNOWN;
+                if (stat(full_path, &file_stat) == 0)
+                {
+                    kind = S_ISDIR(file_stat.st_mode) ? PATH_KIND_DIRECTORY : PATH_KIND_FILE;
+                }
+
+                if (kind == PATH_KIND_DIRECTORY && recursive)
+                {
+                    path_get_files(full_path, callback, true, p_args);
+                }
+                callback(full_path, kind, p_args);
+            }
         }
-        closedir (dir);
+        closedir(p_dir);
+    }
+    else
+    {
+        LOG("FAILED LOOKING UP %s\n", p_directory);
     }
 #endif
 }
@@ -300,8 +325,38 @@ bool path_last_edit(const char * p_path, time_t * p_time)
     CloseHandle(hFile);
     return (hFile != INVALID_HANDLE_VALUE);
 }
+#else
+bool path_last_edit(const char * p_path, time_t * p_time)
+{
+    struct stat file_stat;
+    if (stat(p_path, &file_stat) == 0)
+    {
+        *p_time = file_stat.st_mtime;
+        return true;
+    }
+    return false;
+}
 #endif
 
+bool path_create_directory(const char * p_path)
+{
+    char * p_directory = normalize_path(p_path);
+    /* Create every parent first, the ones that already exist just fail. */
+    for (char * p_c = &p_directory[1]; *p_c; p_c++)
+    {
+        if (*p_c == '/')
+        {
+            *p_c = '\0';
+            make_directory(p_directory);
+            *p_c = '/';
+        }
+    }
+    make_directory(p_directory);
+    bool success = path_is_directory(p_directory);
+    FREE(p_directory);
+    return success;
+}
+
 unsigned path_pair_score(const char * p_header, const char * p_source)
 {
     char * p_header_filename = path_filename_no_ext(p_header);
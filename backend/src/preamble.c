@@ -0,0 +1,663 @@
+#include <stdio.h>
+#include <string.h>
+#include "preamble.h"
+#include "hashtable.h"
+#include "path.h"
+#include "string_pool.h"
+#include "utils.h"
+#include "log.h"
+
+#define PREAMBLE_PARSE_OPTIONS (CXTranslationUnit_Incomplete | CXTranslationUnit_ForSerialization)
+#define DEPENDENCY_LINE_MAX 4096
+
+typedef struct
+{
+    const char * p_path; ///< Pooled
+    time_t last_edit;
+} preamble_dependency_t;
+
+struct preamble
+{
+    char * p_base; ///< Location of the preamble's files, without the extension.
+    char * p_location; ///< Precompiled header
+    mutex_t mut; ///< Held while the preamble is validated or built.
+    bool attempted; ///< Whether the preamble has been loaded or built in this session.
+    bool valid; ///< Whether the precompiled header was built without errors.
+    uint32_t generation; ///< Number of times the precompiled header was written in this session.
+    preamble_dependency_t * p_dependencies; ///< Files included the last time the preamble was built.
+    unsigned dependency_count;
+    unsigned dependency_capacity;
+};
+
+typedef struct
+{
+    const char * p_language;
+    const char ** pp_args;
+    unsigned arg_count;
+} preamble_flags_t;
+
+static struct
+{
+    CXIndex index;
+    char * p_directory;
+    HashTable * p_preambles; ///< By precompiled header location.
+    mutex_t mut;
+} m_preambles;
+
+static const char * m_skipped_flags[] = {"-c", "-M", "-MM", "-MD", "-MMD", "-MP"};
+static const char * m_skipped_flags_with_value[] = {"-o", "-MF", "-MT", "-MQ"};
+
+static bool string_in(const char * p_string, const char ** pp_strings, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (strcmp(p_string, pp_strings[i]) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Language to build the file's precompiled header in. Only source files are supported, as a header's
+ * language depends on the flags of whichever unit it was opened with.
+ */
+static const char * header_language(const char * p_filename)
+{
+    const char * p_extension = strrchr(path_filename(p_filename), '.');
+    if (!p_extension)
+    {
+        return NULL;
+    }
+    else if (strcmp(p_extension, ".c") == 0)
+    {
+        return "c-header";
+    }
+    else if (strcmp(p_extension, ".m") == 0)
+    {
+        return "objective-c-header";
+    }
+    else if (strcmp(p_extension, ".mm") == 0)
+    {
+        return "objective-c++-header";
+    }
+    else if (strcmp(p_extension, ".cpp") == 0 || strcmp(p_extension, ".cc") == 0 ||
+             strcmp(p_extension, ".cxx") == 0 || strcmp(p_extension, ".c++") == 0 ||
+             strcmp(p_extension, ".C") == 0)
+    {
+        return "c++-header";
+    }
+    return NULL;
+}
+
+/**
+ * Strip the flags that only make sense for compiling the unit itself, like the compiler, the source file
+ * and the outputs, so that units with the same options end up with the same flags.
+ *
+ * @returns Whether the precompiled header can be built for the unit.
+ */
+static bool flags_normalize(const char * p_filename, const compile_flags_t * p_flags, preamble_flags_t * p_result)
+{
+    p_result->p_language = header_language(p_filename);
+    p_result->pp_args = MALLOC(sizeof(const char *) * (p_flags->count + 1));
+    p_result->arg_count = 0;
+
+    const char * p_name = path_filename(p_filename);
+    for (unsigned i = (p_flags->full_argv ? 1 : 0); i < p_flags->count; ++i)
+    {
+        const char * p_arg = p_flags->pp_array[i];
+        if (string_in(p_arg, m_skipped_flags, ARRAY_SIZE(m_skipped_flags)))
+        {
+            continue;
+        }
+        else if (string_in(p_arg, m_skipped_flags_with_value, ARRAY_SIZE(m_skipped_flags_with_value)))
+        {
+            i++;
+        }
+        else if (strcmp(p_arg, "-x") == 0 && i + 1 < p_flags->count)
+        {
+            /* An explicit language overrides the extension, and is passed as a header language instead. */
+            i++;
+            p_result->p_language = NULL;
+            if (strstr(p_flags->pp_array[i], "-header") == NULL)
+            {
+                char * p_language = MALLOC(strlen(p_flags->pp_array[i]) + sizeof("-header"));
+                sprintf(p_language, "%s-header", p_flags->pp_array[i]);
+                p_result->p_language = string_pool_string(p_language);
+                FREE(p_language);
+            }
+        }
+        else if (p_arg[0] != '-' && path_equals(path_filename(p_arg), p_name))
+        {
+            continue;
+        }
+        else
+        {
+            p_result->pp_args[p_result->arg_count++] = p_arg;
+        }
+    }
+    return (p_result->p_language != NULL);
+}
+
+/**
+ * Collect the #include and #import lines the file starts with, skipping blank lines and comments. Stops
+ * at the first line of anything else, as the includes after it may depend on it.
+ *
+ * @param[out] p_quoted Whether any of the includes are quoted, and depend on the file's directory.
+ *
+ * @returns The include lines, to be freed by the caller, or NULL if the file doesn't start with any.
+ */
+static char * include_prefix(const char * p_contents, size_t length, bool * p_quoted)
+{
+    const char * p_end = p_contents + length;
+    const char * p_c = p_contents;
+    char * p_prefix = NULL;
+    size_t prefix_length = 0;
+    *p_quoted = false;
+
+    while (p_c < p_end)
+    {
+        if (*p_c == ' ' || *p_c == '\t' || *p_c == '\r' || *p_c == '\n')
+        {
+            p_c++;
+        }
+        else if (p_c + 1 < p_end && p_c[0] == '/' && p_c[1] == '/')
+        {
+            const char * p_line_end = memchr(p_c, '\n', p_end - p_c);
+            p_c = (p_line_end ? p_line_end : p_end);
+        }
+        else if (p_c + 1 < p_end && p_c[0] == '/' && p_c[1] == '*')
+        {
+            const char * p_comment_end = p_c + 2;
+            while (p_comment_end + 1 < p_end && !(p_comment_end[0] == '*' && p_comment_end[1] == '/'))
+            {
+                p_comment_end++;
+            }
+            if (p_comment_end + 1 >= p_end)
+            {
+                break;
+            }
+            p_c = p_comment_end + 2;
+        }
+        else if (*p_c == '#')
+        {
+            const char * p_directive = p_c + 1;
+            while (p_directive < p_end && (*p_directive == ' ' || *p_directive == '\t'))
+            {
+                p_directive++;
+            }
+            size_t remaining = p_end - p_directive;
+            if (!((remaining > 7 && strncmp(p_directive, "include", 7) == 0) ||
+                  (remaining > 6 && strncmp(p_directive, "import", 6) == 0)))
+            {
+                break;
+            }
+
+            const char * p_line_end = memchr(p_c, '\n', p_end - p_c);
+            if (!p_line_end)
+            {
+                p_line_end = p_end;
+            }
+            size_t line_length = p_line_end - p_c;
+            while (line_length > 0 && p_c[line_length - 1] == '\r')
+            {
+                line_length--;
+            }
+            *p_quoted = *p_quoted || (memchr(p_c, '"', line_length) != NULL);
+
+            p_prefix = REALLOC(p_prefix, prefix_length + line_length + 2);
+            memcpy(&p_prefix[prefix_length], p_c, line_length);
+            prefix_length += line_length;
+            p_prefix[prefix_length++] = '\n';
+            p_prefix[prefix_length] = '\0';
+            p_c = p_line_end;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return p_prefix;
+}
+
+static const struct CXUnsavedFile * unsaved_file_find(const char * p_path,
+                                                      struct CXUnsavedFile * p_unsaved_files,
+                                                      uint32_t unsaved_file_count)
+{
+    for (uint32_t i = 0; i < unsaved_file_count; ++i)
+    {
+        if (path_equals(p_unsaved_files[i].Filename, p_path))
+        {
+            return &p_unsaved_files[i];
+        }
+    }
+    return NULL;
+}
+
+static char * file_include_prefix(const char * p_filename,
+                                  struct CXUnsavedFile * p_unsaved_files,
+                                  uint32_t unsaved_file_count,
+                                  bool * p_quoted)
+{
+    const struct CXUnsavedFile * p_unsaved = unsaved_file_find(p_filename, p_unsaved_files, unsaved_file_count);
+    if (p_unsaved)
+    {
+        return include_prefix(p_unsaved->Contents, p_unsaved->Length, p_quoted);
+    }
+
+    mapped_file_t file;
+    if (!mapped_file_open(&file, p_filename))
+    {
+        return NULL;
+    }
+    char * p_prefix = include_prefix(file.p_data, file.size, p_quoted);
+    mapped_file_close(&file);
+    return p_prefix;
+}
+
+/**
+ * Check whether the unsaved contents of a file differ from what's on disk. Clang doesn't validate the
+ * files it reads from a precompiled header against the unsaved files, so they must be checked here.
+ */
+static bool unsaved_file_modified(const struct CXUnsavedFile * p_unsaved)
+{
+    mapped_file_t file;
+    if (!mapped_file_open(&file, p_unsaved->Filename))
+    {
+        return true;
+    }
+    bool modified = (file.size != p_unsaved->Length ||
+                     memcmp(file.p_data, p_unsaved->Contents, file.size) != 0);
+    mapped_file_close(&file);
+    return modified;
+}
+
+/** Must be called with the preamble's mutex taken. */
+static bool dependencies_fresh(const preamble_t * p_preamble)
+{
+    for (unsigned i = 0; i < p_preamble->dependency_count; ++i)
+    {
+        time_t last_edit;
+        if (!path_last_edit(p_preamble->p_dependencies[i].p_path, &last_edit) ||
+            last_edit != p_preamble->p_dependencies[i].last_edit)
+        {
+            LOG("%s changed since preamble %s was built\n", p_preamble->p_dependencies[i].p_path, p_preamble->p_location);
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Must be called with the preamble's mutex taken. */
+static bool dependencies_modified(const preamble_t * p_preamble,
+                                  struct CXUnsavedFile * p_unsaved_files,
+                                  uint32_t unsaved_file_count)
+{
+    for (unsigned i = 0; i < p_preamble->dependency_count; ++i)
+    {
+        const struct CXUnsavedFile * p_unsaved = unsaved_file_find(p_preamble->p_dependencies[i].p_path,
+                                                                   p_unsaved_files,
+                                                                   unsaved_file_count);
+        if (p_unsaved && unsaved_file_modified(p_unsaved))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void dependency_add(preamble_t * p_preamble, const char * p_path, time_t last_edit)
+{
+    if (p_preamble->dependency_count == p_preamble->dependency_capacity)
+    {
+        p_preamble->dependency_capacity = (p_preamble->dependency_capacity ? p_preamble->dependency_capacity * 2 : 16);
+        p_preamble->p_dependencies = REALLOC(p_preamble->p_dependencies,
+                                             p_preamble->dependency_capacity * sizeof(preamble_dependency_t));
+    }
+    p_preamble->p_dependencies[p_preamble->dependency_count].p_path = string_pool_string(p_path);
+    p_preamble->p_dependencies[p_preamble->dependency_count].last_edit = last_edit;
+    p_preamble->dependency_count++;
+}
+
+static void dependency_visitor(CXFile included_file,
+                               CXSourceLocation * p_inclusion_stack,
+                               unsigned include_len,
+                               CXClientData client_data)
+{
+    /* The prefix header itself is keyed by its contents. */
+    if (include_len > 0)
+    {
+        CXString filename = clang_getFileName(included_file);
+        char * p_path = normalize_path(clang_getCString(filename));
+        time_t last_edit;
+        if (path_last_edit(p_path, &last_edit))
+        {
+            dependency_add(client_data, p_path, last_edit);
+        }
+        FREE(p_path);
+        clang_disposeString(filename);
+    }
+}
+
+static char * preamble_file(const preamble_t * p_preamble, const char * p_extension)
+{
+    char * p_file = MALLOC(strlen(p_preamble->p_base) + strlen(p_extension) + 1);
+    sprintf(p_file, "%s%s", p_preamble->p_base, p_extension);
+    return p_file;
+}
+
+/**
+ * Load the dependency list the preamble was built with in an earlier session.
+ */
+static bool dependencies_load(preamble_t * p_preamble)
+{
+    time_t last_edit;
+    if (!path_last_edit(p_preamble->p_location, &last_edit))
+    {
+        return false;
+    }
+
+    char * p_deps_location = preamble_file(p_preamble, ".deps");
+    FILE * f = fopen(p_deps_location, "r");
+    FREE(p_deps_location);
+    if (!f)
+    {
+        return false;
+    }
+
+    char line[DEPENDENCY_LINE_MAX];
+    while (fgets(line, sizeof(line), f))
+    {
+        long long last_edit_value;
+        int path_offset;
+        size_t length = strlen(line);
+        if (length > 0 && line[length - 1] == '\n')
+        {
+            line[--length] = '\0';
+        }
+        if (sscanf(line, "%lld %n", &last_edit_value, &path_offset) == 1 && line[path_offset] != '\0')
+        {
+            dependency_add(p_preamble, &line[path_offset], (time_t) last_edit_value);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static bool dependencies_save(const preamble_t * p_preamble)
+{
+    /* Write to a temporary file and move it into place, so a crash never leaves a half written list. */
+    char * p_location = preamble_file(p_preamble, ".deps");
+    char * p_temp_location = preamble_file(p_preamble, ".deps.tmp");
+
+    bool success = false;
+    FILE * f = fopen(p_temp_location, "w");
+    if (f)
+    {
+        success = true;
+        for (unsigned i = 0; success && i < p_preamble->dependency_count; ++i)
+        {
+            success = (fprintf(f, "%lld %s\n",
+                               (long long) p_preamble->p_dependencies[i].last_edit,
+                               p_preamble->p_dependencies[i].p_path) > 0);
+        }
+        success = (fclose(f) == 0) && success;
+    }
+
+#ifdef _WIN32
+    /* Windows won't rename over an existing file. */
+    if (success)
+    {
+        remove(p_location);
+    }
+#endif
+    success = success && (rename(p_temp_location, p_location) == 0);
+    if (!success)
+    {
+        remove(p_temp_location);
+    }
+
+    FREE(p_temp_location);
+    FREE(p_location);
+    return success;
+}
+
+static bool has_errors(CXTranslationUnit tu)
+{
+    unsigned count = clang_getNumDiagnostics(tu);
+    bool errors = false;
+    for (unsigned i = 0; i < count && !errors; ++i)
+    {
+        CXDiagnostic diagnostic = clang_getDiagnostic(tu, i);
+        errors = (clang_getDiagnosticSeverity(diagnostic) >= CXDiagnostic_Error);
+        clang_disposeDiagnostic(diagnostic);
+    }
+    return errors;
+}
+
+/**
+ * Build the precompiled header from the prefix, and record the files it includes. Must be called with
+ * the preamble's mutex taken.
+ */
+static void preamble_build(preamble_t * p_preamble,
+                           const char * p_filename,
+                           const char * p_prefix,
+                           bool quoted,
+                           const preamble_flags_t * p_flags)
+{
+    profile_time_t start_time = profile_start();
+    p_preamble->valid = false;
+    p_preamble->dependency_count = 0;
+
+    char * p_header = preamble_file(p_preamble, ".h");
+    FILE * f = fopen(p_header, "w");
+    bool written = (f && fputs(p_prefix, f) >= 0);
+    written = (f && fclose(f) == 0) && written;
+    if (!written)
+    {
+        LOG("Failed writing preamble header %s\n", p_header);
+        FREE(p_header);
+        return;
+    }
+
+    /* The prefix header lives in the cache, so quoted includes are looked up next to the unit instead. */
+    const char ** pp_args = MALLOC(sizeof(const char *) * (p_flags->arg_count + 4));
+    memcpy(pp_args, p_flags->pp_args, sizeof(const char *) * p_flags->arg_count);
+    unsigned arg_count = p_flags->arg_count;
+    char * p_directory = path_directory(p_filename);
+    if (quoted)
+    {
+        pp_args[arg_count++] = "-iquote";
+        pp_args[arg_count++] = p_directory;
+    }
+    pp_args[arg_count++] = "-x";
+    pp_args[arg_count++] = p_flags->p_language;
+
+    CXTranslationUnit tu;
+    enum CXErrorCode status = clang_parseTranslationUnit2(m_preambles.index,
+                                                          p_header,
+                                                          pp_args,
+                                                          arg_count,
+                                                          NULL,
+                                                          0,
+                                                          PREAMBLE_PARSE_OPTIONS,
+                                                          &tu);
+    if (status == CXError_Success)
+    {
+        clang_getInclusions(tu, dependency_visitor, p_preamble);
+        if (has_errors(tu))
+        {
+            LOG("The include prefix of %s doesn't compile on its own, not precompiling it\n", p_filename);
+        }
+        else if (clang_saveTranslationUnit(tu, p_preamble->p_location, clang_defaultSaveOptions(tu)) == CXSaveError_None)
+        {
+            p_preamble->valid = true;
+            p_preamble->generation++;
+            if (!dependencies_save(p_preamble))
+            {
+                LOG("Failed writing the dependencies of preamble %s\n", p_preamble->p_location);
+            }
+        }
+        else
+        {
+            LOG("Failed saving preamble %s\n", p_preamble->p_location);
+        }
+        clang_disposeTranslationUnit(tu);
+    }
+    else
+    {
+        LOG("Failed parsing preamble for %s: Status %u\n", p_filename, status);
+    }
+
+    LOG("Built preamble %s for %s in %ums (%u files)\n",
+        p_preamble->p_location,
+        p_filename,
+        PROFILE_NS_TO_MS(profile_end(start_time)),
+        p_preamble->dependency_count);
+
+    FREE(p_directory);
+    FREE(pp_args);
+    FREE(p_header);
+}
+
+static preamble_t * preamble_find_or_add(uint64_t key)
+{
+    char * p_base = MALLOC(strlen(m_preambles.p_directory) + 1 + 16 + 1);
+    sprintf(p_base, "%s/%016llx", m_preambles.p_directory, (unsigned long long) key);
+    char * p_location = MALLOC(strlen(p_base) + sizeof(".pch"));
+    sprintf(p_location, "%s.pch", p_base);
+
+    mutex_take(&m_preambles.mut);
+    preamble_t * p_preamble;
+    if (hashtable_get(m_preambles.p_preambles, p_location, &p_preamble) == CC_OK)
+    {
+        FREE(p_base);
+        FREE(p_location);
+    }
+    else
+    {
+        p_preamble = CALLOC(sizeof(preamble_t), 1);
+        p_preamble->p_base = p_base;
+        p_preamble->p_location = p_location;
+        mutex_init(&p_preamble->mut);
+        ASSERT(hashtable_add(m_preambles.p_preambles, p_location, p_preamble) == CC_OK);
+    }
+    mutex_release(&m_preambles.mut);
+    return p_preamble;
+}
+
+void preamble_init(CXIndex index, const char * p_directory)
+{
+    m_preambles.index = index;
+    m_preambles.p_directory = STRDUP(p_directory);
+    ASSERT(hashtable_new(&m_preambles.p_preambles) == CC_OK);
+    mutex_init(&m_preambles.mut);
+}
+
+void preamble_free(void)
+{
+    if (hashtable_size(m_preambles.p_preambles) > 0)
+    {
+        HashTableIter iter;
+        hashtable_iter_init(&iter, m_preambles.p_preambles);
+        TableEntry * p_entry;
+        while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+        {
+            preamble_t * p_preamble;
+            ASSERT(hashtable_iter_remove(&iter, &p_preamble) == CC_OK);
+            mutex_free(&p_preamble->mut);
+            FREE(p_preamble->p_dependencies);
+            FREE(p_preamble->p_location);
+            FREE(p_preamble->p_base);
+            FREE(p_preamble);
+        }
+    }
+    hashtable_destroy(m_preambles.p_preambles);
+    mutex_free(&m_preambles.mut);
+    FREE(m_preambles.p_directory);
+}
+
+preamble_t * preamble_get(const char * p_filename,
+                          const compile_flags_t * p_flags,
+                          struct CXUnsavedFile * p_unsaved_files,
+                          uint32_t unsaved_file_count,
+                          uint32_t * p_generation)
+{
+    *p_generation = 0;
+    bool quoted;
+    char * p_prefix = file_include_prefix(p_filename, p_unsaved_files, unsaved_file_count, &quoted);
+    if (!p_prefix)
+    {
+        return NULL;
+    }
+
+    preamble_flags_t flags;
+    if (!flags_normalize(p_filename, p_flags, &flags))
+    {
+        FREE(flags.pp_args);
+        FREE(p_prefix);
+        return NULL;
+    }
+
+    /* Quoted includes are looked up in the unit's directory first, so they only match in the same one. */
+    uint64_t key = hash_fnv1a(FNV_OFFSET_BASIS, flags.p_language, strlen(flags.p_language) + 1);
+    for (unsigned i = 0; i < flags.arg_count; ++i)
+    {
+        key = hash_fnv1a(key, flags.pp_args[i], strlen(flags.pp_args[i]) + 1);
+    }
+    if (quoted)
+    {
+        char * p_directory = path_directory(p_filename);
+        key = hash_fnv1a(key, p_directory, strlen(p_directory) + 1);
+        FREE(p_directory);
+    }
+    key = hash_fnv1a(key, p_prefix, strlen(p_prefix));
+
+    preamble_t * p_preamble = preamble_find_or_add(key);
+
+    mutex_take(&p_preamble->mut);
+    bool build = false;
+    if (!p_preamble->attempted)
+    {
+        p_preamble->attempted = true;
+        p_preamble->valid = dependencies_load(p_preamble);
+        build = !(p_preamble->valid && dependencies_fresh(p_preamble));
+    }
+    else
+    {
+        build = !dependencies_fresh(p_preamble);
+    }
+
+    if (build && path_create_directory(m_preambles.p_directory))
+    {
+        preamble_build(p_preamble, p_filename, p_prefix, quoted, &flags);
+    }
+    else if (build)
+    {
+        p_preamble->valid = false;
+    }
+
+    bool usable = (p_preamble->valid && !dependencies_modified(p_preamble, p_unsaved_files, unsaved_file_count));
+    *p_generation = p_preamble->generation;
+    mutex_release(&p_preamble->mut);
+
+    FREE(flags.pp_args);
+    FREE(p_prefix);
+    return (usable ? p_preamble : NULL);
+}
+
+const char * preamble_location(const preamble_t * p_preamble)
+{
+    return p_preamble->p_location;
+}
+
+void preamble_dependencies_get(preamble_t * p_preamble, preamble_dependency_callback_t callback, void * p_args)
+{
+    mutex_take(&p_preamble->mut);
+    for (unsigned i = 0; i < p_preamble->dependency_count; ++i)
+    {
+        callback(p_preamble->p_dependencies[i].p_path, p_args);
+    }
+    mutex_release(&p_preamble->mut);
+}
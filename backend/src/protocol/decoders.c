@@ -12,2047 +12,3169 @@
 static decoder_error_t m_error;
 
 /*******************************************************************************
- * Decoders
+ * Readers
  ******************************************************************************/
-/* Common parameter JSON decoders */
-compilation_database_params_t decode_compilation_database_params(json_t * p_json)
+/* Common parameter JSON readers */
+bool read_compilation_database_params(json_reader_t * p_reader, compilation_database_params_t * p_value)
 {
-    compilation_database_params_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(compilation_database_params_t));
 
-    json_t * p_path_json = json_object_get(p_json, "path");
-    if (json_is_string(p_path_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.path = decode_string(p_path_json);
-        retval.valid_fields |= COMPILATION_DATABASE_PARAMS_FIELD_PATH;
-    }
-
-    json_t * p_additional_arguments_json = json_object_get(p_json, "additionalArguments");
-    if (json_is_array(p_additional_arguments_json))
-    {
-        retval.additional_arguments_count = json_array_size(p_additional_arguments_json);
-        retval.p_additional_arguments = malloc(sizeof(char  *) * retval.additional_arguments_count);
-        ASSERT(retval.p_additional_arguments);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_additional_arguments_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_additional_arguments[index] = decode_string(p_it);
+            if (strcmp(p_key, "path") == 0)
+            {
+                if (read_string(p_reader, &p_value->path))
+                {
+                    p_value->valid_fields |= COMPILATION_DATABASE_PARAMS_FIELD_PATH;
+                }
+            }
+            else if (strcmp(p_key, "additionalArguments") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_additional_arguments = read_array_reserve(p_value->p_additional_arguments, p_value->additional_arguments_count, sizeof(p_value->p_additional_arguments[0]));
+                        if (read_string(p_reader, &p_value->p_additional_arguments[p_value->additional_arguments_count]))
+                        {
+                            p_value->additional_arguments_count++;
+                        }
+                    }
+                    p_value->valid_fields |= COMPILATION_DATABASE_PARAMS_FIELD_ADDITIONAL_ARGUMENTS;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= COMPILATION_DATABASE_PARAMS_FIELD_ADDITIONAL_ARGUMENTS;
     }
 
-
-    if ((retval.valid_fields & COMPILATION_DATABASE_PARAMS_FIELD_REQUIRED) != COMPILATION_DATABASE_PARAMS_FIELD_REQUIRED)
+    if ((p_value->valid_fields & COMPILATION_DATABASE_PARAMS_FIELD_REQUIRED) != COMPILATION_DATABASE_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for compilation_database_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, COMPILATION_DATABASE_PARAMS_FIELD_REQUIRED);
+        LOG("Missing required parameters for compilation_database_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, COMPILATION_DATABASE_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-initialization_options_t decode_initialization_options(json_t * p_json)
+bool read_initialization_options(json_reader_t * p_reader, initialization_options_t * p_value)
 {
-    initialization_options_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_flags_json = json_object_get(p_json, "flags");
-    if (json_is_array(p_flags_json))
-    {
-        retval.flags_count = json_array_size(p_flags_json);
-        retval.p_flags = malloc(sizeof(char  *) * retval.flags_count);
-        ASSERT(retval.p_flags);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_flags_json, index, p_it)
-        {
-            retval.p_flags[index] = decode_string(p_it);
-        }
-        retval.valid_fields |= INITIALIZATION_OPTIONS_FIELD_FLAGS;
-    }
+    memset(p_value, 0, sizeof(initialization_options_t));
 
-    json_t * p_compilation_database_json = json_object_get(p_json, "compilationDatabase");
-    if (json_is_array(p_compilation_database_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.compilation_database_count = json_array_size(p_compilation_database_json);
-        retval.p_compilation_database = malloc(sizeof(compilation_database_params_t) * retval.compilation_database_count);
-        ASSERT(retval.p_compilation_database);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_compilation_database_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_compilation_database[index] = decode_compilation_database_params(p_it);
+            if (strcmp(p_key, "flags") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_flags = read_array_reserve(p_value->p_flags, p_value->flags_count, sizeof(p_value->p_flags[0]));
+                        if (read_string(p_reader, &p_value->p_flags[p_value->flags_count]))
+                        {
+                            p_value->flags_count++;
+                        }
+                    }
+                    p_value->valid_fields |= INITIALIZATION_OPTIONS_FIELD_FLAGS;
+                }
+            }
+            else if (strcmp(p_key, "compilationDatabase") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_compilation_database = read_array_reserve(p_value->p_compilation_database, p_value->compilation_database_count, sizeof(p_value->p_compilation_database[0]));
+                        if (read_compilation_database_params(p_reader, &p_value->p_compilation_database[p_value->compilation_database_count]))
+                        {
+                            p_value->compilation_database_count++;
+                        }
+                    }
+                    p_value->valid_fields |= INITIALIZATION_OPTIONS_FIELD_COMPILATION_DATABASE;
+                }
+            }
+            else if (strcmp(p_key, "workerThreads") == 0)
+            {
+                if (read_number(p_reader, &p_value->worker_threads))
+                {
+                    p_value->valid_fields |= INITIALIZATION_OPTIONS_FIELD_WORKER_THREADS;
+                }
+            }
+            else if (strcmp(p_key, "memoryBudget") == 0)
+            {
+                if (read_number(p_reader, &p_value->memory_budget))
+                {
+                    p_value->valid_fields |= INITIALIZATION_OPTIONS_FIELD_MEMORY_BUDGET;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= INITIALIZATION_OPTIONS_FIELD_COMPILATION_DATABASE;
     }
 
-
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-workspace_client_capabilities_t decode_workspace_client_capabilities(json_t * p_json)
+bool read_workspace_client_capabilities(json_reader_t * p_reader, workspace_client_capabilities_t * p_value)
 {
-    workspace_client_capabilities_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(workspace_client_capabilities_t));
 
-    json_t * p_apply_edit_json = json_object_get(p_json, "applyEdit");
-    if (json_is_boolean(p_apply_edit_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.apply_edit = decode_boolean(p_apply_edit_json);
-        retval.valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_APPLY_EDIT;
-    }
-
-    json_t * p_workspace_edit_json = json_object_get(p_json, "workspaceEdit");
-    if (json_is_object(p_workspace_edit_json))
-    {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.workspace_edit.dynamic_registration = decode_boolean(p_dynamic_registration_json);
+            if (strcmp(p_key, "applyEdit") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->apply_edit))
+                {
+                    p_value->valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_APPLY_EDIT;
+                }
+            }
+            else if (strcmp(p_key, "workspaceEdit") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->workspace_edit.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_WORKSPACE_EDIT;
+                }
+            }
+            else if (strcmp(p_key, "didChangeConfiguration") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->did_change_configuration.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_DID_CHANGE_CONFIGURATION;
+                }
+            }
+            else if (strcmp(p_key, "didChangeWatchedFiles") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->did_change_watched_files.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_DID_CHANGE_WATCHED_FILES;
+                }
+            }
+            else if (strcmp(p_key, "symbol") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->symbol.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_SYMBOL;
+                }
+            }
+            else if (strcmp(p_key, "executeCommand") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->execute_command.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_EXECUTE_COMMAND;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-
-        retval.valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_WORKSPACE_EDIT;
     }
 
-    json_t * p_did_change_configuration_json = json_object_get(p_json, "didChangeConfiguration");
-    if (json_is_object(p_did_change_configuration_json))
-    {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.did_change_configuration.dynamic_registration = decode_boolean(p_dynamic_registration_json);
-        }
+    return !json_reader_error(p_reader);
+}
 
-        retval.valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_DID_CHANGE_CONFIGURATION;
-    }
+bool read_text_document_client_capabilities(json_reader_t * p_reader, text_document_client_capabilities_t * p_value)
+{
+    memset(p_value, 0, sizeof(text_document_client_capabilities_t));
 
-    json_t * p_did_change_watched_files_json = json_object_get(p_json, "didChangeWatchedFiles");
-    if (json_is_object(p_did_change_watched_files_json))
+    if (json_reader_object_start(p_reader))
     {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.did_change_watched_files.dynamic_registration = decode_boolean(p_dynamic_registration_json);
+            if (strcmp(p_key, "synchronization") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->synchronization.dynamic_registration);
+                        }
+                        else if (strcmp(p_key, "willSave") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->synchronization.will_save);
+                        }
+                        else if (strcmp(p_key, "willSaveWaitUntil") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->synchronization.will_save_wait_until);
+                        }
+                        else if (strcmp(p_key, "didSave") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->synchronization.did_save);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_SYNCHRONIZATION;
+                }
+            }
+            else if (strcmp(p_key, "completion") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "snippetSupport") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->completion.snippet_support);
+                        }
+                        else if (strcmp(p_key, "commitCharactersSupport") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->completion.commit_characters_support);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_COMPLETION;
+                }
+            }
+            else if (strcmp(p_key, "hover") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->hover.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_HOVER;
+                }
+            }
+            else if (strcmp(p_key, "signatureHelp") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->signature_help.dynamic_registration);
+                        }
+                        else if (strcmp(p_key, "signatureInformation") == 0)
+                        {
+                            if (json_reader_object_start(p_reader))
+                            {
+                                while (json_reader_object_next(p_reader, &p_key))
+                                {
+                                    if (strcmp(p_key, "documentationFormat") == 0)
+                                    {
+                                        if (json_reader_array_start(p_reader))
+                                        {
+                                            while (json_reader_array_next(p_reader))
+                                            {
+                                                p_value->signature_help.signature_information.p_documentation_format = read_array_reserve(p_value->signature_help.signature_information.p_documentation_format, p_value->signature_help.signature_information.documentation_format_count, sizeof(p_value->signature_help.signature_information.p_documentation_format[0]));
+                                                if (read_string(p_reader, &p_value->signature_help.signature_information.p_documentation_format[p_value->signature_help.signature_information.documentation_format_count]))
+                                                {
+                                                    p_value->signature_help.signature_information.documentation_format_count++;
+                                                }
+                                            }
+                                        }
+                                    }
+                                    else
+                                    {
+                                        json_reader_skip(p_reader);
+                                    }
+                                }
+                            }
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_SIGNATURE_HELP;
+                }
+            }
+            else if (strcmp(p_key, "references") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->references.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_REFERENCES;
+                }
+            }
+            else if (strcmp(p_key, "documentHighlight") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->document_highlight.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DOCUMENT_HIGHLIGHT;
+                }
+            }
+            else if (strcmp(p_key, "documentSymbol") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->document_symbol.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DOCUMENT_SYMBOL;
+                }
+            }
+            else if (strcmp(p_key, "formatting") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->formatting.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_FORMATTING;
+                }
+            }
+            else if (strcmp(p_key, "onTypeFormatting") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->on_type_formatting.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_ON_TYPE_FORMATTING;
+                }
+            }
+            else if (strcmp(p_key, "definition") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->definition.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DEFINITION;
+                }
+            }
+            else if (strcmp(p_key, "codeAction") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->code_action.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_CODE_ACTION;
+                }
+            }
+            else if (strcmp(p_key, "codeLens") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->code_lens.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_CODE_LENS;
+                }
+            }
+            else if (strcmp(p_key, "documentLink") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->document_link.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DOCUMENT_LINK;
+                }
+            }
+            else if (strcmp(p_key, "rename") == 0)
+            {
+                if (json_reader_object_start(p_reader))
+                {
+                    while (json_reader_object_next(p_reader, &p_key))
+                    {
+                        if (strcmp(p_key, "dynamicRegistration") == 0)
+                        {
+                            read_boolean(p_reader, &p_value->rename.dynamic_registration);
+                        }
+                        else
+                        {
+                            json_reader_skip(p_reader);
+                        }
+                    }
+                    p_value->valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_RENAME;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-
-        retval.valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_DID_CHANGE_WATCHED_FILES;
     }
 
-    json_t * p_symbol_json = json_object_get(p_json, "symbol");
-    if (json_is_object(p_symbol_json))
-    {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.symbol.dynamic_registration = decode_boolean(p_dynamic_registration_json);
-        }
+    return !json_reader_error(p_reader);
+}
 
-        retval.valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_SYMBOL;
-    }
+bool read_client_capabilities(json_reader_t * p_reader, client_capabilities_t * p_value)
+{
+    memset(p_value, 0, sizeof(client_capabilities_t));
 
-    json_t * p_execute_command_json = json_object_get(p_json, "executeCommand");
-    if (json_is_object(p_execute_command_json))
+    if (json_reader_object_start(p_reader))
     {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.execute_command.dynamic_registration = decode_boolean(p_dynamic_registration_json);
+            if (strcmp(p_key, "workspace") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_workspace_client_capabilities(p_reader, &p_value->workspace))
+                {
+                    p_value->valid_fields |= CLIENT_CAPABILITIES_FIELD_WORKSPACE;
+                }
+            }
+            else if (strcmp(p_key, "textDocument") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_document_client_capabilities(p_reader, &p_value->text_document))
+                {
+                    p_value->valid_fields |= CLIENT_CAPABILITIES_FIELD_TEXT_DOCUMENT;
+                }
+            }
+            else if (strcmp(p_key, "experimental") == 0)
+            {
+                p_value->experimental = json_reader_json(p_reader);
+                if (p_value->experimental)
+                {
+                    p_value->valid_fields |= CLIENT_CAPABILITIES_FIELD_EXPERIMENTAL;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-
-        retval.valid_fields |= WORKSPACE_CLIENT_CAPABILITIES_FIELD_EXECUTE_COMMAND;
     }
 
-
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-text_document_client_capabilities_t decode_text_document_client_capabilities(json_t * p_json)
+bool read_completion_options(json_reader_t * p_reader, completion_options_t * p_value)
 {
-    text_document_client_capabilities_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(completion_options_t));
 
-    json_t * p_synchronization_json = json_object_get(p_json, "synchronization");
-    if (json_is_object(p_synchronization_json))
+    if (json_reader_object_start(p_reader))
     {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.synchronization.dynamic_registration = decode_boolean(p_dynamic_registration_json);
-        }
-
-        json_t * p_will_save_json = json_object_get(p_json, "willSave");
-        if (json_is_boolean(p_will_save_json))
-        {
-            retval.synchronization.will_save = decode_boolean(p_will_save_json);
-        }
-
-        json_t * p_will_save_wait_until_json = json_object_get(p_json, "willSaveWaitUntil");
-        if (json_is_boolean(p_will_save_wait_until_json))
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.synchronization.will_save_wait_until = decode_boolean(p_will_save_wait_until_json);
+            if (strcmp(p_key, "resolveProvider") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->resolve_provider))
+                {
+                    p_value->valid_fields |= COMPLETION_OPTIONS_FIELD_RESOLVE_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "triggerCharacters") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_trigger_characters = read_array_reserve(p_value->p_trigger_characters, p_value->trigger_characters_count, sizeof(p_value->p_trigger_characters[0]));
+                        if (read_string(p_reader, &p_value->p_trigger_characters[p_value->trigger_characters_count]))
+                        {
+                            p_value->trigger_characters_count++;
+                        }
+                    }
+                    p_value->valid_fields |= COMPLETION_OPTIONS_FIELD_TRIGGER_CHARACTERS;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
+    }
 
-        json_t * p_did_save_json = json_object_get(p_json, "didSave");
-        if (json_is_boolean(p_did_save_json))
-        {
-            retval.synchronization.did_save = decode_boolean(p_did_save_json);
-        }
+    return !json_reader_error(p_reader);
+}
 
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_SYNCHRONIZATION;
-    }
+bool read_signature_help_options(json_reader_t * p_reader, signature_help_options_t * p_value)
+{
+    memset(p_value, 0, sizeof(signature_help_options_t));
 
-    json_t * p_completion_json = json_object_get(p_json, "completion");
-    if (json_is_object(p_completion_json))
+    if (json_reader_object_start(p_reader))
     {
-        json_t * p_snippet_support_json = json_object_get(p_json, "snippetSupport");
-        if (json_is_boolean(p_snippet_support_json))
-        {
-            retval.completion.snippet_support = decode_boolean(p_snippet_support_json);
-        }
-
-        json_t * p_commit_characters_support_json = json_object_get(p_json, "commitCharactersSupport");
-        if (json_is_boolean(p_commit_characters_support_json))
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.completion.commit_characters_support = decode_boolean(p_commit_characters_support_json);
+            if (strcmp(p_key, "triggerCharacters") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_trigger_characters = read_array_reserve(p_value->p_trigger_characters, p_value->trigger_characters_count, sizeof(p_value->p_trigger_characters[0]));
+                        if (read_string(p_reader, &p_value->p_trigger_characters[p_value->trigger_characters_count]))
+                        {
+                            p_value->trigger_characters_count++;
+                        }
+                    }
+                    p_value->valid_fields |= SIGNATURE_HELP_OPTIONS_FIELD_TRIGGER_CHARACTERS;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_COMPLETION;
     }
 
-    json_t * p_hover_json = json_object_get(p_json, "hover");
-    if (json_is_object(p_hover_json))
-    {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.hover.dynamic_registration = decode_boolean(p_dynamic_registration_json);
-        }
+    return !json_reader_error(p_reader);
+}
 
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_HOVER;
-    }
+bool read_code_lens_options(json_reader_t * p_reader, code_lens_options_t * p_value)
+{
+    memset(p_value, 0, sizeof(code_lens_options_t));
 
-    json_t * p_signature_help_json = json_object_get(p_json, "signatureHelp");
-    if (json_is_object(p_signature_help_json))
+    if (json_reader_object_start(p_reader))
     {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.signature_help.dynamic_registration = decode_boolean(p_dynamic_registration_json);
-        }
-
-        json_t * p_signature_information_json = json_object_get(p_json, "signatureInformation");
-        if (json_is_object(p_signature_information_json))
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            json_t * p_documentation_format_json = json_object_get(p_json, "documentationFormat");
-            if (json_is_array(p_documentation_format_json))
+            if (strcmp(p_key, "resolveProvider") == 0)
             {
-                retval.signature_help.signature_information.documentation_format_count = json_array_size(p_documentation_format_json);
-                retval.signature_help.signature_information.p_documentation_format = malloc(sizeof(char  *) * retval.signature_help.signature_information.documentation_format_count);
-                ASSERT(retval.signature_help.signature_information.p_documentation_format);
-                json_t * p_it;
-                uint32_t index;
-                json_array_foreach(p_documentation_format_json, index, p_it)
+                if (read_boolean(p_reader, &p_value->resolve_provider))
                 {
-                    retval.signature_help.signature_information.p_documentation_format[index] = decode_string(p_it);
+                    p_value->valid_fields |= CODE_LENS_OPTIONS_FIELD_RESOLVE_PROVIDER;
                 }
             }
-
-        }
-
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_SIGNATURE_HELP;
-    }
-
-    json_t * p_references_json = json_object_get(p_json, "references");
-    if (json_is_object(p_references_json))
-    {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.references.dynamic_registration = decode_boolean(p_dynamic_registration_json);
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_REFERENCES;
     }
 
-    json_t * p_document_highlight_json = json_object_get(p_json, "documentHighlight");
-    if (json_is_object(p_document_highlight_json))
-    {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.document_highlight.dynamic_registration = decode_boolean(p_dynamic_registration_json);
-        }
+    return !json_reader_error(p_reader);
+}
 
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DOCUMENT_HIGHLIGHT;
-    }
+bool read_save_options(json_reader_t * p_reader, save_options_t * p_value)
+{
+    memset(p_value, 0, sizeof(save_options_t));
 
-    json_t * p_document_symbol_json = json_object_get(p_json, "documentSymbol");
-    if (json_is_object(p_document_symbol_json))
+    if (json_reader_object_start(p_reader))
     {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.document_symbol.dynamic_registration = decode_boolean(p_dynamic_registration_json);
+            if (strcmp(p_key, "includeText") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->include_text))
+                {
+                    p_value->valid_fields |= SAVE_OPTIONS_FIELD_INCLUDE_TEXT;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DOCUMENT_SYMBOL;
     }
 
-    json_t * p_formatting_json = json_object_get(p_json, "formatting");
-    if (json_is_object(p_formatting_json))
-    {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.formatting.dynamic_registration = decode_boolean(p_dynamic_registration_json);
-        }
+    return !json_reader_error(p_reader);
+}
 
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_FORMATTING;
-    }
+bool read_text_document_sync_options(json_reader_t * p_reader, text_document_sync_options_t * p_value)
+{
+    memset(p_value, 0, sizeof(text_document_sync_options_t));
 
-    json_t * p_on_type_formatting_json = json_object_get(p_json, "onTypeFormatting");
-    if (json_is_object(p_on_type_formatting_json))
+    if (json_reader_object_start(p_reader))
     {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.on_type_formatting.dynamic_registration = decode_boolean(p_dynamic_registration_json);
+            if (strcmp(p_key, "openClose") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->open_close))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_OPEN_CLOSE;
+                }
+            }
+            else if (strcmp(p_key, "change") == 0)
+            {
+                if (read_text_document_sync_kind(p_reader, &p_value->change))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_CHANGE;
+                }
+            }
+            else if (strcmp(p_key, "willSave") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->will_save))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_WILL_SAVE;
+                }
+            }
+            else if (strcmp(p_key, "willSaveWaitUntil") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->will_save_wait_until))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_WILL_SAVE_WAIT_UNTIL;
+                }
+            }
+            else if (strcmp(p_key, "save") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_save_options(p_reader, &p_value->save))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_SAVE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_ON_TYPE_FORMATTING;
     }
 
-    json_t * p_definition_json = json_object_get(p_json, "definition");
-    if (json_is_object(p_definition_json))
-    {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.definition.dynamic_registration = decode_boolean(p_dynamic_registration_json);
-        }
+    return !json_reader_error(p_reader);
+}
 
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DEFINITION;
-    }
+bool read_server_capabilities(json_reader_t * p_reader, server_capabilities_t * p_value)
+{
+    memset(p_value, 0, sizeof(server_capabilities_t));
 
-    json_t * p_code_action_json = json_object_get(p_json, "codeAction");
-    if (json_is_object(p_code_action_json))
+    if (json_reader_object_start(p_reader))
     {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.code_action.dynamic_registration = decode_boolean(p_dynamic_registration_json);
+            if (strcmp(p_key, "textDocumentSync") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_document_sync_options(p_reader, &p_value->text_document_sync))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_TEXT_DOCUMENT_SYNC;
+                }
+            }
+            else if (strcmp(p_key, "hoverProvider") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->hover_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_HOVER_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "completionProvider") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_completion_options(p_reader, &p_value->completion_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_COMPLETION_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "signatureHelpProvider") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_signature_help_options(p_reader, &p_value->signature_help_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_SIGNATURE_HELP_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "definitionProvider") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->definition_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_DEFINITION_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "referencesProvider") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->references_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_REFERENCES_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "documentHighlightProvider") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->document_highlight_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_DOCUMENT_HIGHLIGHT_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "documentSymbolProvider") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->document_symbol_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_DOCUMENT_SYMBOL_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "workspaceSymbolProvider") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->workspace_symbol_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_WORKSPACE_SYMBOL_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "codeActionProvider") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->code_action_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_CODE_ACTION_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "codeLensProvider") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_code_lens_options(p_reader, &p_value->code_lens_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_CODE_LENS_PROVIDER;
+                }
+            }
+            else if (strcmp(p_key, "documentFormattingProvider") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->document_formatting_provider))
+                {
+                    p_value->valid_fields |= SERVER_CAPABILITIES_FIELD_DOCUMENT_FORMATTING_PROVIDER;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_CODE_ACTION;
     }
 
-    json_t * p_code_lens_json = json_object_get(p_json, "codeLens");
-    if (json_is_object(p_code_lens_json))
-    {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.code_lens.dynamic_registration = decode_boolean(p_dynamic_registration_json);
-        }
+    return !json_reader_error(p_reader);
+}
 
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_CODE_LENS;
-    }
+bool read_markup_content(json_reader_t * p_reader, markup_content_t * p_value)
+{
+    memset(p_value, 0, sizeof(markup_content_t));
 
-    json_t * p_document_link_json = json_object_get(p_json, "documentLink");
-    if (json_is_object(p_document_link_json))
+    if (json_reader_object_start(p_reader))
     {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.document_link.dynamic_registration = decode_boolean(p_dynamic_registration_json);
+            if (strcmp(p_key, "kind") == 0)
+            {
+                if (read_string(p_reader, &p_value->kind))
+                {
+                    p_value->valid_fields |= MARKUP_CONTENT_FIELD_KIND;
+                }
+            }
+            else if (strcmp(p_key, "value") == 0)
+            {
+                if (read_string(p_reader, &p_value->value))
+                {
+                    p_value->valid_fields |= MARKUP_CONTENT_FIELD_VALUE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DOCUMENT_LINK;
     }
 
-    json_t * p_rename_json = json_object_get(p_json, "rename");
-    if (json_is_object(p_rename_json))
+    if ((p_value->valid_fields & MARKUP_CONTENT_FIELD_REQUIRED) != MARKUP_CONTENT_FIELD_REQUIRED)
     {
-        json_t * p_dynamic_registration_json = json_object_get(p_json, "dynamicRegistration");
-        if (json_is_boolean(p_dynamic_registration_json))
-        {
-            retval.rename.dynamic_registration = decode_boolean(p_dynamic_registration_json);
-        }
-
-        retval.valid_fields |= TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_RENAME;
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for markup_content: Got 0x%x, expected 0x%x\n", p_value->valid_fields, MARKUP_CONTENT_FIELD_REQUIRED);
     }
-
-
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-client_capabilities_t decode_client_capabilities(json_t * p_json)
+bool read_marked_string(json_reader_t * p_reader, marked_string_t * p_value)
 {
-    client_capabilities_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_workspace_json = json_object_get(p_json, "workspace");
-    if (json_is_object(p_workspace_json))
-    {
-        retval.workspace = decode_workspace_client_capabilities(p_workspace_json);
-        retval.valid_fields |= CLIENT_CAPABILITIES_FIELD_WORKSPACE;
-    }
+    memset(p_value, 0, sizeof(marked_string_t));
 
-    json_t * p_text_document_json = json_object_get(p_json, "textDocument");
-    if (json_is_object(p_text_document_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.text_document = decode_text_document_client_capabilities(p_text_document_json);
-        retval.valid_fields |= CLIENT_CAPABILITIES_FIELD_TEXT_DOCUMENT;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "language") == 0)
+            {
+                if (read_string(p_reader, &p_value->language))
+                {
+                    p_value->valid_fields |= MARKED_STRING_FIELD_LANGUAGE;
+                }
+            }
+            else if (strcmp(p_key, "value") == 0)
+            {
+                if (read_string(p_reader, &p_value->value))
+                {
+                    p_value->valid_fields |= MARKED_STRING_FIELD_VALUE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-    json_t * p_experimental_json = json_object_get(p_json, "experimental");
-    if (p_experimental_json != NULL)
+    if ((p_value->valid_fields & MARKED_STRING_FIELD_REQUIRED) != MARKED_STRING_FIELD_REQUIRED)
     {
-        retval.experimental = json_deep_copy(p_experimental_json);
-        retval.valid_fields |= CLIENT_CAPABILITIES_FIELD_EXPERIMENTAL;
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for marked_string: Got 0x%x, expected 0x%x\n", p_value->valid_fields, MARKED_STRING_FIELD_REQUIRED);
     }
-
-
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-completion_options_t decode_completion_options(json_t * p_json)
+bool read_message_action_item(json_reader_t * p_reader, message_action_item_t * p_value)
 {
-    completion_options_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_resolve_provider_json = json_object_get(p_json, "resolveProvider");
-    if (json_is_boolean(p_resolve_provider_json))
-    {
-        retval.resolve_provider = decode_boolean(p_resolve_provider_json);
-        retval.valid_fields |= COMPLETION_OPTIONS_FIELD_RESOLVE_PROVIDER;
-    }
+    memset(p_value, 0, sizeof(message_action_item_t));
 
-    json_t * p_trigger_characters_json = json_object_get(p_json, "triggerCharacters");
-    if (json_is_array(p_trigger_characters_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.trigger_characters_count = json_array_size(p_trigger_characters_json);
-        retval.p_trigger_characters = malloc(sizeof(char  *) * retval.trigger_characters_count);
-        ASSERT(retval.p_trigger_characters);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_trigger_characters_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_trigger_characters[index] = decode_string(p_it);
+            if (strcmp(p_key, "title") == 0)
+            {
+                if (read_string(p_reader, &p_value->title))
+                {
+                    p_value->valid_fields |= MESSAGE_ACTION_ITEM_FIELD_TITLE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= COMPLETION_OPTIONS_FIELD_TRIGGER_CHARACTERS;
     }
 
-
-    return retval;
+    if ((p_value->valid_fields & MESSAGE_ACTION_ITEM_FIELD_REQUIRED) != MESSAGE_ACTION_ITEM_FIELD_REQUIRED)
+    {
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for message_action_item: Got 0x%x, expected 0x%x\n", p_value->valid_fields, MESSAGE_ACTION_ITEM_FIELD_REQUIRED);
+    }
+    return !json_reader_error(p_reader);
 }
 
-signature_help_options_t decode_signature_help_options(json_t * p_json)
+bool read_position(json_reader_t * p_reader, position_t * p_value)
 {
-    signature_help_options_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(position_t));
 
-    json_t * p_trigger_characters_json = json_object_get(p_json, "triggerCharacters");
-    if (json_is_array(p_trigger_characters_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.trigger_characters_count = json_array_size(p_trigger_characters_json);
-        retval.p_trigger_characters = malloc(sizeof(char  *) * retval.trigger_characters_count);
-        ASSERT(retval.p_trigger_characters);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_trigger_characters_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_trigger_characters[index] = decode_string(p_it);
+            if (strcmp(p_key, "line") == 0)
+            {
+                if (read_number(p_reader, &p_value->line))
+                {
+                    p_value->valid_fields |= POSITION_FIELD_LINE;
+                }
+            }
+            else if (strcmp(p_key, "character") == 0)
+            {
+                if (read_number(p_reader, &p_value->character))
+                {
+                    p_value->valid_fields |= POSITION_FIELD_CHARACTER;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= SIGNATURE_HELP_OPTIONS_FIELD_TRIGGER_CHARACTERS;
     }
 
-
-    return retval;
-}
-
-code_lens_options_t decode_code_lens_options(json_t * p_json)
-{
-    code_lens_options_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_resolve_provider_json = json_object_get(p_json, "resolveProvider");
-    if (json_is_boolean(p_resolve_provider_json))
+    if ((p_value->valid_fields & POSITION_FIELD_REQUIRED) != POSITION_FIELD_REQUIRED)
     {
-        retval.resolve_provider = decode_boolean(p_resolve_provider_json);
-        retval.valid_fields |= CODE_LENS_OPTIONS_FIELD_RESOLVE_PROVIDER;
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for position: Got 0x%x, expected 0x%x\n", p_value->valid_fields, POSITION_FIELD_REQUIRED);
     }
-
-
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-save_options_t decode_save_options(json_t * p_json)
+bool read_range(json_reader_t * p_reader, range_t * p_value)
 {
-    save_options_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(range_t));
 
-    json_t * p_include_text_json = json_object_get(p_json, "includeText");
-    if (json_is_boolean(p_include_text_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.include_text = decode_boolean(p_include_text_json);
-        retval.valid_fields |= SAVE_OPTIONS_FIELD_INCLUDE_TEXT;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "start") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_position(p_reader, &p_value->start))
+                {
+                    p_value->valid_fields |= RANGE_FIELD_START;
+                }
+            }
+            else if (strcmp(p_key, "end") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_position(p_reader, &p_value->end))
+                {
+                    p_value->valid_fields |= RANGE_FIELD_END;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    return retval;
+    if ((p_value->valid_fields & RANGE_FIELD_REQUIRED) != RANGE_FIELD_REQUIRED)
+    {
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for range: Got 0x%x, expected 0x%x\n", p_value->valid_fields, RANGE_FIELD_REQUIRED);
+    }
+    return !json_reader_error(p_reader);
 }
 
-text_document_sync_options_t decode_text_document_sync_options(json_t * p_json)
+bool read_text_edit(json_reader_t * p_reader, text_edit_t * p_value)
 {
-    text_document_sync_options_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(text_edit_t));
 
-    json_t * p_open_close_json = json_object_get(p_json, "openClose");
-    if (json_is_boolean(p_open_close_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.open_close = decode_boolean(p_open_close_json);
-        retval.valid_fields |= TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_OPEN_CLOSE;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "range") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_range(p_reader, &p_value->range))
+                {
+                    p_value->valid_fields |= TEXT_EDIT_FIELD_RANGE;
+                }
+            }
+            else if (strcmp(p_key, "newText") == 0)
+            {
+                if (read_string(p_reader, &p_value->new_text))
+                {
+                    p_value->valid_fields |= TEXT_EDIT_FIELD_NEW_TEXT;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-    json_t * p_change_json = json_object_get(p_json, "change");
-    if (json_is_object(p_change_json))
+    if ((p_value->valid_fields & TEXT_EDIT_FIELD_REQUIRED) != TEXT_EDIT_FIELD_REQUIRED)
     {
-        retval.change = decode_text_document_sync_kind(p_change_json);
-        retval.valid_fields |= TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_CHANGE;
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for text_edit: Got 0x%x, expected 0x%x\n", p_value->valid_fields, TEXT_EDIT_FIELD_REQUIRED);
     }
+    return !json_reader_error(p_reader);
+}
 
-    json_t * p_will_save_json = json_object_get(p_json, "willSave");
-    if (json_is_boolean(p_will_save_json))
-    {
-        retval.will_save = decode_boolean(p_will_save_json);
-        retval.valid_fields |= TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_WILL_SAVE;
-    }
+bool read_location(json_reader_t * p_reader, location_t * p_value)
+{
+    memset(p_value, 0, sizeof(location_t));
 
-    json_t * p_will_save_wait_until_json = json_object_get(p_json, "willSaveWaitUntil");
-    if (json_is_boolean(p_will_save_wait_until_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.will_save_wait_until = decode_boolean(p_will_save_wait_until_json);
-        retval.valid_fields |= TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_WILL_SAVE_WAIT_UNTIL;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "uri") == 0)
+            {
+                if (read_uri(p_reader, &p_value->uri))
+                {
+                    p_value->valid_fields |= LOCATION_FIELD_URI;
+                }
+            }
+            else if (strcmp(p_key, "range") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_range(p_reader, &p_value->range))
+                {
+                    p_value->valid_fields |= LOCATION_FIELD_RANGE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-    json_t * p_save_json = json_object_get(p_json, "save");
-    if (json_is_object(p_save_json))
+    if ((p_value->valid_fields & LOCATION_FIELD_REQUIRED) != LOCATION_FIELD_REQUIRED)
     {
-        retval.save = decode_save_options(p_save_json);
-        retval.valid_fields |= TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_SAVE;
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for location: Got 0x%x, expected 0x%x\n", p_value->valid_fields, LOCATION_FIELD_REQUIRED);
     }
-
-
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-server_capabilities_t decode_server_capabilities(json_t * p_json)
+bool read_diagnostic_related_information(json_reader_t * p_reader, diagnostic_related_information_t * p_value)
 {
-    server_capabilities_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(diagnostic_related_information_t));
 
-    json_t * p_text_document_sync_json = json_object_get(p_json, "textDocumentSync");
-    if (json_is_object(p_text_document_sync_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.text_document_sync = decode_text_document_sync_options(p_text_document_sync_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_TEXT_DOCUMENT_SYNC;
-    }
-
-    json_t * p_hover_provider_json = json_object_get(p_json, "hoverProvider");
-    if (json_is_boolean(p_hover_provider_json))
-    {
-        retval.hover_provider = decode_boolean(p_hover_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_HOVER_PROVIDER;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "location") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_location(p_reader, &p_value->location))
+                {
+                    p_value->valid_fields |= DIAGNOSTIC_RELATED_INFORMATION_FIELD_LOCATION;
+                }
+            }
+            else if (strcmp(p_key, "message") == 0)
+            {
+                if (read_string(p_reader, &p_value->message))
+                {
+                    p_value->valid_fields |= DIAGNOSTIC_RELATED_INFORMATION_FIELD_MESSAGE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-    json_t * p_completion_provider_json = json_object_get(p_json, "completionProvider");
-    if (json_is_object(p_completion_provider_json))
+    if ((p_value->valid_fields & DIAGNOSTIC_RELATED_INFORMATION_FIELD_REQUIRED) != DIAGNOSTIC_RELATED_INFORMATION_FIELD_REQUIRED)
     {
-        retval.completion_provider = decode_completion_options(p_completion_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_COMPLETION_PROVIDER;
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for diagnostic_related_information: Got 0x%x, expected 0x%x\n", p_value->valid_fields, DIAGNOSTIC_RELATED_INFORMATION_FIELD_REQUIRED);
     }
+    return !json_reader_error(p_reader);
+}
 
-    json_t * p_signature_help_provider_json = json_object_get(p_json, "signatureHelpProvider");
-    if (json_is_object(p_signature_help_provider_json))
-    {
-        retval.signature_help_provider = decode_signature_help_options(p_signature_help_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_SIGNATURE_HELP_PROVIDER;
-    }
+bool read_diagnostic(json_reader_t * p_reader, diagnostic_t * p_value)
+{
+    memset(p_value, 0, sizeof(diagnostic_t));
 
-    json_t * p_definition_provider_json = json_object_get(p_json, "definitionProvider");
-    if (json_is_boolean(p_definition_provider_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.definition_provider = decode_boolean(p_definition_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_DEFINITION_PROVIDER;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "range") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_range(p_reader, &p_value->range))
+                {
+                    p_value->valid_fields |= DIAGNOSTIC_FIELD_RANGE;
+                }
+            }
+            else if (strcmp(p_key, "severity") == 0)
+            {
+                if (read_diagnostic_severity(p_reader, &p_value->severity))
+                {
+                    p_value->valid_fields |= DIAGNOSTIC_FIELD_SEVERITY;
+                }
+            }
+            else if (strcmp(p_key, "code") == 0)
+            {
+                if (read_number(p_reader, &p_value->code))
+                {
+                    p_value->valid_fields |= DIAGNOSTIC_FIELD_CODE;
+                }
+            }
+            else if (strcmp(p_key, "source") == 0)
+            {
+                if (read_string(p_reader, &p_value->source))
+                {
+                    p_value->valid_fields |= DIAGNOSTIC_FIELD_SOURCE;
+                }
+            }
+            else if (strcmp(p_key, "message") == 0)
+            {
+                if (read_string(p_reader, &p_value->message))
+                {
+                    p_value->valid_fields |= DIAGNOSTIC_FIELD_MESSAGE;
+                }
+            }
+            else if (strcmp(p_key, "relatedInformation") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_related_information = read_array_reserve(p_value->p_related_information, p_value->related_information_count, sizeof(p_value->p_related_information[0]));
+                        if (read_diagnostic_related_information(p_reader, &p_value->p_related_information[p_value->related_information_count]))
+                        {
+                            p_value->related_information_count++;
+                        }
+                    }
+                    p_value->valid_fields |= DIAGNOSTIC_FIELD_RELATED_INFORMATION;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-    json_t * p_references_provider_json = json_object_get(p_json, "referencesProvider");
-    if (json_is_boolean(p_references_provider_json))
+    if ((p_value->valid_fields & DIAGNOSTIC_FIELD_REQUIRED) != DIAGNOSTIC_FIELD_REQUIRED)
     {
-        retval.references_provider = decode_boolean(p_references_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_REFERENCES_PROVIDER;
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for diagnostic: Got 0x%x, expected 0x%x\n", p_value->valid_fields, DIAGNOSTIC_FIELD_REQUIRED);
     }
+    return !json_reader_error(p_reader);
+}
 
-    json_t * p_document_highlight_provider_json = json_object_get(p_json, "documentHighlightProvider");
-    if (json_is_boolean(p_document_highlight_provider_json))
-    {
-        retval.document_highlight_provider = decode_boolean(p_document_highlight_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_DOCUMENT_HIGHLIGHT_PROVIDER;
-    }
+bool read_text_document_item(json_reader_t * p_reader, text_document_item_t * p_value)
+{
+    memset(p_value, 0, sizeof(text_document_item_t));
 
-    json_t * p_document_symbol_provider_json = json_object_get(p_json, "documentSymbolProvider");
-    if (json_is_boolean(p_document_symbol_provider_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.document_symbol_provider = decode_boolean(p_document_symbol_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_DOCUMENT_SYMBOL_PROVIDER;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "uri") == 0)
+            {
+                if (read_uri(p_reader, &p_value->uri))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_ITEM_FIELD_URI;
+                }
+            }
+            else if (strcmp(p_key, "languageId") == 0)
+            {
+                if (read_string(p_reader, &p_value->language_id))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_ITEM_FIELD_LANGUAGE_ID;
+                }
+            }
+            else if (strcmp(p_key, "version") == 0)
+            {
+                if (read_number(p_reader, &p_value->version))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_ITEM_FIELD_VERSION;
+                }
+            }
+            else if (strcmp(p_key, "text") == 0)
+            {
+                if (read_string(p_reader, &p_value->text))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_ITEM_FIELD_TEXT;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-    json_t * p_workspace_symbol_provider_json = json_object_get(p_json, "workspaceSymbolProvider");
-    if (json_is_boolean(p_workspace_symbol_provider_json))
+    if ((p_value->valid_fields & TEXT_DOCUMENT_ITEM_FIELD_REQUIRED) != TEXT_DOCUMENT_ITEM_FIELD_REQUIRED)
     {
-        retval.workspace_symbol_provider = decode_boolean(p_workspace_symbol_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_WORKSPACE_SYMBOL_PROVIDER;
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for text_document_item: Got 0x%x, expected 0x%x\n", p_value->valid_fields, TEXT_DOCUMENT_ITEM_FIELD_REQUIRED);
     }
+    return !json_reader_error(p_reader);
+}
 
-    json_t * p_code_action_provider_json = json_object_get(p_json, "codeActionProvider");
-    if (json_is_boolean(p_code_action_provider_json))
-    {
-        retval.code_action_provider = decode_boolean(p_code_action_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_CODE_ACTION_PROVIDER;
-    }
+bool read_text_document_content_change_event(json_reader_t * p_reader, text_document_content_change_event_t * p_value)
+{
+    memset(p_value, 0, sizeof(text_document_content_change_event_t));
 
-    json_t * p_code_lens_provider_json = json_object_get(p_json, "codeLensProvider");
-    if (json_is_object(p_code_lens_provider_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.code_lens_provider = decode_code_lens_options(p_code_lens_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_CODE_LENS_PROVIDER;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "range") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_range(p_reader, &p_value->range))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_RANGE;
+                }
+            }
+            else if (strcmp(p_key, "rangeLength") == 0)
+            {
+                if (read_number(p_reader, &p_value->range_length))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_RANGE_LENGTH;
+                }
+            }
+            else if (strcmp(p_key, "text") == 0)
+            {
+                if (read_string(p_reader, &p_value->text))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_TEXT;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-    json_t * p_document_formatting_provider_json = json_object_get(p_json, "documentFormattingProvider");
-    if (json_is_boolean(p_document_formatting_provider_json))
+    if ((p_value->valid_fields & TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_REQUIRED) != TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_REQUIRED)
     {
-        retval.document_formatting_provider = decode_boolean(p_document_formatting_provider_json);
-        retval.valid_fields |= SERVER_CAPABILITIES_FIELD_DOCUMENT_FORMATTING_PROVIDER;
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for text_document_content_change_event: Got 0x%x, expected 0x%x\n", p_value->valid_fields, TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_REQUIRED);
     }
-
-
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-markup_content_t decode_markup_content(json_t * p_json)
+bool read_text_document_identifier(json_reader_t * p_reader, text_document_identifier_t * p_value)
 {
-    markup_content_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_kind_json = json_object_get(p_json, "kind");
-    if (json_is_string(p_kind_json))
-    {
-        retval.kind = decode_string(p_kind_json);
-        retval.valid_fields |= MARKUP_CONTENT_FIELD_KIND;
-    }
+    memset(p_value, 0, sizeof(text_document_identifier_t));
 
-    json_t * p_value_json = json_object_get(p_json, "value");
-    if (json_is_string(p_value_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.value = decode_string(p_value_json);
-        retval.valid_fields |= MARKUP_CONTENT_FIELD_VALUE;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "uri") == 0)
+            {
+                if (read_uri(p_reader, &p_value->uri))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_IDENTIFIER_FIELD_URI;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & MARKUP_CONTENT_FIELD_REQUIRED) != MARKUP_CONTENT_FIELD_REQUIRED)
+    if ((p_value->valid_fields & TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED) != TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for markup_content: Got 0x%x, expected 0x%x\n", retval.valid_fields, MARKUP_CONTENT_FIELD_REQUIRED);
+        LOG("Missing required parameters for text_document_identifier: Got 0x%x, expected 0x%x\n", p_value->valid_fields, TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-marked_string_t decode_marked_string(json_t * p_json)
+bool read_versioned_text_document_identifier(json_reader_t * p_reader, versioned_text_document_identifier_t * p_value)
 {
-    marked_string_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_language_json = json_object_get(p_json, "language");
-    if (json_is_string(p_language_json))
-    {
-        retval.language = decode_string(p_language_json);
-        retval.valid_fields |= MARKED_STRING_FIELD_LANGUAGE;
-    }
+    memset(p_value, 0, sizeof(versioned_text_document_identifier_t));
 
-    json_t * p_value_json = json_object_get(p_json, "value");
-    if (json_is_string(p_value_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.value = decode_string(p_value_json);
-        retval.valid_fields |= MARKED_STRING_FIELD_VALUE;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "uri") == 0)
+            {
+                if (read_uri(p_reader, &p_value->uri))
+                {
+                    p_value->valid_fields |= VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_URI;
+                }
+            }
+            else if (strcmp(p_key, "version") == 0)
+            {
+                if (read_number(p_reader, &p_value->version))
+                {
+                    p_value->valid_fields |= VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_VERSION;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & MARKED_STRING_FIELD_REQUIRED) != MARKED_STRING_FIELD_REQUIRED)
+    if ((p_value->valid_fields & VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED) != VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for marked_string: Got 0x%x, expected 0x%x\n", retval.valid_fields, MARKED_STRING_FIELD_REQUIRED);
+        LOG("Missing required parameters for versioned_text_document_identifier: Got 0x%x, expected 0x%x\n", p_value->valid_fields, VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-message_action_item_t decode_message_action_item(json_t * p_json)
+bool read_file_event(json_reader_t * p_reader, file_event_t * p_value)
 {
-    message_action_item_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(file_event_t));
 
-    json_t * p_title_json = json_object_get(p_json, "title");
-    if (json_is_string(p_title_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.title = decode_string(p_title_json);
-        retval.valid_fields |= MESSAGE_ACTION_ITEM_FIELD_TITLE;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "uri") == 0)
+            {
+                if (read_uri(p_reader, &p_value->uri))
+                {
+                    p_value->valid_fields |= FILE_EVENT_FIELD_URI;
+                }
+            }
+            else if (strcmp(p_key, "type") == 0)
+            {
+                if (read_file_change_type(p_reader, &p_value->type))
+                {
+                    p_value->valid_fields |= FILE_EVENT_FIELD_TYPE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & MESSAGE_ACTION_ITEM_FIELD_REQUIRED) != MESSAGE_ACTION_ITEM_FIELD_REQUIRED)
+    if ((p_value->valid_fields & FILE_EVENT_FIELD_REQUIRED) != FILE_EVENT_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for message_action_item: Got 0x%x, expected 0x%x\n", retval.valid_fields, MESSAGE_ACTION_ITEM_FIELD_REQUIRED);
+        LOG("Missing required parameters for file_event: Got 0x%x, expected 0x%x\n", p_value->valid_fields, FILE_EVENT_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-position_t decode_position(json_t * p_json)
+bool read_text_document_position_params(json_reader_t * p_reader, text_document_position_params_t * p_value)
 {
-    position_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(text_document_position_params_t));
 
-    json_t * p_line_json = json_object_get(p_json, "line");
-    if (json_is_integer(p_line_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.line = decode_number(p_line_json);
-        retval.valid_fields |= POSITION_FIELD_LINE;
-    }
-
-    json_t * p_character_json = json_object_get(p_json, "character");
-    if (json_is_integer(p_character_json))
-    {
-        retval.character = decode_number(p_character_json);
-        retval.valid_fields |= POSITION_FIELD_CHARACTER;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "textDocument") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_document_identifier(p_reader, &p_value->text_document))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_POSITION_PARAMS_FIELD_TEXT_DOCUMENT;
+                }
+            }
+            else if (strcmp(p_key, "position") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_position(p_reader, &p_value->position))
+                {
+                    p_value->valid_fields |= TEXT_DOCUMENT_POSITION_PARAMS_FIELD_POSITION;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & POSITION_FIELD_REQUIRED) != POSITION_FIELD_REQUIRED)
+    if ((p_value->valid_fields & TEXT_DOCUMENT_POSITION_PARAMS_FIELD_REQUIRED) != TEXT_DOCUMENT_POSITION_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for position: Got 0x%x, expected 0x%x\n", retval.valid_fields, POSITION_FIELD_REQUIRED);
+        LOG("Missing required parameters for text_document_position_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, TEXT_DOCUMENT_POSITION_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-range_t decode_range(json_t * p_json)
+bool read_command(json_reader_t * p_reader, command_t * p_value)
 {
-    range_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(command_t));
 
-    json_t * p_start_json = json_object_get(p_json, "start");
-    if (json_is_object(p_start_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.start = decode_position(p_start_json);
-        retval.valid_fields |= RANGE_FIELD_START;
-    }
-
-    json_t * p_end_json = json_object_get(p_json, "end");
-    if (json_is_object(p_end_json))
-    {
-        retval.end = decode_position(p_end_json);
-        retval.valid_fields |= RANGE_FIELD_END;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "title") == 0)
+            {
+                if (read_string(p_reader, &p_value->title))
+                {
+                    p_value->valid_fields |= COMMAND_FIELD_TITLE;
+                }
+            }
+            else if (strcmp(p_key, "command") == 0)
+            {
+                if (read_string(p_reader, &p_value->command))
+                {
+                    p_value->valid_fields |= COMMAND_FIELD_COMMAND;
+                }
+            }
+            else if (strcmp(p_key, "arguments") == 0)
+            {
+                p_value->arguments = json_reader_json(p_reader);
+                if (p_value->arguments)
+                {
+                    p_value->valid_fields |= COMMAND_FIELD_ARGUMENTS;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & RANGE_FIELD_REQUIRED) != RANGE_FIELD_REQUIRED)
+    if ((p_value->valid_fields & COMMAND_FIELD_REQUIRED) != COMMAND_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for range: Got 0x%x, expected 0x%x\n", retval.valid_fields, RANGE_FIELD_REQUIRED);
+        LOG("Missing required parameters for command: Got 0x%x, expected 0x%x\n", p_value->valid_fields, COMMAND_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-text_edit_t decode_text_edit(json_t * p_json)
+bool read_completion_item(json_reader_t * p_reader, completion_item_t * p_value)
 {
-    text_edit_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(completion_item_t));
 
-    json_t * p_range_json = json_object_get(p_json, "range");
-    if (json_is_object(p_range_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.range = decode_range(p_range_json);
-        retval.valid_fields |= TEXT_EDIT_FIELD_RANGE;
-    }
-
-    json_t * p_new_text_json = json_object_get(p_json, "newText");
-    if (json_is_string(p_new_text_json))
-    {
-        retval.new_text = decode_string(p_new_text_json);
-        retval.valid_fields |= TEXT_EDIT_FIELD_NEW_TEXT;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "label") == 0)
+            {
+                if (read_string(p_reader, &p_value->label))
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_LABEL;
+                }
+            }
+            else if (strcmp(p_key, "kind") == 0)
+            {
+                if (read_completion_item_kind(p_reader, &p_value->kind))
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_KIND;
+                }
+            }
+            else if (strcmp(p_key, "detail") == 0)
+            {
+                if (read_string(p_reader, &p_value->detail))
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_DETAIL;
+                }
+            }
+            else if (strcmp(p_key, "documentation") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_markup_content(p_reader, &p_value->documentation))
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_DOCUMENTATION;
+                }
+            }
+            else if (strcmp(p_key, "sortText") == 0)
+            {
+                if (read_string(p_reader, &p_value->sort_text))
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_SORT_TEXT;
+                }
+            }
+            else if (strcmp(p_key, "filterText") == 0)
+            {
+                if (read_string(p_reader, &p_value->filter_text))
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_FILTER_TEXT;
+                }
+            }
+            else if (strcmp(p_key, "insertText") == 0)
+            {
+                if (read_string(p_reader, &p_value->insert_text))
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_INSERT_TEXT;
+                }
+            }
+            else if (strcmp(p_key, "insertTextFormat") == 0)
+            {
+                if (read_insert_text_format(p_reader, &p_value->insert_text_format))
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_INSERT_TEXT_FORMAT;
+                }
+            }
+            else if (strcmp(p_key, "textEdit") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_edit(p_reader, &p_value->text_edit))
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_TEXT_EDIT;
+                }
+            }
+            else if (strcmp(p_key, "additionalTextEdits") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_additional_text_edits = read_array_reserve(p_value->p_additional_text_edits, p_value->additional_text_edits_count, sizeof(p_value->p_additional_text_edits[0]));
+                        if (read_text_edit(p_reader, &p_value->p_additional_text_edits[p_value->additional_text_edits_count]))
+                        {
+                            p_value->additional_text_edits_count++;
+                        }
+                    }
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_ADDITIONAL_TEXT_EDITS;
+                }
+            }
+            else if (strcmp(p_key, "commitCharacters") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_commit_characters = read_array_reserve(p_value->p_commit_characters, p_value->commit_characters_count, sizeof(p_value->p_commit_characters[0]));
+                        if (read_string(p_reader, &p_value->p_commit_characters[p_value->commit_characters_count]))
+                        {
+                            p_value->commit_characters_count++;
+                        }
+                    }
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_COMMIT_CHARACTERS;
+                }
+            }
+            else if (strcmp(p_key, "command") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_command(p_reader, &p_value->command))
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_COMMAND;
+                }
+            }
+            else if (strcmp(p_key, "data") == 0)
+            {
+                p_value->data = json_reader_json(p_reader);
+                if (p_value->data)
+                {
+                    p_value->valid_fields |= COMPLETION_ITEM_FIELD_DATA;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & TEXT_EDIT_FIELD_REQUIRED) != TEXT_EDIT_FIELD_REQUIRED)
+    if ((p_value->valid_fields & COMPLETION_ITEM_FIELD_REQUIRED) != COMPLETION_ITEM_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for text_edit: Got 0x%x, expected 0x%x\n", retval.valid_fields, TEXT_EDIT_FIELD_REQUIRED);
+        LOG("Missing required parameters for completion_item: Got 0x%x, expected 0x%x\n", p_value->valid_fields, COMPLETION_ITEM_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-location_t decode_location(json_t * p_json)
+bool read_parameter_information(json_reader_t * p_reader, parameter_information_t * p_value)
 {
-    location_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_uri_json = json_object_get(p_json, "uri");
-    if (json_is_string(p_uri_json))
-    {
-        retval.uri = decode_uri(p_uri_json);
-        retval.valid_fields |= LOCATION_FIELD_URI;
-    }
+    memset(p_value, 0, sizeof(parameter_information_t));
 
-    json_t * p_range_json = json_object_get(p_json, "range");
-    if (json_is_object(p_range_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.range = decode_range(p_range_json);
-        retval.valid_fields |= LOCATION_FIELD_RANGE;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "label") == 0)
+            {
+                if (read_string(p_reader, &p_value->label))
+                {
+                    p_value->valid_fields |= PARAMETER_INFORMATION_FIELD_LABEL;
+                }
+            }
+            else if (strcmp(p_key, "documentation") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_markup_content(p_reader, &p_value->documentation))
+                {
+                    p_value->valid_fields |= PARAMETER_INFORMATION_FIELD_DOCUMENTATION;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & LOCATION_FIELD_REQUIRED) != LOCATION_FIELD_REQUIRED)
+    if ((p_value->valid_fields & PARAMETER_INFORMATION_FIELD_REQUIRED) != PARAMETER_INFORMATION_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for location: Got 0x%x, expected 0x%x\n", retval.valid_fields, LOCATION_FIELD_REQUIRED);
+        LOG("Missing required parameters for parameter_information: Got 0x%x, expected 0x%x\n", p_value->valid_fields, PARAMETER_INFORMATION_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-diagnostic_related_information_t decode_diagnostic_related_information(json_t * p_json)
+bool read_signature_information(json_reader_t * p_reader, signature_information_t * p_value)
 {
-    diagnostic_related_information_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(signature_information_t));
 
-    json_t * p_location_json = json_object_get(p_json, "location");
-    if (json_is_object(p_location_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.location = decode_location(p_location_json);
-        retval.valid_fields |= DIAGNOSTIC_RELATED_INFORMATION_FIELD_LOCATION;
-    }
-
-    json_t * p_message_json = json_object_get(p_json, "message");
-    if (json_is_string(p_message_json))
-    {
-        retval.message = decode_string(p_message_json);
-        retval.valid_fields |= DIAGNOSTIC_RELATED_INFORMATION_FIELD_MESSAGE;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "label") == 0)
+            {
+                if (read_string(p_reader, &p_value->label))
+                {
+                    p_value->valid_fields |= SIGNATURE_INFORMATION_FIELD_LABEL;
+                }
+            }
+            else if (strcmp(p_key, "documentation") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_markup_content(p_reader, &p_value->documentation))
+                {
+                    p_value->valid_fields |= SIGNATURE_INFORMATION_FIELD_DOCUMENTATION;
+                }
+            }
+            else if (strcmp(p_key, "parameters") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_parameters = read_array_reserve(p_value->p_parameters, p_value->parameters_count, sizeof(p_value->p_parameters[0]));
+                        if (read_parameter_information(p_reader, &p_value->p_parameters[p_value->parameters_count]))
+                        {
+                            p_value->parameters_count++;
+                        }
+                    }
+                    p_value->valid_fields |= SIGNATURE_INFORMATION_FIELD_PARAMETERS;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & DIAGNOSTIC_RELATED_INFORMATION_FIELD_REQUIRED) != DIAGNOSTIC_RELATED_INFORMATION_FIELD_REQUIRED)
+    if ((p_value->valid_fields & SIGNATURE_INFORMATION_FIELD_REQUIRED) != SIGNATURE_INFORMATION_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for diagnostic_related_information: Got 0x%x, expected 0x%x\n", retval.valid_fields, DIAGNOSTIC_RELATED_INFORMATION_FIELD_REQUIRED);
+        LOG("Missing required parameters for signature_information: Got 0x%x, expected 0x%x\n", p_value->valid_fields, SIGNATURE_INFORMATION_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-diagnostic_t decode_diagnostic(json_t * p_json)
+bool read_reference_context(json_reader_t * p_reader, reference_context_t * p_value)
 {
-    diagnostic_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_range_json = json_object_get(p_json, "range");
-    if (json_is_object(p_range_json))
-    {
-        retval.range = decode_range(p_range_json);
-        retval.valid_fields |= DIAGNOSTIC_FIELD_RANGE;
-    }
-
-    json_t * p_severity_json = json_object_get(p_json, "severity");
-    if (json_is_object(p_severity_json))
-    {
-        retval.severity = decode_diagnostic_severity(p_severity_json);
-        retval.valid_fields |= DIAGNOSTIC_FIELD_SEVERITY;
-    }
-
-    json_t * p_code_json = json_object_get(p_json, "code");
-    if (json_is_integer(p_code_json))
-    {
-        retval.code = decode_number(p_code_json);
-        retval.valid_fields |= DIAGNOSTIC_FIELD_CODE;
-    }
-
-    json_t * p_source_json = json_object_get(p_json, "source");
-    if (json_is_string(p_source_json))
-    {
-        retval.source = decode_string(p_source_json);
-        retval.valid_fields |= DIAGNOSTIC_FIELD_SOURCE;
-    }
-
-    json_t * p_message_json = json_object_get(p_json, "message");
-    if (json_is_string(p_message_json))
-    {
-        retval.message = decode_string(p_message_json);
-        retval.valid_fields |= DIAGNOSTIC_FIELD_MESSAGE;
-    }
+    memset(p_value, 0, sizeof(reference_context_t));
 
-    json_t * p_related_information_json = json_object_get(p_json, "relatedInformation");
-    if (json_is_array(p_related_information_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.related_information_count = json_array_size(p_related_information_json);
-        retval.p_related_information = malloc(sizeof(diagnostic_related_information_t) * retval.related_information_count);
-        ASSERT(retval.p_related_information);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_related_information_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_related_information[index] = decode_diagnostic_related_information(p_it);
+            if (strcmp(p_key, "includeDeclaration") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->include_declaration))
+                {
+                    p_value->valid_fields |= REFERENCE_CONTEXT_FIELD_INCLUDE_DECLARATION;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= DIAGNOSTIC_FIELD_RELATED_INFORMATION;
     }
 
-
-    if ((retval.valid_fields & DIAGNOSTIC_FIELD_REQUIRED) != DIAGNOSTIC_FIELD_REQUIRED)
+    if ((p_value->valid_fields & REFERENCE_CONTEXT_FIELD_REQUIRED) != REFERENCE_CONTEXT_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for diagnostic: Got 0x%x, expected 0x%x\n", retval.valid_fields, DIAGNOSTIC_FIELD_REQUIRED);
+        LOG("Missing required parameters for reference_context: Got 0x%x, expected 0x%x\n", p_value->valid_fields, REFERENCE_CONTEXT_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-text_document_item_t decode_text_document_item(json_t * p_json)
+bool read_completion_list(json_reader_t * p_reader, completion_list_t * p_value)
 {
-    text_document_item_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(completion_list_t));
 
-    json_t * p_uri_json = json_object_get(p_json, "uri");
-    if (json_is_string(p_uri_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.uri = decode_uri(p_uri_json);
-        retval.valid_fields |= TEXT_DOCUMENT_ITEM_FIELD_URI;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "isIncomplete") == 0)
+            {
+                if (read_boolean(p_reader, &p_value->is_incomplete))
+                {
+                    p_value->valid_fields |= COMPLETION_LIST_FIELD_IS_INCOMPLETE;
+                }
+            }
+            else if (strcmp(p_key, "items") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_items = read_array_reserve(p_value->p_items, p_value->items_count, sizeof(p_value->p_items[0]));
+                        if (read_completion_item(p_reader, &p_value->p_items[p_value->items_count]))
+                        {
+                            p_value->items_count++;
+                        }
+                    }
+                    p_value->valid_fields |= COMPLETION_LIST_FIELD_ITEMS;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-    json_t * p_language_id_json = json_object_get(p_json, "languageId");
-    if (json_is_string(p_language_id_json))
+    if ((p_value->valid_fields & COMPLETION_LIST_FIELD_REQUIRED) != COMPLETION_LIST_FIELD_REQUIRED)
     {
-        retval.language_id = decode_string(p_language_id_json);
-        retval.valid_fields |= TEXT_DOCUMENT_ITEM_FIELD_LANGUAGE_ID;
+        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
+        LOG("Missing required parameters for completion_list: Got 0x%x, expected 0x%x\n", p_value->valid_fields, COMPLETION_LIST_FIELD_REQUIRED);
     }
+    return !json_reader_error(p_reader);
+}
 
-    json_t * p_version_json = json_object_get(p_json, "version");
-    if (json_is_integer(p_version_json))
-    {
-        retval.version = decode_number(p_version_json);
-        retval.valid_fields |= TEXT_DOCUMENT_ITEM_FIELD_VERSION;
-    }
+bool read_code_action_context(json_reader_t * p_reader, code_action_context_t * p_value)
+{
+    memset(p_value, 0, sizeof(code_action_context_t));
 
-    json_t * p_text_json = json_object_get(p_json, "text");
-    if (json_is_string(p_text_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.text = decode_string(p_text_json);
-        retval.valid_fields |= TEXT_DOCUMENT_ITEM_FIELD_TEXT;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "diagnostics") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_diagnostics = read_array_reserve(p_value->p_diagnostics, p_value->diagnostics_count, sizeof(p_value->p_diagnostics[0]));
+                        if (read_diagnostic(p_reader, &p_value->p_diagnostics[p_value->diagnostics_count]))
+                        {
+                            p_value->diagnostics_count++;
+                        }
+                    }
+                    p_value->valid_fields |= CODE_ACTION_CONTEXT_FIELD_DIAGNOSTICS;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & TEXT_DOCUMENT_ITEM_FIELD_REQUIRED) != TEXT_DOCUMENT_ITEM_FIELD_REQUIRED)
+    if ((p_value->valid_fields & CODE_ACTION_CONTEXT_FIELD_REQUIRED) != CODE_ACTION_CONTEXT_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for text_document_item: Got 0x%x, expected 0x%x\n", retval.valid_fields, TEXT_DOCUMENT_ITEM_FIELD_REQUIRED);
+        LOG("Missing required parameters for code_action_context: Got 0x%x, expected 0x%x\n", p_value->valid_fields, CODE_ACTION_CONTEXT_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-text_document_content_change_event_t decode_text_document_content_change_event(json_t * p_json)
-{
-    text_document_content_change_event_t retval;
-    memset(&retval, 0, sizeof(retval));
 
-    json_t * p_range_json = json_object_get(p_json, "range");
-    if (json_is_object(p_range_json))
-    {
-        retval.range = decode_range(p_range_json);
-        retval.valid_fields |= TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_RANGE;
-    }
 
-    json_t * p_range_length_json = json_object_get(p_json, "rangeLength");
-    if (json_is_integer(p_range_length_json))
-    {
-        retval.range_length = decode_number(p_range_length_json);
-        retval.valid_fields |= TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_RANGE_LENGTH;
-    }
+/* Server command parameter JSON readers */
+bool read_initialize_params(json_reader_t * p_reader, initialize_params_t * p_value)
+{
+    memset(p_value, 0, sizeof(initialize_params_t));
 
-    json_t * p_text_json = json_object_get(p_json, "text");
-    if (json_is_string(p_text_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.text = decode_string(p_text_json);
-        retval.valid_fields |= TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_TEXT;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "processId") == 0)
+            {
+                if (read_number(p_reader, &p_value->process_id))
+                {
+                    p_value->valid_fields |= INITIALIZE_PARAMS_FIELD_PROCESS_ID;
+                }
+            }
+            else if (strcmp(p_key, "rootPath") == 0)
+            {
+                if (read_string(p_reader, &p_value->root_path))
+                {
+                    p_value->valid_fields |= INITIALIZE_PARAMS_FIELD_ROOT_PATH;
+                }
+            }
+            else if (strcmp(p_key, "rootUri") == 0)
+            {
+                if (read_uri(p_reader, &p_value->root_uri))
+                {
+                    p_value->valid_fields |= INITIALIZE_PARAMS_FIELD_ROOT_URI;
+                }
+            }
+            else if (strcmp(p_key, "capabilities") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_client_capabilities(p_reader, &p_value->capabilities))
+                {
+                    p_value->valid_fields |= INITIALIZE_PARAMS_FIELD_CAPABILITIES;
+                }
+            }
+            else if (strcmp(p_key, "initializationOptions") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_initialization_options(p_reader, &p_value->initialization_options))
+                {
+                    p_value->valid_fields |= INITIALIZE_PARAMS_FIELD_INITIALIZATION_OPTIONS;
+                }
+            }
+            else if (strcmp(p_key, "trace") == 0)
+            {
+                if (read_string(p_reader, &p_value->trace))
+                {
+                    p_value->valid_fields |= INITIALIZE_PARAMS_FIELD_TRACE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_REQUIRED) != TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_REQUIRED)
+    if ((p_value->valid_fields & INITIALIZE_PARAMS_FIELD_REQUIRED) != INITIALIZE_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for text_document_content_change_event: Got 0x%x, expected 0x%x\n", retval.valid_fields, TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_REQUIRED);
+        LOG("Missing required parameters for initialize_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, INITIALIZE_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-text_document_identifier_t decode_text_document_identifier(json_t * p_json)
+bool read_reference_params(json_reader_t * p_reader, reference_params_t * p_value)
 {
-    text_document_identifier_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(reference_params_t));
 
-    json_t * p_uri_json = json_object_get(p_json, "uri");
-    if (json_is_string(p_uri_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.uri = decode_uri(p_uri_json);
-        retval.valid_fields |= TEXT_DOCUMENT_IDENTIFIER_FIELD_URI;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "context") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_reference_context(p_reader, &p_value->context))
+                {
+                    p_value->valid_fields |= REFERENCE_PARAMS_FIELD_CONTEXT;
+                }
+            }
+            else if (strcmp(p_key, "textDocument") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_document_identifier(p_reader, &p_value->text_document))
+                {
+                    p_value->valid_fields |= REFERENCE_PARAMS_FIELD_TEXT_DOCUMENT;
+                }
+            }
+            else if (strcmp(p_key, "position") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_position(p_reader, &p_value->position))
+                {
+                    p_value->valid_fields |= REFERENCE_PARAMS_FIELD_POSITION;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED) != TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED)
+    if ((p_value->valid_fields & REFERENCE_PARAMS_FIELD_REQUIRED) != REFERENCE_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for text_document_identifier: Got 0x%x, expected 0x%x\n", retval.valid_fields, TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED);
+        LOG("Missing required parameters for reference_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, REFERENCE_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-versioned_text_document_identifier_t decode_versioned_text_document_identifier(json_t * p_json)
+bool read_document_symbol_params(json_reader_t * p_reader, document_symbol_params_t * p_value)
 {
-    versioned_text_document_identifier_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(document_symbol_params_t));
 
-    json_t * p_uri_json = json_object_get(p_json, "uri");
-    if (json_is_string(p_uri_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.uri = decode_uri(p_uri_json);
-        retval.valid_fields |= VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_URI;
-    }
-
-    json_t * p_version_json = json_object_get(p_json, "version");
-    if (json_is_integer(p_version_json))
-    {
-        retval.version = decode_number(p_version_json);
-        retval.valid_fields |= VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_VERSION;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "textDocument") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_document_identifier(p_reader, &p_value->text_document))
+                {
+                    p_value->valid_fields |= DOCUMENT_SYMBOL_PARAMS_FIELD_TEXT_DOCUMENT;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED) != VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED)
+    if ((p_value->valid_fields & DOCUMENT_SYMBOL_PARAMS_FIELD_REQUIRED) != DOCUMENT_SYMBOL_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for versioned_text_document_identifier: Got 0x%x, expected 0x%x\n", retval.valid_fields, VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_REQUIRED);
+        LOG("Missing required parameters for document_symbol_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, DOCUMENT_SYMBOL_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-file_event_t decode_file_event(json_t * p_json)
+bool read_workspace_symbol_params(json_reader_t * p_reader, workspace_symbol_params_t * p_value)
 {
-    file_event_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_uri_json = json_object_get(p_json, "uri");
-    if (json_is_string(p_uri_json))
-    {
-        retval.uri = decode_uri(p_uri_json);
-        retval.valid_fields |= FILE_EVENT_FIELD_URI;
-    }
+    memset(p_value, 0, sizeof(workspace_symbol_params_t));
 
-    json_t * p_type_json = json_object_get(p_json, "type");
-    if (json_is_object(p_type_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.type = decode_file_change_type(p_type_json);
-        retval.valid_fields |= FILE_EVENT_FIELD_TYPE;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "query") == 0)
+            {
+                if (read_string(p_reader, &p_value->query))
+                {
+                    p_value->valid_fields |= WORKSPACE_SYMBOL_PARAMS_FIELD_QUERY;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & FILE_EVENT_FIELD_REQUIRED) != FILE_EVENT_FIELD_REQUIRED)
+    if ((p_value->valid_fields & WORKSPACE_SYMBOL_PARAMS_FIELD_REQUIRED) != WORKSPACE_SYMBOL_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for file_event: Got 0x%x, expected 0x%x\n", retval.valid_fields, FILE_EVENT_FIELD_REQUIRED);
+        LOG("Missing required parameters for workspace_symbol_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, WORKSPACE_SYMBOL_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-text_document_position_params_t decode_text_document_position_params(json_t * p_json)
+bool read_document_link_params(json_reader_t * p_reader, document_link_params_t * p_value)
 {
-    text_document_position_params_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_text_document_json = json_object_get(p_json, "textDocument");
-    if (json_is_object(p_text_document_json))
-    {
-        retval.text_document = decode_text_document_identifier(p_text_document_json);
-        retval.valid_fields |= TEXT_DOCUMENT_POSITION_PARAMS_FIELD_TEXT_DOCUMENT;
-    }
+    memset(p_value, 0, sizeof(document_link_params_t));
 
-    json_t * p_position_json = json_object_get(p_json, "position");
-    if (json_is_object(p_position_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.position = decode_position(p_position_json);
-        retval.valid_fields |= TEXT_DOCUMENT_POSITION_PARAMS_FIELD_POSITION;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "textDocument") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_document_identifier(p_reader, &p_value->text_document))
+                {
+                    p_value->valid_fields |= DOCUMENT_LINK_PARAMS_FIELD_TEXT_DOCUMENT;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & TEXT_DOCUMENT_POSITION_PARAMS_FIELD_REQUIRED) != TEXT_DOCUMENT_POSITION_PARAMS_FIELD_REQUIRED)
+    if ((p_value->valid_fields & DOCUMENT_LINK_PARAMS_FIELD_REQUIRED) != DOCUMENT_LINK_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for text_document_position_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, TEXT_DOCUMENT_POSITION_PARAMS_FIELD_REQUIRED);
+        LOG("Missing required parameters for document_link_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, DOCUMENT_LINK_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-command_t decode_command(json_t * p_json)
+bool read_code_action_params(json_reader_t * p_reader, code_action_params_t * p_value)
 {
-    command_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(code_action_params_t));
 
-    json_t * p_title_json = json_object_get(p_json, "title");
-    if (json_is_string(p_title_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.title = decode_string(p_title_json);
-        retval.valid_fields |= COMMAND_FIELD_TITLE;
-    }
-
-    json_t * p_command_json = json_object_get(p_json, "command");
-    if (json_is_string(p_command_json))
-    {
-        retval.command = decode_string(p_command_json);
-        retval.valid_fields |= COMMAND_FIELD_COMMAND;
-    }
-
-    json_t * p_arguments_json = json_object_get(p_json, "arguments");
-    if (p_arguments_json != NULL)
-    {
-        retval.arguments = json_deep_copy(p_arguments_json);
-        retval.valid_fields |= COMMAND_FIELD_ARGUMENTS;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "textDocument") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_document_identifier(p_reader, &p_value->text_document))
+                {
+                    p_value->valid_fields |= CODE_ACTION_PARAMS_FIELD_TEXT_DOCUMENT;
+                }
+            }
+            else if (strcmp(p_key, "range") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_range(p_reader, &p_value->range))
+                {
+                    p_value->valid_fields |= CODE_ACTION_PARAMS_FIELD_RANGE;
+                }
+            }
+            else if (strcmp(p_key, "context") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_code_action_context(p_reader, &p_value->context))
+                {
+                    p_value->valid_fields |= CODE_ACTION_PARAMS_FIELD_CONTEXT;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & COMMAND_FIELD_REQUIRED) != COMMAND_FIELD_REQUIRED)
+    if ((p_value->valid_fields & CODE_ACTION_PARAMS_FIELD_REQUIRED) != CODE_ACTION_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for command: Got 0x%x, expected 0x%x\n", retval.valid_fields, COMMAND_FIELD_REQUIRED);
+        LOG("Missing required parameters for code_action_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, CODE_ACTION_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-completion_item_t decode_completion_item(json_t * p_json)
-{
-    completion_item_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_label_json = json_object_get(p_json, "label");
-    if (json_is_string(p_label_json))
-    {
-        retval.label = decode_string(p_label_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_LABEL;
-    }
-
-    json_t * p_kind_json = json_object_get(p_json, "kind");
-    if (json_is_object(p_kind_json))
-    {
-        retval.kind = decode_completion_item_kind(p_kind_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_KIND;
-    }
-
-    json_t * p_detail_json = json_object_get(p_json, "detail");
-    if (json_is_string(p_detail_json))
-    {
-        retval.detail = decode_string(p_detail_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_DETAIL;
-    }
-
-    json_t * p_documentation_json = json_object_get(p_json, "documentation");
-    if (json_is_object(p_documentation_json))
-    {
-        retval.documentation = decode_markup_content(p_documentation_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_DOCUMENTATION;
-    }
-
-    json_t * p_sort_text_json = json_object_get(p_json, "sortText");
-    if (json_is_string(p_sort_text_json))
-    {
-        retval.sort_text = decode_string(p_sort_text_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_SORT_TEXT;
-    }
-
-    json_t * p_filter_text_json = json_object_get(p_json, "filterText");
-    if (json_is_string(p_filter_text_json))
-    {
-        retval.filter_text = decode_string(p_filter_text_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_FILTER_TEXT;
-    }
 
-    json_t * p_insert_text_json = json_object_get(p_json, "insertText");
-    if (json_is_string(p_insert_text_json))
-    {
-        retval.insert_text = decode_string(p_insert_text_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_INSERT_TEXT;
-    }
-
-    json_t * p_insert_text_format_json = json_object_get(p_json, "insertTextFormat");
-    if (json_is_object(p_insert_text_format_json))
-    {
-        retval.insert_text_format = decode_insert_text_format(p_insert_text_format_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_INSERT_TEXT_FORMAT;
-    }
-
-    json_t * p_text_edit_json = json_object_get(p_json, "textEdit");
-    if (json_is_object(p_text_edit_json))
-    {
-        retval.text_edit = decode_text_edit(p_text_edit_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_TEXT_EDIT;
-    }
 
-    json_t * p_additional_text_edits_json = json_object_get(p_json, "additionalTextEdits");
-    if (json_is_array(p_additional_text_edits_json))
-    {
-        retval.additional_text_edits_count = json_array_size(p_additional_text_edits_json);
-        retval.p_additional_text_edits = malloc(sizeof(text_edit_t) * retval.additional_text_edits_count);
-        ASSERT(retval.p_additional_text_edits);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_additional_text_edits_json, index, p_it)
-        {
-            retval.p_additional_text_edits[index] = decode_text_edit(p_it);
-        }
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_ADDITIONAL_TEXT_EDITS;
-    }
+/* Client command parameter JSON readers */
+bool read_show_message_request_params(json_reader_t * p_reader, show_message_request_params_t * p_value)
+{
+    memset(p_value, 0, sizeof(show_message_request_params_t));
 
-    json_t * p_commit_characters_json = json_object_get(p_json, "commitCharacters");
-    if (json_is_array(p_commit_characters_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.commit_characters_count = json_array_size(p_commit_characters_json);
-        retval.p_commit_characters = malloc(sizeof(char  *) * retval.commit_characters_count);
-        ASSERT(retval.p_commit_characters);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_commit_characters_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_commit_characters[index] = decode_string(p_it);
+            if (strcmp(p_key, "type") == 0)
+            {
+                if (read_message_type(p_reader, &p_value->type))
+                {
+                    p_value->valid_fields |= SHOW_MESSAGE_REQUEST_PARAMS_FIELD_TYPE;
+                }
+            }
+            else if (strcmp(p_key, "message") == 0)
+            {
+                if (read_string(p_reader, &p_value->message))
+                {
+                    p_value->valid_fields |= SHOW_MESSAGE_REQUEST_PARAMS_FIELD_MESSAGE;
+                }
+            }
+            else if (strcmp(p_key, "actions") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_actions = read_array_reserve(p_value->p_actions, p_value->actions_count, sizeof(p_value->p_actions[0]));
+                        if (read_message_action_item(p_reader, &p_value->p_actions[p_value->actions_count]))
+                        {
+                            p_value->actions_count++;
+                        }
+                    }
+                    p_value->valid_fields |= SHOW_MESSAGE_REQUEST_PARAMS_FIELD_ACTIONS;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_COMMIT_CHARACTERS;
-    }
-
-    json_t * p_command_json = json_object_get(p_json, "command");
-    if (json_is_object(p_command_json))
-    {
-        retval.command = decode_command(p_command_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_COMMAND;
-    }
-
-    json_t * p_data_json = json_object_get(p_json, "data");
-    if (p_data_json != NULL)
-    {
-        retval.data = json_deep_copy(p_data_json);
-        retval.valid_fields |= COMPLETION_ITEM_FIELD_DATA;
     }
 
-
-    if ((retval.valid_fields & COMPLETION_ITEM_FIELD_REQUIRED) != COMPLETION_ITEM_FIELD_REQUIRED)
+    if ((p_value->valid_fields & SHOW_MESSAGE_REQUEST_PARAMS_FIELD_REQUIRED) != SHOW_MESSAGE_REQUEST_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for completion_item: Got 0x%x, expected 0x%x\n", retval.valid_fields, COMPLETION_ITEM_FIELD_REQUIRED);
+        LOG("Missing required parameters for show_message_request_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, SHOW_MESSAGE_REQUEST_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-parameter_information_t decode_parameter_information(json_t * p_json)
+bool read_signature_help(json_reader_t * p_reader, signature_help_t * p_value)
 {
-    parameter_information_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_label_json = json_object_get(p_json, "label");
-    if (json_is_string(p_label_json))
-    {
-        retval.label = decode_string(p_label_json);
-        retval.valid_fields |= PARAMETER_INFORMATION_FIELD_LABEL;
-    }
+    memset(p_value, 0, sizeof(signature_help_t));
 
-    json_t * p_documentation_json = json_object_get(p_json, "documentation");
-    if (json_is_object(p_documentation_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.documentation = decode_markup_content(p_documentation_json);
-        retval.valid_fields |= PARAMETER_INFORMATION_FIELD_DOCUMENTATION;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "signatures") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_signatures = read_array_reserve(p_value->p_signatures, p_value->signatures_count, sizeof(p_value->p_signatures[0]));
+                        if (read_signature_information(p_reader, &p_value->p_signatures[p_value->signatures_count]))
+                        {
+                            p_value->signatures_count++;
+                        }
+                    }
+                    p_value->valid_fields |= SIGNATURE_HELP_FIELD_SIGNATURES;
+                }
+            }
+            else if (strcmp(p_key, "activeSignature") == 0)
+            {
+                if (read_number(p_reader, &p_value->active_signature))
+                {
+                    p_value->valid_fields |= SIGNATURE_HELP_FIELD_ACTIVE_SIGNATURE;
+                }
+            }
+            else if (strcmp(p_key, "activeParameter") == 0)
+            {
+                if (read_number(p_reader, &p_value->active_parameter))
+                {
+                    p_value->valid_fields |= SIGNATURE_HELP_FIELD_ACTIVE_PARAMETER;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & PARAMETER_INFORMATION_FIELD_REQUIRED) != PARAMETER_INFORMATION_FIELD_REQUIRED)
+    if ((p_value->valid_fields & SIGNATURE_HELP_FIELD_REQUIRED) != SIGNATURE_HELP_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for parameter_information: Got 0x%x, expected 0x%x\n", retval.valid_fields, PARAMETER_INFORMATION_FIELD_REQUIRED);
+        LOG("Missing required parameters for signature_help: Got 0x%x, expected 0x%x\n", p_value->valid_fields, SIGNATURE_HELP_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-signature_information_t decode_signature_information(json_t * p_json)
-{
-    signature_information_t retval;
-    memset(&retval, 0, sizeof(retval));
 
-    json_t * p_label_json = json_object_get(p_json, "label");
-    if (json_is_string(p_label_json))
-    {
-        retval.label = decode_string(p_label_json);
-        retval.valid_fields |= SIGNATURE_INFORMATION_FIELD_LABEL;
-    }
 
-    json_t * p_documentation_json = json_object_get(p_json, "documentation");
-    if (json_is_object(p_documentation_json))
-    {
-        retval.documentation = decode_markup_content(p_documentation_json);
-        retval.valid_fields |= SIGNATURE_INFORMATION_FIELD_DOCUMENTATION;
-    }
+/* Command response parameter JSON readers */
+bool read_initialize_result(json_reader_t * p_reader, initialize_result_t * p_value)
+{
+    memset(p_value, 0, sizeof(initialize_result_t));
 
-    json_t * p_parameters_json = json_object_get(p_json, "parameters");
-    if (json_is_array(p_parameters_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.parameters_count = json_array_size(p_parameters_json);
-        retval.p_parameters = malloc(sizeof(parameter_information_t) * retval.parameters_count);
-        ASSERT(retval.p_parameters);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_parameters_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_parameters[index] = decode_parameter_information(p_it);
+            if (strcmp(p_key, "capabilities") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_server_capabilities(p_reader, &p_value->capabilities))
+                {
+                    p_value->valid_fields |= INITIALIZE_RESULT_FIELD_CAPABILITIES;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= SIGNATURE_INFORMATION_FIELD_PARAMETERS;
     }
 
-
-    if ((retval.valid_fields & SIGNATURE_INFORMATION_FIELD_REQUIRED) != SIGNATURE_INFORMATION_FIELD_REQUIRED)
+    if ((p_value->valid_fields & INITIALIZE_RESULT_FIELD_REQUIRED) != INITIALIZE_RESULT_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for signature_information: Got 0x%x, expected 0x%x\n", retval.valid_fields, SIGNATURE_INFORMATION_FIELD_REQUIRED);
+        LOG("Missing required parameters for initialize_result: Got 0x%x, expected 0x%x\n", p_value->valid_fields, INITIALIZE_RESULT_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-reference_context_t decode_reference_context(json_t * p_json)
+bool read_symbol_information(json_reader_t * p_reader, symbol_information_t * p_value)
 {
-    reference_context_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(symbol_information_t));
 
-    json_t * p_include_declaration_json = json_object_get(p_json, "includeDeclaration");
-    if (json_is_boolean(p_include_declaration_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.include_declaration = decode_boolean(p_include_declaration_json);
-        retval.valid_fields |= REFERENCE_CONTEXT_FIELD_INCLUDE_DECLARATION;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "name") == 0)
+            {
+                if (read_string(p_reader, &p_value->name))
+                {
+                    p_value->valid_fields |= SYMBOL_INFORMATION_FIELD_NAME;
+                }
+            }
+            else if (strcmp(p_key, "kind") == 0)
+            {
+                if (read_symbol_kind(p_reader, &p_value->kind))
+                {
+                    p_value->valid_fields |= SYMBOL_INFORMATION_FIELD_KIND;
+                }
+            }
+            else if (strcmp(p_key, "location") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_location(p_reader, &p_value->location))
+                {
+                    p_value->valid_fields |= SYMBOL_INFORMATION_FIELD_LOCATION;
+                }
+            }
+            else if (strcmp(p_key, "containerName") == 0)
+            {
+                if (read_string(p_reader, &p_value->container_name))
+                {
+                    p_value->valid_fields |= SYMBOL_INFORMATION_FIELD_CONTAINER_NAME;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & REFERENCE_CONTEXT_FIELD_REQUIRED) != REFERENCE_CONTEXT_FIELD_REQUIRED)
+    if ((p_value->valid_fields & SYMBOL_INFORMATION_FIELD_REQUIRED) != SYMBOL_INFORMATION_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for reference_context: Got 0x%x, expected 0x%x\n", retval.valid_fields, REFERENCE_CONTEXT_FIELD_REQUIRED);
+        LOG("Missing required parameters for symbol_information: Got 0x%x, expected 0x%x\n", p_value->valid_fields, SYMBOL_INFORMATION_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-completion_list_t decode_completion_list(json_t * p_json)
+bool read_document_link(json_reader_t * p_reader, document_link_t * p_value)
 {
-    completion_list_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(document_link_t));
 
-    json_t * p_is_incomplete_json = json_object_get(p_json, "isIncomplete");
-    if (json_is_boolean(p_is_incomplete_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.is_incomplete = decode_boolean(p_is_incomplete_json);
-        retval.valid_fields |= COMPLETION_LIST_FIELD_IS_INCOMPLETE;
-    }
-
-    json_t * p_items_json = json_object_get(p_json, "items");
-    if (json_is_array(p_items_json))
-    {
-        retval.items_count = json_array_size(p_items_json);
-        retval.p_items = malloc(sizeof(completion_item_t) * retval.items_count);
-        ASSERT(retval.p_items);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_items_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_items[index] = decode_completion_item(p_it);
+            if (strcmp(p_key, "range") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_range(p_reader, &p_value->range))
+                {
+                    p_value->valid_fields |= DOCUMENT_LINK_FIELD_RANGE;
+                }
+            }
+            else if (strcmp(p_key, "target") == 0)
+            {
+                if (read_uri(p_reader, &p_value->target))
+                {
+                    p_value->valid_fields |= DOCUMENT_LINK_FIELD_TARGET;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= COMPLETION_LIST_FIELD_ITEMS;
     }
 
-
-    if ((retval.valid_fields & COMPLETION_LIST_FIELD_REQUIRED) != COMPLETION_LIST_FIELD_REQUIRED)
+    if ((p_value->valid_fields & DOCUMENT_LINK_FIELD_REQUIRED) != DOCUMENT_LINK_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for completion_list: Got 0x%x, expected 0x%x\n", retval.valid_fields, COMPLETION_LIST_FIELD_REQUIRED);
+        LOG("Missing required parameters for document_link: Got 0x%x, expected 0x%x\n", p_value->valid_fields, DOCUMENT_LINK_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-code_action_context_t decode_code_action_context(json_t * p_json)
+bool read_hover(json_reader_t * p_reader, hover_t * p_value)
 {
-    code_action_context_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(hover_t));
 
-    json_t * p_diagnostics_json = json_object_get(p_json, "diagnostics");
-    if (json_is_array(p_diagnostics_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.diagnostics_count = json_array_size(p_diagnostics_json);
-        retval.p_diagnostics = malloc(sizeof(diagnostic_t) * retval.diagnostics_count);
-        ASSERT(retval.p_diagnostics);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_diagnostics_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_diagnostics[index] = decode_diagnostic(p_it);
+            if (strcmp(p_key, "contents") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_markup_content(p_reader, &p_value->contents))
+                {
+                    p_value->valid_fields |= HOVER_FIELD_CONTENTS;
+                }
+            }
+            else if (strcmp(p_key, "range") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_range(p_reader, &p_value->range))
+                {
+                    p_value->valid_fields |= HOVER_FIELD_RANGE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= CODE_ACTION_CONTEXT_FIELD_DIAGNOSTICS;
     }
 
-
-    if ((retval.valid_fields & CODE_ACTION_CONTEXT_FIELD_REQUIRED) != CODE_ACTION_CONTEXT_FIELD_REQUIRED)
+    if ((p_value->valid_fields & HOVER_FIELD_REQUIRED) != HOVER_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for code_action_context: Got 0x%x, expected 0x%x\n", retval.valid_fields, CODE_ACTION_CONTEXT_FIELD_REQUIRED);
+        LOG("Missing required parameters for hover: Got 0x%x, expected 0x%x\n", p_value->valid_fields, HOVER_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
 
 
-/* Server command parameter JSON decoders */
-initialize_params_t decode_initialize_params(json_t * p_json)
+/* Client notification parameter JSON readers */
+bool read_show_message_params(json_reader_t * p_reader, show_message_params_t * p_value)
 {
-    initialize_params_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_process_id_json = json_object_get(p_json, "processId");
-    if (json_is_integer(p_process_id_json))
-    {
-        retval.process_id = decode_number(p_process_id_json);
-        retval.valid_fields |= INITIALIZE_PARAMS_FIELD_PROCESS_ID;
-    }
-
-    json_t * p_root_path_json = json_object_get(p_json, "rootPath");
-    if (json_is_string(p_root_path_json))
-    {
-        retval.root_path = decode_string(p_root_path_json);
-        retval.valid_fields |= INITIALIZE_PARAMS_FIELD_ROOT_PATH;
-    }
-
-    json_t * p_root_uri_json = json_object_get(p_json, "rootUri");
-    if (json_is_string(p_root_uri_json))
-    {
-        retval.root_uri = decode_uri(p_root_uri_json);
-        retval.valid_fields |= INITIALIZE_PARAMS_FIELD_ROOT_URI;
-    }
-
-    json_t * p_capabilities_json = json_object_get(p_json, "capabilities");
-    if (json_is_object(p_capabilities_json))
-    {
-        retval.capabilities = decode_client_capabilities(p_capabilities_json);
-        retval.valid_fields |= INITIALIZE_PARAMS_FIELD_CAPABILITIES;
-    }
-
-    json_t * p_initialization_options_json = json_object_get(p_json, "initializationOptions");
-    if (json_is_object(p_initialization_options_json))
-    {
-        retval.initialization_options = decode_initialization_options(p_initialization_options_json);
-        retval.valid_fields |= INITIALIZE_PARAMS_FIELD_INITIALIZATION_OPTIONS;
-    }
+    memset(p_value, 0, sizeof(show_message_params_t));
 
-    json_t * p_trace_json = json_object_get(p_json, "trace");
-    if (json_is_string(p_trace_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.trace = decode_string(p_trace_json);
-        retval.valid_fields |= INITIALIZE_PARAMS_FIELD_TRACE;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "type") == 0)
+            {
+                if (read_message_type(p_reader, &p_value->type))
+                {
+                    p_value->valid_fields |= SHOW_MESSAGE_PARAMS_FIELD_TYPE;
+                }
+            }
+            else if (strcmp(p_key, "message") == 0)
+            {
+                if (read_string(p_reader, &p_value->message))
+                {
+                    p_value->valid_fields |= SHOW_MESSAGE_PARAMS_FIELD_MESSAGE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & INITIALIZE_PARAMS_FIELD_REQUIRED) != INITIALIZE_PARAMS_FIELD_REQUIRED)
+    if ((p_value->valid_fields & SHOW_MESSAGE_PARAMS_FIELD_REQUIRED) != SHOW_MESSAGE_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for initialize_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, INITIALIZE_PARAMS_FIELD_REQUIRED);
+        LOG("Missing required parameters for show_message_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, SHOW_MESSAGE_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-reference_params_t decode_reference_params(json_t * p_json)
+bool read_log_message_params(json_reader_t * p_reader, log_message_params_t * p_value)
 {
-    reference_params_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_context_json = json_object_get(p_json, "context");
-    if (json_is_object(p_context_json))
-    {
-        retval.context = decode_reference_context(p_context_json);
-        retval.valid_fields |= REFERENCE_PARAMS_FIELD_CONTEXT;
-    }
-
-    json_t * p_text_document_json = json_object_get(p_json, "textDocument");
-    if (json_is_object(p_text_document_json))
-    {
-        retval.text_document = decode_text_document_identifier(p_text_document_json);
-        retval.valid_fields |= REFERENCE_PARAMS_FIELD_TEXT_DOCUMENT;
-    }
+    memset(p_value, 0, sizeof(log_message_params_t));
 
-    json_t * p_position_json = json_object_get(p_json, "position");
-    if (json_is_object(p_position_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.position = decode_position(p_position_json);
-        retval.valid_fields |= REFERENCE_PARAMS_FIELD_POSITION;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "type") == 0)
+            {
+                if (read_message_type(p_reader, &p_value->type))
+                {
+                    p_value->valid_fields |= LOG_MESSAGE_PARAMS_FIELD_TYPE;
+                }
+            }
+            else if (strcmp(p_key, "message") == 0)
+            {
+                if (read_string(p_reader, &p_value->message))
+                {
+                    p_value->valid_fields |= LOG_MESSAGE_PARAMS_FIELD_MESSAGE;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & REFERENCE_PARAMS_FIELD_REQUIRED) != REFERENCE_PARAMS_FIELD_REQUIRED)
+    if ((p_value->valid_fields & LOG_MESSAGE_PARAMS_FIELD_REQUIRED) != LOG_MESSAGE_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for reference_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, REFERENCE_PARAMS_FIELD_REQUIRED);
+        LOG("Missing required parameters for log_message_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, LOG_MESSAGE_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-document_symbol_params_t decode_document_symbol_params(json_t * p_json)
+bool read_publish_diagnostics_params(json_reader_t * p_reader, publish_diagnostics_params_t * p_value)
 {
-    document_symbol_params_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(publish_diagnostics_params_t));
 
-    json_t * p_text_document_json = json_object_get(p_json, "textDocument");
-    if (json_is_object(p_text_document_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.text_document = decode_text_document_identifier(p_text_document_json);
-        retval.valid_fields |= DOCUMENT_SYMBOL_PARAMS_FIELD_TEXT_DOCUMENT;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "uri") == 0)
+            {
+                if (read_uri(p_reader, &p_value->uri))
+                {
+                    p_value->valid_fields |= PUBLISH_DIAGNOSTICS_PARAMS_FIELD_URI;
+                }
+            }
+            else if (strcmp(p_key, "diagnostics") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_diagnostics = read_array_reserve(p_value->p_diagnostics, p_value->diagnostics_count, sizeof(p_value->p_diagnostics[0]));
+                        if (read_diagnostic(p_reader, &p_value->p_diagnostics[p_value->diagnostics_count]))
+                        {
+                            p_value->diagnostics_count++;
+                        }
+                    }
+                    p_value->valid_fields |= PUBLISH_DIAGNOSTICS_PARAMS_FIELD_DIAGNOSTICS;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & DOCUMENT_SYMBOL_PARAMS_FIELD_REQUIRED) != DOCUMENT_SYMBOL_PARAMS_FIELD_REQUIRED)
+    if ((p_value->valid_fields & PUBLISH_DIAGNOSTICS_PARAMS_FIELD_REQUIRED) != PUBLISH_DIAGNOSTICS_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for document_symbol_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, DOCUMENT_SYMBOL_PARAMS_FIELD_REQUIRED);
+        LOG("Missing required parameters for publish_diagnostics_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, PUBLISH_DIAGNOSTICS_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-workspace_symbol_params_t decode_workspace_symbol_params(json_t * p_json)
+
+
+/* Server notification parameter JSON readers */
+bool read_did_open_text_document_params(json_reader_t * p_reader, did_open_text_document_params_t * p_value)
 {
-    workspace_symbol_params_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(did_open_text_document_params_t));
 
-    json_t * p_query_json = json_object_get(p_json, "query");
-    if (json_is_string(p_query_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.query = decode_string(p_query_json);
-        retval.valid_fields |= WORKSPACE_SYMBOL_PARAMS_FIELD_QUERY;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "textDocument") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_document_item(p_reader, &p_value->text_document))
+                {
+                    p_value->valid_fields |= DID_OPEN_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & WORKSPACE_SYMBOL_PARAMS_FIELD_REQUIRED) != WORKSPACE_SYMBOL_PARAMS_FIELD_REQUIRED)
+    if ((p_value->valid_fields & DID_OPEN_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED) != DID_OPEN_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for workspace_symbol_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, WORKSPACE_SYMBOL_PARAMS_FIELD_REQUIRED);
+        LOG("Missing required parameters for did_open_text_document_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, DID_OPEN_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-document_link_params_t decode_document_link_params(json_t * p_json)
+bool read_did_change_text_document_params(json_reader_t * p_reader, did_change_text_document_params_t * p_value)
 {
-    document_link_params_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(did_change_text_document_params_t));
 
-    json_t * p_text_document_json = json_object_get(p_json, "textDocument");
-    if (json_is_object(p_text_document_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.text_document = decode_text_document_identifier(p_text_document_json);
-        retval.valid_fields |= DOCUMENT_LINK_PARAMS_FIELD_TEXT_DOCUMENT;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "textDocument") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_versioned_text_document_identifier(p_reader, &p_value->text_document))
+                {
+                    p_value->valid_fields |= DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT;
+                }
+            }
+            else if (strcmp(p_key, "contentChanges") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_content_changes = read_array_reserve(p_value->p_content_changes, p_value->content_changes_count, sizeof(p_value->p_content_changes[0]));
+                        if (read_text_document_content_change_event(p_reader, &p_value->p_content_changes[p_value->content_changes_count]))
+                        {
+                            p_value->content_changes_count++;
+                        }
+                    }
+                    p_value->valid_fields |= DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_CONTENT_CHANGES;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & DOCUMENT_LINK_PARAMS_FIELD_REQUIRED) != DOCUMENT_LINK_PARAMS_FIELD_REQUIRED)
+    if ((p_value->valid_fields & DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED) != DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for document_link_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, DOCUMENT_LINK_PARAMS_FIELD_REQUIRED);
+        LOG("Missing required parameters for did_change_text_document_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-code_action_params_t decode_code_action_params(json_t * p_json)
+bool read_did_save_text_document_params(json_reader_t * p_reader, did_save_text_document_params_t * p_value)
 {
-    code_action_params_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_text_document_json = json_object_get(p_json, "textDocument");
-    if (json_is_object(p_text_document_json))
-    {
-        retval.text_document = decode_text_document_identifier(p_text_document_json);
-        retval.valid_fields |= CODE_ACTION_PARAMS_FIELD_TEXT_DOCUMENT;
-    }
-
-    json_t * p_range_json = json_object_get(p_json, "range");
-    if (json_is_object(p_range_json))
-    {
-        retval.range = decode_range(p_range_json);
-        retval.valid_fields |= CODE_ACTION_PARAMS_FIELD_RANGE;
-    }
+    memset(p_value, 0, sizeof(did_save_text_document_params_t));
 
-    json_t * p_context_json = json_object_get(p_json, "context");
-    if (json_is_object(p_context_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.context = decode_code_action_context(p_context_json);
-        retval.valid_fields |= CODE_ACTION_PARAMS_FIELD_CONTEXT;
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
+        {
+            if (strcmp(p_key, "textDocument") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_document_identifier(p_reader, &p_value->text_document))
+                {
+                    p_value->valid_fields |= DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT;
+                }
+            }
+            else if (strcmp(p_key, "text") == 0)
+            {
+                if (read_string(p_reader, &p_value->text))
+                {
+                    p_value->valid_fields |= DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
+        }
     }
 
-
-    if ((retval.valid_fields & CODE_ACTION_PARAMS_FIELD_REQUIRED) != CODE_ACTION_PARAMS_FIELD_REQUIRED)
+    if ((p_value->valid_fields & DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED) != DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for code_action_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, CODE_ACTION_PARAMS_FIELD_REQUIRED);
+        LOG("Missing required parameters for did_save_text_document_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-
-
-/* Client command parameter JSON decoders */
-show_message_request_params_t decode_show_message_request_params(json_t * p_json)
+bool read_did_close_text_document_params(json_reader_t * p_reader, did_close_text_document_params_t * p_value)
 {
-    show_message_request_params_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_type_json = json_object_get(p_json, "type");
-    if (json_is_object(p_type_json))
-    {
-        retval.type = decode_message_type(p_type_json);
-        retval.valid_fields |= SHOW_MESSAGE_REQUEST_PARAMS_FIELD_TYPE;
-    }
-
-    json_t * p_message_json = json_object_get(p_json, "message");
-    if (json_is_string(p_message_json))
-    {
-        retval.message = decode_string(p_message_json);
-        retval.valid_fields |= SHOW_MESSAGE_REQUEST_PARAMS_FIELD_MESSAGE;
-    }
+    memset(p_value, 0, sizeof(did_close_text_document_params_t));
 
-    json_t * p_actions_json = json_object_get(p_json, "actions");
-    if (json_is_array(p_actions_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.actions_count = json_array_size(p_actions_json);
-        retval.p_actions = malloc(sizeof(message_action_item_t) * retval.actions_count);
-        ASSERT(retval.p_actions);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_actions_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_actions[index] = decode_message_action_item(p_it);
+            if (strcmp(p_key, "textDocument") == 0)
+            {
+                if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)
+                {
+                    json_reader_skip(p_reader);
+                }
+                else if (read_text_document_identifier(p_reader, &p_value->text_document))
+                {
+                    p_value->valid_fields |= DID_CLOSE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= SHOW_MESSAGE_REQUEST_PARAMS_FIELD_ACTIONS;
     }
 
-
-    if ((retval.valid_fields & SHOW_MESSAGE_REQUEST_PARAMS_FIELD_REQUIRED) != SHOW_MESSAGE_REQUEST_PARAMS_FIELD_REQUIRED)
+    if ((p_value->valid_fields & DID_CLOSE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED) != DID_CLOSE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for show_message_request_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, SHOW_MESSAGE_REQUEST_PARAMS_FIELD_REQUIRED);
+        LOG("Missing required parameters for did_close_text_document_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, DID_CLOSE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
-signature_help_t decode_signature_help(json_t * p_json)
+bool read_did_change_watched_files_params(json_reader_t * p_reader, did_change_watched_files_params_t * p_value)
 {
-    signature_help_t retval;
-    memset(&retval, 0, sizeof(retval));
+    memset(p_value, 0, sizeof(did_change_watched_files_params_t));
 
-    json_t * p_signatures_json = json_object_get(p_json, "signatures");
-    if (json_is_array(p_signatures_json))
+    if (json_reader_object_start(p_reader))
     {
-        retval.signatures_count = json_array_size(p_signatures_json);
-        retval.p_signatures = malloc(sizeof(signature_information_t) * retval.signatures_count);
-        ASSERT(retval.p_signatures);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_signatures_json, index, p_it)
+        const char * p_key;
+        while (json_reader_object_next(p_reader, &p_key))
         {
-            retval.p_signatures[index] = decode_signature_information(p_it);
+            if (strcmp(p_key, "changes") == 0)
+            {
+                if (json_reader_array_start(p_reader))
+                {
+                    while (json_reader_array_next(p_reader))
+                    {
+                        p_value->p_changes = read_array_reserve(p_value->p_changes, p_value->changes_count, sizeof(p_value->p_changes[0]));
+                        if (read_file_event(p_reader, &p_value->p_changes[p_value->changes_count]))
+                        {
+                            p_value->changes_count++;
+                        }
+                    }
+                    p_value->valid_fields |= DID_CHANGE_WATCHED_FILES_PARAMS_FIELD_CHANGES;
+                }
+            }
+            else
+            {
+                json_reader_skip(p_reader);
+            }
         }
-        retval.valid_fields |= SIGNATURE_HELP_FIELD_SIGNATURES;
-    }
-
-    json_t * p_active_signature_json = json_object_get(p_json, "activeSignature");
-    if (json_is_integer(p_active_signature_json))
-    {
-        retval.active_signature = decode_number(p_active_signature_json);
-        retval.valid_fields |= SIGNATURE_HELP_FIELD_ACTIVE_SIGNATURE;
-    }
-
-    json_t * p_active_parameter_json = json_object_get(p_json, "activeParameter");
-    if (json_is_integer(p_active_parameter_json))
-    {
-        retval.active_parameter = decode_number(p_active_parameter_json);
-        retval.valid_fields |= SIGNATURE_HELP_FIELD_ACTIVE_PARAMETER;
     }
 
-
-    if ((retval.valid_fields & SIGNATURE_HELP_FIELD_REQUIRED) != SIGNATURE_HELP_FIELD_REQUIRED)
+    if ((p_value->valid_fields & DID_CHANGE_WATCHED_FILES_PARAMS_FIELD_REQUIRED) != DID_CHANGE_WATCHED_FILES_PARAMS_FIELD_REQUIRED)
     {
         m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for signature_help: Got 0x%x, expected 0x%x\n", retval.valid_fields, SIGNATURE_HELP_FIELD_REQUIRED);
+        LOG("Missing required parameters for did_change_watched_files_params: Got 0x%x, expected 0x%x\n", p_value->valid_fields, DID_CHANGE_WATCHED_FILES_PARAMS_FIELD_REQUIRED);
     }
-    return retval;
+    return !json_reader_error(p_reader);
 }
 
 
-
-/* Command response parameter JSON decoders */
-initialize_result_t decode_initialize_result(json_t * p_json)
+/*******************************************************************************
+ * Releasers
+ ******************************************************************************/
+/* Common parameter structure releasers */
+void release_compilation_database_params(compilation_database_params_t * p_value)
 {
-    initialize_result_t retval;
-    memset(&retval, 0, sizeof(retval));
+    free(p_value->p_additional_arguments);
+}
 
-    json_t * p_capabilities_json = json_object_get(p_json, "capabilities");
-    if (json_is_object(p_capabilities_json))
+void release_initialization_options(initialization_options_t * p_value)
+{
+    free(p_value->p_flags);
+    for (uint32_t i = 0; i < p_value->compilation_database_count; ++i)
     {
-        retval.capabilities = decode_server_capabilities(p_capabilities_json);
-        retval.valid_fields |= INITIALIZE_RESULT_FIELD_CAPABILITIES;
+        release_compilation_database_params(&p_value->p_compilation_database[i]);
     }
+    free(p_value->p_compilation_database);
+}
 
-
-    if ((retval.valid_fields & INITIALIZE_RESULT_FIELD_REQUIRED) != INITIALIZE_RESULT_FIELD_REQUIRED)
-    {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for initialize_result: Got 0x%x, expected 0x%x\n", retval.valid_fields, INITIALIZE_RESULT_FIELD_REQUIRED);
-    }
-    return retval;
+void release_workspace_client_capabilities(workspace_client_capabilities_t * p_value)
+{
 }
 
-symbol_information_t decode_symbol_information(json_t * p_json)
+void release_text_document_client_capabilities(text_document_client_capabilities_t * p_value)
 {
-    symbol_information_t retval;
-    memset(&retval, 0, sizeof(retval));
+    free(p_value->signature_help.signature_information.p_documentation_format);
+}
 
-    json_t * p_name_json = json_object_get(p_json, "name");
-    if (json_is_string(p_name_json))
-    {
-        retval.name = decode_string(p_name_json);
-        retval.valid_fields |= SYMBOL_INFORMATION_FIELD_NAME;
-    }
+void release_client_capabilities(client_capabilities_t * p_value)
+{
+    release_text_document_client_capabilities(&p_value->text_document);
+    json_decref(p_value->experimental);
+}
 
-    json_t * p_kind_json = json_object_get(p_json, "kind");
-    if (json_is_object(p_kind_json))
-    {
-        retval.kind = decode_symbol_kind(p_kind_json);
-        retval.valid_fields |= SYMBOL_INFORMATION_FIELD_KIND;
-    }
+void release_completion_options(completion_options_t * p_value)
+{
+    free(p_value->p_trigger_characters);
+}
 
-    json_t * p_location_json = json_object_get(p_json, "location");
-    if (json_is_object(p_location_json))
-    {
-        retval.location = decode_location(p_location_json);
-        retval.valid_fields |= SYMBOL_INFORMATION_FIELD_LOCATION;
-    }
+void release_signature_help_options(signature_help_options_t * p_value)
+{
+    free(p_value->p_trigger_characters);
+}
 
-    json_t * p_container_name_json = json_object_get(p_json, "containerName");
-    if (json_is_string(p_container_name_json))
-    {
-        retval.container_name = decode_string(p_container_name_json);
-        retval.valid_fields |= SYMBOL_INFORMATION_FIELD_CONTAINER_NAME;
-    }
+void release_code_lens_options(code_lens_options_t * p_value)
+{
+}
 
+void release_save_options(save_options_t * p_value)
+{
+}
 
-    if ((retval.valid_fields & SYMBOL_INFORMATION_FIELD_REQUIRED) != SYMBOL_INFORMATION_FIELD_REQUIRED)
-    {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for symbol_information: Got 0x%x, expected 0x%x\n", retval.valid_fields, SYMBOL_INFORMATION_FIELD_REQUIRED);
-    }
-    return retval;
+void release_text_document_sync_options(text_document_sync_options_t * p_value)
+{
 }
 
-document_link_t decode_document_link(json_t * p_json)
+void release_server_capabilities(server_capabilities_t * p_value)
 {
-    document_link_t retval;
-    memset(&retval, 0, sizeof(retval));
+    release_completion_options(&p_value->completion_provider);
+    release_signature_help_options(&p_value->signature_help_provider);
+}
 
-    json_t * p_range_json = json_object_get(p_json, "range");
-    if (json_is_object(p_range_json))
-    {
-        retval.range = decode_range(p_range_json);
-        retval.valid_fields |= DOCUMENT_LINK_FIELD_RANGE;
-    }
+void release_markup_content(markup_content_t * p_value)
+{
+}
 
-    json_t * p_target_json = json_object_get(p_json, "target");
-    if (json_is_string(p_target_json))
-    {
-        retval.target = decode_uri(p_target_json);
-        retval.valid_fields |= DOCUMENT_LINK_FIELD_TARGET;
-    }
+void release_marked_string(marked_string_t * p_value)
+{
+}
 
+void release_message_action_item(message_action_item_t * p_value)
+{
+}
 
-    if ((retval.valid_fields & DOCUMENT_LINK_FIELD_REQUIRED) != DOCUMENT_LINK_FIELD_REQUIRED)
-    {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for document_link: Got 0x%x, expected 0x%x\n", retval.valid_fields, DOCUMENT_LINK_FIELD_REQUIRED);
-    }
-    return retval;
+void release_position(position_t * p_value)
+{
 }
 
-hover_t decode_hover(json_t * p_json)
+void release_range(range_t * p_value)
 {
-    hover_t retval;
-    memset(&retval, 0, sizeof(retval));
+}
 
-    json_t * p_contents_json = json_object_get(p_json, "contents");
-    if (json_is_object(p_contents_json))
-    {
-        retval.contents = decode_markup_content(p_contents_json);
-        retval.valid_fields |= HOVER_FIELD_CONTENTS;
-    }
+void release_text_edit(text_edit_t * p_value)
+{
+}
 
-    json_t * p_range_json = json_object_get(p_json, "range");
-    if (json_is_object(p_range_json))
-    {
-        retval.range = decode_range(p_range_json);
-        retval.valid_fields |= HOVER_FIELD_RANGE;
-    }
+void release_location(location_t * p_value)
+{
+    release_uri(&p_value->uri);
+}
 
+void release_diagnostic_related_information(diagnostic_related_information_t * p_value)
+{
+    release_location(&p_value->location);
+}
 
-    if ((retval.valid_fields & HOVER_FIELD_REQUIRED) != HOVER_FIELD_REQUIRED)
+void release_diagnostic(diagnostic_t * p_value)
+{
+    for (uint32_t i = 0; i < p_value->related_information_count; ++i)
     {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for hover: Got 0x%x, expected 0x%x\n", retval.valid_fields, HOVER_FIELD_REQUIRED);
+        release_diagnostic_related_information(&p_value->p_related_information[i]);
     }
-    return retval;
+    free(p_value->p_related_information);
 }
 
+void release_text_document_item(text_document_item_t * p_value)
+{
+    release_uri(&p_value->uri);
+}
 
+void release_text_document_content_change_event(text_document_content_change_event_t * p_value)
+{
+}
 
-/* Client notification parameter JSON decoders */
-show_message_params_t decode_show_message_params(json_t * p_json)
+void release_text_document_identifier(text_document_identifier_t * p_value)
 {
-    show_message_params_t retval;
-    memset(&retval, 0, sizeof(retval));
+    release_uri(&p_value->uri);
+}
 
-    json_t * p_type_json = json_object_get(p_json, "type");
-    if (json_is_object(p_type_json))
-    {
-        retval.type = decode_message_type(p_type_json);
-        retval.valid_fields |= SHOW_MESSAGE_PARAMS_FIELD_TYPE;
-    }
+void release_versioned_text_document_identifier(versioned_text_document_identifier_t * p_value)
+{
+    release_uri(&p_value->uri);
+}
 
-    json_t * p_message_json = json_object_get(p_json, "message");
-    if (json_is_string(p_message_json))
-    {
-        retval.message = decode_string(p_message_json);
-        retval.valid_fields |= SHOW_MESSAGE_PARAMS_FIELD_MESSAGE;
-    }
+void release_file_event(file_event_t * p_value)
+{
+    release_uri(&p_value->uri);
+}
 
+void release_text_document_position_params(text_document_position_params_t * p_value)
+{
+    release_text_document_identifier(&p_value->text_document);
+}
 
-    if ((retval.valid_fields & SHOW_MESSAGE_PARAMS_FIELD_REQUIRED) != SHOW_MESSAGE_PARAMS_FIELD_REQUIRED)
-    {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for show_message_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, SHOW_MESSAGE_PARAMS_FIELD_REQUIRED);
-    }
-    return retval;
+void release_command(command_t * p_value)
+{
+    json_decref(p_value->arguments);
 }
 
-log_message_params_t decode_log_message_params(json_t * p_json)
+void release_completion_item(completion_item_t * p_value)
 {
-    log_message_params_t retval;
-    memset(&retval, 0, sizeof(retval));
+    free(p_value->p_additional_text_edits);
+    free(p_value->p_commit_characters);
+    release_command(&p_value->command);
+    json_decref(p_value->data);
+}
 
-    json_t * p_type_json = json_object_get(p_json, "type");
-    if (json_is_object(p_type_json))
-    {
-        retval.type = decode_message_type(p_type_json);
-        retval.valid_fields |= LOG_MESSAGE_PARAMS_FIELD_TYPE;
-    }
+void release_parameter_information(parameter_information_t * p_value)
+{
+}
 
-    json_t * p_message_json = json_object_get(p_json, "message");
-    if (json_is_string(p_message_json))
-    {
-        retval.message = decode_string(p_message_json);
-        retval.valid_fields |= LOG_MESSAGE_PARAMS_FIELD_MESSAGE;
-    }
+void release_signature_information(signature_information_t * p_value)
+{
+    free(p_value->p_parameters);
+}
 
+void release_reference_context(reference_context_t * p_value)
+{
+}
 
-    if ((retval.valid_fields & LOG_MESSAGE_PARAMS_FIELD_REQUIRED) != LOG_MESSAGE_PARAMS_FIELD_REQUIRED)
+void release_completion_list(completion_list_t * p_value)
+{
+    for (uint32_t i = 0; i < p_value->items_count; ++i)
     {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for log_message_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, LOG_MESSAGE_PARAMS_FIELD_REQUIRED);
+        release_completion_item(&p_value->p_items[i]);
     }
-    return retval;
+    free(p_value->p_items);
 }
 
-publish_diagnostics_params_t decode_publish_diagnostics_params(json_t * p_json)
+void release_code_action_context(code_action_context_t * p_value)
 {
-    publish_diagnostics_params_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_uri_json = json_object_get(p_json, "uri");
-    if (json_is_string(p_uri_json))
+    for (uint32_t i = 0; i < p_value->diagnostics_count; ++i)
     {
-        retval.uri = decode_uri(p_uri_json);
-        retval.valid_fields |= PUBLISH_DIAGNOSTICS_PARAMS_FIELD_URI;
+        release_diagnostic(&p_value->p_diagnostics[i]);
     }
+    free(p_value->p_diagnostics);
+}
 
-    json_t * p_diagnostics_json = json_object_get(p_json, "diagnostics");
-    if (json_is_array(p_diagnostics_json))
-    {
-        retval.diagnostics_count = json_array_size(p_diagnostics_json);
-        retval.p_diagnostics = malloc(sizeof(diagnostic_t) * retval.diagnostics_count);
-        ASSERT(retval.p_diagnostics);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_diagnostics_json, index, p_it)
-        {
-            retval.p_diagnostics[index] = decode_diagnostic(p_it);
-        }
-        retval.valid_fields |= PUBLISH_DIAGNOSTICS_PARAMS_FIELD_DIAGNOSTICS;
-    }
 
+/* Server command parameter structure releasers */
+void release_initialize_params(initialize_params_t * p_value)
+{
+    release_uri(&p_value->root_uri);
+    release_client_capabilities(&p_value->capabilities);
+    release_initialization_options(&p_value->initialization_options);
+}
 
-    if ((retval.valid_fields & PUBLISH_DIAGNOSTICS_PARAMS_FIELD_REQUIRED) != PUBLISH_DIAGNOSTICS_PARAMS_FIELD_REQUIRED)
-    {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for publish_diagnostics_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, PUBLISH_DIAGNOSTICS_PARAMS_FIELD_REQUIRED);
-    }
-    return retval;
+void release_reference_params(reference_params_t * p_value)
+{
+    release_text_document_identifier(&p_value->text_document);
 }
 
+void release_document_symbol_params(document_symbol_params_t * p_value)
+{
+    release_text_document_identifier(&p_value->text_document);
+}
 
+void release_workspace_symbol_params(workspace_symbol_params_t * p_value)
+{
+}
 
-/* Server notification parameter JSON decoders */
-did_open_text_document_params_t decode_did_open_text_document_params(json_t * p_json)
+void release_document_link_params(document_link_params_t * p_value)
 {
-    did_open_text_document_params_t retval;
-    memset(&retval, 0, sizeof(retval));
+    release_text_document_identifier(&p_value->text_document);
+}
 
-    json_t * p_text_document_json = json_object_get(p_json, "textDocument");
-    if (json_is_object(p_text_document_json))
-    {
-        retval.text_document = decode_text_document_item(p_text_document_json);
-        retval.valid_fields |= DID_OPEN_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT;
-    }
+void release_code_action_params(code_action_params_t * p_value)
+{
+    release_text_document_identifier(&p_value->text_document);
+    release_code_action_context(&p_value->context);
+}
 
 
-    if ((retval.valid_fields & DID_OPEN_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED) != DID_OPEN_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED)
-    {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for did_open_text_document_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, DID_OPEN_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED);
-    }
-    return retval;
+/* Client command parameter structure releasers */
+void release_show_message_request_params(show_message_request_params_t * p_value)
+{
+    free(p_value->p_actions);
 }
 
-did_change_text_document_params_t decode_did_change_text_document_params(json_t * p_json)
+void release_signature_help(signature_help_t * p_value)
 {
-    did_change_text_document_params_t retval;
-    memset(&retval, 0, sizeof(retval));
-
-    json_t * p_text_document_json = json_object_get(p_json, "textDocument");
-    if (json_is_object(p_text_document_json))
-    {
-        retval.text_document = decode_versioned_text_document_identifier(p_text_document_json);
-        retval.valid_fields |= DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT;
-    }
-
-    json_t * p_content_changes_json = json_object_get(p_json, "contentChanges");
-    if (json_is_array(p_content_changes_json))
+    for (uint32_t i = 0; i < p_value->signatures_count; ++i)
     {
-        retval.content_changes_count = json_array_size(p_content_changes_json);
-        retval.p_content_changes = malloc(sizeof(text_document_content_change_event_t) * retval.content_changes_count);
-        ASSERT(retval.p_content_changes);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_content_changes_json, index, p_it)
-        {
-            retval.p_content_changes[index] = decode_text_document_content_change_event(p_it);
-        }
-        retval.valid_fields |= DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_CONTENT_CHANGES;
+        release_signature_information(&p_value->p_signatures[i]);
     }
+    free(p_value->p_signatures);
+}
 
 
-    if ((retval.valid_fields & DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED) != DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED)
-    {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for did_change_text_document_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED);
-    }
-    return retval;
+/* Command response parameter structure releasers */
+void release_initialize_result(initialize_result_t * p_value)
+{
+    release_server_capabilities(&p_value->capabilities);
 }
 
-did_save_text_document_params_t decode_did_save_text_document_params(json_t * p_json)
+void release_symbol_information(symbol_information_t * p_value)
 {
-    did_save_text_document_params_t retval;
-    memset(&retval, 0, sizeof(retval));
+    release_location(&p_value->location);
+}
 
-    json_t * p_text_document_json = json_object_get(p_json, "textDocument");
-    if (json_is_object(p_text_document_json))
-    {
-        retval.text_document = decode_text_document_identifier(p_text_document_json);
-        retval.valid_fields |= DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT;
-    }
+void release_document_link(document_link_t * p_value)
+{
+    release_uri(&p_value->target);
+}
 
-    json_t * p_text_json = json_object_get(p_json, "text");
-    if (json_is_string(p_text_json))
-    {
-        retval.text = decode_string(p_text_json);
-        retval.valid_fields |= DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT;
-    }
+void release_hover(hover_t * p_value)
+{
+}
 
 
-    if ((retval.valid_fields & DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED) != DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED)
-    {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for did_save_text_document_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED);
-    }
-    return retval;
+/* Client notification parameter structure releasers */
+void release_show_message_params(show_message_params_t * p_value)
+{
 }
 
-did_close_text_document_params_t decode_did_close_text_document_params(json_t * p_json)
+void release_log_message_params(log_message_params_t * p_value)
 {
-    did_close_text_document_params_t retval;
-    memset(&retval, 0, sizeof(retval));
+}
 
-    json_t * p_text_document_json = json_object_get(p_json, "textDocument");
-    if (json_is_object(p_text_document_json))
+void release_publish_diagnostics_params(publish_diagnostics_params_t * p_value)
+{
+    release_uri(&p_value->uri);
+    for (uint32_t i = 0; i < p_value->diagnostics_count; ++i)
     {
-        retval.text_document = decode_text_document_identifier(p_text_document_json);
-        retval.valid_fields |= DID_CLOSE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT;
+        release_diagnostic(&p_value->p_diagnostics[i]);
     }
+    free(p_value->p_diagnostics);
+}
 
 
-    if ((retval.valid_fields & DID_CLOSE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED) != DID_CLOSE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED)
-    {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for did_close_text_document_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, DID_CLOSE_TEXT_DOCUMENT_PARAMS_FIELD_REQUIRED);
-    }
-    return retval;
+/* Server notification parameter structure releasers */
+void release_did_open_text_document_params(did_open_text_document_params_t * p_value)
+{
+    release_text_document_item(&p_value->text_document);
 }
 
-did_change_watched_files_params_t decode_did_change_watched_files_params(json_t * p_json)
+void release_did_change_text_document_params(did_change_text_document_params_t * p_value)
 {
-    did_change_watched_files_params_t retval;
-    memset(&retval, 0, sizeof(retval));
+    release_versioned_text_document_identifier(&p_value->text_document);
+    free(p_value->p_content_changes);
+}
 
-    json_t * p_changes_json = json_object_get(p_json, "changes");
-    if (json_is_array(p_changes_json))
-    {
-        retval.changes_count = json_array_size(p_changes_json);
-        retval.p_changes = malloc(sizeof(file_event_t) * retval.changes_count);
-        ASSERT(retval.p_changes);
-        json_t * p_it;
-        uint32_t index;
-        json_array_foreach(p_changes_json, index, p_it)
-        {
-            retval.p_changes[index] = decode_file_event(p_it);
-        }
-        retval.valid_fields |= DID_CHANGE_WATCHED_FILES_PARAMS_FIELD_CHANGES;
-    }
+void release_did_save_text_document_params(did_save_text_document_params_t * p_value)
+{
+    release_text_document_identifier(&p_value->text_document);
+}
 
+void release_did_close_text_document_params(did_close_text_document_params_t * p_value)
+{
+    release_text_document_identifier(&p_value->text_document);
+}
 
-    if ((retval.valid_fields & DID_CHANGE_WATCHED_FILES_PARAMS_FIELD_REQUIRED) != DID_CHANGE_WATCHED_FILES_PARAMS_FIELD_REQUIRED)
+void release_did_change_watched_files_params(did_change_watched_files_params_t * p_value)
+{
+    for (uint32_t i = 0; i < p_value->changes_count; ++i)
     {
-        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;
-        LOG("Missing required parameters for did_change_watched_files_params: Got 0x%x, expected 0x%x\n", retval.valid_fields, DID_CHANGE_WATCHED_FILES_PARAMS_FIELD_REQUIRED);
+        release_file_event(&p_value->p_changes[i]);
     }
-    return retval;
+    free(p_value->p_changes);
 }
 
-
 /*******************************************************************************
  * Freers
  ******************************************************************************/
@@ -52,6 +52,16 @@ json_t * encode_initialization_options(initialization_options_t value)
         }
         json_object_set_new(p_json, "compilationDatabase", p_compilation_database_json);
     }
+
+    if (value.valid_fields & INITIALIZATION_OPTIONS_FIELD_WORKER_THREADS)
+    {
+        json_object_set_new(p_json, "workerThreads", encode_number(value.worker_threads));
+    }
+
+    if (value.valid_fields & INITIALIZATION_OPTIONS_FIELD_MEMORY_BUDGET)
+    {
+        json_object_set_new(p_json, "memoryBudget", encode_number(value.memory_budget));
+    }
     return p_json;
 }
 
@@ -1212,4 +1222,1407 @@ json_t * encode_did_change_watched_files_params(did_change_watched_files_params_
         json_object_set_new(p_json, "changes", p_changes_json);
     }
     return p_json;
+}
+
+/* Common parameter JSON writers */
+void write_compilation_database_params(json_writer_t * p_writer, const compilation_database_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & COMPILATION_DATABASE_PARAMS_FIELD_PATH)
+    {
+        json_writer_key(p_writer, "path");
+        write_string(p_writer, p_value->path);
+    }
+
+    if (p_value->valid_fields & COMPILATION_DATABASE_PARAMS_FIELD_ADDITIONAL_ARGUMENTS)
+    {
+        json_writer_key(p_writer, "additionalArguments");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->additional_arguments_count; ++i)
+        {
+            write_string(p_writer, p_value->p_additional_arguments[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_initialization_options(json_writer_t * p_writer, const initialization_options_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & INITIALIZATION_OPTIONS_FIELD_FLAGS)
+    {
+        json_writer_key(p_writer, "flags");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->flags_count; ++i)
+        {
+            write_string(p_writer, p_value->p_flags[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+
+    if (p_value->valid_fields & INITIALIZATION_OPTIONS_FIELD_COMPILATION_DATABASE)
+    {
+        json_writer_key(p_writer, "compilationDatabase");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->compilation_database_count; ++i)
+        {
+            write_compilation_database_params(p_writer, &p_value->p_compilation_database[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+
+    if (p_value->valid_fields & INITIALIZATION_OPTIONS_FIELD_WORKER_THREADS)
+    {
+        json_writer_key(p_writer, "workerThreads");
+        write_number(p_writer, p_value->worker_threads);
+    }
+
+    if (p_value->valid_fields & INITIALIZATION_OPTIONS_FIELD_MEMORY_BUDGET)
+    {
+        json_writer_key(p_writer, "memoryBudget");
+        write_number(p_writer, p_value->memory_budget);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_workspace_client_capabilities(json_writer_t * p_writer, const workspace_client_capabilities_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & WORKSPACE_CLIENT_CAPABILITIES_FIELD_APPLY_EDIT)
+    {
+        json_writer_key(p_writer, "applyEdit");
+        write_boolean(p_writer, p_value->apply_edit);
+    }
+
+    if (p_value->valid_fields & WORKSPACE_CLIENT_CAPABILITIES_FIELD_WORKSPACE_EDIT)
+    {
+        json_writer_key(p_writer, "workspaceEdit");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->workspace_edit.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & WORKSPACE_CLIENT_CAPABILITIES_FIELD_DID_CHANGE_CONFIGURATION)
+    {
+        json_writer_key(p_writer, "didChangeConfiguration");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->did_change_configuration.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & WORKSPACE_CLIENT_CAPABILITIES_FIELD_DID_CHANGE_WATCHED_FILES)
+    {
+        json_writer_key(p_writer, "didChangeWatchedFiles");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->did_change_watched_files.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & WORKSPACE_CLIENT_CAPABILITIES_FIELD_SYMBOL)
+    {
+        json_writer_key(p_writer, "symbol");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->symbol.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & WORKSPACE_CLIENT_CAPABILITIES_FIELD_EXECUTE_COMMAND)
+    {
+        json_writer_key(p_writer, "executeCommand");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->execute_command.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_text_document_client_capabilities(json_writer_t * p_writer, const text_document_client_capabilities_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_SYNCHRONIZATION)
+    {
+        json_writer_key(p_writer, "synchronization");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->synchronization.dynamic_registration);
+        json_writer_key(p_writer, "willSave");
+        write_boolean(p_writer, p_value->synchronization.will_save);
+        json_writer_key(p_writer, "willSaveWaitUntil");
+        write_boolean(p_writer, p_value->synchronization.will_save_wait_until);
+        json_writer_key(p_writer, "didSave");
+        write_boolean(p_writer, p_value->synchronization.did_save);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_COMPLETION)
+    {
+        json_writer_key(p_writer, "completion");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "snippetSupport");
+        write_boolean(p_writer, p_value->completion.snippet_support);
+        json_writer_key(p_writer, "commitCharactersSupport");
+        write_boolean(p_writer, p_value->completion.commit_characters_support);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_HOVER)
+    {
+        json_writer_key(p_writer, "hover");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->hover.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_SIGNATURE_HELP)
+    {
+        json_writer_key(p_writer, "signatureHelp");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->signature_help.dynamic_registration);
+        json_writer_key(p_writer, "signatureInformation");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "documentationFormat");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->signature_help.signature_information.documentation_format_count; ++i)
+        {
+            write_string(p_writer, p_value->signature_help.signature_information.p_documentation_format[i]);
+        }
+        json_writer_array_end(p_writer);
+        json_writer_object_end(p_writer);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_REFERENCES)
+    {
+        json_writer_key(p_writer, "references");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->references.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DOCUMENT_HIGHLIGHT)
+    {
+        json_writer_key(p_writer, "documentHighlight");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->document_highlight.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DOCUMENT_SYMBOL)
+    {
+        json_writer_key(p_writer, "documentSymbol");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->document_symbol.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_FORMATTING)
+    {
+        json_writer_key(p_writer, "formatting");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->formatting.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_ON_TYPE_FORMATTING)
+    {
+        json_writer_key(p_writer, "onTypeFormatting");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->on_type_formatting.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DEFINITION)
+    {
+        json_writer_key(p_writer, "definition");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->definition.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_CODE_ACTION)
+    {
+        json_writer_key(p_writer, "codeAction");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->code_action.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_CODE_LENS)
+    {
+        json_writer_key(p_writer, "codeLens");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->code_lens.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_DOCUMENT_LINK)
+    {
+        json_writer_key(p_writer, "documentLink");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->document_link.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CLIENT_CAPABILITIES_FIELD_RENAME)
+    {
+        json_writer_key(p_writer, "rename");
+        json_writer_object_start(p_writer);
+        json_writer_key(p_writer, "dynamicRegistration");
+        write_boolean(p_writer, p_value->rename.dynamic_registration);
+        json_writer_object_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_client_capabilities(json_writer_t * p_writer, const client_capabilities_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & CLIENT_CAPABILITIES_FIELD_WORKSPACE)
+    {
+        json_writer_key(p_writer, "workspace");
+        write_workspace_client_capabilities(p_writer, &p_value->workspace);
+    }
+
+    if (p_value->valid_fields & CLIENT_CAPABILITIES_FIELD_TEXT_DOCUMENT)
+    {
+        json_writer_key(p_writer, "textDocument");
+        write_text_document_client_capabilities(p_writer, &p_value->text_document);
+    }
+
+    if (p_value->valid_fields & CLIENT_CAPABILITIES_FIELD_EXPERIMENTAL)
+    {
+        json_writer_key(p_writer, "experimental");
+        json_writer_json(p_writer, p_value->experimental);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_completion_options(json_writer_t * p_writer, const completion_options_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & COMPLETION_OPTIONS_FIELD_RESOLVE_PROVIDER)
+    {
+        json_writer_key(p_writer, "resolveProvider");
+        write_boolean(p_writer, p_value->resolve_provider);
+    }
+
+    if (p_value->valid_fields & COMPLETION_OPTIONS_FIELD_TRIGGER_CHARACTERS)
+    {
+        json_writer_key(p_writer, "triggerCharacters");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->trigger_characters_count; ++i)
+        {
+            write_string(p_writer, p_value->p_trigger_characters[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_signature_help_options(json_writer_t * p_writer, const signature_help_options_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & SIGNATURE_HELP_OPTIONS_FIELD_TRIGGER_CHARACTERS)
+    {
+        json_writer_key(p_writer, "triggerCharacters");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->trigger_characters_count; ++i)
+        {
+            write_string(p_writer, p_value->p_trigger_characters[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_code_lens_options(json_writer_t * p_writer, const code_lens_options_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & CODE_LENS_OPTIONS_FIELD_RESOLVE_PROVIDER)
+    {
+        json_writer_key(p_writer, "resolveProvider");
+        write_boolean(p_writer, p_value->resolve_provider);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_save_options(json_writer_t * p_writer, const save_options_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & SAVE_OPTIONS_FIELD_INCLUDE_TEXT)
+    {
+        json_writer_key(p_writer, "includeText");
+        write_boolean(p_writer, p_value->include_text);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_text_document_sync_options(json_writer_t * p_writer, const text_document_sync_options_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_OPEN_CLOSE)
+    {
+        json_writer_key(p_writer, "openClose");
+        write_boolean(p_writer, p_value->open_close);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_CHANGE)
+    {
+        json_writer_key(p_writer, "change");
+        write_text_document_sync_kind(p_writer, p_value->change);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_WILL_SAVE)
+    {
+        json_writer_key(p_writer, "willSave");
+        write_boolean(p_writer, p_value->will_save);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_WILL_SAVE_WAIT_UNTIL)
+    {
+        json_writer_key(p_writer, "willSaveWaitUntil");
+        write_boolean(p_writer, p_value->will_save_wait_until);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_SYNC_OPTIONS_FIELD_SAVE)
+    {
+        json_writer_key(p_writer, "save");
+        write_save_options(p_writer, &p_value->save);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_server_capabilities(json_writer_t * p_writer, const server_capabilities_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_TEXT_DOCUMENT_SYNC)
+    {
+        json_writer_key(p_writer, "textDocumentSync");
+        write_text_document_sync_options(p_writer, &p_value->text_document_sync);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_HOVER_PROVIDER)
+    {
+        json_writer_key(p_writer, "hoverProvider");
+        write_boolean(p_writer, p_value->hover_provider);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_COMPLETION_PROVIDER)
+    {
+        json_writer_key(p_writer, "completionProvider");
+        write_completion_options(p_writer, &p_value->completion_provider);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_SIGNATURE_HELP_PROVIDER)
+    {
+        json_writer_key(p_writer, "signatureHelpProvider");
+        write_signature_help_options(p_writer, &p_value->signature_help_provider);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_DEFINITION_PROVIDER)
+    {
+        json_writer_key(p_writer, "definitionProvider");
+        write_boolean(p_writer, p_value->definition_provider);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_REFERENCES_PROVIDER)
+    {
+        json_writer_key(p_writer, "referencesProvider");
+        write_boolean(p_writer, p_value->references_provider);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_DOCUMENT_HIGHLIGHT_PROVIDER)
+    {
+        json_writer_key(p_writer, "documentHighlightProvider");
+        write_boolean(p_writer, p_value->document_highlight_provider);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_DOCUMENT_SYMBOL_PROVIDER)
+    {
+        json_writer_key(p_writer, "documentSymbolProvider");
+        write_boolean(p_writer, p_value->document_symbol_provider);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_WORKSPACE_SYMBOL_PROVIDER)
+    {
+        json_writer_key(p_writer, "workspaceSymbolProvider");
+        write_boolean(p_writer, p_value->workspace_symbol_provider);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_CODE_ACTION_PROVIDER)
+    {
+        json_writer_key(p_writer, "codeActionProvider");
+        write_boolean(p_writer, p_value->code_action_provider);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_CODE_LENS_PROVIDER)
+    {
+        json_writer_key(p_writer, "codeLensProvider");
+        write_code_lens_options(p_writer, &p_value->code_lens_provider);
+    }
+
+    if (p_value->valid_fields & SERVER_CAPABILITIES_FIELD_DOCUMENT_FORMATTING_PROVIDER)
+    {
+        json_writer_key(p_writer, "documentFormattingProvider");
+        write_boolean(p_writer, p_value->document_formatting_provider);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_markup_content(json_writer_t * p_writer, const markup_content_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & MARKUP_CONTENT_FIELD_KIND)
+    {
+        json_writer_key(p_writer, "kind");
+        write_string(p_writer, p_value->kind);
+    }
+
+    if (p_value->valid_fields & MARKUP_CONTENT_FIELD_VALUE)
+    {
+        json_writer_key(p_writer, "value");
+        write_string(p_writer, p_value->value);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_marked_string(json_writer_t * p_writer, const marked_string_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & MARKED_STRING_FIELD_LANGUAGE)
+    {
+        json_writer_key(p_writer, "language");
+        write_string(p_writer, p_value->language);
+    }
+
+    if (p_value->valid_fields & MARKED_STRING_FIELD_VALUE)
+    {
+        json_writer_key(p_writer, "value");
+        write_string(p_writer, p_value->value);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_message_action_item(json_writer_t * p_writer, const message_action_item_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & MESSAGE_ACTION_ITEM_FIELD_TITLE)
+    {
+        json_writer_key(p_writer, "title");
+        write_string(p_writer, p_value->title);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_position(json_writer_t * p_writer, const position_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & POSITION_FIELD_LINE)
+    {
+        json_writer_key(p_writer, "line");
+        write_number(p_writer, p_value->line);
+    }
+
+    if (p_value->valid_fields & POSITION_FIELD_CHARACTER)
+    {
+        json_writer_key(p_writer, "character");
+        write_number(p_writer, p_value->character);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_range(json_writer_t * p_writer, const range_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & RANGE_FIELD_START)
+    {
+        json_writer_key(p_writer, "start");
+        write_position(p_writer, &p_value->start);
+    }
+
+    if (p_value->valid_fields & RANGE_FIELD_END)
+    {
+        json_writer_key(p_writer, "end");
+        write_position(p_writer, &p_value->end);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_text_edit(json_writer_t * p_writer, const text_edit_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & TEXT_EDIT_FIELD_RANGE)
+    {
+        json_writer_key(p_writer, "range");
+        write_range(p_writer, &p_value->range);
+    }
+
+    if (p_value->valid_fields & TEXT_EDIT_FIELD_NEW_TEXT)
+    {
+        json_writer_key(p_writer, "newText");
+        write_string(p_writer, p_value->new_text);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_location(json_writer_t * p_writer, const location_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & LOCATION_FIELD_URI)
+    {
+        json_writer_key(p_writer, "uri");
+        write_uri(p_writer, p_value->uri);
+    }
+
+    if (p_value->valid_fields & LOCATION_FIELD_RANGE)
+    {
+        json_writer_key(p_writer, "range");
+        write_range(p_writer, &p_value->range);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_diagnostic_related_information(json_writer_t * p_writer, const diagnostic_related_information_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & DIAGNOSTIC_RELATED_INFORMATION_FIELD_LOCATION)
+    {
+        json_writer_key(p_writer, "location");
+        write_location(p_writer, &p_value->location);
+    }
+
+    if (p_value->valid_fields & DIAGNOSTIC_RELATED_INFORMATION_FIELD_MESSAGE)
+    {
+        json_writer_key(p_writer, "message");
+        write_string(p_writer, p_value->message);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_diagnostic(json_writer_t * p_writer, const diagnostic_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & DIAGNOSTIC_FIELD_RANGE)
+    {
+        json_writer_key(p_writer, "range");
+        write_range(p_writer, &p_value->range);
+    }
+
+    if (p_value->valid_fields & DIAGNOSTIC_FIELD_SEVERITY)
+    {
+        json_writer_key(p_writer, "severity");
+        write_diagnostic_severity(p_writer, p_value->severity);
+    }
+
+    if (p_value->valid_fields & DIAGNOSTIC_FIELD_CODE)
+    {
+        json_writer_key(p_writer, "code");
+        write_number(p_writer, p_value->code);
+    }
+
+    if (p_value->valid_fields & DIAGNOSTIC_FIELD_SOURCE)
+    {
+        json_writer_key(p_writer, "source");
+        write_string(p_writer, p_value->source);
+    }
+
+    if (p_value->valid_fields & DIAGNOSTIC_FIELD_MESSAGE)
+    {
+        json_writer_key(p_writer, "message");
+        write_string(p_writer, p_value->message);
+    }
+
+    if (p_value->valid_fields & DIAGNOSTIC_FIELD_RELATED_INFORMATION)
+    {
+        json_writer_key(p_writer, "relatedInformation");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->related_information_count; ++i)
+        {
+            write_diagnostic_related_information(p_writer, &p_value->p_related_information[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_text_document_item(json_writer_t * p_writer, const text_document_item_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_ITEM_FIELD_URI)
+    {
+        json_writer_key(p_writer, "uri");
+        write_uri(p_writer, p_value->uri);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_ITEM_FIELD_LANGUAGE_ID)
+    {
+        json_writer_key(p_writer, "languageId");
+        write_string(p_writer, p_value->language_id);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_ITEM_FIELD_VERSION)
+    {
+        json_writer_key(p_writer, "version");
+        write_number(p_writer, p_value->version);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_ITEM_FIELD_TEXT)
+    {
+        json_writer_key(p_writer, "text");
+        write_string(p_writer, p_value->text);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_text_document_content_change_event(json_writer_t * p_writer, const text_document_content_change_event_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_RANGE)
+    {
+        json_writer_key(p_writer, "range");
+        write_range(p_writer, &p_value->range);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_RANGE_LENGTH)
+    {
+        json_writer_key(p_writer, "rangeLength");
+        write_number(p_writer, p_value->range_length);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_CONTENT_CHANGE_EVENT_FIELD_TEXT)
+    {
+        json_writer_key(p_writer, "text");
+        write_string(p_writer, p_value->text);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_text_document_identifier(json_writer_t * p_writer, const text_document_identifier_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_IDENTIFIER_FIELD_URI)
+    {
+        json_writer_key(p_writer, "uri");
+        write_uri(p_writer, p_value->uri);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_versioned_text_document_identifier(json_writer_t * p_writer, const versioned_text_document_identifier_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_URI)
+    {
+        json_writer_key(p_writer, "uri");
+        write_uri(p_writer, p_value->uri);
+    }
+
+    if (p_value->valid_fields & VERSIONED_TEXT_DOCUMENT_IDENTIFIER_FIELD_VERSION)
+    {
+        json_writer_key(p_writer, "version");
+        write_number(p_writer, p_value->version);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_file_event(json_writer_t * p_writer, const file_event_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & FILE_EVENT_FIELD_URI)
+    {
+        json_writer_key(p_writer, "uri");
+        write_uri(p_writer, p_value->uri);
+    }
+
+    if (p_value->valid_fields & FILE_EVENT_FIELD_TYPE)
+    {
+        json_writer_key(p_writer, "type");
+        write_file_change_type(p_writer, p_value->type);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_text_document_position_params(json_writer_t * p_writer, const text_document_position_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_POSITION_PARAMS_FIELD_TEXT_DOCUMENT)
+    {
+        json_writer_key(p_writer, "textDocument");
+        write_text_document_identifier(p_writer, &p_value->text_document);
+    }
+
+    if (p_value->valid_fields & TEXT_DOCUMENT_POSITION_PARAMS_FIELD_POSITION)
+    {
+        json_writer_key(p_writer, "position");
+        write_position(p_writer, &p_value->position);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_command(json_writer_t * p_writer, const command_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & COMMAND_FIELD_TITLE)
+    {
+        json_writer_key(p_writer, "title");
+        write_string(p_writer, p_value->title);
+    }
+
+    if (p_value->valid_fields & COMMAND_FIELD_COMMAND)
+    {
+        json_writer_key(p_writer, "command");
+        write_string(p_writer, p_value->command);
+    }
+
+    if (p_value->valid_fields & COMMAND_FIELD_ARGUMENTS)
+    {
+        json_writer_key(p_writer, "arguments");
+        json_writer_json(p_writer, p_value->arguments);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_completion_item(json_writer_t * p_writer, const completion_item_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_LABEL)
+    {
+        json_writer_key(p_writer, "label");
+        write_string(p_writer, p_value->label);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_KIND)
+    {
+        json_writer_key(p_writer, "kind");
+        write_completion_item_kind(p_writer, p_value->kind);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_DETAIL)
+    {
+        json_writer_key(p_writer, "detail");
+        write_string(p_writer, p_value->detail);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_DOCUMENTATION)
+    {
+        json_writer_key(p_writer, "documentation");
+        write_markup_content(p_writer, &p_value->documentation);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_SORT_TEXT)
+    {
+        json_writer_key(p_writer, "sortText");
+        write_string(p_writer, p_value->sort_text);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_FILTER_TEXT)
+    {
+        json_writer_key(p_writer, "filterText");
+        write_string(p_writer, p_value->filter_text);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_INSERT_TEXT)
+    {
+        json_writer_key(p_writer, "insertText");
+        write_string(p_writer, p_value->insert_text);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_INSERT_TEXT_FORMAT)
+    {
+        json_writer_key(p_writer, "insertTextFormat");
+        write_insert_text_format(p_writer, p_value->insert_text_format);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_TEXT_EDIT)
+    {
+        json_writer_key(p_writer, "textEdit");
+        write_text_edit(p_writer, &p_value->text_edit);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_ADDITIONAL_TEXT_EDITS)
+    {
+        json_writer_key(p_writer, "additionalTextEdits");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->additional_text_edits_count; ++i)
+        {
+            write_text_edit(p_writer, &p_value->p_additional_text_edits[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_COMMIT_CHARACTERS)
+    {
+        json_writer_key(p_writer, "commitCharacters");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->commit_characters_count; ++i)
+        {
+            write_string(p_writer, p_value->p_commit_characters[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_COMMAND)
+    {
+        json_writer_key(p_writer, "command");
+        write_command(p_writer, &p_value->command);
+    }
+
+    if (p_value->valid_fields & COMPLETION_ITEM_FIELD_DATA)
+    {
+        json_writer_key(p_writer, "data");
+        json_writer_json(p_writer, p_value->data);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_parameter_information(json_writer_t * p_writer, const parameter_information_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & PARAMETER_INFORMATION_FIELD_LABEL)
+    {
+        json_writer_key(p_writer, "label");
+        write_string(p_writer, p_value->label);
+    }
+
+    if (p_value->valid_fields & PARAMETER_INFORMATION_FIELD_DOCUMENTATION)
+    {
+        json_writer_key(p_writer, "documentation");
+        write_markup_content(p_writer, &p_value->documentation);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_signature_information(json_writer_t * p_writer, const signature_information_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & SIGNATURE_INFORMATION_FIELD_LABEL)
+    {
+        json_writer_key(p_writer, "label");
+        write_string(p_writer, p_value->label);
+    }
+
+    if (p_value->valid_fields & SIGNATURE_INFORMATION_FIELD_DOCUMENTATION)
+    {
+        json_writer_key(p_writer, "documentation");
+        write_markup_content(p_writer, &p_value->documentation);
+    }
+
+    if (p_value->valid_fields & SIGNATURE_INFORMATION_FIELD_PARAMETERS)
+    {
+        json_writer_key(p_writer, "parameters");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->parameters_count; ++i)
+        {
+            write_parameter_information(p_writer, &p_value->p_parameters[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_reference_context(json_writer_t * p_writer, const reference_context_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & REFERENCE_CONTEXT_FIELD_INCLUDE_DECLARATION)
+    {
+        json_writer_key(p_writer, "includeDeclaration");
+        write_boolean(p_writer, p_value->include_declaration);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_completion_list(json_writer_t * p_writer, const completion_list_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & COMPLETION_LIST_FIELD_IS_INCOMPLETE)
+    {
+        json_writer_key(p_writer, "isIncomplete");
+        write_boolean(p_writer, p_value->is_incomplete);
+    }
+
+    if (p_value->valid_fields & COMPLETION_LIST_FIELD_ITEMS)
+    {
+        json_writer_key(p_writer, "items");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->items_count; ++i)
+        {
+            write_completion_item(p_writer, &p_value->p_items[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_code_action_context(json_writer_t * p_writer, const code_action_context_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & CODE_ACTION_CONTEXT_FIELD_DIAGNOSTICS)
+    {
+        json_writer_key(p_writer, "diagnostics");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->diagnostics_count; ++i)
+        {
+            write_diagnostic(p_writer, &p_value->p_diagnostics[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+/* Server command parameter JSON writers */
+void write_initialize_params(json_writer_t * p_writer, const initialize_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & INITIALIZE_PARAMS_FIELD_PROCESS_ID)
+    {
+        json_writer_key(p_writer, "processId");
+        write_number(p_writer, p_value->process_id);
+    }
+
+    if (p_value->valid_fields & INITIALIZE_PARAMS_FIELD_ROOT_PATH)
+    {
+        json_writer_key(p_writer, "rootPath");
+        write_string(p_writer, p_value->root_path);
+    }
+
+    if (p_value->valid_fields & INITIALIZE_PARAMS_FIELD_ROOT_URI)
+    {
+        json_writer_key(p_writer, "rootUri");
+        write_uri(p_writer, p_value->root_uri);
+    }
+
+    if (p_value->valid_fields & INITIALIZE_PARAMS_FIELD_CAPABILITIES)
+    {
+        json_writer_key(p_writer, "capabilities");
+        write_client_capabilities(p_writer, &p_value->capabilities);
+    }
+
+    if (p_value->valid_fields & INITIALIZE_PARAMS_FIELD_INITIALIZATION_OPTIONS)
+    {
+        json_writer_key(p_writer, "initializationOptions");
+        write_initialization_options(p_writer, &p_value->initialization_options);
+    }
+
+    if (p_value->valid_fields & INITIALIZE_PARAMS_FIELD_TRACE)
+    {
+        json_writer_key(p_writer, "trace");
+        write_string(p_writer, p_value->trace);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_reference_params(json_writer_t * p_writer, const reference_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & REFERENCE_PARAMS_FIELD_CONTEXT)
+    {
+        json_writer_key(p_writer, "context");
+        write_reference_context(p_writer, &p_value->context);
+    }
+
+    if (p_value->valid_fields & REFERENCE_PARAMS_FIELD_TEXT_DOCUMENT)
+    {
+        json_writer_key(p_writer, "textDocument");
+        write_text_document_identifier(p_writer, &p_value->text_document);
+    }
+
+    if (p_value->valid_fields & REFERENCE_PARAMS_FIELD_POSITION)
+    {
+        json_writer_key(p_writer, "position");
+        write_position(p_writer, &p_value->position);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_document_symbol_params(json_writer_t * p_writer, const document_symbol_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & DOCUMENT_SYMBOL_PARAMS_FIELD_TEXT_DOCUMENT)
+    {
+        json_writer_key(p_writer, "textDocument");
+        write_text_document_identifier(p_writer, &p_value->text_document);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_workspace_symbol_params(json_writer_t * p_writer, const workspace_symbol_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & WORKSPACE_SYMBOL_PARAMS_FIELD_QUERY)
+    {
+        json_writer_key(p_writer, "query");
+        write_string(p_writer, p_value->query);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_document_link_params(json_writer_t * p_writer, const document_link_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & DOCUMENT_LINK_PARAMS_FIELD_TEXT_DOCUMENT)
+    {
+        json_writer_key(p_writer, "textDocument");
+        write_text_document_identifier(p_writer, &p_value->text_document);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_code_action_params(json_writer_t * p_writer, const code_action_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & CODE_ACTION_PARAMS_FIELD_TEXT_DOCUMENT)
+    {
+        json_writer_key(p_writer, "textDocument");
+        write_text_document_identifier(p_writer, &p_value->text_document);
+    }
+
+    if (p_value->valid_fields & CODE_ACTION_PARAMS_FIELD_RANGE)
+    {
+        json_writer_key(p_writer, "range");
+        write_range(p_writer, &p_value->range);
+    }
+
+    if (p_value->valid_fields & CODE_ACTION_PARAMS_FIELD_CONTEXT)
+    {
+        json_writer_key(p_writer, "context");
+        write_code_action_context(p_writer, &p_value->context);
+    }
+    json_writer_object_end(p_writer);
+}
+
+/* Client command parameter JSON writers */
+void write_show_message_request_params(json_writer_t * p_writer, const show_message_request_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & SHOW_MESSAGE_REQUEST_PARAMS_FIELD_TYPE)
+    {
+        json_writer_key(p_writer, "type");
+        write_message_type(p_writer, p_value->type);
+    }
+
+    if (p_value->valid_fields & SHOW_MESSAGE_REQUEST_PARAMS_FIELD_MESSAGE)
+    {
+        json_writer_key(p_writer, "message");
+        write_string(p_writer, p_value->message);
+    }
+
+    if (p_value->valid_fields & SHOW_MESSAGE_REQUEST_PARAMS_FIELD_ACTIONS)
+    {
+        json_writer_key(p_writer, "actions");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->actions_count; ++i)
+        {
+            write_message_action_item(p_writer, &p_value->p_actions[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_signature_help(json_writer_t * p_writer, const signature_help_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & SIGNATURE_HELP_FIELD_SIGNATURES)
+    {
+        json_writer_key(p_writer, "signatures");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->signatures_count; ++i)
+        {
+            write_signature_information(p_writer, &p_value->p_signatures[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+
+    if (p_value->valid_fields & SIGNATURE_HELP_FIELD_ACTIVE_SIGNATURE)
+    {
+        json_writer_key(p_writer, "activeSignature");
+        write_number(p_writer, p_value->active_signature);
+    }
+
+    if (p_value->valid_fields & SIGNATURE_HELP_FIELD_ACTIVE_PARAMETER)
+    {
+        json_writer_key(p_writer, "activeParameter");
+        write_number(p_writer, p_value->active_parameter);
+    }
+    json_writer_object_end(p_writer);
+}
+
+/* Command response parameter JSON writers */
+void write_initialize_result(json_writer_t * p_writer, const initialize_result_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & INITIALIZE_RESULT_FIELD_CAPABILITIES)
+    {
+        json_writer_key(p_writer, "capabilities");
+        write_server_capabilities(p_writer, &p_value->capabilities);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_symbol_information(json_writer_t * p_writer, const symbol_information_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & SYMBOL_INFORMATION_FIELD_NAME)
+    {
+        json_writer_key(p_writer, "name");
+        write_string(p_writer, p_value->name);
+    }
+
+    if (p_value->valid_fields & SYMBOL_INFORMATION_FIELD_KIND)
+    {
+        json_writer_key(p_writer, "kind");
+        write_symbol_kind(p_writer, p_value->kind);
+    }
+
+    if (p_value->valid_fields & SYMBOL_INFORMATION_FIELD_LOCATION)
+    {
+        json_writer_key(p_writer, "location");
+        write_location(p_writer, &p_value->location);
+    }
+
+    if (p_value->valid_fields & SYMBOL_INFORMATION_FIELD_CONTAINER_NAME)
+    {
+        json_writer_key(p_writer, "containerName");
+        write_string(p_writer, p_value->container_name);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_document_link(json_writer_t * p_writer, const document_link_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & DOCUMENT_LINK_FIELD_RANGE)
+    {
+        json_writer_key(p_writer, "range");
+        write_range(p_writer, &p_value->range);
+    }
+
+    if (p_value->valid_fields & DOCUMENT_LINK_FIELD_TARGET)
+    {
+        json_writer_key(p_writer, "target");
+        write_uri(p_writer, p_value->target);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_hover(json_writer_t * p_writer, const hover_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & HOVER_FIELD_CONTENTS)
+    {
+        json_writer_key(p_writer, "contents");
+        write_markup_content(p_writer, &p_value->contents);
+    }
+
+    if (p_value->valid_fields & HOVER_FIELD_RANGE)
+    {
+        json_writer_key(p_writer, "range");
+        write_range(p_writer, &p_value->range);
+    }
+    json_writer_object_end(p_writer);
+}
+
+/* Client notification parameter JSON writers */
+void write_show_message_params(json_writer_t * p_writer, const show_message_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & SHOW_MESSAGE_PARAMS_FIELD_TYPE)
+    {
+        json_writer_key(p_writer, "type");
+        write_message_type(p_writer, p_value->type);
+    }
+
+    if (p_value->valid_fields & SHOW_MESSAGE_PARAMS_FIELD_MESSAGE)
+    {
+        json_writer_key(p_writer, "message");
+        write_string(p_writer, p_value->message);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_log_message_params(json_writer_t * p_writer, const log_message_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & LOG_MESSAGE_PARAMS_FIELD_TYPE)
+    {
+        json_writer_key(p_writer, "type");
+        write_message_type(p_writer, p_value->type);
+    }
+
+    if (p_value->valid_fields & LOG_MESSAGE_PARAMS_FIELD_MESSAGE)
+    {
+        json_writer_key(p_writer, "message");
+        write_string(p_writer, p_value->message);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_publish_diagnostics_params(json_writer_t * p_writer, const publish_diagnostics_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & PUBLISH_DIAGNOSTICS_PARAMS_FIELD_URI)
+    {
+        json_writer_key(p_writer, "uri");
+        write_uri(p_writer, p_value->uri);
+    }
+
+    if (p_value->valid_fields & PUBLISH_DIAGNOSTICS_PARAMS_FIELD_DIAGNOSTICS)
+    {
+        json_writer_key(p_writer, "diagnostics");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->diagnostics_count; ++i)
+        {
+            write_diagnostic(p_writer, &p_value->p_diagnostics[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+/* Server notification parameter JSON writers */
+void write_did_open_text_document_params(json_writer_t * p_writer, const did_open_text_document_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & DID_OPEN_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT)
+    {
+        json_writer_key(p_writer, "textDocument");
+        write_text_document_item(p_writer, &p_value->text_document);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_did_change_text_document_params(json_writer_t * p_writer, const did_change_text_document_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT)
+    {
+        json_writer_key(p_writer, "textDocument");
+        write_versioned_text_document_identifier(p_writer, &p_value->text_document);
+    }
+
+    if (p_value->valid_fields & DID_CHANGE_TEXT_DOCUMENT_PARAMS_FIELD_CONTENT_CHANGES)
+    {
+        json_writer_key(p_writer, "contentChanges");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->content_changes_count; ++i)
+        {
+            write_text_document_content_change_event(p_writer, &p_value->p_content_changes[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_did_save_text_document_params(json_writer_t * p_writer, const did_save_text_document_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT)
+    {
+        json_writer_key(p_writer, "textDocument");
+        write_text_document_identifier(p_writer, &p_value->text_document);
+    }
+
+    if (p_value->valid_fields & DID_SAVE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT)
+    {
+        json_writer_key(p_writer, "text");
+        write_string(p_writer, p_value->text);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_did_close_text_document_params(json_writer_t * p_writer, const did_close_text_document_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & DID_CLOSE_TEXT_DOCUMENT_PARAMS_FIELD_TEXT_DOCUMENT)
+    {
+        json_writer_key(p_writer, "textDocument");
+        write_text_document_identifier(p_writer, &p_value->text_document);
+    }
+    json_writer_object_end(p_writer);
+}
+
+void write_did_change_watched_files_params(json_writer_t * p_writer, const did_change_watched_files_params_t * p_value)
+{
+    json_writer_object_start(p_writer);
+
+    if (p_value->valid_fields & DID_CHANGE_WATCHED_FILES_PARAMS_FIELD_CHANGES)
+    {
+        json_writer_key(p_writer, "changes");
+        json_writer_array_start(p_writer);
+        for (uint32_t i = 0; i < p_value->changes_count; ++i)
+        {
+            write_file_event(p_writer, &p_value->p_changes[i]);
+        }
+        json_writer_array_end(p_writer);
+    }
+    json_writer_object_end(p_writer);
 }
\ No newline at end of file
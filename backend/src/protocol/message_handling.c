@@ -12,24 +12,6 @@
 #include "log.h"
 #include "message_handling.h"
 
-/*******************************************************************************
- * Message names
- ******************************************************************************/
-#define LSP_REQUEST_INITIALIZE "initialize"
-#define LSP_REQUEST_WORKSPACE_SYMBOL "workspace/symbol"
-#define LSP_REQUEST_TEXT_DOCUMENT_DOCUMENT_SYMBOL "textDocument/documentSymbol"
-#define LSP_REQUEST_TEXT_DOCUMENT_COMPLETION "textDocument/completion"
-#define LSP_REQUEST_TEXT_DOCUMENT_SIGNATURE_HELP "textDocument/signatureHelp"
-#define LSP_REQUEST_TEXT_DOCUMENT_DEFINITION "textDocument/definition"
-#define LSP_REQUEST_TEXT_DOCUMENT_REFERENCES "textDocument/references"
-#define LSP_REQUEST_TEXT_DOCUMENT_DOCUMENT_LINK "textDocument/documentLink"
-#define LSP_REQUEST_TEXT_DOCUMENT_HOVER "textDocument/hover"
-#define LSP_REQUEST_TEXT_DOCUMENT_CODE_ACTION "textDocument/codeAction"
-#define LSP_NOTIFICATION_TEXT_DOCUMENT_DID_OPEN "textDocument/didOpen"
-#define LSP_NOTIFICATION_TEXT_DOCUMENT_DID_CHANGE "textDocument/didChange"
-#define LSP_NOTIFICATION_TEXT_DOCUMENT_DID_SAVE "textDocument/didSave"
-#define LSP_NOTIFICATION_TEXT_DOCUMENT_DID_CLOSE "textDocument/didClose"
-
 /*******************************************************************************
  * Handler function pointers
  ******************************************************************************/
@@ -37,6 +19,7 @@ static lsp_request_handler_initialize_t mp_request_handler_initialize;
 static lsp_request_handler_workspace_symbol_t mp_request_handler_workspace_symbol;
 static lsp_request_handler_text_document_document_symbol_t mp_request_handler_text_document_document_symbol;
 static lsp_request_handler_text_document_completion_t mp_request_handler_text_document_completion;
+static lsp_request_handler_completion_item_resolve_t mp_request_handler_completion_item_resolve;
 static lsp_request_handler_text_document_signature_help_t mp_request_handler_text_document_signature_help;
 static lsp_request_handler_text_document_definition_t mp_request_handler_text_document_definition;
 static lsp_request_handler_text_document_references_t mp_request_handler_text_document_references;
@@ -51,159 +34,335 @@ static lsp_notification_handler_text_document_did_close_t mp_notification_handle
 /*******************************************************************************
  * Handler functions
  ******************************************************************************/
-static void request_handler_initialize(const char * p_method, json_t * p_params, json_t * p_response)
+static void * request_params_read_initialize(json_reader_t * p_reader, const char ** pp_document)
 {
-    initialize_params_t params = decode_initialize_params(p_params);
-    if (decoder_error() == DECODER_ERROR_NONE)
-    {
-        mp_request_handler_initialize(&params, p_response);
-    }
-    else
+    initialize_params_t * p_params = MALLOC(sizeof(initialize_params_t));
+    bool valid = read_initialize_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
+        release_initialize_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    free_initialize_params(params);
+    *pp_document = NULL;
+    return p_params;
 }
-static void request_handler_workspace_symbol(const char * p_method, json_t * p_params, json_t * p_response)
+static void request_params_free_initialize(void * p_params)
 {
-    workspace_symbol_params_t params = decode_workspace_symbol_params(p_params);
-    if (decoder_error() == DECODER_ERROR_NONE)
-    {
-        mp_request_handler_workspace_symbol(&params, p_response);
-    }
-    else
-    {
-        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
-    }
-    free_workspace_symbol_params(params);
+    release_initialize_params(p_params);
+    FREE(p_params);
 }
-static void request_handler_text_document_document_symbol(const char * p_method, json_t * p_params, json_t * p_response)
+static void * request_params_read_workspace_symbol(json_reader_t * p_reader, const char ** pp_document)
 {
-    document_symbol_params_t params = decode_document_symbol_params(p_params);
-    if (decoder_error() == DECODER_ERROR_NONE)
-    {
-        mp_request_handler_text_document_document_symbol(&params, p_response);
-    }
-    else
+    workspace_symbol_params_t * p_params = MALLOC(sizeof(workspace_symbol_params_t));
+    bool valid = read_workspace_symbol_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
+        release_workspace_symbol_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    free_document_symbol_params(params);
+    *pp_document = NULL;
+    return p_params;
 }
-static void request_handler_text_document_completion(const char * p_method, json_t * p_params, json_t * p_response)
+static void request_params_free_workspace_symbol(void * p_params)
 {
-    text_document_position_params_t params = decode_text_document_position_params(p_params);
-    if (decoder_error() == DECODER_ERROR_NONE)
-    {
-        mp_request_handler_text_document_completion(&params, p_response);
-    }
-    else
+    release_workspace_symbol_params(p_params);
+    FREE(p_params);
+}
+static void * request_params_read_text_document_document_symbol(json_reader_t * p_reader, const char ** pp_document)
+{
+    document_symbol_params_t * p_params = MALLOC(sizeof(document_symbol_params_t));
+    bool valid = read_document_symbol_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
+        release_document_symbol_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    free_text_document_position_params(params);
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
 }
-static void request_handler_text_document_signature_help(const char * p_method, json_t * p_params, json_t * p_response)
+static void request_params_free_text_document_document_symbol(void * p_params)
 {
-    text_document_position_params_t params = decode_text_document_position_params(p_params);
-    if (decoder_error() == DECODER_ERROR_NONE)
+    release_document_symbol_params(p_params);
+    FREE(p_params);
+}
+static void * request_params_read_text_document_completion(json_reader_t * p_reader, const char ** pp_document)
+{
+    text_document_position_params_t * p_params = MALLOC(sizeof(text_document_position_params_t));
+    bool valid = read_text_document_position_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        mp_request_handler_text_document_signature_help(&params, p_response);
+        release_text_document_position_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    else
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
+}
+static void request_params_free_text_document_completion(void * p_params)
+{
+    release_text_document_position_params(p_params);
+    FREE(p_params);
+}
+static void * request_params_read_completion_item_resolve(json_reader_t * p_reader, const char ** pp_document)
+{
+    completion_item_t * p_params = MALLOC(sizeof(completion_item_t));
+    bool valid = read_completion_item(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
+        release_completion_item(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    free_text_document_position_params(params);
+    *pp_document = json_string_value(json_object_get(p_params->data, "file"));
+    return p_params;
+}
+static void request_params_free_completion_item_resolve(void * p_params)
+{
+    release_completion_item(p_params);
+    FREE(p_params);
 }
-static void request_handler_text_document_definition(const char * p_method, json_t * p_params, json_t * p_response)
+static void * request_params_read_text_document_signature_help(json_reader_t * p_reader, const char ** pp_document)
 {
-    text_document_position_params_t params = decode_text_document_position_params(p_params);
-    if (decoder_error() == DECODER_ERROR_NONE)
+    text_document_position_params_t * p_params = MALLOC(sizeof(text_document_position_params_t));
+    bool valid = read_text_document_position_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        mp_request_handler_text_document_definition(&params, p_response);
+        release_text_document_position_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    else
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
+}
+static void request_params_free_text_document_signature_help(void * p_params)
+{
+    release_text_document_position_params(p_params);
+    FREE(p_params);
+}
+static void * request_params_read_text_document_definition(json_reader_t * p_reader, const char ** pp_document)
+{
+    text_document_position_params_t * p_params = MALLOC(sizeof(text_document_position_params_t));
+    bool valid = read_text_document_position_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
+        release_text_document_position_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    free_text_document_position_params(params);
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
 }
-static void request_handler_text_document_references(const char * p_method, json_t * p_params, json_t * p_response)
+static void request_params_free_text_document_definition(void * p_params)
 {
-    reference_params_t params = decode_reference_params(p_params);
-    if (decoder_error() == DECODER_ERROR_NONE)
+    release_text_document_position_params(p_params);
+    FREE(p_params);
+}
+static void * request_params_read_text_document_references(json_reader_t * p_reader, const char ** pp_document)
+{
+    reference_params_t * p_params = MALLOC(sizeof(reference_params_t));
+    bool valid = read_reference_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        mp_request_handler_text_document_references(&params, p_response);
+        release_reference_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    else
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
+}
+static void request_params_free_text_document_references(void * p_params)
+{
+    release_reference_params(p_params);
+    FREE(p_params);
+}
+static void * request_params_read_text_document_document_link(json_reader_t * p_reader, const char ** pp_document)
+{
+    document_link_params_t * p_params = MALLOC(sizeof(document_link_params_t));
+    bool valid = read_document_link_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
+        release_document_link_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    free_reference_params(params);
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
+}
+static void request_params_free_text_document_document_link(void * p_params)
+{
+    release_document_link_params(p_params);
+    FREE(p_params);
 }
-static void request_handler_text_document_document_link(const char * p_method, json_t * p_params, json_t * p_response)
+static void * request_params_read_text_document_hover(json_reader_t * p_reader, const char ** pp_document)
 {
-    document_link_params_t params = decode_document_link_params(p_params);
-    if (decoder_error() == DECODER_ERROR_NONE)
+    text_document_position_params_t * p_params = MALLOC(sizeof(text_document_position_params_t));
+    bool valid = read_text_document_position_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        mp_request_handler_text_document_document_link(&params, p_response);
+        release_text_document_position_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    else
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
+}
+static void request_params_free_text_document_hover(void * p_params)
+{
+    release_text_document_position_params(p_params);
+    FREE(p_params);
+}
+static void * request_params_read_text_document_code_action(json_reader_t * p_reader, const char ** pp_document)
+{
+    code_action_params_t * p_params = MALLOC(sizeof(code_action_params_t));
+    bool valid = read_code_action_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
+        release_code_action_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    free_document_link_params(params);
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
 }
-static void request_handler_text_document_hover(const char * p_method, json_t * p_params, json_t * p_response)
+static void request_params_free_text_document_code_action(void * p_params)
 {
-    text_document_position_params_t params = decode_text_document_position_params(p_params);
-    if (decoder_error() == DECODER_ERROR_NONE)
+    release_code_action_params(p_params);
+    FREE(p_params);
+}
+static void request_handler_initialize(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_initialize(p_params, p_response);
+}
+static void request_handler_workspace_symbol(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_workspace_symbol(p_params, p_response);
+}
+static void request_handler_text_document_document_symbol(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_text_document_document_symbol(p_params, p_response);
+}
+static void request_handler_text_document_completion(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_text_document_completion(p_params, p_response);
+}
+static void request_handler_completion_item_resolve(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_completion_item_resolve(p_params, p_response);
+}
+static void request_handler_text_document_signature_help(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_text_document_signature_help(p_params, p_response);
+}
+static void request_handler_text_document_definition(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_text_document_definition(p_params, p_response);
+}
+static void request_handler_text_document_references(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_text_document_references(p_params, p_response);
+}
+static void request_handler_text_document_document_link(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_text_document_document_link(p_params, p_response);
+}
+static void request_handler_text_document_hover(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_text_document_hover(p_params, p_response);
+}
+static void request_handler_text_document_code_action(const char * p_method, void * p_params, json_t * p_response)
+{
+    mp_request_handler_text_document_code_action(p_params, p_response);
+}
+static void * notification_params_read_text_document_did_open(json_reader_t * p_reader, const char ** pp_document)
+{
+    did_open_text_document_params_t * p_params = MALLOC(sizeof(did_open_text_document_params_t));
+    bool valid = read_did_open_text_document_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        mp_request_handler_text_document_hover(&params, p_response);
+        release_did_open_text_document_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    else
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
+}
+static void notification_params_free_text_document_did_open(void * p_params)
+{
+    release_did_open_text_document_params(p_params);
+    FREE(p_params);
+}
+static void * notification_params_read_text_document_did_change(json_reader_t * p_reader, const char ** pp_document)
+{
+    did_change_text_document_params_t * p_params = MALLOC(sizeof(did_change_text_document_params_t));
+    bool valid = read_did_change_text_document_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
+        release_did_change_text_document_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    free_text_document_position_params(params);
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
 }
-static void request_handler_text_document_code_action(const char * p_method, json_t * p_params, json_t * p_response)
+static void notification_params_free_text_document_did_change(void * p_params)
 {
-    code_action_params_t params = decode_code_action_params(p_params);
-    if (decoder_error() == DECODER_ERROR_NONE)
+    release_did_change_text_document_params(p_params);
+    FREE(p_params);
+}
+static void * notification_params_read_text_document_did_save(json_reader_t * p_reader, const char ** pp_document)
+{
+    did_save_text_document_params_t * p_params = MALLOC(sizeof(did_save_text_document_params_t));
+    bool valid = read_did_save_text_document_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        mp_request_handler_text_document_code_action(&params, p_response);
+        release_did_save_text_document_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    else
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
+}
+static void notification_params_free_text_document_did_save(void * p_params)
+{
+    release_did_save_text_document_params(p_params);
+    FREE(p_params);
+}
+static void * notification_params_read_text_document_did_close(json_reader_t * p_reader, const char ** pp_document)
+{
+    did_close_text_document_params_t * p_params = MALLOC(sizeof(did_close_text_document_params_t));
+    bool valid = read_did_close_text_document_params(p_reader, p_params);
+    if (decoder_error() != DECODER_ERROR_NONE || !valid)
     {
-        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);
+        release_did_close_text_document_params(p_params);
+        FREE(p_params);
+        return NULL;
     }
-    free_code_action_params(params);
+    *pp_document = p_params->text_document.uri.path;
+    return p_params;
 }
-static void notification_handler_text_document_did_open(const char * p_method, json_t * p_params)
+static void notification_params_free_text_document_did_close(void * p_params)
 {
-    did_open_text_document_params_t params = decode_did_open_text_document_params(p_params);
-    mp_notification_handler_text_document_did_open(&params);
-    free_did_open_text_document_params(params);
+    release_did_close_text_document_params(p_params);
+    FREE(p_params);
 }
-static void notification_handler_text_document_did_change(const char * p_method, json_t * p_params)
+static void notification_handler_text_document_did_open(const char * p_method, void * p_params)
 {
-    did_change_text_document_params_t params = decode_did_change_text_document_params(p_params);
-    mp_notification_handler_text_document_did_change(&params);
-    free_did_change_text_document_params(params);
+    mp_notification_handler_text_document_did_open(p_params);
 }
-static void notification_handler_text_document_did_save(const char * p_method, json_t * p_params)
+static void notification_handler_text_document_did_change(const char * p_method, void * p_params)
 {
-    did_save_text_document_params_t params = decode_did_save_text_document_params(p_params);
-    mp_notification_handler_text_document_did_save(&params);
-    free_did_save_text_document_params(params);
+    mp_notification_handler_text_document_did_change(p_params);
 }
-static void notification_handler_text_document_did_close(const char * p_method, json_t * p_params)
+static void notification_handler_text_document_did_save(const char * p_method, void * p_params)
 {
-    did_close_text_document_params_t params = decode_did_close_text_document_params(p_params);
-    mp_notification_handler_text_document_did_close(&params);
-    free_did_close_text_document_params(params);
+    mp_notification_handler_text_document_did_save(p_params);
+}
+static void notification_handler_text_document_did_close(const char * p_method, void * p_params)
+{
+    mp_notification_handler_text_document_did_close(p_params);
 }
 
 /*******************************************************************************
@@ -212,70 +371,120 @@ static void notification_handler_text_document_did_close(const char * p_method,
 void lsp_request_handler_initialize_register(lsp_request_handler_initialize_t handler)
 {
     mp_request_handler_initialize = handler;
-    json_rpc_request_handler_add(LSP_REQUEST_INITIALIZE, request_handler_initialize);
+    json_rpc_request_handler_add(LSP_REQUEST_INITIALIZE,
+                                 request_params_read_initialize,
+                                 request_handler_initialize,
+                                 request_params_free_initialize);
 }
 void lsp_request_handler_workspace_symbol_register(lsp_request_handler_workspace_symbol_t handler)
 {
     mp_request_handler_workspace_symbol = handler;
-    json_rpc_request_handler_add(LSP_REQUEST_WORKSPACE_SYMBOL, request_handler_workspace_symbol);
+    json_rpc_request_handler_add(LSP_REQUEST_WORKSPACE_SYMBOL,
+                                 request_params_read_workspace_symbol,
+                                 request_handler_workspace_symbol,
+                                 request_params_free_workspace_symbol);
 }
 void lsp_request_handler_text_document_document_symbol_register(lsp_request_handler_text_document_document_symbol_t handler)
 {
     mp_request_handler_text_document_document_symbol = handler;
-    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_DOCUMENT_SYMBOL, request_handler_text_document_document_symbol);
+    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_DOCUMENT_SYMBOL,
+                                 request_params_read_text_document_document_symbol,
+                                 request_handler_text_document_document_symbol,
+                                 request_params_free_text_document_document_symbol);
 }
 void lsp_request_handler_text_document_completion_register(lsp_request_handler_text_document_completion_t handler)
 {
     mp_request_handler_text_document_completion = handler;
-    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_COMPLETION, request_handler_text_document_completion);
+    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_COMPLETION,
+                                 request_params_read_text_document_completion,
+                                 request_handler_text_document_completion,
+                                 request_params_free_text_document_completion);
+}
+void lsp_request_handler_completion_item_resolve_register(lsp_request_handler_completion_item_resolve_t handler)
+{
+    mp_request_handler_completion_item_resolve = handler;
+    json_rpc_request_handler_add(LSP_REQUEST_COMPLETION_ITEM_RESOLVE,
+                                 request_params_read_completion_item_resolve,
+                                 request_handler_completion_item_resolve,
+                                 request_params_free_completion_item_resolve);
 }
 void lsp_request_handler_text_document_signature_help_register(lsp_request_handler_text_document_signature_help_t handler)
 {
     mp_request_handler_text_document_signature_help = handler;
-    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_SIGNATURE_HELP, request_handler_text_document_signature_help);
+    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_SIGNATURE_HELP,
+                                 request_params_read_text_document_signature_help,
+                                 request_handler_text_document_signature_help,
+                                 request_params_free_text_document_signature_help);
 }
 void lsp_request_handler_text_document_definition_register(lsp_request_handler_text_document_definition_t handler)
 {
     mp_request_handler_text_document_definition = handler;
-    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_DEFINITION, request_handler_text_document_definition);
+    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_DEFINITION,
+                                 request_params_read_text_document_definition,
+                                 request_handler_text_document_definition,
+                                 request_params_free_text_document_definition);
 }
 void lsp_request_handler_text_document_references_register(lsp_request_handler_text_document_references_t handler)
 {
     mp_request_handler_text_document_references = handler;
-    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_REFERENCES, request_handler_text_document_references);
+    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_REFERENCES,
+                                 request_params_read_text_document_references,
+                                 request_handler_text_document_references,
+                                 request_params_free_text_document_references);
 }
 void lsp_request_handler_text_document_document_link_register(lsp_request_handler_text_document_document_link_t handler)
 {
     mp_request_handler_text_document_document_link = handler;
-    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_DOCUMENT_LINK, request_handler_text_document_document_link);
+    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_DOCUMENT_LINK,
+                                 request_params_read_text_document_document_link,
+                                 request_handler_text_document_document_link,
+                                 request_params_free_text_document_document_link);
 }
 void lsp_request_handler_text_document_hover_register(lsp_request_handler_text_document_hover_t handler)
 {
     mp_request_handler_text_document_hover = handler;
-    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_HOVER, request_handler_text_document_hover);
+    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_HOVER,
+                                 request_params_read_text_document_hover,
+                                 request_handler_text_document_hover,
+                                 request_params_free_text_document_hover);
 }
 void lsp_request_handler_text_document_code_action_register(lsp_request_handler_text_document_code_action_t handler)
 {
     mp_request_handler_text_document_code_action = handler;
-    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_CODE_ACTION, request_handler_text_document_code_action);
+    json_rpc_request_handler_add(LSP_REQUEST_TEXT_DOCUMENT_CODE_ACTION,
+                                 request_params_read_text_document_code_action,
+                                 request_handler_text_document_code_action,
+                                 request_params_free_text_document_code_action);
 }
 void lsp_notification_handler_text_document_did_open_register(lsp_notification_handler_text_document_did_open_t handler)
 {
     mp_notification_handler_text_document_did_open = handler;
-    json_rpc_notification_handler_add(LSP_NOTIFICATION_TEXT_DOCUMENT_DID_OPEN, notification_handler_text_document_did_open);
+    json_rpc_notification_handler_add(LSP_NOTIFICATION_TEXT_DOCUMENT_DID_OPEN,
+                                      notification_params_read_text_document_did_open,
+                                      notification_handler_text_document_did_open,
+                                      notification_params_free_text_document_did_open);
 }
 void lsp_notification_handler_text_document_did_change_register(lsp_notification_handler_text_document_did_change_t handler)
 {
     mp_notification_handler_text_document_did_change = handler;
-    json_rpc_notification_handler_add(LSP_NOTIFICATION_TEXT_DOCUMENT_DID_CHANGE, notification_handler_text_document_did_change);
+    json_rpc_notification_handler_add(LSP_NOTIFICATION_TEXT_DOCUMENT_DID_CHANGE,
+                                      notification_params_read_text_document_did_change,
+                                      notification_handler_text_document_did_change,
+                                      notification_params_free_text_document_did_change);
 }
 void lsp_notification_handler_text_document_did_save_register(lsp_notification_handler_text_document_did_save_t handler)
 {
     mp_notification_handler_text_document_did_save = handler;
-    json_rpc_notification_handler_add(LSP_NOTIFICATION_TEXT_DOCUMENT_DID_SAVE, notification_handler_text_document_did_save);
+    json_rpc_notification_handler_add(LSP_NOTIFICATION_TEXT_DOCUMENT_DID_SAVE,
+                                      notification_params_read_text_document_did_save,
+                                      notification_handler_text_document_did_save,
+                                      notification_params_free_text_document_did_save);
 }
 void lsp_notification_handler_text_document_did_close_register(lsp_notification_handler_text_document_did_close_t handler)
 {
     mp_notification_handler_text_document_did_close = handler;
-    json_rpc_notification_handler_add(LSP_NOTIFICATION_TEXT_DOCUMENT_DID_CLOSE, notification_handler_text_document_did_close);
+    json_rpc_notification_handler_add(LSP_NOTIFICATION_TEXT_DOCUMENT_DID_CLOSE,
+                                      notification_params_read_text_document_did_close,
+                                      notification_handler_text_document_did_close,
+                                      notification_params_free_text_document_did_close);
 }
@@ -5,6 +5,7 @@
 #include "path.h"
 #include "unit_storage.h"
 #include "unsaved_files.h"
+#include "file_watcher.h"
 
 
 void assert_handler(const char * p_file, unsigned line)
@@ -24,11 +25,13 @@ void signal_handler(int signal)
     exit(-1);
 }
 
+#ifdef _WIN32
 BOOL WINAPI ctrl_handler(DWORD ctrl_type)
 {
 	LOG("CTRL: %#x\n", ctrl_type);
 	return true;
 }
+#endif
 
 int main(unsigned argc, const char ** pp_argv)
 {
@@ -37,9 +40,14 @@ int main(unsigned argc, const char ** pp_argv)
     signal(SIGFPE, signal_handler);
     signal(SIGSEGV, signal_handler);
     signal(SIGTERM, signal_handler);
-    signal(SIGBREAK, signal_handler);
     signal(SIGABRT, signal_handler);
+#ifdef _WIN32
+    signal(SIGBREAK, signal_handler);
 	SetConsoleCtrlHandler(ctrl_handler, true);
+#else
+    /* The client closing the pipe shouldn't kill us mid-write. */
+    signal(SIGPIPE, SIG_IGN);
+#endif
     log_init();
     OUT_ERASE();
     LOG("-------------------------------------------------------\n");
@@ -56,7 +64,10 @@ int main(unsigned argc, const char ** pp_argv)
         LOG("Running from file %s\n", pp_argv[1]);
     }
     json_rpc_listen(p_stream);
+    /* Stopped first, as it hands changes to the unit storage. */
+    file_watcher_free();
 	unit_storage_wait_for_completion();
+    json_rpc_free();
     unsaved_files_free();
     unit_index_free();
 
@@ -1,95 +1,373 @@
+#include <string.h>
 #include "source_file.h"
 #include "utils.h"
 #include "log.h"
 
-static char * position_to_offset(const source_file_t * p_file, const position_t * p_pos)
+/* New text is split into chunks of at most this many bytes. */
+#define CHUNK_SIZE_MAX 1024
+
+/* Rebuild the rope when it holds more than this many chunks per full chunk of text. */
+#define CHUNK_FRAGMENTATION_MAX 4
+
+/**
+ * Node in the rope. The rope is a treap ordered by byte offset, where every node owns a chunk of the
+ * text, and keeps the length and newline count of its subtree, so that both offset and line lookups
+ * are O(log n).
+ */
+struct source_file_chunk
+{
+    source_file_chunk_t * p_left;
+    source_file_chunk_t * p_right;
+    uint32_t priority;
+
+    char * p_text;
+    size_t length;
+    size_t newlines;
+
+    size_t total_length;
+    size_t total_newlines;
+    size_t total_chunks;
+};
+
+#define TOTAL_LENGTH(p_chunk)   ((p_chunk) ? (p_chunk)->total_length : 0)
+#define TOTAL_NEWLINES(p_chunk) ((p_chunk) ? (p_chunk)->total_newlines : 0)
+#define TOTAL_CHUNKS(p_chunk)   ((p_chunk) ? (p_chunk)->total_chunks : 0)
+
+static uint32_t chunk_priority(void)
+{
+    /* xorshift32, the treap only needs the priorities to be well distributed. Documents are patched on
+     * several workers at once, so each thread has its own state. */
+    static THREAD_LOCAL uint32_t state = 2463534242u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static size_t count_newlines(const char * p_text, size_t length)
+{
+    size_t newlines = 0;
+    for (const char * p_c = memchr(p_text, '\n', length);
+         p_c != NULL;
+         p_c = memchr(p_c + 1, '\n', length - (p_c + 1 - p_text)))
+    {
+        newlines++;
+    }
+    return newlines;
+}
+
+static void chunk_update(source_file_chunk_t * p_chunk)
+{
+    p_chunk->total_length   = TOTAL_LENGTH(p_chunk->p_left) + p_chunk->length + TOTAL_LENGTH(p_chunk->p_right);
+    p_chunk->total_newlines = TOTAL_NEWLINES(p_chunk->p_left) + p_chunk->newlines + TOTAL_NEWLINES(p_chunk->p_right);
+    p_chunk->total_chunks   = TOTAL_CHUNKS(p_chunk->p_left) + 1 + TOTAL_CHUNKS(p_chunk->p_right);
+}
+
+static source_file_chunk_t * chunk_create(const char * p_text, size_t length)
+{
+    source_file_chunk_t * p_chunk = MALLOC(sizeof(source_file_chunk_t));
+    p_chunk->p_left = NULL;
+    p_chunk->p_right = NULL;
+    p_chunk->priority = chunk_priority();
+    p_chunk->p_text = MALLOC(length);
+    memcpy(p_chunk->p_text, p_text, length);
+    p_chunk->length = length;
+    p_chunk->newlines = count_newlines(p_text, length);
+    chunk_update(p_chunk);
+    return p_chunk;
+}
+
+static void rope_free(source_file_chunk_t * p_chunk)
+{
+    if (p_chunk)
+    {
+        rope_free(p_chunk->p_left);
+        rope_free(p_chunk->p_right);
+        FREE(p_chunk->p_text);
+        FREE(p_chunk);
+    }
+}
+
+static source_file_chunk_t * rope_merge(source_file_chunk_t * p_left, source_file_chunk_t * p_right)
+{
+    if (!p_left)
+    {
+        return p_right;
+    }
+    if (!p_right)
+    {
+        return p_left;
+    }
+
+    if (p_left->priority > p_right->priority)
+    {
+        p_left->p_right = rope_merge(p_left->p_right, p_right);
+        chunk_update(p_left);
+        return p_left;
+    }
+    else
+    {
+        p_right->p_left = rope_merge(p_left, p_right->p_left);
+        chunk_update(p_right);
+        return p_right;
+    }
+}
+
+/* Split the rope at the given byte offset. Chunks crossing the offset are cut in two. */
+static void rope_split(source_file_chunk_t * p_chunk, size_t offset, source_file_chunk_t ** pp_left, source_file_chunk_t ** pp_right)
+{
+    if (!p_chunk)
+    {
+        *pp_left = NULL;
+        *pp_right = NULL;
+        return;
+    }
+
+    size_t left_length = TOTAL_LENGTH(p_chunk->p_left);
+
+    if (offset <= left_length)
+    {
+        rope_split(p_chunk->p_left, offset, pp_left, &p_chunk->p_left);
+        chunk_update(p_chunk);
+        *pp_right = p_chunk;
+    }
+    else if (offset >= left_length + p_chunk->length)
+    {
+        rope_split(p_chunk->p_right, offset - left_length - p_chunk->length, &p_chunk->p_right, pp_right);
+        chunk_update(p_chunk);
+        *pp_left = p_chunk;
+    }
+    else
+    {
+        size_t cut = offset - left_length;
+        source_file_chunk_t * p_tail = chunk_create(&p_chunk->p_text[cut], p_chunk->length - cut);
+        source_file_chunk_t * p_right = p_chunk->p_right;
+
+        p_chunk->length = cut;
+        p_chunk->newlines -= p_tail->newlines;
+        p_chunk->p_right = NULL;
+        chunk_update(p_chunk);
+
+        *pp_left = p_chunk;
+        *pp_right = rope_merge(p_tail, p_right);
+    }
+}
+
+static source_file_chunk_t * rope_build(const char * p_text, size_t length)
+{
+    source_file_chunk_t * p_root = NULL;
+    for (size_t offset = 0; offset < length; offset += CHUNK_SIZE_MAX)
+    {
+        p_root = rope_merge(p_root, chunk_create(&p_text[offset], min(CHUNK_SIZE_MAX, length - offset)));
+    }
+    return p_root;
+}
+
+/* Copy length bytes, starting at the given offset, into p_dst. */
+static void rope_copy(const source_file_chunk_t * p_chunk, size_t offset, size_t length, char * p_dst)
+{
+    while (p_chunk && length > 0)
+    {
+        size_t left_length = TOTAL_LENGTH(p_chunk->p_left);
+        if (offset < left_length)
+        {
+            size_t count = min(length, left_length - offset);
+            rope_copy(p_chunk->p_left, offset, count, p_dst);
+            p_dst += count;
+            length -= count;
+            offset = left_length;
+        }
+
+        offset -= left_length;
+        if (length > 0 && offset < p_chunk->length)
+        {
+            size_t count = min(length, p_chunk->length - offset);
+            memcpy(p_dst, &p_chunk->p_text[offset], count);
+            p_dst += count;
+            length -= count;
+            offset = p_chunk->length;
+        }
+
+        offset -= p_chunk->length;
+        p_chunk = p_chunk->p_right;
+    }
+}
+
+/* Get the byte offset of the start of the given line. Lines past the end of the file map to the end. */
+static size_t rope_line_offset(const source_file_chunk_t * p_chunk, size_t line)
+{
+    size_t offset = 0;
+    while (p_chunk && line > 0)
+    {
+        size_t left_newlines = TOTAL_NEWLINES(p_chunk->p_left);
+        if (line <= left_newlines)
+        {
+            p_chunk = p_chunk->p_left;
+            continue;
+        }
+
+        line -= left_newlines;
+        offset += TOTAL_LENGTH(p_chunk->p_left);
+
+        if (line <= p_chunk->newlines)
+        {
+            for (size_t i = 0; i < p_chunk->length; ++i)
+            {
+                if (p_chunk->p_text[i] == '\n' && --line == 0)
+                {
+                    return offset + i + 1;
+                }
+            }
+        }
+
+        line -= p_chunk->newlines;
+        offset += p_chunk->length;
+        p_chunk = p_chunk->p_right;
+    }
+    return offset;
+}
+
+/* Drop the source file's own reference to its snapshot. Anyone else holding it keeps it alive. */
+static void snapshot_invalidate(source_file_t * p_source_file)
 {
-    char * p_offset = p_file->p_contents;
-    for (unsigned i = 0; i < p_pos->line && p_offset && p_offset < p_file->p_contents + p_file->size; ++i, p_offset++)
+    if (p_source_file->p_snapshot)
     {
-        LOG("Looking for line ending #%u -> %p\n", i, p_offset);
-        p_offset = strchr(p_offset, '\n');
+        source_file_snapshot_release(p_source_file->p_snapshot);
+        p_source_file->p_snapshot = NULL;
     }
-    LOG("OFFSET: %p\n", p_offset);
-    return p_offset + p_pos->character;
+    p_source_file->version++;
 }
 
-source_file_t * source_file_create(const char * p_contents)
+static source_file_snapshot_t * snapshot_update(source_file_t * p_source_file)
+{
+    if (!p_source_file->p_snapshot)
+    {
+        source_file_snapshot_t * p_snapshot = MALLOC(sizeof(source_file_snapshot_t));
+        ASSERT(p_snapshot);
+        p_snapshot->p_filename = STRDUP(p_source_file->p_filename);
+        p_snapshot->p_contents = MALLOC(p_source_file->size + 1);
+        rope_copy(p_source_file->p_root, 0, p_source_file->size, p_snapshot->p_contents);
+        p_snapshot->p_contents[p_source_file->size] = '\0';
+        p_snapshot->size = p_source_file->size;
+        p_snapshot->version = p_source_file->version;
+        p_snapshot->refs.value = 1; /* Owned by the source file until the next edit. */
+        p_source_file->p_snapshot = p_snapshot;
+
+        /* Every edit leaves a few small chunks behind. Now that we have paid for a flat copy anyway,
+         * use it to rebuild the rope if it's gotten too fragmented. */
+        if (TOTAL_CHUNKS(p_source_file->p_root) > CHUNK_FRAGMENTATION_MAX * (p_source_file->size / CHUNK_SIZE_MAX + 1))
+        {
+            rope_free(p_source_file->p_root);
+            p_source_file->p_root = rope_build(p_snapshot->p_contents, p_snapshot->size);
+        }
+    }
+    return p_source_file->p_snapshot;
+}
+
+source_file_t * source_file_create(const char * p_filename, const char * p_contents)
 {
     source_file_t * p_source_file = MALLOC(sizeof(source_file_t));
     ASSERT(p_source_file);
-    p_source_file->p_contents = STRDUP(p_contents);
+    p_source_file->p_filename = STRDUP(p_filename);
     p_source_file->size = strlen(p_contents);
+    p_source_file->p_root = rope_build(p_contents, p_source_file->size);
+    p_source_file->p_snapshot = NULL;
+    p_source_file->version = 0;
     p_source_file->unsaved = true;
     return p_source_file;
 }
 
 void source_file_contents_set(source_file_t * p_source_file, const char * p_new_contents)
 {
-    ASSERT(p_source_file->p_contents);
-    p_source_file->p_contents = STRDUP(p_new_contents);
+    rope_free(p_source_file->p_root);
+    snapshot_invalidate(p_source_file);
     p_source_file->size = strlen(p_new_contents);
+    p_source_file->p_root = rope_build(p_new_contents, p_source_file->size);
 }
 
-void source_file_patch(source_file_t * p_source_file, const char * p_new_contents, const position_t * p_start_pos, size_t old_len)
+/* Get the byte offset of a position, with the character clamped to the end of its line, before the line
+ * break. Lines past the end of the file map to the end. */
+static size_t position_offset(const source_file_t * p_source_file, const position_t * p_pos)
 {
-    LOG("Patching file\n");
-    size_t new_len = strlen(p_new_contents);
-    char * p_start_offset = position_to_offset(p_source_file, p_start_pos);
-    ASSERT(p_start_offset);
-    LOG("LINE %lld => OFFSET %u\n", p_start_pos->line, &p_start_offset[0] - &p_source_file->p_contents[0]);
-
-    if (new_len == old_len)
+    size_t newlines = TOTAL_NEWLINES(p_source_file->p_root);
+    size_t line = (p_pos->line > 0) ? (size_t) p_pos->line : 0;
+    if (line > newlines)
     {
-        memcpy(p_start_offset, p_new_contents, new_len);
+        return p_source_file->size;
     }
-    else if (new_len < old_len)
-    {
-        size_t remainder = p_source_file->size - (p_start_offset + old_len - p_source_file->p_contents) + 1;
-        memcpy(p_start_offset, p_new_contents, new_len);
-        memmove(p_start_offset + new_len, p_start_offset + old_len, remainder);
-        p_source_file->size -= (old_len - new_len);
-        p_source_file->p_contents = REALLOC(p_source_file->p_contents, p_source_file->size + 1);
-    }
-    else
+
+    size_t start = rope_line_offset(p_source_file->p_root, line);
+    size_t end = (line < newlines) ? rope_line_offset(p_source_file->p_root, line + 1) - 1 : p_source_file->size;
+    size_t character = (p_pos->character > 0) ? (size_t) p_pos->character : 0;
+    return (character < end - start) ? start + character : end;
+}
+
+void source_file_patch(source_file_t * p_source_file, const char * p_new_contents, const range_t * p_range)
+{
+    size_t new_len = strlen(p_new_contents);
+    size_t start = position_offset(p_source_file, &p_range->start);
+    size_t end = position_offset(p_source_file, &p_range->end);
+    size_t old_len = (end > start) ? end - start : 0;
+    LOG("Patching file: LINE %lld => OFFSET %zu (-%zu +%zu)\n", (long long) p_range->start.line, start, old_len, new_len);
+
+    source_file_chunk_t * p_head;
+    source_file_chunk_t * p_rest;
+    source_file_chunk_t * p_removed;
+    source_file_chunk_t * p_tail;
+    rope_split(p_source_file->p_root, start, &p_head, &p_rest);
+    rope_split(p_rest, old_len, &p_removed, &p_tail);
+    rope_free(p_removed);
+
+    p_source_file->p_root = rope_merge(rope_merge(p_head, rope_build(p_new_contents, new_len)), p_tail);
+    p_source_file->size = p_source_file->size - old_len + new_len;
+    snapshot_invalidate(p_source_file);
+}
+
+const char * source_file_contents_get(source_file_t * p_source_file)
+{
+    return snapshot_update(p_source_file)->p_contents;
+}
+
+source_file_snapshot_t * source_file_snapshot_get(source_file_t * p_source_file)
+{
+    source_file_snapshot_t * p_snapshot = snapshot_update(p_source_file);
+    atomic_get_and_add(&p_snapshot->refs);
+    return p_snapshot;
+}
+
+void source_file_snapshot_release(source_file_snapshot_t * p_snapshot)
+{
+    if (atomic_get_and_sub(&p_snapshot->refs) == 0)
     {
-        size_t remainder = p_source_file->size - (p_start_offset + old_len - p_source_file->p_contents) + 1;
-        p_source_file->size += (new_len - old_len);
-        p_source_file->p_contents = REALLOC(p_source_file->p_contents, p_source_file->size + 1);
-        memmove(p_start_offset + new_len, p_start_offset + old_len, remainder);
-        memcpy(p_start_offset, p_new_contents, new_len);
+        FREE(p_snapshot->p_filename);
+        FREE(p_snapshot->p_contents);
+        FREE(p_snapshot);
     }
-    LOG("File contents:%s\n", p_source_file->p_contents);
 }
 
-char * source_file_line_get(const source_file_t * p_source_file, unsigned line)
+char * source_file_line_get(const source_file_t * p_source_file, uint32_t line)
 {
-    position_t pos = {
-        .line = line,
-        .character = 0
-    };
-    const char * p_line = position_to_offset(p_source_file, &pos);
-    if (p_line)
+    if (line > TOTAL_NEWLINES(p_source_file->p_root))
     {
-        const char * p_end = strchr(p_line, '\n');
-        if (p_end)
-        {
-            size_t len = (p_end - p_line);
-            char * p_line_copy = MALLOC(len);
-            memcpy(p_line_copy, p_line, len);
-            p_line_copy[len] = '\0';
-            return p_line_copy;
-        }
-        return STRDUP(p_end);
+        return NULL;
     }
-    return NULL;
+
+    size_t start = rope_line_offset(p_source_file->p_root, line);
+    size_t end = (line < TOTAL_NEWLINES(p_source_file->p_root)) ?
+        rope_line_offset(p_source_file->p_root, line + 1) - 1 :
+        p_source_file->size;
+
+    char * p_line = MALLOC(end - start + 1);
+    rope_copy(p_source_file->p_root, start, end - start, p_line);
+    p_line[end - start] = '\0';
+    return p_line;
 }
 
 void source_file_free(source_file_t * p_source_file)
 {
     ASSERT(p_source_file);
-    ASSERT(p_source_file->p_contents);
-    FREE(p_source_file->p_contents);
+    rope_free(p_source_file->p_root);
+    snapshot_invalidate(p_source_file);
+    FREE(p_source_file->p_filename);
     FREE(p_source_file);
-
-}
\ No newline at end of file
+}
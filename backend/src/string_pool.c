@@ -0,0 +1,200 @@
+#include <string.h>
+#include "string_pool.h"
+#include "utils.h"
+#include "log.h"
+
+#define BLOCK_SIZE       (64 * 1024)
+#define PAGE_BITS        12
+#define PAGE_SIZE        (1 << PAGE_BITS)
+#define PAGE_COUNT       (1 << 16)
+#define INITIAL_CAPACITY 4096
+
+/** Arena block the strings are copied into. Blocks are only freed with the pool. */
+typedef struct block
+{
+    struct block * p_next;
+    size_t used;
+    size_t size;
+    char data[];
+} block_t;
+
+static block_t * mp_blocks;
+static const char ** mp_pages[PAGE_COUNT]; ///< Strings by id. Pages never move, so lookups need no lock.
+static uint32_t * mp_slots;        ///< Open addressing hash table of ids.
+static uint32_t * mp_slot_hashes;
+static uint32_t m_capacity;
+static uint32_t m_count;
+static size_t m_size;
+static mutex_t m_mut;
+
+static uint32_t hash_string(const char * p_string, size_t length)
+{
+    uint32_t hash = 0x811C9DC5;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash = (hash ^ (uint8_t) p_string[i]) * 0x01000193;
+    }
+    return hash;
+}
+
+static char * block_alloc(size_t size)
+{
+    if (size > BLOCK_SIZE / 4)
+    {
+        /* Big strings get a block of their own, behind the current one, so its free space isn't lost. */
+        block_t * p_block = MALLOC(sizeof(block_t) + size);
+        p_block->used = size;
+        p_block->size = size;
+        if (mp_blocks)
+        {
+            p_block->p_next = mp_blocks->p_next;
+            mp_blocks->p_next = p_block;
+        }
+        else
+        {
+            p_block->p_next = NULL;
+            mp_blocks = p_block;
+        }
+        return p_block->data;
+    }
+
+    if (!mp_blocks || mp_blocks->used + size > mp_blocks->size)
+    {
+        block_t * p_block = MALLOC(sizeof(block_t) + BLOCK_SIZE);
+        p_block->used = 0;
+        p_block->size = BLOCK_SIZE;
+        p_block->p_next = mp_blocks;
+        mp_blocks = p_block;
+    }
+    char * p_data = &mp_blocks->data[mp_blocks->used];
+    mp_blocks->used += size;
+    return p_data;
+}
+
+static void table_grow(void)
+{
+    uint32_t * p_old_slots = mp_slots;
+    uint32_t * p_old_hashes = mp_slot_hashes;
+    uint32_t old_capacity = m_capacity;
+
+    m_capacity = old_capacity ? old_capacity * 2 : INITIAL_CAPACITY;
+    mp_slots = CALLOC(sizeof(uint32_t), m_capacity);
+    mp_slot_hashes = MALLOC(sizeof(uint32_t) * m_capacity);
+
+    uint32_t mask = m_capacity - 1;
+    for (uint32_t i = 0; i < old_capacity; ++i)
+    {
+        if (p_old_slots[i] != STRING_ID_NONE)
+        {
+            uint32_t slot = p_old_hashes[i] & mask;
+            while (mp_slots[slot] != STRING_ID_NONE)
+            {
+                slot = (slot + 1) & mask;
+            }
+            mp_slots[slot] = p_old_slots[i];
+            mp_slot_hashes[slot] = p_old_hashes[i];
+        }
+    }
+    FREE(p_old_slots);
+    FREE(p_old_hashes);
+}
+
+void string_pool_init(void)
+{
+    mutex_init(&m_mut);
+    m_count = 0;
+    m_size = 0;
+    m_capacity = 0;
+    table_grow();
+}
+
+string_id_t string_pool_intern(const char * p_string)
+{
+    if (!p_string)
+    {
+        return STRING_ID_NONE;
+    }
+
+    size_t length = strlen(p_string);
+    uint32_t hash = hash_string(p_string, length);
+
+    mutex_take(&m_mut);
+    uint32_t mask = m_capacity - 1;
+    uint32_t slot = hash & mask;
+    while (mp_slots[slot] != STRING_ID_NONE)
+    {
+        if (mp_slot_hashes[slot] == hash && strcmp(string_pool_get(mp_slots[slot]), p_string) == 0)
+        {
+            string_id_t id = mp_slots[slot];
+            mutex_release(&m_mut);
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    string_id_t id = ++m_count;
+    ASSERT((id >> PAGE_BITS) < PAGE_COUNT);
+    char * p_copy = block_alloc(length + 1);
+    memcpy(p_copy, p_string, length + 1);
+    m_size += length + 1;
+
+    if (!mp_pages[id >> PAGE_BITS])
+    {
+        mp_pages[id >> PAGE_BITS] = CALLOC(sizeof(const char *), PAGE_SIZE);
+    }
+    mp_pages[id >> PAGE_BITS][id & (PAGE_SIZE - 1)] = p_copy;
+
+    mp_slots[slot] = id;
+    mp_slot_hashes[slot] = hash;
+    if (m_count > m_capacity / 4 * 3)
+    {
+        table_grow();
+    }
+    mutex_release(&m_mut);
+    return id;
+}
+
+const char * string_pool_string(const char * p_string)
+{
+    return string_pool_get(string_pool_intern(p_string));
+}
+
+const char * string_pool_get(string_id_t id)
+{
+    if (id == STRING_ID_NONE)
+    {
+        return NULL;
+    }
+    return mp_pages[id >> PAGE_BITS][id & (PAGE_SIZE - 1)];
+}
+
+void string_pool_stats(uint32_t * p_count, size_t * p_size)
+{
+    mutex_take(&m_mut);
+    *p_count = m_count;
+    *p_size = m_size;
+    mutex_release(&m_mut);
+}
+
+void string_pool_free(void)
+{
+    LOG("String pool: %u strings, %u kB\n", m_count, (unsigned) (m_size / 1024));
+    while (mp_blocks)
+    {
+        block_t * p_next = mp_blocks->p_next;
+        FREE(mp_blocks);
+        mp_blocks = p_next;
+    }
+    for (uint32_t i = 0; i < PAGE_COUNT && mp_pages[i]; ++i)
+    {
+        FREE(mp_pages[i]);
+        mp_pages[i] = NULL;
+    }
+    FREE(mp_slots);
+    FREE(mp_slot_hashes);
+    mp_slots = NULL;
+    mp_slot_hashes = NULL;
+    m_capacity = 0;
+    m_count = 0;
+    mutex_free(&m_mut);
+}
@@ -0,0 +1,271 @@
+#include "thread_pool.h"
+#include "deque.h"
+#include "log.h"
+
+typedef struct
+{
+    thread_pool_task_t function;
+    void * p_args;
+    thread_pool_priority_t priority;
+    thread_pool_group_t * p_group;
+    profile_time_t queued_time;
+} task_t;
+
+typedef struct
+{
+    unsigned index;
+    bool background; ///< Runs the background tasks only, at a low thread priority.
+    thread_t * p_thread;
+    Deque * p_tasks[THREAD_POOL_PRIORITY_COUNT];
+    mutex_t mut;
+} worker_t;
+
+static const char * mp_priority_names[] = {
+    [THREAD_POOL_PRIORITY_INTERACTIVE] = "interactive",
+    [THREAD_POOL_PRIORITY_ACTIVE]      = "active",
+    [THREAD_POOL_PRIORITY_BACKGROUND]  = "background",
+};
+
+static worker_t * mp_workers;
+static unsigned m_worker_count;
+static semaphore_t m_task_sem;       ///< Signaled once for every queued foreground task, and once per foreground worker when stopping.
+static semaphore_t m_background_sem; ///< Same as m_task_sem, for background tasks and workers.
+static semaphore_t m_idle_sem;
+static atomic_counter_t m_pending;
+static atomic_counter_t m_draining;
+static atomic_counter_t m_next_worker;
+static thread_pool_stats_t m_stats[THREAD_POOL_PRIORITY_COUNT];
+static mutex_t m_stats_mut;
+
+static THREAD_LOCAL worker_t * mp_current_worker;
+
+static void group_task_done(thread_pool_group_t * p_group)
+{
+    if (atomic_get_and_sub(&p_group->pending) == 0 && p_group->callback)
+    {
+        p_group->callback(p_group->p_args);
+    }
+}
+
+static semaphore_t * task_semaphore(bool background)
+{
+    return background ? &m_background_sem : &m_task_sem;
+}
+
+static bool task_take(worker_t * p_worker, task_t ** pp_task)
+{
+    bool found = false;
+    unsigned first = p_worker->background ? THREAD_POOL_PRIORITY_BACKGROUND : 0;
+    unsigned last = p_worker->background ? THREAD_POOL_PRIORITY_COUNT : THREAD_POOL_PRIORITY_BACKGROUND;
+    for (unsigned priority = first; priority < last && !found; ++priority)
+    {
+        /* Newest task from our own deque first, it's the most likely to be in the cache. */
+        mutex_take(&p_worker->mut);
+        found = (deque_remove_last(p_worker->p_tasks[priority], (void *) pp_task) == CC_OK);
+        mutex_release(&p_worker->mut);
+
+        for (unsigned i = 1; i < m_worker_count && !found; ++i)
+        {
+            worker_t * p_victim = &mp_workers[(p_worker->index + i) % m_worker_count];
+            mutex_take(&p_victim->mut);
+            found = (deque_remove_first(p_victim->p_tasks[priority], (void *) pp_task) == CC_OK);
+            mutex_release(&p_victim->mut);
+        }
+    }
+    return found;
+}
+
+static void worker_thread(void * p_args)
+{
+    worker_t * p_worker = p_args;
+    mp_current_worker = p_worker;
+
+    while (true)
+    {
+        semaphore_wait(task_semaphore(p_worker->background));
+
+        /* Every task is queued before the semaphore of its kind is signaled, and every worker takes one
+         * signal per task, so there's always a task left for us unless we're stopping. */
+        task_t * p_task;
+        while (!task_take(p_worker, &p_task))
+        {
+            if (atomic_get(&m_draining))
+            {
+                return;
+            }
+        }
+
+        thread_pool_stats_record(p_task->priority, profile_end(p_task->queued_time));
+        p_task->function(p_task->p_args);
+        if (p_task->p_group)
+        {
+            group_task_done(p_task->p_group);
+        }
+        FREE(p_task);
+
+        if (atomic_get_and_sub(&m_pending) == 0 && atomic_get(&m_draining))
+        {
+            semaphore_signal(&m_idle_sem);
+        }
+    }
+}
+
+void thread_pool_init(unsigned thread_count)
+{
+    ASSERT(mp_workers == NULL);
+    if (thread_count == 0)
+    {
+        thread_count = thread_hardware_concurrency();
+    }
+    LOG("Starting %u foreground and %u background worker threads\n", thread_count, thread_count);
+
+    semaphore_init(&m_task_sem, 0x7FFFFFFF);
+    semaphore_init(&m_background_sem, 0x7FFFFFFF);
+    semaphore_init(&m_idle_sem, 1);
+    m_pending.value = 0;
+    m_draining.value = 0;
+    m_next_worker.value = 0;
+    mutex_init(&m_stats_mut);
+
+    m_worker_count = thread_count * 2;
+    mp_workers = CALLOC(sizeof(worker_t), m_worker_count);
+    for (unsigned i = 0; i < m_worker_count; ++i)
+    {
+        mp_workers[i].index = i;
+        mp_workers[i].background = (i >= thread_count);
+        mutex_init(&mp_workers[i].mut);
+        for (unsigned priority = 0; priority < THREAD_POOL_PRIORITY_COUNT; ++priority)
+        {
+            ASSERT(deque_new(&mp_workers[i].p_tasks[priority]) == CC_OK);
+        }
+    }
+
+    /* Start the threads after all the deques exist, as they'll start stealing right away. Thread
+     * priorities can't be raised again without privileges on Linux, so only the background workers are
+     * lowered, and the rest run requests at the normal priority. */
+    for (unsigned i = 0; i < m_worker_count; ++i)
+    {
+        mp_workers[i].p_thread = thread_start(worker_thread, &mp_workers[i],
+                                              mp_workers[i].background ? THREAD_PRIO_LOW : THREAD_PRIO_NORMAL);
+        ASSERT(mp_workers[i].p_thread);
+    }
+}
+
+unsigned thread_pool_thread_count(void)
+{
+    return m_worker_count;
+}
+
+void thread_pool_submit(thread_pool_task_t task, void * p_args, thread_pool_priority_t priority, thread_pool_group_t * p_group)
+{
+    ASSERT(mp_workers);
+    ASSERT(priority < THREAD_POOL_PRIORITY_COUNT);
+    task_t * p_task = MALLOC(sizeof(task_t));
+    p_task->function = task;
+    p_task->p_args = p_args;
+    p_task->priority = priority;
+    p_task->p_group = p_group;
+    p_task->queued_time = profile_start();
+
+    if (p_group)
+    {
+        atomic_get_and_add(&p_group->pending);
+    }
+    atomic_get_and_add(&m_pending);
+
+    worker_t * p_worker = mp_current_worker;
+    if (!p_worker)
+    {
+        p_worker = &mp_workers[(unsigned) atomic_get_and_add(&m_next_worker) % m_worker_count];
+    }
+
+    mutex_take(&p_worker->mut);
+    ASSERT(deque_add_last(p_worker->p_tasks[priority], p_task) == CC_OK);
+    mutex_release(&p_worker->mut);
+
+    semaphore_signal(task_semaphore(priority == THREAD_POOL_PRIORITY_BACKGROUND));
+}
+
+void thread_pool_group_init(thread_pool_group_t * p_group, thread_pool_group_callback_t callback, void * p_args)
+{
+    /* The group holds on to one pending count until it's closed, so it can't complete while tasks are
+     * still being added to it. */
+    p_group->pending.value = 1;
+    p_group->callback = callback;
+    p_group->p_args = p_args;
+}
+
+void thread_pool_group_close(thread_pool_group_t * p_group)
+{
+    group_task_done(p_group);
+}
+
+void thread_pool_stats_record(thread_pool_priority_t priority, uint64_t wait_time)
+{
+    if (!mp_workers)
+    {
+        return;
+    }
+
+    mutex_take(&m_stats_mut);
+    m_stats[priority].count++;
+    m_stats[priority].wait_total += wait_time;
+    if (wait_time > m_stats[priority].wait_max)
+    {
+        m_stats[priority].wait_max = wait_time;
+    }
+    mutex_release(&m_stats_mut);
+}
+
+void thread_pool_stats_get(thread_pool_priority_t priority, thread_pool_stats_t * p_stats)
+{
+    mutex_take(&m_stats_mut);
+    *p_stats = m_stats[priority];
+    mutex_release(&m_stats_mut);
+}
+
+void thread_pool_free(void)
+{
+    if (!mp_workers)
+    {
+        return;
+    }
+
+    atomic_get_and_add(&m_draining);
+    if (atomic_get(&m_pending) > 0)
+    {
+        semaphore_wait(&m_idle_sem);
+    }
+
+    for (unsigned i = 0; i < m_worker_count; ++i)
+    {
+        semaphore_signal(task_semaphore(mp_workers[i].background));
+    }
+
+    /* Idle workers steal from each other until they see the stop signal, so the deques must outlive all of them. */
+    for (unsigned i = 0; i < m_worker_count; ++i)
+    {
+        thread_join(mp_workers[i].p_thread);
+    }
+
+    for (unsigned i = 0; i < m_worker_count; ++i)
+    {
+        for (unsigned priority = 0; priority < THREAD_POOL_PRIORITY_COUNT; ++priority)
+        {
+            deque_destroy(mp_workers[i].p_tasks[priority]);
+        }
+        mutex_free(&mp_workers[i].mut);
+    }
+
+    for (unsigned priority = 0; priority < THREAD_POOL_PRIORITY_COUNT; ++priority)
+    {
+        LOG("Queue wait (%s): %u tasks, avg %u us, max %u ms\n",
+            mp_priority_names[priority],
+            (unsigned) m_stats[priority].count,
+            (unsigned) (m_stats[priority].count ? m_stats[priority].wait_total / m_stats[priority].count / 1000 : 0),
+            PROFILE_NS_TO_MS(m_stats[priority].wait_max));
+    }
+    FREE(mp_workers);
+    mp_workers = NULL;
+    m_worker_count = 0;
+}
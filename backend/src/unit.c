@@ -7,6 +7,9 @@
 #include "decoders.h"
 #include "encoders.h"
 #include "indexer.h"
+#include "preamble.h"
+#include "include_index.h"
+#include "file_watcher.h"
 
 #define TRANSLATION_UNIT_PARSE_OPTIONS (CXTranslationUnit_PrecompiledPreamble |                  \
                                         CXTranslationUnit_CacheCompletionResults |               \
@@ -53,6 +56,80 @@ static unit_diagnostics_callback_t m_diagnostics_callback;
 static index_t m_decl_index;
 static CXIndexAction m_index_action;
 static CXIndexAction m_index_action_tu;
+static HashTable * mp_dependents; ///< Units including each file, by pooled path
+static mutex_t m_dependents_mut;
+
+/** Units that may keep a spare translation unit, the one reparsed the longest ago first. */
+static struct
+{
+    mutex_t mut;
+    unit_t ** pp_units;
+    unsigned count;
+} m_spares;
+
+/**
+ * Completion candidate. Only what it's ranked by is read from the completion string up front, the item is
+ * built the first time the candidate makes it into a response, and its detail and documentation the first
+ * time the client resolves it.
+ */
+typedef struct
+{
+    const CXCompletionResult * p_result; ///< Points into the cache's results.
+    char * p_typed_text; ///< Text matched against what's typed at the completion point, or NULL.
+    uint32_t priority; ///< Clang's priority, lower is better.
+    bool built;
+    bool resolved;
+    completion_item_t item; ///< Only valid once built, its detail and documentation once resolved.
+    char * p_full_text;
+} completion_candidate_t;
+
+typedef struct
+{
+    unsigned candidate;
+    int32_t score;
+    uint32_t priority;
+} completion_match_t;
+
+/**
+ * Candidates from the last completion in a unit. Typing more of the same identifier doesn't change what
+ * clang would complete there, so they are refiltered instead of asking clang again, as long as the rest
+ * of the document stays the same.
+ */
+struct completion_cache
+{
+    char * p_filename;
+    size_t start; ///< Offset of the identifier being completed.
+    uint64_t context_hash; ///< Hash of the document around the identifier.
+    CXCodeCompleteResults * p_results; ///< Owns the completion strings the candidates are built from.
+    completion_candidate_t * p_candidates;
+    uint64_t * p_masks; ///< Character bitmap of each candidate's filter text, to reject most of them without scoring.
+    unsigned count;
+    unsigned capacity;
+    arena_t arena; ///< Strings of the candidates, released with the cache.
+    uint32_t id; ///< Tells resolve requests for the candidates of an older cache apart.
+};
+
+static atomic_counter_t m_completion_cache_id;
+
+static void completion_cache_free(completion_cache_t * p_cache)
+{
+    if (p_cache)
+    {
+        clang_disposeCodeCompleteResults(p_cache->p_results);
+        arena_free(&p_cache->arena);
+        FREE(p_cache->p_candidates);
+        FREE(p_cache->p_masks);
+        FREE(p_cache->p_filename);
+        FREE(p_cache);
+    }
+}
+
+/** Must be called with the unit's mutex taken, whenever its published translation unit changes. */
+static void completion_cache_clear(unit_t * p_unit)
+{
+    completion_cache_free(p_unit->p_completion_cache);
+    p_unit->p_completion_cache = NULL;
+}
 
 static bool position_equal(const position_t * p_pos1, const position_t * p_pos2)
 {
@@ -322,7 +399,7 @@ static enum CXChildVisitResult cursor_visitor(CXCursor cursor, CXCursor parent,
     return CXChildVisit_Continue;
 }
 
-static CXCursor get_function_cursor(unit_t * p_unit, const char * p_filename, unsigned line, unsigned column, unsigned * p_param_index)
+static CXCursor get_function_cursor(unit_t * p_unit, const char * p_filename, unsigned line, unsigned column, unsigned * p_param_index, cancel_token_t * p_token)
 {
     // Tokenize last search_lines lines
     const unsigned search_lines = 20;
@@ -344,7 +421,7 @@ static CXCursor get_function_cursor(unit_t * p_unit, const char * p_filename, un
         int parenthesises_depth = 0;
         *p_param_index = 0;
         bool found = false;
-        for (int i = token_count - 1; i >= 0 && !found; --i)
+        for (int i = token_count - 1; i >= 0 && !found && !cancel_token_should_stop(p_token); --i)
         {
             enum CXCursorKind kind = clang_getCursorKind(p_cursors[i]);
             CXString token_spelling = clang_getTokenSpelling(p_unit->tu, p_tokens[i]);
@@ -465,11 +542,21 @@ static void include_visitor(CXFile included_file,
 
 static void clear_index_decls(unit_t * p_unit)
 {
-    index_declaration_t * p_decl;
-    while (array_remove_last(p_unit->p_declarations, &p_decl) == CC_OK)
+    index_unit_decls_remove(&m_decl_index, &p_unit->first_declaration);
+}
+
+/** Must be called with m_dependents_mut taken. */
+static void dependent_remove(const char * p_file, unit_t * p_unit)
+{
+    HashTable * p_units;
+    if (hashtable_get(mp_dependents, (void *) p_file, &p_units) == CC_OK)
     {
-        index_decl_remove(&m_decl_index, p_decl->p_USR, p_decl);
-        index_decl_free(p_decl);
+        hashtable_remove(p_units, (void *) p_unit->p_filename, NULL);
+        if (hashtable_size(p_units) == 0)
+        {
+            hashtable_remove(mp_dependents, (void *) p_file, NULL);
+            hashtable_destroy(p_units);
+        }
     }
 }
 
@@ -479,22 +566,66 @@ static void clear_included_files(unit_t * p_unit)
     p_unit->main_header_score = PATH_PAIR_SCORE_SUBSTRING;
 	if (hashtable_size(p_unit->p_included_files) > 0)
 	{
+		mutex_take(&m_dependents_mut);
 		HashTableIter iter;
 		hashtable_iter_init(&iter, p_unit->p_included_files);
 		TableEntry * p_entry;
 		while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
 		{
-			char * p_value;
-			if (hashtable_iter_remove(&iter, &p_value) == CC_OK)
-				FREE(p_value);
+			dependent_remove(p_entry->key, p_unit);
+			/* The paths are pooled, and shared with the other units. */
+			hashtable_iter_remove(&iter, NULL);
 		}
+		mutex_release(&m_dependents_mut);
 	}
 }
 
+static void dependent_add(const char * p_file, unit_t * p_unit)
+{
+    mutex_take(&m_dependents_mut);
+    HashTable * p_units;
+    if (hashtable_get(mp_dependents, (void *) p_file, &p_units) != CC_OK)
+    {
+        ASSERT(hashtable_new(&p_units) == CC_OK);
+        ASSERT(hashtable_add(mp_dependents, (void *) p_file, p_units) == CC_OK);
+    }
+    ASSERT(hashtable_add(p_units, (void *) p_unit->p_filename, p_unit) == CC_OK);
+    mutex_release(&m_dependents_mut);
+}
+
+/** Add a file the unit includes without the indexer reporting it. */
+static void included_file_add(const char * p_path, void * p_args)
+{
+    unit_t * p_unit = p_args;
+    const char * p_filename = string_pool_string(p_path);
+    if (!path_equals(p_filename, p_unit->p_filename) &&
+        !hashtable_contains_key(p_unit->p_included_files, (void *) p_filename))
+    {
+        ASSERT(hashtable_add(p_unit->p_included_files, (void *) p_filename, (void *) p_filename) == CC_OK);
+        dependent_add(p_filename, p_unit);
+    }
+    file_watcher_add(p_filename);
+}
+
+/* The preamble doesn't tell quoted includes from angled ones, but the unit's own header is the one most
+ * likely to be precompiled, so all of them are considered for it. */
+static void preamble_dependency_add(const char * p_path, void * p_args)
+{
+    unit_t * p_unit = p_args;
+    included_file_add(p_path, p_unit);
+    unsigned header_score = path_pair_score(p_path, p_unit->p_filename);
+    if (header_score > p_unit->main_header_score && !path_equals(p_path, p_unit->p_filename))
+    {
+        p_unit->p_main_header = p_path;
+        p_unit->main_header_score = header_score;
+    }
+}
+
 typedef struct
 {
     unit_t * p_unit;
     CXFile main_file;
+    string_id_t main_file_path;
     bool in_main_file;
     bool cleared_includes;
 } index_context_t;
@@ -504,6 +635,13 @@ static CXIdxClientFile index_entered_mainfile(CXClientData client_data, CXFile m
     index_context_t * p_context = client_data;
     p_context->main_file = main_file;
     p_context->in_main_file = true;
+
+    /* All indexed declarations are in the main file, so its path is only looked up once. */
+    CXString filename = clang_getFileName(main_file);
+    uri_t uri = uri_file(clang_getCString(filename));
+    p_context->main_file_path = string_pool_intern(uri.path);
+    uri_free_members(&uri);
+    clang_disposeString(filename);
     return NULL;
 }
 
@@ -521,31 +659,21 @@ static void index_declaration(CXClientData client_data, const CXIdxDeclInfo * p_
             unsigned line;
             unsigned column;
             clang_indexLoc_getFileLocation(p_info->loc, NULL, &file, &line, &column, NULL);
-            CXString filename = clang_getFileName(file);
 
             if (clang_File_isEqual(file, p_context->main_file))
             {
-                index_declaration_t * p_decl = MALLOC(sizeof(index_declaration_t));
-                ASSERT(p_decl);
-
                 enum CXVisibilityKind visibility = clang_getCursorVisibility(p_info->cursor);
 
-                p_decl->p_USR = NULL;
-                p_decl->kind = kind;
-                p_decl->p_name = STRDUP(clang_getCString(symbolname));
-                p_decl->scope = (visibility == CXVisibility_Default) ? INDEX_SCOPE_GLOBAL : INDEX_SCOPE_LOCAL;
-                p_decl->location.uri = uri_file(clang_getCString(filename));
-                p_decl->location.range.start.line = line - 1;
-                p_decl->location.range.start.character = column - 1;
-                p_decl->location.range.start.valid_fields = POSITION_FIELD_ALL;
-                p_decl->location.range.end = p_decl->location.range.start;
-                p_decl->location.range.valid_fields = RANGE_FIELD_ALL;
-                p_decl->location.valid_fields = LOCATION_FIELD_ALL;
-
-                index_declaration_add(&m_decl_index, p_info->entityInfo->USR, p_decl);
-                array_add(p_context->p_unit->p_declarations, p_decl);
+                index_declaration_t decl;
+                decl.kind = kind;
+                decl.name = string_pool_intern(clang_getCString(symbolname));
+                decl.scope = (visibility == CXVisibility_Default) ? INDEX_SCOPE_GLOBAL : INDEX_SCOPE_LOCAL;
+                decl.file = p_context->main_file_path;
+                decl.line = line - 1;
+                decl.character = column - 1;
+
+                index_declaration_add(&m_decl_index, p_info->entityInfo->USR, &decl, &p_context->p_unit->first_declaration);
             }
-            clang_disposeString(filename);
         }
         clang_disposeString(symbolname);
     }
@@ -562,9 +690,13 @@ CXIdxClientFile index_included_file(CXClientData client_data, const CXIdxInclude
             p_context->cleared_includes = true;
         }
         CXString filename = clang_getFileName(p_info->file);
-        char * p_filename = absolute_path(clang_getCString(filename), path_cwd());
+        char * p_absolute_path = absolute_path(clang_getCString(filename), path_cwd());
+        const char * p_filename = string_pool_string(p_absolute_path);
+        FREE(p_absolute_path);
         clang_disposeString(filename);
-        ASSERT(hashtable_add(p_context->p_unit->p_included_files, p_filename, p_filename) == CC_OK);
+        ASSERT(hashtable_add(p_context->p_unit->p_included_files, (void *) p_filename, (void *) p_filename) == CC_OK);
+        dependent_add(p_filename, p_context->p_unit);
+        file_watcher_add(p_filename);
         if (!p_info->isAngled)
         {
             unsigned header_score = path_pair_score(p_filename, p_context->p_unit->p_filename);
@@ -587,7 +719,11 @@ static bool index_source_file(unit_t * p_unit,
                               uint32_t unsaved_file_count,
                               bool keep_tu)
 {
+    /* Units are indexed again when their files change on disk, so the declarations and includes of the
+     * last index go first, as they do when a translation unit is indexed. */
     mutex_take(&p_unit->decl_mutex);
+    clear_index_decls(p_unit);
+    index_unit_supersede(&m_decl_index, p_unit->p_filename);
     profile_time_t start_time = profile_start();
     IndexerCallbacks callbacks = {
         .enteredMainFile = index_entered_mainfile,
@@ -596,7 +732,7 @@ static bool index_source_file(unit_t * p_unit,
     };
     index_context_t context = {
         .p_unit = p_unit,
-        .cleared_includes = true
+        .cleared_includes = false
     };
     bool success;
     if (p_unit->flags.full_argv)
@@ -646,17 +782,18 @@ static bool index_source_file(unit_t * p_unit,
         index_header_set(&m_decl_index, p_unit->p_filename, p_unit->p_main_header);
     }
 
-    unsigned delta = profile_end(start_time);
+    unsigned delta = PROFILE_NS_TO_MS(profile_end(start_time));
     LOG("Index %s: %ums\n", p_unit->p_filename, delta);
 
     mutex_release(&p_unit->decl_mutex);
     return success;
 }
 
-static void index_translation_unit(unit_t * p_unit)
+static void index_translation_unit(unit_t * p_unit, CXTranslationUnit tu)
 {
     mutex_take(&p_unit->decl_mutex);
     clear_index_decls(p_unit);
+    index_unit_supersede(&m_decl_index, p_unit->p_filename);
 
     profile_time_t start_timer = profile_start();
     IndexerCallbacks callbacks = {
@@ -668,10 +805,21 @@ static void index_translation_unit(unit_t * p_unit)
         .p_unit = p_unit,
         .cleared_includes = false
     };
-    clang_indexTranslationUnit(m_index_action_tu, &context, &callbacks, sizeof(callbacks), INDEX_OPTIONS, p_unit->tu);
+    clang_indexTranslationUnit(m_index_action_tu, &context, &callbacks, sizeof(callbacks), INDEX_OPTIONS, tu);
+
+    /* The indexer doesn't report the files included through the precompiled header, so they're taken
+     * from the preamble, or the unit wouldn't be reparsed when they change. */
+    if (p_unit->p_preamble)
+    {
+        if (!context.cleared_includes)
+        {
+            clear_included_files(p_unit);
+        }
+        preamble_dependencies_get(p_unit->p_preamble, preamble_dependency_add, p_unit);
+    }
     index_header_set(&m_decl_index, p_unit->p_filename, p_unit->p_main_header);
 
-    LOG("Index: %ums\n", profile_end(start_timer));
+    LOG("Index: %ums\n", PROFILE_NS_TO_MS(profile_end(start_timer)));
     LOG("%s header file: %s (score: %u)\n", p_unit->p_filename, p_unit->p_main_header, p_unit->main_header_score);
 
     mutex_release(&p_unit->decl_mutex);
@@ -682,9 +830,22 @@ void unit_init(const unit_config_t * p_config)
     m_index = clang_createIndex(true, false);
     clang_CXIndex_setGlobalOptions(m_index, CXGlobalOpt_ThreadBackgroundPriorityForEditing);
     m_config = *p_config;
+    string_pool_init();
     index_init(&m_decl_index);
+    ASSERT(hashtable_new(&mp_dependents) == CC_OK);
+    mutex_init(&m_dependents_mut);
     m_index_action = clang_IndexAction_create(m_index);
     m_index_action_tu = clang_IndexAction_create(m_index);
+    mutex_init(&m_spares.mut);
+    if (m_config.spare_units_max > 0)
+    {
+        m_spares.pp_units = MALLOC(sizeof(unit_t *) * m_config.spare_units_max);
+    }
+    if (m_config.p_preamble_directory)
+    {
+        preamble_init(m_index, m_config.p_preamble_directory);
+    }
+    include_index_init();
 }
 
 void unit_diagnostics_callback_set(unit_diagnostics_callback_t callback)
@@ -701,86 +862,267 @@ unit_t * unit_create(const char * p_filename,
     p_unit->p_filename = normalize_path(p_filename);
     mutex_init(&p_unit->decl_mutex);
     mutex_init(&p_unit->mutex);
+    mutex_init(&p_unit->reparse_mutex);
     ASSERT(hashtable_new(&p_unit->diag_files) == CC_OK);
-    ASSERT(array_new(&p_unit->p_declarations) == CC_OK);
+    p_unit->first_declaration = INDEX_DECL_NONE;
     ASSERT(hashtable_new(&p_unit->p_included_files) == CC_OK);
+
+    /* The unit depends on its main file as well, so that it's reindexed when the file changes on disk. */
+    const char * p_pooled_filename = string_pool_string(p_unit->p_filename);
+    dependent_add(p_pooled_filename, p_unit);
+    file_watcher_add(p_pooled_filename);
     LOG("Added unit %s\n", p_unit->p_filename);
     return p_unit;
 }
 
-typedef struct
+static void index_shard_write(unit_t * p_unit)
 {
-    unit_t * p_unit;
-    struct CXUnsavedFile * p_unsaved_files;
-    uint32_t unsaved_file_count;
-} index_thread_context_t;
+    mutex_take(&p_unit->decl_mutex);
+    size_t dependency_count = 0;
+    index_dependency_t * p_dependencies = MALLOC(sizeof(index_dependency_t) * (1 + hashtable_size(p_unit->p_included_files)));
 
-static void index_thread(void * p_args)
-{
-    index_thread_context_t * p_context = p_args;
-    index_source_file(p_context->p_unit, p_context->p_unsaved_files, p_context->unsaved_file_count, false);
-    FREE(p_context);
+    /* Files that can't be read are left out, they'll show up in the unit's next index. */
+    p_dependencies[dependency_count].p_path = p_unit->p_filename;
+    if (index_file_hash(&m_decl_index, p_unit->p_filename, &p_dependencies[dependency_count].hash))
+    {
+        dependency_count++;
+    }
+    if (hashtable_size(p_unit->p_included_files) > 0)
+    {
+        HashTableIter iter;
+        hashtable_iter_init(&iter, p_unit->p_included_files);
+        TableEntry * p_entry;
+        while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+        {
+            p_dependencies[dependency_count].p_path = p_entry->key;
+            if (index_file_hash(&m_decl_index, p_entry->key, &p_dependencies[dependency_count].hash))
+            {
+                dependency_count++;
+            }
+        }
+    }
+
+    if (path_create_directory(m_config.p_index_directory))
+    {
+        char * p_location = index_shard_location(m_config.p_index_directory, p_unit->p_filename);
+        index_shard_save(&m_decl_index, p_location, p_unit->p_filename, p_unit->first_declaration, p_unit->p_main_header, p_dependencies, dependency_count);
+        FREE(p_location);
+    }
+    FREE(p_dependencies);
+    mutex_release(&p_unit->decl_mutex);
 }
 
 void unit_index(unit_t * p_unit,
                 struct CXUnsavedFile * p_unsaved_files,
                 uint32_t unsaved_file_count)
 {
-#if MULTITHREAD_INDEXING
-    index_thread_context_t * p_context = MALLOC(sizeof(index_thread_context_t));
-    p_context->p_unit = p_unit;
-    p_context->p_unsaved_files = p_unsaved_files;
-    p_context->unsaved_file_count = unsaved_file_count;
-    p_unit->p_index_thread = thread_start(index_thread, p_context);
-#else
-    index_source_file(p_unit, p_unsaved_files, unsaved_file_count, false);
-#endif
+    if (index_source_file(p_unit, p_unsaved_files, unsaved_file_count, false))
+    {
+        index_shard_write(p_unit);
+    }
 }
 
-bool unit_parse(unit_t * p_unit,
-                struct CXUnsavedFile * p_unsaved_files,
-                uint32_t unsaved_file_count)
+static void spares_remove(unit_t * p_unit)
+{
+    for (unsigned i = 0; i < m_spares.count; ++i)
+    {
+        if (m_spares.pp_units[i] == p_unit)
+        {
+            memmove(&m_spares.pp_units[i], &m_spares.pp_units[i + 1], (m_spares.count - i - 1) * sizeof(unit_t *));
+            m_spares.count--;
+            return;
+        }
+    }
+}
+
+/**
+ * Get a place in the spare translation unit budget, taking it from the unit that was reparsed the
+ * longest ago if they're all in use. Must be called with the unit's reparse mutex taken.
+ *
+ * @returns Whether the unit may keep a spare.
+ */
+static bool spare_acquire(unit_t * p_unit)
+{
+    if (m_config.spare_units_max == 0)
+    {
+        return false;
+    }
+
+    mutex_take(&m_spares.mut);
+    unsigned count_before = m_spares.count;
+    spares_remove(p_unit);
+    bool acquired = (m_spares.count < count_before || m_spares.count < m_config.spare_units_max);
+
+    for (unsigned i = 0; i < m_spares.count && !acquired; ++i)
+    {
+        /* A unit that's being reparsed is using its spare, so it's left alone. Only trying the lock
+         * keeps two units that evict each other from deadlocking. */
+        unit_t * p_victim = m_spares.pp_units[i];
+        if (mutex_try_take(&p_victim->reparse_mutex))
+        {
+            LOG("Dropping the spare translation unit of %s\n", p_victim->p_filename);
+            if (p_victim->next_tu)
+            {
+                clang_disposeTranslationUnit(p_victim->next_tu);
+                p_victim->next_tu = NULL;
+                p_victim->next_tu_memory = 0;
+            }
+            mutex_release(&p_victim->reparse_mutex);
+            spares_remove(p_victim);
+            acquired = true;
+        }
+    }
+
+    if (acquired)
+    {
+        m_spares.pp_units[m_spares.count++] = p_unit;
+    }
+    mutex_release(&m_spares.mut);
+    return acquired;
+}
+
+/** Must be called with the unit's reparse mutex taken. */
+static void spare_release(unit_t * p_unit)
+{
+    if (p_unit->next_tu)
+    {
+        clang_disposeTranslationUnit(p_unit->next_tu);
+        p_unit->next_tu = NULL;
+        p_unit->next_tu_memory = 0;
+    }
+    mutex_take(&m_spares.mut);
+    spares_remove(p_unit);
+    mutex_release(&m_spares.mut);
+}
+
+/** Bytes of memory held by the translation unit, as reported by libclang. */
+static uint64_t tu_memory_usage(CXTranslationUnit tu)
 {
-    ASSERT(!p_unit->active);
+    uint64_t total = 0;
+    CXTUResourceUsage usage = clang_getCXTUResourceUsage(tu);
+    for (unsigned i = 0; i < usage.numEntries; ++i)
+    {
+        total += usage.entries[i].amount;
+    }
+    clang_disposeCXTUResourceUsage(usage);
+    return total;
+}
 
+/**
+ * Make the translation unit the one that requests read from. Requests that are already reading the
+ * previous one finish with it first. The previous one becomes the spare that the next generation is
+ * reparsed in, or is disposed of. Must be called with the unit's reparse mutex taken.
+ */
+static void publish(unit_t * p_unit, CXTranslationUnit tu, bool keep_spare)
+{
+    /* Measured while no request can be reading it yet. */
+    uint64_t memory = tu_memory_usage(tu);
+
+    mutex_take(&p_unit->mutex);
+    CXTranslationUnit old_tu = (p_unit->active ? p_unit->tu : NULL);
+    uint64_t old_memory = p_unit->tu_memory;
+    p_unit->tu = tu;
+    p_unit->tu_memory = memory;
+    p_unit->active = true;
+    completion_cache_clear(p_unit);
+    mutex_release(&p_unit->mutex);
+
+    if (old_tu && keep_spare && !p_unit->next_tu)
+    {
+        p_unit->next_tu = old_tu;
+        p_unit->next_tu_memory = old_memory;
+    }
+    else if (old_tu)
+    {
+        clang_disposeTranslationUnit(old_tu);
+    }
+}
+
+/**
+ * Parse a new translation unit for the unit, on top of the shared precompiled header for its includes
+ * when there is one. Must be called with the unit's reparse mutex taken.
+ */
+static bool parse_translation_unit(unit_t * p_unit,
+                                   struct CXUnsavedFile * p_unsaved_files,
+                                   uint32_t unsaved_file_count,
+                                   CXTranslationUnit * p_tu)
+{
+    preamble_t * p_preamble = NULL;
+    uint32_t preamble_generation = 0;
+    if (m_config.p_preamble_directory)
+    {
+        p_preamble = preamble_get(p_unit->p_filename, &p_unit->flags, p_unsaved_files, unsaved_file_count, &preamble_generation);
+    }
+
+    const char ** pp_args = MALLOC(sizeof(const char *) * (p_unit->flags.count + 2));
+    memcpy(pp_args, p_unit->flags.pp_array, sizeof(const char *) * p_unit->flags.count);
+    unsigned arg_count = p_unit->flags.count;
+    if (p_preamble)
+    {
+        pp_args[arg_count++] = "-include-pch";
+        pp_args[arg_count++] = preamble_location(p_preamble);
+    }
+
+    bool success;
     if (p_unit->flags.full_argv)
     {
-        p_unit->active = (clang_parseTranslationUnit2FullArgv(m_index,
-                                                    NULL,
-                                                    p_unit->flags.pp_array,
-                                                    p_unit->flags.count,
-                                                    p_unsaved_files,
-                                                    unsaved_file_count,
-                                                    TRANSLATION_UNIT_PARSE_OPTIONS,
-                                                    &p_unit->tu) == CXError_Success);
+        success = (clang_parseTranslationUnit2FullArgv(m_index,
+                                                       NULL,
+                                                       pp_args,
+                                                       arg_count,
+                                                       p_unsaved_files,
+                                                       unsaved_file_count,
+                                                       TRANSLATION_UNIT_PARSE_OPTIONS,
+                                                       p_tu) == CXError_Success);
     }
     else
     {
-        p_unit->active = (clang_parseTranslationUnit2(m_index,
-                                                    p_unit->p_filename,
-                                                    p_unit->flags.pp_array,
-                                                    p_unit->flags.count,
-                                                    p_unsaved_files,
-                                                    unsaved_file_count,
-                                                    TRANSLATION_UNIT_PARSE_OPTIONS,
-                                                    &p_unit->tu) == CXError_Success);
+        success = (clang_parseTranslationUnit2(m_index,
+                                               p_unit->p_filename,
+                                               pp_args,
+                                               arg_count,
+                                               p_unsaved_files,
+                                               unsaved_file_count,
+                                               TRANSLATION_UNIT_PARSE_OPTIONS,
+                                               p_tu) == CXError_Success);
     }
+    FREE(pp_args);
 
-    if (p_unit->active)
+    if (success)
     {
-        index_translation_unit(p_unit);
+        p_unit->p_preamble = p_preamble;
+        p_unit->preamble_generation = preamble_generation;
     }
-    return p_unit->active;
+    return success;
+}
+
+bool unit_parse(unit_t * p_unit,
+                struct CXUnsavedFile * p_unsaved_files,
+                uint32_t unsaved_file_count)
+{
+    /* Parsed off to the side, so that requests can keep reading the current generation meanwhile. */
+    CXTranslationUnit tu;
+    bool success = parse_translation_unit(p_unit, p_unsaved_files, unsaved_file_count, &tu);
+    if (success)
+    {
+        index_translation_unit(p_unit, tu);
+        publish(p_unit, tu, p_unit->active && spare_acquire(p_unit));
+    }
+    return success;
 }
 
 void unit_free(unit_t * p_unit)
 {
-    FREE((char *) p_unit->p_filename);
+    spare_release(p_unit);
+    completion_cache_clear(p_unit);
     clang_disposeTranslationUnit(p_unit->tu);
     clear_included_files(p_unit);
     hashtable_destroy(p_unit->p_included_files);
+    mutex_take(&m_dependents_mut);
+    dependent_remove(string_pool_string(p_unit->p_filename), p_unit);
+    mutex_release(&m_dependents_mut);
+    FREE((char *) p_unit->p_filename);
     clear_index_decls(p_unit);
-    array_destroy(p_unit->p_declarations);
     compile_flags_free(&p_unit->flags);
 
     for (size_t i = 0; i < p_unit->fixit_count; ++i)
@@ -790,7 +1132,6 @@ void unit_free(unit_t * p_unit)
         FREE(p_unit->p_fixits[i].p_string);
     }
     FREE(p_unit->p_fixits);
-    FREE(p_unit->p_main_header);
 
     if (hashtable_size(p_unit->diag_files) > 0)
     {
@@ -815,14 +1156,33 @@ void unit_free(unit_t * p_unit)
 
 void unit_index_free(void)
 {
+    if (m_config.p_preamble_directory)
+    {
+        preamble_free();
+    }
+    include_index_free();
     clang_disposeIndex(m_index);
     index_free(&m_decl_index);
+    hashtable_destroy(mp_dependents);
+    mutex_free(&m_dependents_mut);
+    string_pool_free();
 }
 
 void unit_suspend(unit_t * p_unit)
 {
+    spare_release(p_unit);
+    mutex_take(&p_unit->mutex);
     clang_disposeTranslationUnit(p_unit->tu);
+    p_unit->tu = NULL;
+    p_unit->tu_memory = 0;
     p_unit->active = false;
+    completion_cache_clear(p_unit);
+    mutex_release(&p_unit->mutex);
+}
+
+uint64_t unit_memory_usage(unit_t * p_unit)
+{
+    return p_unit->tu_memory + p_unit->next_tu_memory;
 }
 
 bool unit_reparse(unit_t * p_unit,
@@ -832,15 +1192,80 @@ bool unit_reparse(unit_t * p_unit,
     ASSERT(p_unit->active);
     LOG("Reparsing %s\n", p_unit->p_filename);
 
-    enum CXErrorCode status = clang_reparseTranslationUnit(p_unit->tu,
-                                         unsaved_file_count,
-                                         p_unsaved_files,
-                                         TRANSLATION_UNIT_REPARSE_OPTIONS);
-    if (status == CXError_Success)
+    /* A translation unit can't switch to another precompiled header, or stop using it, without being
+     * parsed again. It changes with the unit's includes, or when the files it includes change. A rebuilt
+     * header is written over the old one, so it's the same preamble with a new generation. */
+    uint32_t preamble_generation = 0;
+    preamble_t * p_preamble = NULL;
+    if (m_config.p_preamble_directory)
+    {
+        p_preamble = preamble_get(p_unit->p_filename, &p_unit->flags, p_unsaved_files, unsaved_file_count, &preamble_generation);
+    }
+    if (m_config.p_preamble_directory &&
+        (p_preamble != p_unit->p_preamble || (p_preamble && preamble_generation != p_unit->preamble_generation)))
+    {
+        LOG("The precompiled includes of %s changed, parsing it from scratch\n", p_unit->p_filename);
+        /* The spare was parsed with the old precompiled header as well. */
+        spare_release(p_unit);
+        bool success = unit_parse(p_unit, p_unsaved_files, unsaved_file_count);
+        spare_release(p_unit);
+        return success;
+    }
+
+    if (!p_unit->next_tu && spare_acquire(p_unit))
+    {
+        /* There's no spare to reparse yet, so a new generation is parsed from scratch instead, and the
+         * current one becomes the spare. */
+        return unit_parse(p_unit, p_unsaved_files, unsaved_file_count);
+    }
+
+    enum CXErrorCode status;
+    if (p_unit->next_tu)
     {
-        index_translation_unit(p_unit);
+        /* The spare is an older generation, and catches up with every change since in one reparse. */
+        status = clang_reparseTranslationUnit(p_unit->next_tu,
+                                              unsaved_file_count,
+                                              p_unsaved_files,
+                                              TRANSLATION_UNIT_REPARSE_OPTIONS);
+        CXTranslationUnit tu = p_unit->next_tu;
+        p_unit->next_tu = NULL;
+        p_unit->next_tu_memory = 0;
+        if (status == CXError_Success)
+        {
+            index_translation_unit(p_unit, tu);
+            publish(p_unit, tu, spare_acquire(p_unit));
+        }
+        else
+        {
+            /* A translation unit that failed to reparse can only be disposed of. */
+            clang_disposeTranslationUnit(tu);
+        }
     }
     else
+    {
+        /* Over the spare budget: reparse in place, holding off the requests meanwhile. */
+        mutex_take(&p_unit->mutex);
+        completion_cache_clear(p_unit);
+        status = clang_reparseTranslationUnit(p_unit->tu,
+                                              unsaved_file_count,
+                                              p_unsaved_files,
+                                              TRANSLATION_UNIT_REPARSE_OPTIONS);
+        if (status == CXError_Success)
+        {
+            index_translation_unit(p_unit, p_unit->tu);
+            p_unit->tu_memory = tu_memory_usage(p_unit->tu);
+        }
+        else
+        {
+            clang_disposeTranslationUnit(p_unit->tu);
+            p_unit->tu = NULL;
+            p_unit->tu_memory = 0;
+            p_unit->active = false;
+        }
+        mutex_release(&p_unit->mutex);
+    }
+
+    if (status != CXError_Success)
     {
         LOG("Reparse failed: Status %u\n", status);
     }
@@ -938,22 +1363,525 @@ static void tokenize_line(unit_t * p_unit,
 
 typedef struct
 {
-    size_t base_path_len;
     completion_item_t completion_item;
     unit_completion_result_callback_t callback;
     void * p_args;
+    unsigned count;
 } include_file_completion_callback_context_t;
 
-static void include_file_completion_callback(const char * p_filename, path_kind_t kind, void * p_args)
+static bool include_file_completion_callback(const char * p_path, bool directory, void * p_args)
 {
-    if (kind == PATH_KIND_FILE)
+    include_file_completion_callback_context_t * p_context = p_args;
+    if (p_context->count == m_config.completion_results_max)
     {
-        include_file_completion_callback_context_t * p_context = p_args;
-        ASSERT(strlen(p_filename) >= p_context->base_path_len);
-        p_context->completion_item.text_edit.new_text = (char *) &p_filename[p_context->base_path_len + 1];
-        p_context->completion_item.label = (char *) &p_filename[p_context->base_path_len + 1];
-        p_context->callback(&p_context->completion_item, 0, p_context->p_args);
+        return false;
     }
+    char label[COMPLETION_STRING_MAXLEN];
+    snprintf(label, sizeof(label), "%s%s", p_path, directory ? "/" : "");
+    p_context->completion_item.text_edit.new_text = label;
+    p_context->completion_item.label = label;
+    p_context->completion_item.kind = (directory ? COMPLETION_ITEM_KIND_FOLDER : COMPLETION_ITEM_KIND_FILE);
+    p_context->callback(&p_context->completion_item, 0, p_context->p_args);
+    p_context->count++;
+    return true;
+}
+
+/**
+ * Get the directories an include is looked up in, in the order the preprocessor searches them. Quoted
+ * includes are looked up next to the file and in the -iquote directories before the others.
+ *
+ * @param[out] pp_directories Array with room for a directory per flag, plus one.
+ * @param[out] pp_file_directory Directory of the file, if it's searched. Must be freed by the caller.
+ *
+ * @returns The number of directories.
+ */
+static unsigned include_directories_get(const unit_t * p_unit,
+                                        const char * p_filename,
+                                        bool quoted,
+                                        const char ** pp_directories,
+                                        char ** pp_file_directory)
+{
+    static const char * include_flags[] = {"-iquote", "-I", "-isystem", "-idirafter"};
+    unsigned count = 0;
+    *pp_file_directory = NULL;
+    if (quoted)
+    {
+        *pp_file_directory = path_directory(p_filename);
+        pp_directories[count++] = *pp_file_directory;
+    }
+
+    for (unsigned flag = (quoted ? 0 : 1); flag < ARRAY_SIZE(include_flags); ++flag)
+    {
+        size_t flag_length = strlen(include_flags[flag]);
+        for (unsigned i = 0; i < p_unit->flags.count; ++i)
+        {
+            const char * p_arg = p_unit->flags.pp_array[i];
+            if (strncmp(p_arg, include_flags[flag], flag_length) == 0)
+            {
+                if (p_arg[flag_length] != '\0')
+                {
+                    pp_directories[count++] = &p_arg[flag_length];
+                }
+                else if (i + 1 < p_unit->flags.count)
+                {
+                    pp_directories[count++] = p_unit->flags.pp_array[++i];
+                }
+            }
+        }
+    }
+    return count;
+}
+
+/** Position of a completion in the current contents of its document. */
+typedef struct
+{
+    size_t start; ///< Start of the identifier being completed, or the cursor if there's none.
+    size_t cursor;
+    uint64_t context_hash; ///< Hash of everything but the identifier.
+} completion_point_t;
+
+static bool is_identifier_char(char c)
+{
+    return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_');
+}
+
+/**
+ * Find the position in the document's unsaved contents.
+ *
+ * @param[out] p_line_start Offset of the start of the position's line.
+ * @param[out] p_cursor Offset of the position.
+ *
+ * @returns The unsaved document, or NULL if the document isn't open.
+ */
+static const struct CXUnsavedFile * document_cursor_get(const text_document_position_params_t * p_position,
+                                                        struct CXUnsavedFile * p_unsaved_files,
+                                                        uint32_t unsaved_file_count,
+                                                        size_t * p_line_start,
+                                                        size_t * p_cursor)
+{
+    const struct CXUnsavedFile * p_file = NULL;
+    for (uint32_t i = 0; i < unsaved_file_count && !p_file; ++i)
+    {
+        if (path_equals(p_unsaved_files[i].Filename, p_position->text_document.uri.path))
+        {
+            p_file = &p_unsaved_files[i];
+        }
+    }
+    if (!p_file)
+    {
+        return NULL;
+    }
+
+    const char * p_contents = p_file->Contents;
+    size_t length = p_file->Length;
+    size_t line_start = 0;
+    for (int64_t line = 0; line < p_position->position.line && line_start < length; ++line)
+    {
+        const char * p_line_end = memchr(&p_contents[line_start], '\n', length - line_start);
+        line_start = (p_line_end ? (size_t) (p_line_end - p_contents) + 1 : length);
+    }
+
+    size_t cursor = line_start;
+    while (cursor < length && cursor - line_start < (size_t) p_position->position.character && p_contents[cursor] != '\n')
+    {
+        cursor++;
+    }
+    *p_line_start = line_start;
+    *p_cursor = cursor;
+    return p_file;
+}
+
+/**
+ * Find the completion point in the document's unsaved contents.
+ *
+ * @param[out] pp_start_string The part of the identifier that's typed so far, or NULL if there's none.
+ *      Must be freed by the caller.
+ *
+ * @returns false if the document isn't open.
+ */
+static bool completion_point_get(const text_document_position_params_t * p_position,
+                                 struct CXUnsavedFile * p_unsaved_files,
+                                 uint32_t unsaved_file_count,
+                                 completion_point_t * p_point,
+                                 char ** pp_start_string)
+{
+    size_t line_start;
+    size_t cursor;
+    const struct CXUnsavedFile * p_file = document_cursor_get(p_position, p_unsaved_files, unsaved_file_count, &line_start, &cursor);
+    if (!p_file)
+    {
+        return false;
+    }
+
+    const char * p_contents = p_file->Contents;
+    size_t length = p_file->Length;
+    size_t start = cursor;
+    while (start > line_start && is_identifier_char(p_contents[start - 1]))
+    {
+        start--;
+    }
+    /* Numbers aren't completed. */
+    if (start < cursor && p_contents[start] >= '0' && p_contents[start] <= '9')
+    {
+        start = cursor;
+    }
+
+    p_point->start = start;
+    p_point->cursor = cursor;
+    p_point->context_hash = hash_fnv1a(hash_fnv1a(FNV_OFFSET_BASIS, p_contents, start), &p_contents[cursor], length - cursor);
+
+    *pp_start_string = NULL;
+    if (start < cursor)
+    {
+        *pp_start_string = MALLOC(cursor - start + 1);
+        memcpy(*pp_start_string, &p_contents[start], cursor - start);
+        (*pp_start_string)[cursor - start] = '\0';
+    }
+    return true;
+}
+
+/**
+ * Find the include path typed so far in the document's unsaved contents.
+ *
+ * @param[out] p_quoted Whether the include path is in quotes rather than angle brackets.
+ *
+ * @returns The include path up to the position, or NULL if the document isn't open. Must be freed by
+ *      the caller.
+ */
+static char * include_prefix_get(const text_document_position_params_t * p_position,
+                                 struct CXUnsavedFile * p_unsaved_files,
+                                 uint32_t unsaved_file_count,
+                                 bool * p_quoted)
+{
+    size_t line_start;
+    size_t cursor;
+    const struct CXUnsavedFile * p_file = document_cursor_get(p_position, p_unsaved_files, unsaved_file_count, &line_start, &cursor);
+    if (!p_file)
+    {
+        return NULL;
+    }
+
+    size_t start = cursor;
+    while (start > line_start && p_file->Contents[start - 1] != '"' && p_file->Contents[start - 1] != '<')
+    {
+        start--;
+    }
+    if (start == line_start)
+    {
+        return NULL;
+    }
+    *p_quoted = (p_file->Contents[start - 1] == '"');
+
+    char * p_prefix = MALLOC(cursor - start + 1);
+    memcpy(p_prefix, &p_file->Contents[start], cursor - start);
+    p_prefix[cursor - start] = '\0';
+    return p_prefix;
+}
+
+/**
+ * Read what the result is ranked by.
+ *
+ * @returns false if the result is discarded for its priority.
+ */
+static bool completion_candidate_init(const CXCompletionResult * p_result, completion_candidate_t * p_candidate, arena_t * p_arena)
+{
+    CXCompletionString completion = p_result->CompletionString;
+
+    /* Punish functions with poor availability */
+    uint32_t priority = clang_getCompletionPriority(completion);// + 10000 * clang_getCompletionAvailability(completion);
+    if (priority > m_config.completion_priority_max)
+    {
+        return false;
+    }
+
+    memset(p_candidate, 0, sizeof(completion_candidate_t));
+    p_candidate->p_result = p_result;
+    p_candidate->priority = priority;
+
+    unsigned chunk_count = clang_getNumCompletionChunks(completion);
+    for (unsigned j = 0; j < chunk_count && !p_candidate->p_typed_text; ++j)
+    {
+        if (clang_getCompletionChunkKind(completion, j) == CXCompletionChunk_TypedText)
+        {
+            CXString chunk_string = clang_getCompletionChunkText(completion, j);
+            p_candidate->p_typed_text = arena_strdup(p_arena, clang_getCString(chunk_string));
+            clang_disposeString(chunk_string);
+        }
+    }
+    return true;
+}
+
+/**
+ * Build the completion item for a candidate in the arena, if it hasn't been built yet. The detail and
+ * documentation are left for completion_candidate_resolve.
+ */
+static void completion_candidate_build(completion_candidate_t * p_candidate, arena_t * p_arena)
+{
+    if (p_candidate->built)
+    {
+        return;
+    }
+    const CXCompletionResult * p_result = p_candidate->p_result;
+    CXCompletionString completion = p_result->CompletionString;
+
+    const char * p_typed_text = p_candidate->p_typed_text;
+    bool has_inserted_text = false;
+
+    char full_text[COMPLETION_STRING_MAXLEN];
+    char label[COMPLETION_STRING_MAXLEN];
+    char * p_label_next = &label[0];
+    char * p_full_text_next = &full_text[0];
+    unsigned placeholders = 0;
+    unsigned chunk_count = clang_getNumCompletionChunks(completion);
+
+    for (unsigned j = 0; j < chunk_count; ++j)
+    {
+        enum CXCompletionChunkKind kind = clang_getCompletionChunkKind(completion, j);
+        CXString chunk_string           = clang_getCompletionChunkText(completion, j);
+
+        const char * p_text = clang_getCString(chunk_string);
+        unsigned text_len = strlen(p_text);
+
+        if (kind == CXCompletionChunk_Placeholder)
+        {
+            if (p_full_text_next + text_len + 8 < &full_text[COMPLETION_STRING_MAXLEN])
+            {
+                p_full_text_next += sprintf(p_full_text_next, "${%u:%s}", ++placeholders, p_text);
+            }
+        }
+        else if (kind != CXCompletionChunk_ResultType && kind != CXCompletionChunk_Optional) //TODO: Emit separate results per optional chunk
+        {
+            if (p_full_text_next + text_len < &full_text[COMPLETION_STRING_MAXLEN])
+            {
+                strcpy(p_full_text_next, p_text);
+                p_full_text_next += text_len;
+            }
+        }
+
+        if (kind != CXCompletionChunk_ResultType &&
+            kind != CXCompletionChunk_Optional &&
+            p_label_next + text_len < &label[COMPLETION_STRING_MAXLEN])
+        {
+            strcpy(p_label_next, p_text);
+            p_label_next += text_len;
+        }
+
+        if (kind == CXCompletionChunk_Text)
+        {
+            if (has_inserted_text)
+            {
+                LOG("Got second inserted text (new: %s)\n", clang_getCString(chunk_string));
+            }
+            has_inserted_text = true;
+        }
+        clang_disposeString(chunk_string);
+    }
+
+    *p_label_next = '\0';
+    *p_full_text_next = '\0';
+
+    completion_item_t * p_item = &p_candidate->item;
+    p_candidate->p_full_text = arena_strdup(p_arena, full_text);
+    p_candidate->built = true;
+
+    p_item->valid_fields = (COMPLETION_ITEM_FIELD_KIND |
+                            COMPLETION_ITEM_FIELD_LABEL |
+                            COMPLETION_ITEM_FIELD_SORT_TEXT |
+                            COMPLETION_ITEM_FIELD_INSERT_TEXT_FORMAT);
+
+    p_item->kind = get_kind(p_result->CursorKind);
+
+    if (p_typed_text && strcmp(p_typed_text, full_text) != 0)
+    {
+        p_item->insert_text = p_candidate->p_typed_text;
+        p_item->filter_text = p_candidate->p_typed_text;
+        p_item->valid_fields |= (COMPLETION_ITEM_FIELD_INSERT_TEXT | COMPLETION_ITEM_FIELD_FILTER_TEXT);
+    }
+    else
+    {
+        p_item->insert_text = "";
+    }
+
+    p_item->label = arena_strdup(p_arena, label);
+
+    if (placeholders > 0)
+    {
+        p_item->insert_text_format = INSERT_TEXT_FORMAT_SNIPPET;
+        if (!has_inserted_text)
+        {
+            p_item->insert_text = p_candidate->p_full_text;
+            p_item->valid_fields |= COMPLETION_ITEM_FIELD_INSERT_TEXT;
+        }
+    }
+    else
+    {
+        p_item->insert_text_format = INSERT_TEXT_FORMAT_PLAIN_TEXT;
+    }
+}
+
+/**
+ * Add the detail and documentation to a built candidate's item, if they haven't been added yet. The
+ * documentation is rendered to markdown, which is too slow to do for every candidate in a response.
+ */
+static void completion_candidate_resolve(completion_candidate_t * p_candidate, arena_t * p_arena)
+{
+    ASSERT(p_candidate->built);
+    if (p_candidate->resolved)
+    {
+        return;
+    }
+    CXCompletionString completion = p_candidate->p_result->CompletionString;
+    completion_item_t * p_item = &p_candidate->item;
+
+    unsigned chunk_count = clang_getNumCompletionChunks(completion);
+    for (unsigned j = 0; j < chunk_count; ++j)
+    {
+        if (clang_getCompletionChunkKind(completion, j) == CXCompletionChunk_ResultType)
+        {
+            CXString chunk_string = clang_getCompletionChunkText(completion, j);
+            p_item->detail = arena_strdup(p_arena, clang_getCString(chunk_string));
+            p_item->valid_fields |= COMPLETION_ITEM_FIELD_DETAIL;
+            clang_disposeString(chunk_string);
+            break;
+        }
+    }
+
+    CXString doc = clang_getCompletionBriefComment(completion);
+    const char * p_doc = clang_getCString(doc);
+    char * p_markdown_doc = (p_doc && *p_doc) ? doxygen_to_markdown(p_doc, false) : NULL;
+    if (p_markdown_doc)
+    {
+        p_item->documentation.kind = MARKUP_KIND_MARKUP;
+        p_item->documentation.value = arena_strdup(p_arena, p_markdown_doc);
+        p_item->documentation.valid_fields = MARKUP_CONTENT_FIELD_ALL;
+        p_item->valid_fields |= COMPLETION_ITEM_FIELD_DOCUMENTATION;
+        FREE(p_markdown_doc);
+    }
+    clang_disposeString(doc);
+
+    p_candidate->resolved = true;
+}
+
+/** Best score first, then clang's priority, then clang's order. */
+static int completion_match_compare(const void * p_a, const void * p_b)
+{
+    const completion_match_t * p_match_a = p_a;
+    const completion_match_t * p_match_b = p_b;
+    if (p_match_a->score != p_match_b->score)
+    {
+        return (p_match_a->score > p_match_b->score) ? -1 : 1;
+    }
+    if (p_match_a->priority != p_match_b->priority)
+    {
+        return (p_match_a->priority < p_match_b->priority) ? -1 : 1;
+    }
+    return (p_match_a->candidate < p_match_b->candidate) ? -1 : (p_match_a->candidate > p_match_b->candidate);
+}
+
+static void match_heap_swap(completion_match_t * p_heap, unsigned a, unsigned b)
+{
+    completion_match_t temp = p_heap[a];
+    p_heap[a] = p_heap[b];
+    p_heap[b] = temp;
+}
+
+/**
+ * Keep the best matches in a heap with the worst of them on top, so that a new match only has to beat
+ * that one to get in.
+ */
+static void match_heap_push(completion_match_t * p_heap, unsigned * p_count, unsigned capacity, const completion_match_t * p_match)
+{
+    if (*p_count < capacity)
+    {
+        unsigned i = (*p_count)++;
+        p_heap[i] = *p_match;
+        while (i > 0 && completion_match_compare(&p_heap[(i - 1) / 2], &p_heap[i]) < 0)
+        {
+            match_heap_swap(p_heap, i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+    else if (capacity > 0 && completion_match_compare(p_match, &p_heap[0]) < 0)
+    {
+        p_heap[0] = *p_match;
+        unsigned i = 0;
+        for (;;)
+        {
+            unsigned worst = i;
+            unsigned left = 2 * i + 1;
+            unsigned right = 2 * i + 2;
+            if (left < *p_count && completion_match_compare(&p_heap[left], &p_heap[worst]) > 0)
+            {
+                worst = left;
+            }
+            if (right < *p_count && completion_match_compare(&p_heap[right], &p_heap[worst]) > 0)
+            {
+                worst = right;
+            }
+            if (worst == i)
+            {
+                break;
+            }
+            match_heap_swap(p_heap, i, worst);
+            i = worst;
+        }
+    }
+}
+
+/**
+ * Pass the best candidates matching what's typed so far to the callback, the best match first. The
+ * candidates are ranked by their typed text and priority alone, and only the ones that make it into the
+ * response are built.
+ *
+ * @returns Whether all matching candidates were passed.
+ */
+static bool completion_candidates_filter(completion_cache_t * p_cache,
+                                         const char * p_start_string,
+                                         unit_completion_result_callback_t callback,
+                                         void * p_args,
+                                         arena_t * p_arena)
+{
+    unsigned capacity = m_config.completion_results_max;
+    completion_match_t * p_heap = arena_alloc(p_arena, sizeof(completion_match_t) * (capacity ? capacity : 1));
+    unsigned heap_count = 0;
+    unsigned match_count = 0;
+
+    uint64_t pattern_mask = (p_start_string ? string_char_mask(p_start_string) : 0);
+    for (unsigned i = 0; i < p_cache->count; ++i)
+    {
+        const completion_candidate_t * p_candidate = &p_cache->p_candidates[i];
+        completion_match_t match = {.candidate = i, .score = 0, .priority = p_candidate->priority};
+        if (p_start_string &&
+            !(string_char_mask_covers(p_cache->p_masks[i], pattern_mask) &&
+              string_fuzzy_score(p_candidate->p_typed_text ? p_candidate->p_typed_text : "", p_start_string, &match.score)))
+        {
+            continue;
+        }
+        match_count++;
+        match_heap_push(p_heap, &heap_count, capacity, &match);
+    }
+
+    qsort(p_heap, heap_count, sizeof(completion_match_t), completion_match_compare);
+
+    /* The client sorts by the sort text, so it's the rank of the match. The data identifies the
+     * candidate when the client resolves the item. */
+    for (unsigned i = 0; i < heap_count; ++i)
+    {
+        completion_candidate_t * p_candidate = &p_cache->p_candidates[p_heap[i].candidate];
+        completion_candidate_build(p_candidate, &p_cache->arena);
+        completion_item_t item = p_candidate->item;
+        char sort_text[16];
+        sprintf(sort_text, "%06u", i);
+        item.sort_text = sort_text;
+        item.data = json_pack("{s:s, s:I, s:I}",
+                              "file", p_cache->p_filename,
+                              "cache", (json_int_t) p_cache->id,
+                              "candidate", (json_int_t) p_heap[i].candidate);
+        item.valid_fields |= COMPLETION_ITEM_FIELD_DATA;
+        callback(&item, match_count, p_args);
+        json_decref(item.data);
+    }
+    return (match_count <= capacity);
 }
 
 bool unit_code_completion(unit_t *p_unit,
@@ -961,12 +1889,15 @@ bool unit_code_completion(unit_t *p_unit,
                           struct CXUnsavedFile *p_unsaved_files,
                           uint32_t unsaved_file_count,
                           unit_completion_result_callback_t callback,
-                          void *p_args)
+                          void *p_args,
+                          arena_t *p_arena,
+                          cancel_token_t *p_token)
 {
 
     ASSERT(p_unit);
     ASSERT(p_position);
     ASSERT(callback);
+    ASSERT(p_arena);
     ASSERT(p_unit->active);
 
     CXToken * p_tokens;
@@ -979,28 +1910,46 @@ bool unit_code_completion(unit_t *p_unit,
         include_file_completion_callback_context_t context;
         context.callback = callback;
         context.p_args = p_args;
+        context.count = 0;
 
         context.completion_item.valid_fields = (COMPLETION_ITEM_FIELD_LABEL | COMPLETION_ITEM_FIELD_TEXT_EDIT | COMPLETION_ITEM_FIELD_KIND);
         context.completion_item.text_edit.range = include_range;
         context.completion_item.text_edit.valid_fields = TEXT_EDIT_FIELD_ALL;
-        context.completion_item.kind = COMPLETION_ITEM_KIND_FILE;
 
-        for (unsigned i = 0; i < p_unit->flags.count; ++i)
+        /* Without the document's contents, the whole level of the include directories is listed. */
+        bool quoted;
+        char * p_prefix = include_prefix_get(p_position, p_unsaved_files, unsaved_file_count, &quoted);
+        if (!p_prefix)
         {
-            if (strstr(p_unit->flags.pp_array[i], "-I") == p_unit->flags.pp_array[i] ||
-                strstr(p_unit->flags.pp_array[i], "-i") == p_unit->flags.pp_array[i])
-            {
-                const char * p_directory = &(p_unit->flags.pp_array[i])[2];
-                context.base_path_len = strlen(p_directory);
-                path_get_files(p_directory, include_file_completion_callback, true, &context);
-            }
+            CXString string_filename = clang_getTokenSpelling(p_unit->tu, p_tokens[2]);
+            quoted = (clang_getCString(string_filename)[0] == '"');
+            clang_disposeString(string_filename);
+            p_prefix = STRDUP("");
         }
+        clang_disposeTokens(p_unit->tu, p_tokens, token_count);
 
-        return true;
+        const char ** pp_directories = MALLOC(sizeof(char *) * (p_unit->flags.count + 1));
+        char * p_file_directory;
+        unsigned directory_count = include_directories_get(p_unit,
+                                                           p_position->text_document.uri.path,
+                                                           quoted,
+                                                           pp_directories,
+                                                           &p_file_directory);
+        include_index_find(pp_directories, directory_count, p_prefix, include_file_completion_callback, &context);
+        FREE(pp_directories);
+        FREE(p_file_directory);
+        FREE(p_prefix);
+
+        /* Only one directory level is listed, so the client must ask again as the path is typed. */
+        return false;
     }
 
+    /* The identifier being completed is found in the document as it is now, as the translation unit may
+     * not have caught up with the latest keystrokes. */
+    completion_point_t point;
     char * p_start_string = NULL;
-    if (token_count > 0)
+    bool cacheable = completion_point_get(p_position, p_unsaved_files, unsaved_file_count, &point, &p_start_string);
+    if (!cacheable && token_count > 0)
     {
         CXTokenKind token_kind = clang_getTokenKind(p_tokens[token_count - 1]);
         if (token_kind == CXToken_Identifier || token_kind == CXToken_Keyword)
@@ -1008,10 +1957,23 @@ bool unit_code_completion(unit_t *p_unit,
             CXString clang_string_start = clang_getTokenSpelling(p_unit->tu, p_tokens[token_count - 1]);
             p_start_string = STRDUP(clang_getCString(clang_string_start));
             clang_disposeString(clang_string_start);
-            LOG("START STRING: %s\n", p_start_string);
         }
     }
     clang_disposeTokens(p_unit->tu, p_tokens, token_count);
+    LOG("START STRING: %s\n", p_start_string ? p_start_string : "");
+
+    completion_cache_t * p_cache = p_unit->p_completion_cache;
+    if (cacheable &&
+        p_cache &&
+        p_cache->start == point.start &&
+        p_cache->context_hash == point.context_hash &&
+        strcmp(p_cache->p_filename, p_position->text_document.uri.path) == 0)
+    {
+        LOG("Refiltering %u cached completion candidates\n", p_cache->count);
+        bool complete = completion_candidates_filter(p_cache, p_start_string, callback, p_args, p_arena);
+        FREE(p_start_string);
+        return complete;
+    }
 
     CXCodeCompleteResults * p_results = clang_codeCompleteAt(p_unit->tu,
                                                              p_position->text_document.uri.path,
@@ -1023,186 +1985,55 @@ bool unit_code_completion(unit_t *p_unit,
 
     if (p_results)
     {
+        /* Every candidate is kept, not just the ones matching so far, so that the next keystrokes can
+         * be served from the cache. */
+        p_cache = CALLOC(sizeof(completion_cache_t), 1);
+        p_cache->p_results = p_results;
+        p_cache->id = (uint32_t) atomic_get_and_add(&m_completion_cache_id) + 1;
+        p_cache->p_filename = STRDUP(p_position->text_document.uri.path);
+        p_cache->start = point.start;
+        p_cache->context_hash = point.context_hash;
+        p_cache->capacity = p_results->NumResults;
+        p_cache->p_candidates = MALLOC(sizeof(completion_candidate_t) * (p_cache->capacity ? p_cache->capacity : 1));
+        p_cache->p_masks = MALLOC(sizeof(uint64_t) * (p_cache->capacity ? p_cache->capacity : 1));
+
         unsigned result_count = p_results->NumResults;
-        unsigned passed_results = 0;
-        for (unsigned i = 0; i < result_count && passed_results < m_config.completion_results_max; ++i)
+        bool stopped = false;
+        for (unsigned i = 0; i < result_count; ++i)
         {
-            CXCompletionString completion = p_results->Results[i].CompletionString;
-
-            /* Punish functions with poor availability */
-            uint32_t priority = clang_getCompletionPriority(completion);// + 10000 * clang_getCompletionAvailability(completion);
-            if (priority > m_config.completion_priority_max)
+            /* Checking for every result would cost more than reading most of them. */
+            if ((i & 0x3F) == 0 && cancel_token_should_stop(p_token))
             {
-                LOG("Discarded completion item with priority %u\n", priority);
-                continue;
-            }
-
-            CXString doc = clang_getCompletionBriefComment(completion);
-            char * p_typed_text = NULL;
-            char * p_inserted_text = NULL;
-            char * p_var_type_text = NULL;
-
-            char full_text[COMPLETION_STRING_MAXLEN];
-            char * p_label = MALLOC(COMPLETION_STRING_MAXLEN);
-            char * p_label_next = p_label;
-            char * p_full_text_next = &full_text[0];
-            unsigned placeholders = 0;
-            unsigned chunk_count = clang_getNumCompletionChunks(completion);
-
-            for (unsigned j = 0; j < chunk_count; ++j)
-            {
-                enum CXCompletionChunkKind kind = clang_getCompletionChunkKind(completion, j);
-                CXString chunk_string           = clang_getCompletionChunkText(completion, j);
-
-                const char * p_text = clang_getCString(chunk_string);
-                unsigned text_len = strlen(p_text);
-
-                if (kind == CXCompletionChunk_Placeholder)
-                {
-                    if (p_full_text_next + text_len + 8 < &full_text[COMPLETION_STRING_MAXLEN])
-                    {
-                        p_full_text_next += sprintf(p_full_text_next, "${%u:%s}", ++placeholders, p_text);
-                    }
-                }
-                else if (kind != CXCompletionChunk_ResultType && kind != CXCompletionChunk_Optional) //TODO: Emit separate results per optional chunk
-                {
-                    if (p_full_text_next + text_len < &full_text[COMPLETION_STRING_MAXLEN])
-                    {
-                        strcpy(p_full_text_next, p_text);
-                        p_full_text_next += text_len;
-                    }
-                }
-
-                if (kind != CXCompletionChunk_ResultType &&
-                    kind != CXCompletionChunk_Optional &&
-                    p_label_next + text_len < &p_label[COMPLETION_STRING_MAXLEN])
-                {
-                    strcpy(p_label_next, p_text);
-                    p_label_next += text_len;
-                }
-
-                switch (kind)
-                {
-                    case CXCompletionChunk_TypedText:
-                        ASSERT(!p_typed_text);
-                        p_typed_text = STRDUP(clang_getCString(chunk_string));
-                        break;
-
-                    case CXCompletionChunk_Text:
-                        if (p_inserted_text)
-                        {
-                            LOG("Got second inserted text (old: %s, new: %s)\n", p_inserted_text, clang_getCString(chunk_string));
-                            FREE(p_inserted_text);
-                        }
-                        p_inserted_text = STRDUP(clang_getCString(chunk_string));
-                        break;
-
-                    case CXCompletionChunk_ResultType:
-                        ASSERT(!p_var_type_text);
-                        p_var_type_text = STRDUP(clang_getCString(chunk_string));
-                        break;
-                }
-                clang_disposeString(chunk_string);
+                LOG("Completion stopped after %u of %u results\n", i, result_count);
+                stopped = true;
+                break;
             }
 
-            *p_label_next = '\0';
-
-            bool filter_pass;
-            if (p_start_string == NULL)
+            completion_candidate_t * p_candidate = &p_cache->p_candidates[p_cache->count];
+            if (completion_candidate_init(&p_results->Results[i], p_candidate, &p_cache->arena))
             {
-                filter_pass = true;
+                p_cache->p_masks[p_cache->count] = (p_candidate->p_typed_text ? string_char_mask(p_candidate->p_typed_text) : 0);
+                p_cache->count++;
             }
-            else if (p_typed_text)
-            {
-                filter_pass = string_fuzzy_match(p_typed_text, p_start_string);
-            }
-            else
-            {
-                filter_pass = string_fuzzy_match(full_text, p_start_string);
-            }
-
-            if (filter_pass)
-            {
-                completion_item_t result;
-                result.valid_fields = (COMPLETION_ITEM_FIELD_KIND |
-                                    COMPLETION_ITEM_FIELD_LABEL |
-                                    COMPLETION_ITEM_FIELD_SORT_TEXT |
-                                    COMPLETION_ITEM_FIELD_INSERT_TEXT_FORMAT);
-
-                result.kind = get_kind(p_results->Results[i].CursorKind);
-
-                if (p_typed_text && strcmp(p_typed_text, full_text) != 0)
-                {
-                    result.insert_text = p_typed_text;
-                    result.filter_text = p_typed_text;
-                    result.valid_fields |= (COMPLETION_ITEM_FIELD_INSERT_TEXT | COMPLETION_ITEM_FIELD_FILTER_TEXT);
-                }
-                else
-                {
-                    result.insert_text = "";
-                }
-
-                if (p_var_type_text)
-                {
-                    result.detail = p_var_type_text;
-                    result.valid_fields |= COMPLETION_ITEM_FIELD_DETAIL;
-                }
-
-                result.label = p_label;
-
-                const char * p_doc = clang_getCString(doc);
-#if 0 // markdown in completion
-                char * p_markdown_doc = doxygen_to_markdown(p_doc, false);
-                if (p_markdown_doc)
-                {
-                    result.documentation.kind = MARKUP_KIND_MARKUP;
-                    result.documentation.value = p_markdown_doc;
-                    result.documentation.valid_fields = MARKUP_CONTENT_FIELD_ALL;
-                    result.valid_fields |= COMPLETION_ITEM_FIELD_DOCUMENTATION;
-                }
-#else
-                if (p_doc)
-                {
-                    result.documentation.kind = MARKUP_KIND_MARKUP;
-                    result.documentation.value = (char *) p_doc;
-                    result.documentation.valid_fields = MARKUP_CONTENT_FIELD_ALL;
-                    result.valid_fields |= COMPLETION_ITEM_FIELD_DOCUMENTATION;
-                }
-#endif
+        }
 
-                /* Make a string of priority + name to get prioritized sorting, e.g. "000071 param" */
-                result.sort_text = CALLOC(strlen(result.insert_text) + 8, 1);
-                sprintf(result.sort_text, "%06u %s", priority, result.insert_text);
+        bool complete = completion_candidates_filter(p_cache, p_start_string, callback, p_args, p_arena) && !stopped;
+        LOG("Completion built %u candidates in %u arena allocations, %zu bytes\n",
+            p_cache->count, p_cache->arena.allocations, p_cache->arena.used);
 
-                if (placeholders > 0)
-                {
-                    result.insert_text_format = INSERT_TEXT_FORMAT_SNIPPET;
-                    if (!p_inserted_text)
-                    {
-                        result.insert_text = full_text;
-                        result.valid_fields |= COMPLETION_ITEM_FIELD_INSERT_TEXT;
-                    }
-                }
-                else
-                {
-                    result.insert_text_format = INSERT_TEXT_FORMAT_PLAIN_TEXT;
-                }
-
-                callback(&result, result_count, p_args);
-                FREE(result.sort_text);
-                passed_results++;
-            }
-            // FREE(p_markdown_doc);
-            clang_disposeString(doc);
-            FREE(p_typed_text);
-            FREE(p_inserted_text);
-            FREE(p_var_type_text);
-            FREE(p_label);
+        /* A partial list would leave out candidates the next keystrokes may match. */
+        completion_cache_clear(p_unit);
+        if (cacheable && !stopped)
+        {
+            p_unit->p_completion_cache = p_cache;
+        }
+        else
+        {
+            completion_cache_free(p_cache);
         }
 
-        clang_disposeCodeCompleteResults(p_results);
         FREE(p_start_string);
-        return (passed_results < m_config.completion_results_max);
+        return complete;
     }
     else
     {
@@ -1211,14 +2042,52 @@ bool unit_code_completion(unit_t *p_unit,
     }
 }
 
+bool unit_completion_resolve(unit_t * p_unit,
+                             uint32_t cache_id,
+                             unsigned candidate,
+                             completion_item_t * p_item,
+                             arena_t * p_arena)
+{
+    ASSERT(p_unit);
+    ASSERT(p_item);
+    ASSERT(p_arena);
+
+    completion_cache_t * p_cache = p_unit->p_completion_cache;
+    if (!p_cache || p_cache->id != cache_id || candidate >= p_cache->count || !p_cache->p_candidates[candidate].built)
+    {
+        return false;
+    }
+
+    completion_candidate_t * p_candidate = &p_cache->p_candidates[candidate];
+    completion_candidate_resolve(p_candidate, &p_cache->arena);
+
+    /* The cache may be dropped as soon as the unit is given back. */
+    if (p_candidate->item.valid_fields & COMPLETION_ITEM_FIELD_DETAIL)
+    {
+        p_item->detail = arena_strdup(p_arena, p_candidate->item.detail);
+        p_item->valid_fields |= COMPLETION_ITEM_FIELD_DETAIL;
+    }
+    if (p_candidate->item.valid_fields & COMPLETION_ITEM_FIELD_DOCUMENTATION)
+    {
+        p_item->documentation.kind = MARKUP_KIND_MARKUP;
+        p_item->documentation.value = arena_strdup(p_arena, p_candidate->item.documentation.value);
+        p_item->documentation.valid_fields = MARKUP_CONTENT_FIELD_ALL;
+        p_item->valid_fields |= COMPLETION_ITEM_FIELD_DOCUMENTATION;
+    }
+    return true;
+}
+
 unsigned unit_function_signature_get(unit_t *p_unit,
                                      const text_document_position_params_t *p_position,
                                      unit_signature_callback_t callback,
-                                     void *p_args)
+                                     void *p_args,
+                                     arena_t *p_arena,
+                                     cancel_token_t *p_token)
 {
     ASSERT(p_unit);
     ASSERT(p_position);
     ASSERT(callback);
+    ASSERT(p_arena);
     ASSERT(p_unit->active);
 
     unsigned param_index = 0;
@@ -1226,7 +2095,8 @@ unsigned unit_function_signature_get(unit_t *p_unit,
                                                      p_position->text_document.uri.path,
                                                      (unsigned) p_position->position.line + 1,
                                                      (unsigned) p_position->position.character + 1,
-                                                     &param_index);
+                                                     &param_index,
+                                                     p_token);
     int arg_count = clang_Cursor_getNumArguments(definition_cursor);
 
     if (arg_count >= 0)
@@ -1247,18 +2117,20 @@ unsigned unit_function_signature_get(unit_t *p_unit,
 
                 if (false && p_doc_markdown)
                 {
-                    info.documentation.kind = STRDUP(MARKUP_KIND_MARKUP);
-                    info.documentation.value = p_doc_markdown;
+                    info.documentation.kind = MARKUP_KIND_MARKUP;
+                    info.documentation.value = arena_strdup(p_arena, p_doc_markdown);
                     info.documentation.valid_fields = MARKUP_CONTENT_FIELD_ALL;
                     info.valid_fields |= SIGNATURE_INFORMATION_FIELD_DOCUMENTATION;
                 }
+                FREE(p_doc_markdown);
             }
-            info.label = MALLOC(1024);
-            char * p_label_next = info.label + sprintf(info.label, "%s(", p_definition->p_name);
+            /* The parameter labels are joined into the signature label once they're all known. */
+            size_t label_length = strlen(p_definition->p_name) + 3;
 
             if (arg_count > 0)
             {
-                info.p_parameters = CALLOC(arg_count, sizeof(parameter_information_t));
+                info.p_parameters = arena_alloc(p_arena, arg_count * sizeof(parameter_information_t));
+                memset(info.p_parameters, 0, arg_count * sizeof(parameter_information_t));
                 info.parameters_count = arg_count;
                 info.valid_fields |= SIGNATURE_INFORMATION_FIELD_PARAMETERS;
 
@@ -1270,15 +2142,9 @@ unsigned unit_function_signature_get(unit_t *p_unit,
                     CXString type_name = clang_getTypeSpelling(type);
                     CXString name = clang_getCursorDisplayName(arg);
 
-                    if (i != 0)
-                    {
-                        p_label_next += sprintf(p_label_next, ", ");
-                    }
-                    p_label_next += sprintf(p_label_next, "%s %s", clang_getCString(type_name), clang_getCString(name));
-
                     info.p_parameters[i].valid_fields = PARAMETER_INFORMATION_FIELD_LABEL;
-                    info.p_parameters[i].label = MALLOC(strlen(clang_getCString(type_name)) + strlen(clang_getCString(name)) + 2);
-                    sprintf(info.p_parameters[i].label, "%s %s", clang_getCString(type_name), clang_getCString(name));
+                    info.p_parameters[i].label = arena_sprintf(p_arena, "%s %s", clang_getCString(type_name), clang_getCString(name));
+                    label_length += strlen(info.p_parameters[i].label) + 2;
 
                     if (p_doxygen)
                     {
@@ -1299,8 +2165,9 @@ unsigned unit_function_signature_get(unit_t *p_unit,
                             // char * p_arg_doc = MALLOC(1 + strlen(clang_getCString(name)) + 3 + strlen(p_description) + 2);
                             // sprintf(p_arg_doc, "`%s`: %s\n", clang_getCString(name), p_description);
                             // FREE(p_description);
-                            info.p_parameters[i].documentation.kind = STRDUP(MARKUP_KIND_MARKUP);
-                            info.p_parameters[i].documentation.value = p_description; //p_arg_doc;
+                            info.p_parameters[i].documentation.kind = MARKUP_KIND_MARKUP;
+                            info.p_parameters[i].documentation.value = arena_strdup(p_arena, p_description); //p_arg_doc;
+                            FREE(p_description);
                             info.p_parameters[i].documentation.valid_fields = MARKUP_CONTENT_FIELD_ALL;
                             info.p_parameters[i].valid_fields |= SIGNATURE_INFORMATION_FIELD_DOCUMENTATION;
                         }
@@ -1311,11 +2178,16 @@ unsigned unit_function_signature_get(unit_t *p_unit,
                 }
             }
 
+            info.label = arena_alloc(p_arena, label_length);
+            char * p_label_next = info.label + sprintf(info.label, "%s(", p_definition->p_name);
+            for (unsigned i = 0; i < info.parameters_count; ++i)
+            {
+                p_label_next += sprintf(p_label_next, (i != 0) ? ", %s" : "%s", info.p_parameters[i].label);
+            }
             sprintf(p_label_next, ")");
 
             callback(&info, 0, p_args);
 
-            free_signature_information(info);
             doxygen_function_free(p_doxygen);
             FREE(p_definition->p_documentation);
             FREE(p_definition->p_name);
@@ -1335,6 +2207,19 @@ unsigned unit_function_signature_get(unit_t *p_unit,
     return param_index;
 }
 
+typedef struct
+{
+    unit_definition_callback_t callback;
+    void * p_args;
+    bool found;
+} definition_search_t;
+
+static void definition_from_index(const char * p_name, const location_t * p_location, symbol_kind_t kind, void * p_args)
+{
+    definition_search_t * p_search = p_args;
+    p_search->found = true;
+    p_search->callback(p_location, 0, p_search->p_args, DEFINITION_TYPE_DEFINITION);
+}
 
 void unit_definition_get(unit_t *p_unit,
                          const text_document_position_params_t *p_position,
@@ -1380,21 +2265,13 @@ void unit_definition_get(unit_t *p_unit,
             CXString USR = clang_getCursorUSR(definition_cursor);
             LOG("Got reference cursor for %s\n", clang_getCString(USR));
 
-            mutex_take(&m_decl_index.mut);
-            Array * p_results = index_decls_get(&m_decl_index, clang_getCString(USR));
-            bool found_def = false;
-            if (p_results)
-            {
-                ArrayIter iter;
-                array_iter_init(&iter, p_results);
-                index_declaration_t * p_decl;
-                while (array_iter_next(&iter, &p_decl) != CC_ITER_END)
-                {
-                    found_def = true;
-                    callback(&p_decl->location, 0, p_args, DEFINITION_TYPE_DEFINITION);
-                }
-            }
-            mutex_release(&m_decl_index.mut);
+            definition_search_t search = {
+                .callback = callback,
+                .p_args = p_args,
+                .found = false
+            };
+            index_decls_get(&m_decl_index, clang_getCString(USR), definition_from_index, &search);
+            bool found_def = search.found;
 
             clang_disposeString(USR);
             if (found_def)
@@ -1430,11 +2307,13 @@ void unit_definition_get(unit_t *p_unit,
 
 bool unit_hover_get(unit_t * p_unit,
                     const text_document_position_params_t * p_position,
-                    hover_t * p_hover)
+                    hover_t * p_hover,
+                    arena_t * p_arena)
 {
     ASSERT(p_unit);
     ASSERT(p_position);
     ASSERT(p_hover);
+    ASSERT(p_arena);
     ASSERT(p_unit->active);
 
     CXCursor cursor = cursor_get(p_unit,
@@ -1473,7 +2352,7 @@ bool unit_hover_get(unit_t * p_unit,
 
         const char * p_header = "\n\n```c\n";
         const char * p_footer = "\n```\n";
-        char * p_type = NULL;
+        CXString type_string;
         CXString doc_string = clang_Cursor_getBriefCommentText(definition_cursor);
 
         const char * p_doc_string = clang_getCString(doc_string);
@@ -1482,31 +2361,25 @@ bool unit_hover_get(unit_t * p_unit,
         CXType type = clang_getCursorType(definition_cursor);
         if (kind == CXCursor_FunctionDecl)
         {
-            CXString type_string = clang_getTypeSpelling(clang_getResultType(type));
-            p_type = STRDUP(clang_getCString(type_string));
-            clang_disposeString(type_string);
+            type_string = clang_getTypeSpelling(clang_getResultType(type));
         }
         else
         {
-            CXString type_string = clang_getTypeSpelling(type);
-            p_type = STRDUP(clang_getCString(type_string));
-            clang_disposeString(type_string);
+            type_string = clang_getTypeSpelling(type);
         }
         LOG("KIND: %s\n", clang_getCString(clang_getTypeKindSpelling(kind)));
 
-        size_t str_length = strlen(p_header) + strlen(p_type) + strlen(clang_getCString(name)) + strlen(p_footer) + 2;
-        if (p_doc_string)
-        {
-            str_length += strlen(p_doc_string);
-        }
-
-        p_hover->contents.value = malloc(str_length);
-        ASSERT(p_hover->contents.value);
-        sprintf(p_hover->contents.value, "%s%s%s %s%s", p_doc_string ? p_doc_string : "" , p_header, p_type, clang_getCString(name), p_footer);
-        p_hover->contents.kind = STRDUP(MARKUP_KIND_MARKUP);
+        p_hover->contents.value = arena_sprintf(p_arena,
+                                                "%s%s%s %s%s",
+                                                p_doc_string ? p_doc_string : "",
+                                                p_header,
+                                                clang_getCString(type_string),
+                                                clang_getCString(name),
+                                                p_footer);
+        p_hover->contents.kind = MARKUP_KIND_MARKUP;
+        clang_disposeString(type_string);
         clang_disposeString(name);
         clang_disposeString(doc_string);
-        free(p_type);
         return true;
     }
     return false;
@@ -1715,27 +2588,55 @@ bool unit_includes_file(unit_t * p_unit, const char * p_file)
 #endif
 }
 
+typedef struct
+{
+    unit_symbol_callback_t callback;
+    void * p_args;
+} symbols_get_context_t;
+
+static void symbol_from_index(const char * p_name, const location_t * p_location, symbol_kind_t kind, void * p_args)
+{
+    symbols_get_context_t * p_context = p_args;
+    p_context->callback(p_location, p_name, kind, p_context->p_args);
+}
+
 void unit_symbols_get(unit_t * p_unit, unit_symbol_callback_t callback, void * p_args)
 {
+    symbols_get_context_t context = {callback, p_args};
     mutex_take(&p_unit->decl_mutex);
-    ArrayIter iter;
-    array_iter_init(&iter, p_unit->p_declarations);
-    index_declaration_t * p_decl;
-    while (array_iter_next(&iter, &p_decl) == CC_OK)
-    {
-        callback(&p_decl->location, p_decl->p_name, p_decl->kind, p_args);
-    }
+    index_unit_decls_get(&m_decl_index, p_unit->first_declaration, symbol_from_index, &context);
     mutex_release(&p_unit->decl_mutex);
 }
 
-bool unit_index_load(time_t * p_timestamp)
+unit_t ** unit_dependents_get(const char * p_file, size_t * p_count)
 {
-    return index_load(&m_decl_index, m_config.p_index_file, p_timestamp);
+    unit_t ** pp_units = NULL;
+    *p_count = 0;
+
+    mutex_take(&m_dependents_mut);
+    HashTable * p_units;
+    if (hashtable_get(mp_dependents, (void *) p_file, &p_units) == CC_OK)
+    {
+        pp_units = MALLOC(sizeof(unit_t *) * hashtable_size(p_units));
+        HashTableIter iter;
+        hashtable_iter_init(&iter, p_units);
+        TableEntry * p_entry;
+        while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+        {
+            pp_units[(*p_count)++] = p_entry->value;
+        }
+    }
+    mutex_release(&m_dependents_mut);
+    return pp_units;
 }
 
-void unit_index_save(time_t timestamp)
+bool unit_index_load(unit_t * p_unit)
 {
-    index_save(&m_decl_index, m_config.p_index_file, timestamp);
+    char * p_location = index_shard_location(m_config.p_index_directory, p_unit->p_filename);
+    /* Units loaded from their shard aren't parsed, so the shard has to tell which files they depend on. */
+    bool loaded = index_shard_load(&m_decl_index, p_location, p_unit->p_filename, included_file_add, p_unit);
+    FREE(p_location);
+    return loaded;
 }
 
 
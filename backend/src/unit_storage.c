@@ -2,11 +2,14 @@
 #include <clang-c/CXCompilationDatabase.h>
 #include "unit_storage.h"
 #include "hashtable.h"
-#include "queue.h"
 #include "path.h"
 #include "log.h"
 #include "json_rpc.h"
 #include "unsaved_files.h"
+#include "thread_pool.h"
+
+#define REPARSE_QUIET_PERIOD_MS 300
+#define MEMORY_BUDGET_DEFAULT_MB 2048
 
 typedef struct
 {
@@ -23,83 +26,317 @@ typedef struct
 
 typedef struct
 {
-    Queue * p_queue;
+    thread_pool_group_t group;
+    atomic_counter_t loaded_count;
+    atomic_counter_t indexed_count;
+    profile_time_t start_time;
+} index_context_t;
+
+typedef struct
+{
+    index_context_t * p_context;
+    unit_t * p_unit;
+} index_task_args_t;
+
+/** Units waiting for their documents to go quiet before they're reparsed. */
+static struct
+{
+    mutex_t mut;
+    semaphore_t sem;
+    unit_t ** pp_units;
+    unsigned count;
+    unsigned capacity;
+    bool stopping;
+    thread_t * p_thread;
+} m_reparses;
+
+typedef struct
+{
+    unit_t * p_unit;
+    uint64_t memory; ///< Memory held by the unit's translation units the last time it was parsed.
+} open_unit_t;
+
+/** Open units, the least recently used first. */
+static struct
+{
     mutex_t mut;
-    bool index_loaded;
-    time_t prev_index_time;
-} index_thread_context_t;
+    open_unit_t * p_units;
+    unsigned count;
+    unsigned capacity;
+    uint64_t memory;
+    uint64_t budget; ///< Bytes the open units may hold before the least recently used ones are suspended, or 0 for no limit.
+} m_open_units;
 
 static compile_flags_t m_base_flags;
 static unit_storage_t m_storage;
-static bool m_exit;
-static thread_t * mp_index_thread;
-static thread_t * mp_reparse_thread;
-static Queue * mp_change_queue;
-static semaphore_t m_change_queue_sem;
 
 static unit_diagnostics_callback_t m_diag_callback;
 
-static void reparse_thread(void * p_context)
+static unsigned open_units_find(unit_t * p_unit)
+{
+    unsigned i = 0;
+    while (i < m_open_units.count && m_open_units.p_units[i].p_unit != p_unit)
+    {
+        i++;
+    }
+    return i;
+}
+
+static void open_units_remove(unsigned index)
+{
+    m_open_units.memory -= m_open_units.p_units[index].memory;
+    memmove(&m_open_units.p_units[index],
+            &m_open_units.p_units[index + 1],
+            (m_open_units.count - index - 1) * sizeof(open_unit_t));
+    m_open_units.count--;
+}
+
+/**
+ * Record the memory the unit holds after a parse, and make it the most recently used unit. Must be called
+ * with the unit's reparse mutex taken.
+ */
+static void open_units_update(unit_t * p_unit)
 {
-    while (!m_exit)
+    mutex_take(&m_open_units.mut);
+    unsigned i = open_units_find(p_unit);
+    if (i < m_open_units.count)
     {
-        char * p_changed_file;
-        if (queue_size(mp_change_queue) == 0)
+        open_units_remove(i);
+    }
+    if (m_open_units.count == m_open_units.capacity)
+    {
+        m_open_units.capacity = (m_open_units.capacity ? m_open_units.capacity * 2 : 8);
+        m_open_units.p_units = REALLOC(m_open_units.p_units, m_open_units.capacity * sizeof(open_unit_t));
+    }
+    open_unit_t * p_entry = &m_open_units.p_units[m_open_units.count++];
+    p_entry->p_unit = p_unit;
+    p_entry->memory = unit_memory_usage(p_unit);
+    m_open_units.memory += p_entry->memory;
+    mutex_release(&m_open_units.mut);
+}
+
+/**
+ * Suspend the least recently used units until the open units fit in the memory budget. Their symbols stay
+ * in the index, and they're parsed again the next time a request needs them.
+ */
+static void memory_trim(unit_t * p_keep)
+{
+    unit_t * victims[16];
+    unsigned victim_count = 0;
+
+    mutex_take(&m_open_units.mut);
+    unsigned i = 0;
+    while (m_open_units.budget > 0 &&
+           m_open_units.memory > m_open_units.budget &&
+           i < m_open_units.count &&
+           victim_count < ARRAY_SIZE(victims))
+    {
+        if (m_open_units.p_units[i].p_unit == p_keep)
         {
-            semaphore_wait(&m_change_queue_sem);
+            i++;
         }
+        else
+        {
+            victims[victim_count++] = m_open_units.p_units[i].p_unit;
+            open_units_remove(i);
+        }
+    }
+    mutex_release(&m_open_units.mut);
 
-        bool found_elem = (queue_poll(mp_change_queue, &p_changed_file) == CC_OK);
-
-        if (found_elem && hashtable_size(m_storage.p_table) > 0)
+    for (unsigned j = 0; j < victim_count; ++j)
+    {
+        /* A unit that's being reparsed is in use, and its refresh puts it back in the list. Only trying
+         * the lock keeps two units that trim each other from deadlocking. */
+        if (mutex_try_take(&victims[j]->reparse_mutex))
         {
-            unsaved_files_t * p_unsaved_files = unsaved_files_get();
-            LOG("ASYNC CHANGE: %s\n", p_changed_file);
+            LOG("Over the memory budget, suspending %s\n", victims[j]->p_filename);
+            unit_suspend(victims[j]);
+            mutex_release(&victims[j]->reparse_mutex);
+        }
+    }
+}
+
+static bool unit_refresh(unit_t * p_unit, bool reopen);
+
+static void reparse_task(void * p_args)
+{
+    /* Requests keep reading the unit's last good translation unit until the new one is published. Units
+     * that were suspended to stay in the memory budget since are left closed, the next request that needs
+     * them parses them again. */
+    unit_refresh(p_args, false);
+}
 
-            HashTableIter iter;
-            hashtable_iter_init(&iter, m_storage.p_table);
-            TableEntry * p_entry;
-            while (hashtable_iter_next(&iter, &p_entry) == CC_OK)
+/**
+ * Hand the units over to the workers once their reparse time has passed, and sleep until the next one
+ * is due. Changes coming in push the reparse time back, so a unit is only reparsed once its documents
+ * have been quiet for a while.
+ */
+static void reparse_scheduler_thread(void * p_args)
+{
+    mutex_take(&m_reparses.mut);
+    while (!m_reparses.stopping)
+    {
+        profile_time_t now = profile_start();
+        profile_time_t next = 0;
+        unsigned i = 0;
+        while (i < m_reparses.count)
+        {
+            unit_t * p_unit = m_reparses.pp_units[i];
+            if (p_unit->reparse_time <= now)
+            {
+                p_unit->reparse_time = 0;
+                m_reparses.pp_units[i] = m_reparses.pp_units[--m_reparses.count];
+                thread_pool_submit(reparse_task, p_unit, THREAD_POOL_PRIORITY_ACTIVE, NULL);
+            }
+            else
             {
-                unit_t * p_unit = p_entry->value;
-                if (unit_includes_file(p_unit, p_changed_file) && !path_equals(p_unit->p_filename, p_changed_file))
+                if (next == 0 || p_unit->reparse_time < next)
                 {
-                    unit_reparse(p_unit, p_unsaved_files->p_list, p_unsaved_files->count);
-                    unit_diagnostics_get(p_unit, m_diag_callback, NULL, NULL);
+                    next = p_unit->reparse_time;
                 }
+                i++;
             }
+        }
+        mutex_release(&m_reparses.mut);
+
+        /* Woken up early whenever a unit is added, as it may be due before the others. */
+        if (next)
+        {
+            semaphore_wait_timeout(&m_reparses.sem, next - now);
+        }
+        else
+        {
+            semaphore_wait(&m_reparses.sem);
+        }
+        mutex_take(&m_reparses.mut);
+    }
+    mutex_release(&m_reparses.mut);
+}
+
+static void change_task(void * p_args)
+{
+    char * p_changed_file = p_args;
+    LOG("ASYNC CHANGE: %s\n", p_changed_file);
+
+    size_t count;
+    unit_t ** pp_units = unit_dependents_get(p_changed_file, &count);
+
+    /* Only open units have a translation unit to reparse. Closed ones find out about the change when
+     * their index shard is validated against the file's hash. Each reparse is its own task, so that the
+     * dependents are spread over the workers, and they're debounced just like the changed file. */
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (pp_units[i]->active && !path_equals(pp_units[i]->p_filename, p_changed_file))
+        {
+            unit_storage_change_schedule(pp_units[i]);
+        }
+    }
+    FREE(pp_units);
+    FREE(p_changed_file);
+}
+
+static void reindex_task(void * p_args)
+{
+    unit_t * p_unit = p_args;
+
+    json_rpc_suspend();
+    unsaved_files_t * p_unsaved_files = unsaved_files_get();
+
+    /* Open units are indexed when they're reparsed. */
+    if (!p_unit->active)
+    {
+        LOG("Reindexing %s\n", p_unit->p_filename);
+        unit_index(p_unit, p_unsaved_files->p_list, p_unsaved_files->count);
+    }
+    unsaved_files_release(p_unsaved_files);
+    json_rpc_resume();
+}
+
+typedef struct
+{
+    unit_t * p_unit;
+    compile_flags_t flags;
+} flags_update_t;
+
+static void flags_update_task(void * p_args)
+{
+    flags_update_t * p_update = p_args;
+    unit_t * p_unit = p_update->p_unit;
+
+    /* The translation units can't be reparsed with other flags, so they're dropped, and the unit is
+     * parsed again from scratch if it was open. */
+    mutex_take(&p_unit->reparse_mutex);
+    bool active = p_unit->active;
+    unit_suspend(p_unit);
+    mutex_take(&p_unit->mutex);
+    compile_flags_free(&p_unit->flags);
+    p_unit->flags = p_update->flags;
+    mutex_release(&p_unit->mutex);
+    mutex_release(&p_unit->reparse_mutex);
+    FREE(p_update);
+
+    LOG("Flags of %s changed\n", p_unit->p_filename);
+    if (active)
+    {
+        unit_storage_unit_refresh(p_unit);
+    }
+    else
+    {
+        reindex_task(p_unit);
+    }
+}
+
+static bool flags_equal(const compile_flags_t * p_flags1, const compile_flags_t * p_flags2)
+{
+    bool equal = (p_flags1->count == p_flags2->count && p_flags1->full_argv == p_flags2->full_argv);
+    for (unsigned i = 0; equal && i < p_flags1->count; ++i)
+    {
+        equal = (strcmp(p_flags1->pp_array[i], p_flags2->pp_array[i]) == 0);
+    }
+    return equal;
+}
 
-            FREE(p_changed_file);
-            unsaved_files_release(p_unsaved_files);
+static bool path_in_unsaved_files(const char * p_path, const unsaved_files_t * p_unsaved_files)
+{
+    for (unsigned i = 0; i < p_unsaved_files->count; ++i)
+    {
+        if (path_equals(p_unsaved_files->p_list[i].Filename, p_path))
+        {
+            return true;
         }
     }
+    return false;
 }
 
 void unit_storage_init(const compile_flags_t * p_base_flags, unit_diagnostics_callback_t diag_callback)
 {
-    m_exit = false;
     ASSERT(hashtable_new(&m_storage.p_table) == CC_OK);
     ASSERT(hashtable_new(&m_storage.p_directories) == CC_OK);
-    ASSERT(queue_new(&mp_change_queue) == CC_OK);
-    semaphore_init(&m_change_queue_sem, 1);
     compile_flags_clone(&m_base_flags, p_base_flags);
     m_diag_callback = diag_callback;
-    mp_reparse_thread = thread_start(reparse_thread, NULL, THREAD_PRIORITY_LOWEST);
-    ASSERT(mp_reparse_thread);
+
+    mutex_init(&m_open_units.mut);
+    m_open_units.budget = MEMORY_BUDGET_DEFAULT_MB * 1024ULL * 1024ULL;
+
+    mutex_init(&m_reparses.mut);
+    semaphore_init(&m_reparses.sem, 0x7FFFFFFF);
+    m_reparses.p_thread = thread_start(reparse_scheduler_thread, NULL, THREAD_PRIO_NORMAL);
 }
 
 void unit_storage_wait_for_completion(void)
 {
-    m_exit = true;
-    if (mp_reparse_thread)
-    {
-        semaphore_signal(&m_change_queue_sem);
-        thread_join(mp_reparse_thread);
-    }
-	if (mp_index_thread)
-	{
-		thread_join(mp_index_thread);
-	}
+    /* Reparses that are still waiting for their quiet period are dropped, no one is going to look at
+     * their results. */
+    mutex_take(&m_reparses.mut);
+    m_reparses.stopping = true;
+    mutex_release(&m_reparses.mut);
+    semaphore_signal(&m_reparses.sem);
+    thread_join(m_reparses.p_thread);
+    FREE(m_reparses.pp_units);
+    FREE(m_open_units.p_units);
+
+    /* Finish all queued indexing and reparsing before the units go away. */
+    thread_pool_free();
 
     if (hashtable_size(m_storage.p_directories) > 0)
     {
@@ -134,75 +371,198 @@ void unit_storage_wait_for_completion(void)
     hashtable_destroy(m_storage.p_table);
 }
 
-void unit_storage_notify_change(const char * p_filename)
+void unit_storage_memory_budget_set(uint64_t budget)
 {
-    ASSERT(queue_enqueue(mp_change_queue, absolute_path(p_filename, path_cwd())) == CC_OK);
-    semaphore_signal(&m_change_queue_sem);
+    mutex_take(&m_open_units.mut);
+    m_open_units.budget = budget;
+    mutex_release(&m_open_units.mut);
 }
 
-static void index_thread(void * p_args)
+void unit_storage_unit_used(unit_t * p_unit)
 {
-    index_thread_context_t * p_context = p_args;
-
-    while (true)
+    mutex_take(&m_open_units.mut);
+    unsigned i = open_units_find(p_unit);
+    if (i + 1 < m_open_units.count)
     {
-        unit_t * p_unit;
+        open_unit_t entry = m_open_units.p_units[i];
+        memmove(&m_open_units.p_units[i],
+                &m_open_units.p_units[i + 1],
+                (m_open_units.count - i - 1) * sizeof(open_unit_t));
+        m_open_units.p_units[m_open_units.count - 1] = entry;
+    }
+    mutex_release(&m_open_units.mut);
+}
 
-        mutex_take(&p_context->mut);
-        bool has_value = (queue_poll(p_context->p_queue, &p_unit) == CC_OK);
-        mutex_release(&p_context->mut);
+void unit_storage_notify_change(const char * p_filename)
+{
+    thread_pool_submit(change_task, absolute_path(p_filename, path_cwd()), THREAD_POOL_PRIORITY_ACTIVE, NULL);
+}
 
-        if (has_value)
-        {
-            json_rpc_suspend();
-            unsaved_files_t * p_unsaved_files = unsaved_files_get();
+void unit_storage_files_changed(const char * const * pp_paths, unsigned count)
+{
+    HashTable * p_reindexed;
+    ASSERT(hashtable_new(&p_reindexed) == CC_OK);
+    unsaved_files_t * p_unsaved_files = unsaved_files_get();
 
-            time_t last_edit;
-            bool found_file = path_last_edit(p_unit->p_filename, &last_edit);
-            bool new_changes = (!p_context->index_loaded || last_edit >= p_context->prev_index_time);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        /* The open units read the editor's contents of its documents, and already had their changes
+         * scheduled as they came in. */
+        bool in_editor = path_in_unsaved_files(pp_paths[i], p_unsaved_files);
 
-            if (!p_unit->active && found_file && new_changes)
+        size_t unit_count;
+        unit_t ** pp_units = unit_dependents_get(pp_paths[i], &unit_count);
+        for (size_t j = 0; j < unit_count; ++j)
+        {
+            unit_t * p_unit = pp_units[j];
+            if (p_unit->active)
+            {
+                if (!in_editor)
+                {
+                    unit_storage_change_schedule(p_unit);
+                }
+            }
+            else if (!hashtable_contains_key(p_reindexed, (void *) p_unit->p_filename))
             {
-                unit_index(p_unit, p_unsaved_files->p_list, p_unsaved_files->count);
+                /* Closed units are indexed again, so their shards stay valid for the next session. */
+                ASSERT(hashtable_add(p_reindexed, (void *) p_unit->p_filename, p_unit) == CC_OK);
+                thread_pool_submit(reindex_task, p_unit, THREAD_POOL_PRIORITY_BACKGROUND, NULL);
             }
-            unsaved_files_release(p_unsaved_files);
-            json_rpc_resume();
         }
-        else
+        FREE(pp_units);
+    }
+
+    unsaved_files_release(p_unsaved_files);
+    LOG("%u files changed on disk, reindexing %u units\n", count, (unsigned) hashtable_size(p_reindexed));
+    hashtable_destroy(p_reindexed);
+}
+
+void unit_storage_change_schedule(unit_t * p_unit)
+{
+    mutex_take(&m_reparses.mut);
+    p_unit->changes_scheduled++;
+    bool scheduled = (p_unit->reparse_time != 0);
+    p_unit->reparse_time = profile_start() + REPARSE_QUIET_PERIOD_MS * 1000000ULL;
+    if (!scheduled)
+    {
+        if (m_reparses.count == m_reparses.capacity)
         {
-            break;
+            m_reparses.capacity = (m_reparses.capacity ? m_reparses.capacity * 2 : 8);
+            m_reparses.pp_units = REALLOC(m_reparses.pp_units, m_reparses.capacity * sizeof(unit_t *));
         }
+        m_reparses.pp_units[m_reparses.count++] = p_unit;
+    }
+    mutex_release(&m_reparses.mut);
+
+    if (!scheduled)
+    {
+        semaphore_signal(&m_reparses.sem);
     }
 }
 
-static void index_monitor_thread(void * p_args)
+/**
+ * @param[in] reopen Parse the unit if it isn't open. Otherwise closed units are left as they are.
+ */
+static bool unit_refresh(unit_t * p_unit, bool reopen)
 {
-    index_thread_context_t * p_context = p_args;
-    time_t index_start_time = time(0);
+    mutex_take(&p_unit->reparse_mutex);
 
-    profile_time_t start_time = profile_start();
-    thread_t * p_threads[INDEXING_THREADS];
+    mutex_take(&m_reparses.mut);
+    uint32_t changes = p_unit->changes_scheduled;
+    mutex_release(&m_reparses.mut);
 
-    p_context->index_loaded = false; //unit_index_load(&p_context->prev_index_time);
-    if (p_context->index_loaded)
+    bool parsed = (p_unit->active && p_unit->changes_parsed == changes);
+    if (!parsed && (reopen || p_unit->active))
     {
-        LOG("Loaded index\n");
+        /* Every change that was scheduled is already in the unsaved files, so this parse covers all of
+         * them, and the scheduled reparse finds nothing left to do. */
+        unsaved_files_t * p_unsaved_files = unsaved_files_get();
+        if (p_unit->active)
+        {
+            parsed = unit_reparse(p_unit, p_unsaved_files->p_list, p_unsaved_files->count);
+            if (!parsed)
+            {
+                LOG("Reparse of %s failed, parsing it from scratch\n", p_unit->p_filename);
+            }
+        }
+
+        if (!parsed)
+        {
+            parsed = unit_parse(p_unit, p_unsaved_files->p_list, p_unsaved_files->count);
+        }
+        unsaved_files_release(p_unsaved_files);
+
+        if (parsed)
+        {
+            p_unit->changes_parsed = changes;
+            open_units_update(p_unit);
+            memory_trim(p_unit);
+
+            /* The fixits of the diagnostics are kept for the code actions, which read them under the
+             * unit's mutex. */
+            mutex_take(&p_unit->mutex);
+            unit_diagnostics_get(p_unit, m_diag_callback, NULL, NULL);
+            mutex_release(&p_unit->mutex);
+        }
     }
 
-    for (unsigned i = 0; i < INDEXING_THREADS; ++i)
+    if (!p_unit->active)
     {
-        p_threads[i] = thread_start(index_thread, p_context, THREAD_PRIO_LOW);
+        /* Closed by a failed reparse, so it no longer holds any memory. */
+        mutex_take(&m_open_units.mut);
+        unsigned i = open_units_find(p_unit);
+        if (i < m_open_units.count)
+        {
+            open_units_remove(i);
+        }
+        mutex_release(&m_open_units.mut);
     }
 
-    for (unsigned i = 0; i < INDEXING_THREADS; ++i)
+    mutex_release(&p_unit->reparse_mutex);
+    return parsed;
+}
+
+bool unit_storage_unit_refresh(unit_t * p_unit)
+{
+    return unit_refresh(p_unit, true);
+}
+
+static void index_task(void * p_args)
+{
+    index_task_args_t * p_task = p_args;
+    index_context_t * p_context = p_task->p_context;
+    unit_t * p_unit = p_task->p_unit;
+    FREE(p_task);
+
+    /* Borrowing the request handler's resource for each file makes indexing yield to pending requests
+     * between files. */
+    json_rpc_suspend();
+    unsaved_files_t * p_unsaved_files = unsaved_files_get();
+
+    /* Open units are indexed when they're parsed. */
+    if (!p_unit->active)
     {
-        thread_join(p_threads[i]);
+        if (unit_index_load(p_unit))
+        {
+            atomic_get_and_add(&p_context->loaded_count);
+        }
+        else
+        {
+            unit_index(p_unit, p_unsaved_files->p_list, p_unsaved_files->count);
+            atomic_get_and_add(&p_context->indexed_count);
+        }
     }
-    LOG("Indexing complete: %u ms\n", profile_end(start_time));
+    unsaved_files_release(p_unsaved_files);
+    json_rpc_resume();
+}
 
-    mutex_free(&p_context->mut);
-    queue_destroy(p_context->p_queue);
-    unit_index_save(index_start_time);
+static void index_complete(void * p_args)
+{
+    index_context_t * p_context = p_args;
+    LOG("Indexing complete: %u ms, %u units loaded from disk, %u indexed\n",
+        PROFILE_NS_TO_MS(profile_end(p_context->start_time)),
+        (unsigned) atomic_get(&p_context->loaded_count),
+        (unsigned) atomic_get(&p_context->indexed_count));
     FREE(p_context);
 }
 
@@ -216,9 +576,15 @@ bool unit_storage_compilation_database_load(const compilation_database_params_t
         size_t command_count = clang_CompileCommands_getSize(commands);
         LOG("Found %u commands in %s\n", command_count, p_params->path);
 
-        index_thread_context_t  * p_context = MALLOC(sizeof(index_thread_context_t));
-        mutex_init(&p_context->mut);
-        ASSERT(queue_new(&p_context->p_queue) == CC_OK);
+        index_context_t * p_context = MALLOC(sizeof(index_context_t));
+        p_context->start_time = profile_start();
+        p_context->loaded_count.value = 0;
+        p_context->indexed_count.value = 0;
+        thread_pool_group_init(&p_context->group, index_complete, p_context);
+
+        /* Units of this load, by path. Units that were already there are from an earlier load. */
+        HashTable * p_loaded;
+        ASSERT(hashtable_new(&p_loaded) == CC_OK);
 
         for (size_t i = 0; i < command_count; ++i)
         {
@@ -231,7 +597,15 @@ bool unit_storage_compilation_database_load(const compilation_database_params_t
 
             unsigned command_flags_maxcount = clang_CompileCommand_getNumArgs(command);
 
-            if (command_flags_maxcount && unit_storage_get(p_filename) == NULL)
+            unit_t * p_existing_unit = unit_storage_get(p_filename);
+            if (p_existing_unit && strcmp(p_existing_unit->p_filename, p_filename) != 0)
+            {
+                /* Found through the header map, the file has a unit of its own. */
+                p_existing_unit = NULL;
+            }
+
+            /* The first command for a file wins. */
+            if (command_flags_maxcount && !hashtable_contains_key(p_loaded, p_filename))
             {
                 compile_flags_t flags;
                 flags.full_argv = true;
@@ -268,13 +642,33 @@ bool unit_storage_compilation_database_load(const compilation_database_params_t
                     flags.pp_array[flags.count++] = STRDUP(p_params->p_additional_arguments[j]);
                 }
 
-                unit_t * p_unit = unit_create(p_filename, &flags);
-
-                if (p_unit)
+                if (p_existing_unit)
                 {
-                    queue_enqueue(p_context->p_queue, p_unit);
-                    // unit_index(p_unit, p_unsaved_files->p_list, p_unsaved_files->count);
-                    unit_storage_add(p_unit);
+                    /* The database was loaded again. Units that are already there only change if their
+                     * flags did. */
+                    if (!flags_equal(&flags, &p_existing_unit->flags))
+                    {
+                        flags_update_t * p_update = MALLOC(sizeof(flags_update_t));
+                        p_update->p_unit = p_existing_unit;
+                        compile_flags_clone(&p_update->flags, &flags);
+                        thread_pool_submit(flags_update_task, p_update, THREAD_POOL_PRIORITY_BACKGROUND, NULL);
+                    }
+                    ASSERT(hashtable_add(p_loaded, (void *) p_existing_unit->p_filename, p_existing_unit) == CC_OK);
+                }
+                else
+                {
+                    unit_t * p_unit = unit_create(p_filename, &flags);
+
+                    if (p_unit)
+                    {
+                        unit_storage_add(p_unit);
+                        ASSERT(hashtable_add(p_loaded, (void *) p_unit->p_filename, p_unit) == CC_OK);
+
+                        index_task_args_t * p_task = MALLOC(sizeof(index_task_args_t));
+                        p_task->p_context = p_context;
+                        p_task->p_unit = p_unit;
+                        thread_pool_submit(index_task, p_task, THREAD_POOL_PRIORITY_BACKGROUND, &p_context->group);
+                    }
                 }
                 // remember directory
                 char * p_directory = path_directory(p_filename);
@@ -301,8 +695,8 @@ bool unit_storage_compilation_database_load(const compilation_database_params_t
             clang_disposeString(directory);
         }
         clang_CompileCommands_dispose(commands);
-        //index_thread(p_context);
-        mp_index_thread = thread_start(index_monitor_thread, p_context, THREAD_PRIO_NORMAL);
+        hashtable_destroy(p_loaded);
+        thread_pool_group_close(&p_context->group);
     }
     else
     {
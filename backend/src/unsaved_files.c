@@ -24,6 +24,7 @@ unsaved_files_t * unsaved_files_get(void)
     if (size > 0)
     {
         p_unsaved_files->p_list = MALLOC(sizeof(struct CXUnsavedFile) * size);
+        p_unsaved_files->pp_snapshots = MALLOC(sizeof(source_file_snapshot_t *) * size);
         p_unsaved_files->count = 0;
 
         HashTableIter it;
@@ -34,10 +35,13 @@ unsaved_files_t * unsaved_files_get(void)
             source_file_t * p_value = (source_file_t *) p_entry->value;
             if (p_value->unsaved)
             {
-                p_unsaved_files->p_list[p_unsaved_files->count].Filename = (const char *) STRDUP(p_entry->key);
-                p_unsaved_files->p_list[p_unsaved_files->count].Contents = STRDUP(p_value->p_contents);
-                p_unsaved_files->p_list[p_unsaved_files->count].Length   = (unsigned long) p_value->size;
-                ASSERT(strlen(p_unsaved_files->p_list[p_unsaved_files->count].Contents) == p_value->size);
+                /* The snapshot is shared with every other caller that asks for this version of the file,
+                 * so only the first one after an edit pays for a copy. */
+                source_file_snapshot_t * p_snapshot = source_file_snapshot_get(p_value);
+                p_unsaved_files->pp_snapshots[p_unsaved_files->count] = p_snapshot;
+                p_unsaved_files->p_list[p_unsaved_files->count].Filename = p_snapshot->p_filename;
+                p_unsaved_files->p_list[p_unsaved_files->count].Contents = p_snapshot->p_contents;
+                p_unsaved_files->p_list[p_unsaved_files->count].Length   = (unsigned long) p_snapshot->size;
                 p_unsaved_files->count++;
             }
         }
@@ -45,12 +49,15 @@ unsaved_files_t * unsaved_files_get(void)
         if (p_unsaved_files->count == 0)
         {
             FREE(p_unsaved_files->p_list);
+            FREE(p_unsaved_files->pp_snapshots);
             p_unsaved_files->p_list = NULL;
+            p_unsaved_files->pp_snapshots = NULL;
         }
     }
     else
     {
         p_unsaved_files->p_list = NULL;
+        p_unsaved_files->pp_snapshots = NULL;
         p_unsaved_files->count = 0;
     }
     mutex_release(&m_mutex);
@@ -71,19 +78,19 @@ void unsaved_file_set(const char * p_filename, const char * p_contents)
     else
     {
         LOG("\t->Add\n");
-        ASSERT(hashtable_add(mp_unsaved_files, STRDUP(p_filename), source_file_create(p_contents)) == CC_OK);
+        ASSERT(hashtable_add(mp_unsaved_files, STRDUP(p_filename), source_file_create(p_filename, p_contents)) == CC_OK);
     }
     mutex_release(&m_mutex);
 }
 
-void unsaved_file_patch(const char * p_filename, const char * p_new_contents, const position_t * p_start_pos, size_t old_len)
+void unsaved_file_patch(const char * p_filename, const char * p_new_contents, const range_t * p_range)
 {
     mutex_take(&m_mutex);
     LOG("Patching unsaved file %s...\n", p_filename);
     source_file_t * p_file = NULL;
     ASSERT(hashtable_get(mp_unsaved_files, (void *) p_filename, &p_file) == CC_OK);
     LOG("Found unsaved file...\n");
-    source_file_patch(p_file, p_new_contents, p_start_pos, old_len);
+    source_file_patch(p_file, p_new_contents, p_range);
     mutex_release(&m_mutex);
 }
 
@@ -105,10 +112,10 @@ void unsaved_files_release(unsaved_files_t * p_unsaved_files)
 {
     for (unsigned i = 0; i < p_unsaved_files->count; ++i)
     {
-        FREE((char *) p_unsaved_files->p_list[i].Contents);
-        FREE((char *) p_unsaved_files->p_list[i].Filename);
+        source_file_snapshot_release(p_unsaved_files->pp_snapshots[i]);
     }
     FREE(p_unsaved_files->p_list);
+    FREE(p_unsaved_files->pp_snapshots);
     FREE(p_unsaved_files);
 }
 
@@ -1,6 +1,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
 #include "utils.h"
 #include "log.h"
 #include "hashtable.h"
@@ -10,8 +12,37 @@
     #define STACK_SIZE 4096
 #else
     #include <pthread.h>
+    #include <semaphore.h>
+    #include <sys/resource.h>
+    #include <errno.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
 #endif
 
+#define FNV_PRIME 0x100000001B3ULL
+#define ARENA_BLOCK_SIZE (16 * 1024)
+#define ARENA_ALIGNMENT  8
+
+#define FUZZY_LENGTH_MAX            256
+#define FUZZY_NO_MATCH              INT32_MIN
+#define FUZZY_SCORE_MATCH           16
+#define FUZZY_BONUS_BOUNDARY        8
+#define FUZZY_BONUS_CAMEL           7
+#define FUZZY_BONUS_CONSECUTIVE     5
+#define FUZZY_PENALTY_GAP_START     3
+#define FUZZY_PENALTY_GAP_EXTEND    1
+#define FUZZY_PENALTY_LENGTH_MAX    16
+
+struct arena_block
+{
+    struct arena_block * p_next;
+    size_t used;
+    size_t size;
+    char data[];
+};
+
 struct thread
 {
     thread_function_t func;
@@ -21,6 +52,7 @@ struct thread
     HANDLE handle;
 #else
     pthread_t pthread;
+    thread_priority_t priority;
 #endif
 };
 
@@ -100,6 +132,15 @@ thread_t * thread_start(thread_function_t function, void * p_args, thread_priori
 void thread_join(thread_t * p_thread)
 {
     WaitForSingleObject(p_thread->handle, INFINITE);
+    CloseHandle(p_thread->handle);
+    FREE(p_thread);
+}
+
+unsigned thread_hardware_concurrency(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (unsigned) info.dwNumberOfProcessors : 1;
 }
 
 void mutex_init(mutex_t *  p_mut)
@@ -136,6 +177,12 @@ void semaphore_wait(semaphore_t * p_sem)
     WaitForSingleObject(p_sem->sem, INFINITE);
 }
 
+bool semaphore_wait_timeout(semaphore_t * p_sem, uint64_t timeout_ns)
+{
+    /* Round up, so that the timeout doesn't end before the time it's waiting for. */
+    return (WaitForSingleObject(p_sem->sem, (DWORD) ((timeout_ns + 999999) / 1000000)) == WAIT_OBJECT_0);
+}
+
 void semaphore_signal(semaphore_t * p_sem)
 {
     ReleaseSemaphore(p_sem->sem, 1, NULL);
@@ -151,41 +198,299 @@ int atomic_get_and_sub(atomic_counter_t * p_flag)
     return (int) InterlockedAdd(&p_flag->value, -1);
 }
 
-
-profile_time_t profile_start(void)
+int atomic_get(atomic_counter_t * p_flag)
 {
-    return GetTickCount();
+    return (int) InterlockedCompareExchange(&p_flag->value, 0, 0);
 }
 
-unsigned profile_end(profile_time_t start_time)
+
+profile_time_t profile_start(void)
 {
-    return GetTickCount() - start_time;
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&frequency);
+    }
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    /* Split the conversion to avoid overflowing on long uptimes. */
+    return (profile_time_t) (counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+           (profile_time_t) (counter.QuadPart % frequency.QuadPart) * 1000000000ULL / frequency.QuadPart;
 }
 
 #else
 static void * posix_thread(void * p_args)
 {
     thread_t * p_thread = p_args;
+    if (p_thread->priority == THREAD_PRIO_LOW)
+    {
+        /* On Linux, the nice value is per thread. Raising the priority requires privileges, so the other
+         * levels are left alone. */
+        setpriority(PRIO_PROCESS, 0, 10);
+    }
     p_thread->func(p_thread->p_args);
     return NULL;
 }
+
+thread_t * thread_start(thread_function_t function, void * p_args, thread_priority_t priority)
+{
+    thread_t * p_thread = MALLOC(sizeof(thread_t));
+    ASSERT(p_thread);
+    p_thread->func = function;
+    p_thread->p_args = p_args;
+    p_thread->priority = priority;
+
+    ASSERT(pthread_create(&p_thread->pthread, NULL, posix_thread, p_thread) == 0);
+    return p_thread;
+}
+
+void thread_join(thread_t * p_thread)
+{
+    pthread_join(p_thread->pthread, NULL);
+    FREE(p_thread);
+}
+
+unsigned thread_hardware_concurrency(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (unsigned) count : 1;
+}
+
+void mutex_init(mutex_t *  p_mut)
+{
+    /* Critical sections are recursive on Windows, keep the same behavior. */
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    ASSERT(pthread_mutex_init(&p_mut->mutex, &attr) == 0);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void mutex_take(mutex_t * p_mut)
+{
+    pthread_mutex_lock(&p_mut->mutex);
+}
+
+bool mutex_try_take(mutex_t * p_mut)
+{
+    return (pthread_mutex_trylock(&p_mut->mutex) == 0);
+}
+
+void mutex_release(mutex_t * p_mut)
+{
+    pthread_mutex_unlock(&p_mut->mutex);
+}
+
+void mutex_free(mutex_t * p_mut)
+{
+    pthread_mutex_destroy(&p_mut->mutex);
+}
+
+void semaphore_init(semaphore_t * p_sem, unsigned max_count)
+{
+    /* POSIX semaphores have no upper bound. */
+    ASSERT(sem_init(&p_sem->sem, 0, 0) == 0);
+}
+
+void semaphore_wait(semaphore_t * p_sem)
+{
+    while (sem_wait(&p_sem->sem) != 0 && errno == EINTR);
+}
+
+bool semaphore_wait_timeout(semaphore_t * p_sem, uint64_t timeout_ns)
+{
+    /* The timeout is an absolute time on the realtime clock. */
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += (time_t) (timeout_ns / 1000000000ULL);
+    deadline.tv_nsec += (long) (timeout_ns % 1000000000ULL);
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    int result;
+    while ((result = sem_timedwait(&p_sem->sem, &deadline)) != 0 && errno == EINTR);
+    return (result == 0);
+}
+
+void semaphore_signal(semaphore_t * p_sem)
+{
+    sem_post(&p_sem->sem);
+}
+
+int atomic_get_and_add(atomic_counter_t * p_flag)
+{
+    return __atomic_add_fetch(&p_flag->value, 1, __ATOMIC_SEQ_CST);
+}
+
+int atomic_get_and_sub(atomic_counter_t * p_flag)
+{
+    return __atomic_sub_fetch(&p_flag->value, 1, __ATOMIC_SEQ_CST);
+}
+
+int atomic_get(atomic_counter_t * p_flag)
+{
+    return __atomic_load_n(&p_flag->value, __ATOMIC_SEQ_CST);
+}
+
+profile_time_t profile_start(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (profile_time_t) now.tv_sec * 1000000000ULL + (profile_time_t) now.tv_nsec;
+}
+#endif
+
+uint64_t profile_end(profile_time_t start_time)
+{
+    return profile_start() - start_time;
+}
+
+#ifdef _WIN32
+bool mapped_file_open(mapped_file_t * p_file, const char * p_path)
+{
+    memset(p_file, 0, sizeof(mapped_file_t));
+    p_file->file = CreateFile(p_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (p_file->file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(p_file->file, &size) && size.QuadPart > 0)
+    {
+        p_file->mapping = CreateFileMapping(p_file->file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (p_file->mapping)
+        {
+            p_file->p_data = MapViewOfFile(p_file->mapping, FILE_MAP_READ, 0, 0, 0);
+            p_file->size = (size_t) size.QuadPart;
+        }
+    }
+
+    if (!p_file->p_data)
+    {
+        mapped_file_close(p_file);
+        return false;
+    }
+    return true;
+}
+
+void mapped_file_close(mapped_file_t * p_file)
+{
+    if (p_file->p_data)
+    {
+        UnmapViewOfFile(p_file->p_data);
+    }
+    if (p_file->mapping)
+    {
+        CloseHandle(p_file->mapping);
+    }
+    if (p_file->file && p_file->file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(p_file->file);
+    }
+    memset(p_file, 0, sizeof(mapped_file_t));
+}
+#else
+bool mapped_file_open(mapped_file_t * p_file, const char * p_path)
+{
+    memset(p_file, 0, sizeof(mapped_file_t));
+    int fd = open(p_path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0)
+    {
+        void * p_data = mmap(NULL, (size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p_data != MAP_FAILED)
+        {
+            p_file->p_data = p_data;
+            p_file->size = (size_t) file_stat.st_size;
+        }
+    }
+
+    /* The mapping stays valid after the file is closed. */
+    close(fd);
+    return (p_file->p_data != NULL);
+}
+
+void mapped_file_close(mapped_file_t * p_file)
+{
+    if (p_file->p_data)
+    {
+        munmap((void *) p_file->p_data, p_file->size);
+    }
+    memset(p_file, 0, sizeof(mapped_file_t));
+}
+#endif
+
+#ifdef _WIN32
+bool output_write(const void * p_data, size_t size)
+{
+    HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+    const char * p_c = p_data;
+    while (size > 0)
+    {
+        DWORD written;
+        if (!WriteFile(output, p_c, (DWORD) min(size, 0x40000000), &written, NULL))
+        {
+            return false;
+        }
+        p_c += written;
+        size -= written;
+    }
+    return true;
+}
+#else
+bool output_write(const void * p_data, size_t size)
+{
+    const char * p_c = p_data;
+    while (size > 0)
+    {
+        ssize_t written = write(STDOUT_FILENO, p_c, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        p_c += written;
+        size -= (size_t) written;
+    }
+    return true;
+}
 #endif
 
 
 void shared_resource_init(shared_resource_t * p_resource)
 {
     mutex_init(&p_resource->mut);
-    mutex_init(&p_resource->owner_mut);
+    mutex_init(&p_resource->gate);
+    semaphore_init(&p_resource->owner_sem, 1);
+    semaphore_signal(&p_resource->owner_sem);
     p_resource->users = 0;
 }
 
 void shared_resource_borrow(shared_resource_t * p_resource)
 {
+    /* Wait for any pending owner to get its turn first, otherwise overlapping borrowers could keep
+     * the owner out forever. */
+    mutex_take(&p_resource->gate);
+    mutex_release(&p_resource->gate);
+
     mutex_take(&p_resource->mut);
     p_resource->users++;
     if (p_resource->users == 1)
     {
-        mutex_take(&p_resource->owner_mut);
+        semaphore_wait(&p_resource->owner_sem);
     }
     mutex_release(&p_resource->mut);
 }
@@ -197,22 +502,121 @@ void shared_resource_release(shared_resource_t * p_resource)
     p_resource->users--;
     if (p_resource->users == 0)
     {
-        mutex_release(&p_resource->owner_mut);
+        semaphore_signal(&p_resource->owner_sem);
     }
     mutex_release(&p_resource->mut);
 }
 
 void shared_resource_lock(shared_resource_t * p_resource)
 {
-    mutex_take(&p_resource->owner_mut);
+    mutex_take(&p_resource->gate);
+    semaphore_wait(&p_resource->owner_sem);
+    mutex_release(&p_resource->gate);
 }
 
 void shared_resource_unlock(shared_resource_t * p_resource)
 {
-    mutex_release(&p_resource->owner_mut);
+    semaphore_signal(&p_resource->owner_sem);
+}
+
+void cancel_token_init(cancel_token_t * p_token, uint64_t timeout_ns)
+{
+    p_token->cancelled.value = 0;
+    p_token->deadline = (timeout_ns > 0) ? profile_start() + timeout_ns : 0;
 }
 
+void cancel_token_cancel(cancel_token_t * p_token)
+{
+    atomic_get_and_add(&p_token->cancelled);
+}
 
+bool cancel_token_is_cancelled(cancel_token_t * p_token)
+{
+    return (p_token && atomic_get(&p_token->cancelled) > 0);
+}
+
+bool cancel_token_should_stop(cancel_token_t * p_token)
+{
+    if (!p_token)
+    {
+        return false;
+    }
+    return (atomic_get(&p_token->cancelled) > 0 ||
+            (p_token->deadline != 0 && profile_start() >= p_token->deadline));
+}
+
+
+void * arena_alloc(arena_t * p_arena, size_t size)
+{
+    size = (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+    arena_block_t * p_block = p_arena->p_blocks;
+    if (!p_block || p_block->used + size > p_block->size)
+    {
+        size_t block_size = max(size, (size_t) ARENA_BLOCK_SIZE);
+        p_block = MALLOC(sizeof(arena_block_t) + block_size);
+        p_block->used = 0;
+        p_block->size = block_size;
+        p_block->p_next = p_arena->p_blocks;
+        p_arena->p_blocks = p_block;
+    }
+    void * p_data = &p_block->data[p_block->used];
+    p_block->used += size;
+
+    p_arena->used += size;
+    p_arena->peak = max(p_arena->peak, p_arena->used);
+    p_arena->allocations++;
+    return p_data;
+}
+
+char * arena_strdup(arena_t * p_arena, const char * p_string)
+{
+    size_t size = strlen(p_string) + 1;
+    char * p_copy = arena_alloc(p_arena, size);
+    memcpy(p_copy, p_string, size);
+    return p_copy;
+}
+
+char * arena_sprintf(arena_t * p_arena, const char * p_format, ...)
+{
+    va_list args;
+    va_start(args, p_format);
+    int length = vsnprintf(NULL, 0, p_format, args);
+    va_end(args);
+    ASSERT(length >= 0);
+
+    char * p_string = arena_alloc(p_arena, (size_t) length + 1);
+    va_start(args, p_format);
+    vsnprintf(p_string, (size_t) length + 1, p_format, args);
+    va_end(args);
+    return p_string;
+}
+
+void arena_reset(arena_t * p_arena)
+{
+    /* The oldest block is kept, as the newer ones are either the same size or oversized. */
+    arena_block_t * p_block = p_arena->p_blocks;
+    while (p_block && p_block->p_next)
+    {
+        arena_block_t * p_next = p_block->p_next;
+        FREE(p_block);
+        p_block = p_next;
+    }
+    if (p_block)
+    {
+        p_block->used = 0;
+    }
+    p_arena->p_blocks = p_block;
+    p_arena->used = 0;
+    p_arena->allocations = 0;
+}
+
+void arena_free(arena_t * p_arena)
+{
+    arena_reset(p_arena);
+    FREE(p_arena->p_blocks);
+    p_arena->p_blocks = NULL;
+    p_arena->peak = 0;
+}
 
 static bool char_equal_case_insensitive(char a, char b)
 {
@@ -221,6 +625,16 @@ static bool char_equal_case_insensitive(char a, char b)
     return a == b;
 }
 
+uint64_t hash_fnv1a(uint64_t hash, const void * p_data, size_t size)
+{
+    const uint8_t * p_bytes = p_data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ p_bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
 bool string_fuzzy_match(const char * p_string, const char * p_pattern)
 {
     while (*p_pattern)
@@ -238,3 +652,181 @@ bool string_fuzzy_match(const char * p_string, const char * p_pattern)
     }
     return true;
 }
+
+static uint64_t char_mask_bit(char c)
+{
+    if (c >= 'a' && c <= 'z')
+    {
+        return 1ULL << (c - 'a');
+    }
+    else if (c >= 'A' && c <= 'Z')
+    {
+        return 1ULL << (c - 'A');
+    }
+    else if (c >= '0' && c <= '9')
+    {
+        return 1ULL << (26 + c - '0');
+    }
+    else if (c == '_')
+    {
+        return 1ULL << 36;
+    }
+    else
+    {
+        return 1ULL << 37;
+    }
+}
+
+uint64_t string_char_mask(const char * p_string)
+{
+    uint64_t mask = 0;
+    for (const char * p_c = p_string; *p_c; ++p_c)
+    {
+        mask |= char_mask_bit(*p_c);
+    }
+    return mask;
+}
+
+typedef enum
+{
+    CHAR_CLASS_OTHER,
+    CHAR_CLASS_LOWER,
+    CHAR_CLASS_UPPER,
+    CHAR_CLASS_DIGIT,
+} char_class_t;
+
+static char_class_t char_class(char c)
+{
+    if (c >= 'a' && c <= 'z')
+    {
+        return CHAR_CLASS_LOWER;
+    }
+    else if (c >= 'A' && c <= 'Z')
+    {
+        return CHAR_CLASS_UPPER;
+    }
+    else if (c >= '0' && c <= '9')
+    {
+        return CHAR_CLASS_DIGIT;
+    }
+    return CHAR_CLASS_OTHER;
+}
+
+/** Bonus for matching the character at the given position, for where it is in its word. */
+static int32_t position_bonus(const char * p_string, size_t index)
+{
+    if (index == 0)
+    {
+        return FUZZY_BONUS_BOUNDARY;
+    }
+    char_class_t prev = char_class(p_string[index - 1]);
+    char_class_t cur = char_class(p_string[index]);
+    if (cur != CHAR_CLASS_OTHER && prev == CHAR_CLASS_OTHER)
+    {
+        /* Start of a snake_case segment, or of a word after any other separator. */
+        return FUZZY_BONUS_BOUNDARY;
+    }
+    else if ((cur == CHAR_CLASS_UPPER && prev == CHAR_CLASS_LOWER) ||
+             (cur == CHAR_CLASS_DIGIT && prev != CHAR_CLASS_DIGIT))
+    {
+        return FUZZY_BONUS_CAMEL;
+    }
+    return 0;
+}
+
+bool string_fuzzy_score(const char * p_string, const char * p_pattern, int32_t * p_score)
+{
+    size_t length = strlen(p_string);
+    size_t pattern_length = strlen(p_pattern);
+    if (pattern_length == 0)
+    {
+        *p_score = 0;
+        return true;
+    }
+    if (length > FUZZY_LENGTH_MAX)
+    {
+        length = FUZZY_LENGTH_MAX;
+    }
+    if (pattern_length > length)
+    {
+        return false;
+    }
+
+    /* Best score of the pattern so far with its last character matched at each position of the string,
+     * one row per pattern character. Only the previous row is needed for the next one. */
+    int32_t rows[2][FUZZY_LENGTH_MAX];
+    int32_t * p_prev = rows[0];
+    int32_t * p_row = rows[1];
+
+    for (size_t j = 0; j < pattern_length; ++j)
+    {
+        /* Best score of a match of the previous pattern character before a gap, with the gap so far
+         * paid for. */
+        int32_t gapped = FUZZY_NO_MATCH;
+        bool any = false;
+        for (size_t i = 0; i < length; ++i)
+        {
+            int32_t score = FUZZY_NO_MATCH;
+            if (char_equal_case_insensitive(p_string[i], p_pattern[j]))
+            {
+                int32_t match = FUZZY_SCORE_MATCH + position_bonus(p_string, i) + (p_string[i] == p_pattern[j] ? 1 : 0);
+                if (j == 0)
+                {
+                    /* Where the match starts matters the most. */
+                    score = match + position_bonus(p_string, i);
+                }
+                else if (i > 0)
+                {
+                    int32_t best = gapped;
+                    if (p_prev[i - 1] != FUZZY_NO_MATCH && p_prev[i - 1] + FUZZY_BONUS_CONSECUTIVE > best)
+                    {
+                        best = p_prev[i - 1] + FUZZY_BONUS_CONSECUTIVE;
+                    }
+                    if (best != FUZZY_NO_MATCH)
+                    {
+                        score = best + match;
+                    }
+                }
+            }
+            p_row[i] = score;
+            any = any || (score != FUZZY_NO_MATCH);
+
+            if (j > 0)
+            {
+                if (gapped != FUZZY_NO_MATCH)
+                {
+                    gapped -= FUZZY_PENALTY_GAP_EXTEND;
+                }
+                if (p_prev[i] != FUZZY_NO_MATCH && p_prev[i] - FUZZY_PENALTY_GAP_START > gapped)
+                {
+                    gapped = p_prev[i] - FUZZY_PENALTY_GAP_START;
+                }
+            }
+        }
+
+        if (!any)
+        {
+            return false;
+        }
+        int32_t * p_swap = p_prev;
+        p_prev = p_row;
+        p_row = p_swap;
+    }
+
+    int32_t best = FUZZY_NO_MATCH;
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (p_prev[i] > best)
+        {
+            best = p_prev[i];
+        }
+    }
+    if (best == FUZZY_NO_MATCH)
+    {
+        return false;
+    }
+
+    /* Among equal matches, the shorter string is the closer one. */
+    *p_score = best - (int32_t) min(length - pattern_length, FUZZY_PENALTY_LENGTH_MAX);
+    return true;
+}
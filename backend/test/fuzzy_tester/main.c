@@ -0,0 +1,73 @@
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned m_failures;
+
+void assert_handler(const char * p_file, unsigned line)
+{
+    printf("ASSERT @ %s:%u\n", p_file, line);
+    fflush(stdout);
+    exit(1);
+}
+
+static void check(bool ok, const char * p_what)
+{
+    printf("%s\t%s\n", ok ? "ok:" : "FAIL:", p_what);
+    m_failures += !ok;
+}
+
+/** Check that the pattern matches the first string better than the second. */
+static void test_better(const char * p_pattern, const char * p_better, const char * p_worse)
+{
+    int32_t better_score;
+    int32_t worse_score;
+    bool better_match = string_fuzzy_score(p_better, p_pattern, &better_score);
+    bool worse_match = string_fuzzy_score(p_worse, p_pattern, &worse_score);
+
+    char what[256];
+    snprintf(what, sizeof(what), "\"%s\": %s (%d) > %s (%d)",
+             p_pattern,
+             p_better, better_match ? better_score : 0,
+             p_worse, worse_match ? worse_score : 0);
+    check(better_match && worse_match && better_score > worse_score, what);
+}
+
+static void test_no_match(const char * p_pattern, const char * p_string)
+{
+    int32_t score;
+    char what[256];
+    snprintf(what, sizeof(what), "\"%s\" doesn't match %s", p_pattern, p_string);
+    check(!string_fuzzy_score(p_string, p_pattern, &score), what);
+}
+
+int main(void)
+{
+    /* Prefixes first, then segment starts, then anything else. */
+    test_better("get", "getName", "forget");
+    test_better("name", "getName", "rename");
+    test_better("sp", "string_pool", "isspace");
+    test_better("sp", "StringPool", "isspace");
+    test_better("spi", "spiral_init", "string_pool_init");
+
+    /* Consecutive characters beat the same characters spread out. */
+    test_better("pool", "pool_free", "p_o_o_l");
+    test_better("abc", "abcdef", "axbxcx");
+
+    /* Shorter gaps are better. */
+    test_better("fb", "foo_bar", "foo_something_bar");
+
+    /* Case doesn't decide whether it matches. */
+    test_better("SPI", "string_pool_init", "xstring_xpool_xinit");
+
+    test_no_match("xyz", "string_pool");
+    test_no_match("ba", "ab");
+    test_no_match("longer", "long");
+
+    int32_t score = -1;
+    check(string_fuzzy_score("anything", "", &score) && score == 0, "empty pattern matches with score 0");
+
+    printf("%u failures\n", m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
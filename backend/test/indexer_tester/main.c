@@ -0,0 +1,145 @@
+#include "indexer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned m_failures;
+
+void assert_handler(const char * p_file, unsigned line)
+{
+    printf("ASSERT @ %s:%u\n", p_file, line);
+    fflush(stdout);
+    exit(1);
+}
+
+static void check(bool ok, const char * p_what)
+{
+    printf("%s\t%s\n", ok ? "ok:" : "FAIL:", p_what);
+    m_failures += !ok;
+}
+
+static void count_callback(const char * p_name, const location_t * p_location, symbol_kind_t kind, void * p_args)
+{
+    (*(unsigned *) p_args)++;
+}
+
+static unsigned USR_count(index_t * p_index, const char * p_USR)
+{
+    unsigned count = 0;
+    index_decls_get(p_index, p_USR, count_callback, &count);
+    return count;
+}
+
+static unsigned unit_count(index_t * p_index, index_decl_id_t unit_decls)
+{
+    unsigned count = 0;
+    index_unit_decls_get(p_index, unit_decls, count_callback, &count);
+    return count;
+}
+
+static void declaration_add(index_t * p_index, const char * p_USR, const char * p_name, uint32_t line, index_decl_id_t * p_unit_decls)
+{
+    index_declaration_t decl = {
+        .name = string_pool_intern(p_name),
+        .file = string_pool_intern("/src/unit.c"),
+        .line = line,
+        .character = 0,
+        .scope = INDEX_SCOPE_GLOBAL,
+        .kind = SYMBOL_KIND_FUNCTION
+    };
+    index_declaration_add(p_index, p_USR, &decl, p_unit_decls);
+}
+
+/** Index the unit the way unit.c does, dropping its last index first. */
+static void unit_reindex(index_t * p_index, index_decl_id_t * p_unit_decls)
+{
+    index_unit_decls_remove(p_index, p_unit_decls);
+    index_unit_supersede(p_index, "/src/unit.c");
+    declaration_add(p_index, "c:@F@foo", "foo", 1, p_unit_decls);
+    declaration_add(p_index, "c:@F@foo", "foo", 10, p_unit_decls);
+    declaration_add(p_index, "c:@F@bar", "bar", 20, p_unit_decls);
+}
+
+/** Save a unit's declarations to a shard, then drop them, so that only the shard has them. */
+static void shard_write(index_t * p_index, const char * p_location, const char * p_unit, index_decl_id_t * p_unit_decls)
+{
+    check(index_shard_save(p_index, p_location, p_unit, *p_unit_decls, NULL, NULL, 0), "shard saved");
+    index_unit_decls_remove(p_index, p_unit_decls);
+}
+
+static void shard_dependency(const char * p_path, void * p_args)
+{
+}
+
+static void shards_check(void)
+{
+    index_t index;
+    index_init(&index);
+
+    index_decl_id_t a_decls = INDEX_DECL_NONE;
+    declaration_add(&index, "c:@F@foo", "foo", 1, &a_decls);
+    declaration_add(&index, "c:@F@foo", "foo", 10, &a_decls);
+    declaration_add(&index, "c:@F@bar", "bar", 20, &a_decls);
+    shard_write(&index, "indexer_test_a.shard", "/src/a.c", &a_decls);
+    index_decl_id_t b_decls = INDEX_DECL_NONE;
+    declaration_add(&index, "c:@F@foo", "foo", 5, &b_decls);
+    shard_write(&index, "indexer_test_b.shard", "/src/b.c", &b_decls);
+    check(USR_count(&index, "c:@F@foo") == 0, "no declarations before loading the shards");
+
+    check(index_shard_load(&index, "indexer_test_a.shard", "/src/a.c", shard_dependency, NULL), "first shard loaded");
+    check(index_shard_load(&index, "indexer_test_b.shard", "/src/b.c", shard_dependency, NULL), "second shard loaded");
+    check(index_shard_load(&index, "indexer_test_a.shard", "/src/a.c", shard_dependency, NULL), "loading a shard again");
+    check(USR_count(&index, "c:@F@foo") == 3, "declarations of a USR in both shards");
+    check(USR_count(&index, "c:@F@bar") == 1, "declarations of a USR in one shard");
+
+    /* The shard loaded last heads the table entry of the USR they share, so dropping it replaces the
+     * entry, while dropping the other one unlinks it from the middle. */
+    index_unit_supersede(&index, "/src/b.c");
+    check(USR_count(&index, "c:@F@foo") == 2, "declarations after dropping the second shard");
+    check(index_shard_load(&index, "indexer_test_b.shard", "/src/b.c", shard_dependency, NULL), "second shard loaded again");
+    index_unit_supersede(&index, "/src/a.c");
+    check(USR_count(&index, "c:@F@foo") == 1 && USR_count(&index, "c:@F@bar") == 0, "declarations after dropping the first shard");
+    index_unit_supersede(&index, "/src/b.c");
+    check(USR_count(&index, "c:@F@foo") == 0 && USR_count(&index, "c:@F@bar") == 0, "no declarations after dropping both shards");
+
+    check(index_shard_load(&index, "indexer_test_a.shard", "/src/a.c", shard_dependency, NULL), "first shard loaded again");
+    check(USR_count(&index, "c:@F@foo") == 2, "declarations after loading a dropped shard again");
+
+    index_free(&index);
+    remove("indexer_test_a.shard");
+    remove("indexer_test_b.shard");
+}
+
+int main(void)
+{
+    string_pool_init();
+    index_t index;
+    index_init(&index);
+
+    index_decl_id_t unit_decls = INDEX_DECL_NONE;
+    index_decl_id_t other_decls = INDEX_DECL_NONE;
+    declaration_add(&index, "c:@F@foo", "foo", 5, &other_decls);
+
+    unit_reindex(&index, &unit_decls);
+    check(USR_count(&index, "c:@F@foo") == 3 && USR_count(&index, "c:@F@bar") == 1, "declarations after the first index");
+
+    /* Indexing the unit again, as when one of its files changes on disk, replaces its declarations. */
+    unit_reindex(&index, &unit_decls);
+    unit_reindex(&index, &unit_decls);
+    check(USR_count(&index, "c:@F@foo") == 3, "one row per declaration after indexing again");
+    check(USR_count(&index, "c:@F@bar") == 1, "one row per declaration of another USR");
+    check(unit_count(&index, unit_decls) == 3, "one row per declaration in the unit's list");
+    check(unit_count(&index, other_decls) == 1, "other units keep their declarations");
+    check(index.decls.count == 4, "removed rows are reused");
+
+    index_unit_decls_remove(&index, &unit_decls);
+    check(USR_count(&index, "c:@F@foo") == 1 && USR_count(&index, "c:@F@bar") == 0, "declarations after removing the unit");
+
+    index_free(&index);
+
+    shards_check();
+    string_pool_free();
+
+    printf("%u failures\n", m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#include "json_reader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned m_failures;
+
+void assert_handler(const char * p_file, unsigned line)
+{
+    printf("ASSERT @ %s:%u\n", p_file, line);
+    fflush(stdout);
+    exit(1);
+}
+
+static void check(bool ok, const char * p_what)
+{
+    printf("%s\t%s\n", ok ? "ok:" : "FAIL:", p_what);
+    m_failures += !ok;
+}
+
+static void check_string(const char * p_json, const char * p_expected)
+{
+    char * p_buffer = strdup(p_json);
+    json_reader_t reader;
+    json_reader_init(&reader, p_buffer, strlen(p_buffer));
+    const char * p_string = json_reader_string(&reader);
+    check(p_string && strcmp(p_string, p_expected) == 0 && !json_reader_error(&reader), p_json);
+    free(p_buffer);
+}
+
+static void check_invalid_string(const char * p_json)
+{
+    char * p_buffer = strdup(p_json);
+    json_reader_t reader;
+    json_reader_init(&reader, p_buffer, strlen(p_buffer));
+    check(json_reader_string(&reader) == NULL && json_reader_error(&reader), p_json);
+    free(p_buffer);
+}
+
+static void test_object(void)
+{
+    char buffer[] = "{\"skip\": [1, {\"a\": null}, \"\\\"]\"], \"id\": -42, \"ok\": true, \"text\": \"x\\ty\"}";
+    json_reader_t reader;
+    json_reader_init(&reader, buffer, strlen(buffer));
+
+    int64_t id = 0;
+    bool ok = false;
+    const char * p_text = NULL;
+    const char * p_key;
+    check(json_reader_object_start(&reader), "object start");
+    while (json_reader_object_next(&reader, &p_key))
+    {
+        if (strcmp(p_key, "id") == 0)
+        {
+            json_reader_integer(&reader, &id);
+        }
+        else if (strcmp(p_key, "ok") == 0)
+        {
+            json_reader_boolean(&reader, &ok);
+        }
+        else if (strcmp(p_key, "text") == 0)
+        {
+            p_text = json_reader_string(&reader);
+        }
+        else
+        {
+            json_reader_skip(&reader);
+        }
+    }
+    check(!json_reader_error(&reader), "object read without errors");
+    check(id == -42, "integer member after a skipped array");
+    check(ok, "boolean member");
+    check(p_text && strcmp(p_text, "x\ty") == 0, "string member");
+}
+
+int main(void)
+{
+    check_string("\"plain\"", "plain");
+    check_string("\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"", "\"\\/\b\f\n\r\t");
+    check_string("\"a\\nb\\nc\"", "a\nb\nc");
+    check_string("\"\\u0041\\u00e9\\u20AC\"", "A\xC3\xA9\xE2\x82\xAC");
+    check_string("\"\\ud83d\\ude00\"", "\xF0\x9F\x98\x80");
+    check_string("\"raw \xC3\xA6\xC3\xB8\xC3\xA5\"", "raw \xC3\xA6\xC3\xB8\xC3\xA5");
+    check_string("\"\"", "");
+    check_invalid_string("\"\\ude00\"");
+    check_invalid_string("\"\\ud83d\"");
+    check_invalid_string("\"\\u12\"");
+    check_invalid_string("\"\\x\"");
+    check_invalid_string("\"unterminated");
+    test_object();
+
+    printf("%u failures\n", m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
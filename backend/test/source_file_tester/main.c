@@ -0,0 +1,158 @@
+#include "source_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Larger than a chunk of the rope, so that the edits cross chunk boundaries. */
+#define FILE_LINES 400
+#define PATCH_COUNT 2000
+#define PATCH_LENGTH_MAX 3000
+
+static unsigned m_failures;
+static uint32_t m_random = 12345;
+
+void assert_handler(const char * p_file, unsigned line)
+{
+    printf("ASSERT @ %s:%u\n", p_file, line);
+    fflush(stdout);
+    exit(1);
+}
+
+static void check(bool ok, const char * p_what)
+{
+    if (!ok)
+    {
+        printf("FAIL:\t%s\n", p_what);
+        m_failures++;
+    }
+}
+
+static uint32_t random_next(uint32_t range)
+{
+    m_random = m_random * 1103515245u + 12345u;
+    return (m_random >> 8) % range;
+}
+
+/** The position of a byte offset in the flat copy of the file. */
+static position_t position_get(const char * p_contents, size_t offset)
+{
+    position_t position = {0};
+    const char * p_line = p_contents;
+    for (const char * p_c = p_contents; p_c < p_contents + offset; ++p_c)
+    {
+        if (*p_c == '\n')
+        {
+            position.line++;
+            p_line = p_c + 1;
+        }
+    }
+    position.character = (p_contents + offset) - p_line;
+    return position;
+}
+
+/** Apply the same edit to the flat copy. */
+static char * flat_patch(char * p_contents, size_t offset, size_t old_len, const char * p_new)
+{
+    size_t size = strlen(p_contents);
+    size_t new_len = strlen(p_new);
+    char * p_result = malloc(size - old_len + new_len + 1);
+    memcpy(p_result, p_contents, offset);
+    memcpy(p_result + offset, p_new, new_len);
+    strcpy(p_result + offset + new_len, p_contents + offset + old_len);
+    free(p_contents);
+    return p_result;
+}
+
+static char * random_text(void)
+{
+    size_t length = random_next(PATCH_LENGTH_MAX / 2);
+    char * p_text = malloc(length + 1);
+    for (size_t i = 0; i < length; ++i)
+    {
+        p_text[i] = (random_next(12) == 0) ? '\n' : (char) ('a' + random_next(26));
+    }
+    p_text[length] = '\0';
+    return p_text;
+}
+
+static void check_lines(source_file_t * p_file, const char * p_contents)
+{
+    const char * p_line = p_contents;
+    uint32_t line = 0;
+    while (true)
+    {
+        const char * p_end = strchr(p_line, '\n');
+        size_t length = p_end ? (size_t) (p_end - p_line) : strlen(p_line);
+        char * p_got = source_file_line_get(p_file, line);
+        check(p_got && strlen(p_got) == length && memcmp(p_got, p_line, length) == 0, "line contents");
+        free(p_got);
+        if (!p_end)
+        {
+            break;
+        }
+        p_line = p_end + 1;
+        line++;
+    }
+    char * p_past_end = source_file_line_get(p_file, line + 1);
+    check(p_past_end == NULL, "line past the end");
+    free(p_past_end);
+}
+
+int main(void)
+{
+    char * p_contents = malloc(FILE_LINES * 32);
+    p_contents[0] = '\0';
+    for (unsigned i = 0; i < FILE_LINES; ++i)
+    {
+        sprintf(&p_contents[strlen(p_contents)], "line %u of the file\n", i);
+    }
+    source_file_t * p_file = source_file_create("test.c", p_contents);
+    check(strcmp(source_file_contents_get(p_file), p_contents) == 0, "created contents");
+
+    source_file_snapshot_t * p_first = source_file_snapshot_get(p_file);
+
+    for (unsigned i = 0; i < PATCH_COUNT; ++i)
+    {
+        size_t size = strlen(p_contents);
+        size_t offset = random_next((uint32_t) size + 1);
+        size_t old_len = random_next((uint32_t) min(size - offset, PATCH_LENGTH_MAX) + 1);
+        char * p_new = random_text();
+
+        range_t range = { .start = position_get(p_contents, offset), .end = position_get(p_contents, offset + old_len) };
+        source_file_patch(p_file, p_new, &range);
+        p_contents = flat_patch(p_contents, offset, old_len, p_new);
+        free(p_new);
+
+        const char * p_rope = source_file_contents_get(p_file);
+        check(strcmp(p_rope, p_contents) == 0, "contents after patch");
+        if (i % 100 == 0)
+        {
+            check_lines(p_file, p_contents);
+        }
+    }
+
+    /* Everything is deleted in one patch, with an end past the last line, then written again in one. */
+    range_t range = { .end = { .line = FILE_LINES * 2 } };
+    source_file_patch(p_file, "", &range);
+    check(strcmp(source_file_contents_get(p_file), "") == 0, "empty after deleting everything");
+    range.end = range.start;
+    source_file_patch(p_file, "int main(void)\n{\n}\n", &range);
+    check(strcmp(source_file_contents_get(p_file), "int main(void)\n{\n}\n") == 0, "contents after refilling");
+
+    /* Characters past the end of a line stop before its line break. */
+    range = (range_t) { .start = { .line = 0, .character = 14 }, .end = { .line = 0, .character = 100 } };
+    source_file_patch(p_file, " argc", &range);
+    check(strcmp(source_file_contents_get(p_file), "int main(void) argc\n{\n}\n") == 0, "start and end clamped to their line");
+    range = (range_t) { .start = { .line = 1, .character = 5 }, .end = { .line = 2, .character = 0 } };
+    source_file_patch(p_file, "", &range);
+    check(strcmp(source_file_contents_get(p_file), "int main(void) argc\n{}\n") == 0, "range across a line break");
+
+    check(strncmp(p_first->p_contents, "line 0 of the file\n", 19) == 0, "snapshot survives the patches");
+    source_file_snapshot_release(p_first);
+
+    source_file_free(p_file);
+    free(p_contents);
+
+    printf("%u failures\n", m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include "unit.h"
+#include "file_watcher.h"
+#include "path.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WATCHER_TIMEOUT_NS (10 * 1000000000ULL)
+
+static unsigned m_failures;
+static semaphore_t m_changed_sem;
+static unit_t * mp_unit;
+static bool m_scheduled;
+
+void assert_handler(const char * p_file, unsigned line)
+{
+    printf("ASSERT @ %s:%u\n", p_file, line);
+    fflush(stdout);
+    exit(1);
+}
+
+static void check(bool ok, const char * p_what)
+{
+    printf("%s\t%s\n", ok ? "ok:" : "FAIL:", p_what);
+    m_failures += !ok;
+}
+
+static char * file_write(const char * p_directory, const char * p_name, const char * p_contents)
+{
+    char * p_path = MALLOC(strlen(p_directory) + 1 + strlen(p_name) + 1);
+    sprintf(p_path, "%s/%s", p_directory, p_name);
+    FILE * f = fopen(p_path, "w");
+    ASSERT(f);
+    fputs(p_contents, f);
+    fclose(f);
+    return p_path;
+}
+
+/* The units unit_storage_files_changed schedules are the dependents of the changed files. */
+static void files_changed(const char * const * pp_paths, unsigned count, void * p_args)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        size_t unit_count;
+        unit_t ** pp_units = unit_dependents_get(pp_paths[i], &unit_count);
+        for (size_t j = 0; j < unit_count; ++j)
+        {
+            m_scheduled |= (pp_units[j] == mp_unit);
+        }
+        FREE(pp_units);
+    }
+    semaphore_signal(&m_changed_sem);
+}
+
+int main(void)
+{
+    char * p_directory = absolute_path("unit_dependents_files", path_cwd());
+    ASSERT(path_create_directory(p_directory));
+
+    /* inner.h is only included through outer.h, which is the whole include prefix of main.c, so the
+     * indexer never sees either of them once the prefix is precompiled. */
+    char * p_inner = file_write(p_directory, "inner.h", "static inline int inner(void) { return 0; }\n");
+    char * p_outer = file_write(p_directory, "outer.h", "#include \"inner.h\"\n");
+    char * p_main = file_write(p_directory, "main.c", "#include \"outer.h\"\n\nint main(void)\n{\n    return inner();\n}\n");
+
+    char * p_preambles = absolute_path("unit_dependents_files/preambles", path_cwd());
+    char * p_shards = absolute_path("unit_dependents_files/index", path_cwd());
+    unit_config_t config = {
+        .completion_results_max = 100,
+        .diagnostics_max = 100,
+        .p_index_directory = p_shards,
+        .p_preamble_directory = p_preambles,
+    };
+    semaphore_init(&m_changed_sem, 0x7FFFFFFF);
+    file_watcher_init(files_changed, NULL);
+    unit_init(&config);
+
+    compile_flags_t flags = {0};
+    mp_unit = unit_create(p_main, &flags);
+    mutex_take(&mp_unit->reparse_mutex);
+    check(unit_parse(mp_unit, NULL, 0), "parsed the unit");
+    check(mp_unit->p_preamble != NULL, "parsed on top of the precompiled includes");
+    mutex_release(&mp_unit->reparse_mutex);
+
+    check(unit_includes_file(mp_unit, p_outer), "includes the precompiled header");
+    check(unit_includes_file(mp_unit, p_inner), "includes the header included through it");
+
+    FREE(file_write(p_directory, "inner.h", "static inline int inner(void) { return 1; }\n"));
+    bool reported = semaphore_wait_timeout(&m_changed_sem, WATCHER_TIMEOUT_NS);
+    check(reported, "watcher reported the change");
+    check(m_scheduled, "unit scheduled for the nested header's change");
+
+    file_watcher_free();
+    unit_free(mp_unit);
+    FREE(p_shards);
+    FREE(p_preambles);
+    FREE(p_main);
+    FREE(p_outer);
+    FREE(p_inner);
+    FREE(p_directory);
+
+    printf("%u failures\n", m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -13,6 +13,8 @@ interface CompilationDatabaseParams {
 interface InitializationOptions {
     flags: string[];
     compilationDatabase: CompilationDatabaseParams[];
+    workerThreads?: number;
+    memoryBudget?: number;
 }
 
 var langClient: client.LanguageClient;
@@ -27,10 +29,14 @@ function server_launch() {
     var config = vscode.workspace.getConfiguration();
     var flags = <string[]> config.get(CONFIG_SECTION + '.flags');
     var db = <object[]>config.get(CONFIG_SECTION + '.compile_commands');
+    var workerThreads = <number>config.get(CONFIG_SECTION + '.worker_threads');
+    var memoryBudget = <number>config.get(CONFIG_SECTION + '.memory_budget');
 
     var initOptions = <InitializationOptions>{
         flags: flags,
-        compilationDatabase: db.map(config => <CompilationDatabaseParams>{path: config['path'], additionalArguments: config['additional_arguments']})
+        compilationDatabase: db.map(config => <CompilationDatabaseParams>{path: config['path'], additionalArguments: config['additional_arguments']}),
+        workerThreads: workerThreads,
+        memoryBudget: memoryBudget
     };
     console.dir("INIT OPTIONS: " + initOptions);
     console.log("FLAGS: " + flags);
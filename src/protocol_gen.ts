@@ -256,90 +256,211 @@ function generate_encoder_definitions(): string {
     }).join('\n\n');
 }
 
-function generate_enum_decoders(): string {
+function generate_enum_writers(): string {
     return database.enums.map(e => {
-        return `static inline ${e}_t decode_${e}(json_t * p_json)\n` +
+        return `static inline void write_${e}(json_writer_t * p_writer, ${e}_t value)\n` +
         `{\n` +
-        `    return (${e}_t) decode_number(p_json);\n` +
+        `    json_writer_integer(p_writer, value);\n` +
         `}\n`;
     }).join('\n');
 }
 
-function generate_member_decoders(members: any, structure_name: string, indent='    ', retval='retval'): string {
-    return Object.keys(members).map(key => {
-        var field_setter = indent + `    ${retval}.valid_fields |= ${enum_field_name(structure_name, key)};\n`;
-        var setter = '';
-        setter += indent + `json_t * p_${key}_json = json_object_get(p_json, "${to_camelcase(key)}");\n`
-        if (typeof members[key] === 'object'){
-            setter += indent + `if (json_is_object(p_${key}_json))\n`;
-            setter += indent + `{\n`;
-            setter += generate_member_decoders(members[key], structure_name, indent + '    ', retval + '.' + key);
-            if (retval === 'retval')
-                setter += field_setter;
-            setter += indent + `}\n`;
+function is_structure(type_name: string): boolean {
+    return !!structures.find(s => s.name === type_name);
+}
+
+function generate_value_writer(type_name: string, value: string): string {
+    if (type_name === 'any')
+        return `json_writer_json(p_writer, ${value});`;
+    if (is_structure(type_name))
+        return `write_${type_name}(p_writer, &${value});`;
+    return `write_${type_name}(p_writer, ${value});`;
+}
+
+function generate_member_writers(members: any, name: string, indent = '    ', field_value = 'p_value->', top_level = true): string[] {
+    return [].concat(...Object.keys(members).map((key, index) => {
+        var lines: string[] = [];
+        var body_indent = top_level ? indent + '    ' : indent;
+        if (top_level) {
+            if (index > 0)
+                lines.push('');
+            lines.push(indent + `if (p_value->valid_fields & ${enum_field_name(name, key)})`);
+            lines.push(indent + `{`);
         }
-        else if (members[key] === 'any') {
-            setter += indent + `if (p_${key}_json != NULL)\n`;
-            setter += indent + `{\n`;
-            setter += indent + `    ${retval}.${key} = json_deep_copy(p_${key}_json);\n`
-            if (retval === 'retval')
-                setter += field_setter;
-            setter += indent + `}\n`;
+        lines.push(body_indent + `json_writer_key(p_writer, "${to_camelcase(key)}");`);
+
+        if (typeof members[key] === 'object') {
+            lines.push(body_indent + `json_writer_object_start(p_writer);`);
+            lines = lines.concat(generate_member_writers(members[key], name, body_indent, `${field_value}${key}.`, false));
+            lines.push(body_indent + `json_writer_object_end(p_writer);`);
+        }
+        else if (is_array(members[key])) {
+            lines.push(body_indent + `json_writer_array_start(p_writer);`);
+            lines.push(body_indent + `for (uint32_t i = 0; i < ${field_value}${key}_count; ++i)`);
+            lines.push(body_indent + `{`);
+            lines.push(body_indent + `    ` + generate_value_writer(members[key].replace('[]', ''), `${field_value}p_${key}[i]`));
+            lines.push(body_indent + `}`);
+            lines.push(body_indent + `json_writer_array_end(p_writer);`);
         }
         else {
-            setter += indent + `if (json_is_${get_json_type(members[key])}(p_${key}_json))\n`;
-            setter += indent + `{\n`;
-            if (is_array(members[key])) {
-                setter += indent + `    ${retval}.${key}_count = json_array_size(p_${key}_json);\n`;
-                setter += indent + `    ${retval}.p_${key} = malloc(sizeof(${get_type(members[key]).replace('*', '').trim()}) * ${retval}.${key}_count);\n`;
-                setter += indent + `    ASSERT(${retval}.p_${key});\n`;
-                setter += indent + `    json_t * p_it;\n`;
-                setter += indent + `    uint32_t index;\n`;
-                setter += indent + `    json_array_foreach(p_${key}_json, index, p_it)\n`;
-                setter += indent + `    {\n`;
-                setter += indent + `        ${retval}.p_${key}[index] = decode_${members[key].replace('[]','')}(p_it);\n`;
-                setter += indent + `    }\n`;
+            lines.push(body_indent + generate_value_writer(members[key], `${field_value}${key}`));
+        }
+
+        if (top_level)
+            lines.push(indent + `}`);
+        return lines;
+    }));
+}
+
+function generate_writer_declarations(): string {
+    return groups.map(g => {
+        return `/* ${g.name} JSON writers */\n` + g.structures.map(s => {
+            return `void write_${s.name}(json_writer_t * p_writer, const ${s.name}_t * p_value);\n`;
+        }).join('');
+    }).join('');
+}
+
+function generate_writer_definitions(): string {
+    return groups.map(g => {
+        return `/* ${g.name} JSON writers */\n` + g.structures.map(s => {
+            return `void write_${s.name}(json_writer_t * p_writer, const ${s.name}_t * p_value)\n` +
+            `{\n` +
+            `    json_writer_object_start(p_writer);\n` +
+            `\n` +
+            generate_member_writers(s.members, s.name).map(line => line + '\n').join('') +
+            `    json_writer_object_end(p_writer);\n` +
+            `}`;
+        }).join('\n\n');
+    }).join('\n\n');
+}
+
+function generate_enum_readers(): string {
+    return database.enums.map(e => {
+        return `static inline bool read_${e}(json_reader_t * p_reader, ${e}_t * p_value)\n` +
+        `{\n` +
+        `    int64_t value;\n` +
+        `    bool valid = json_reader_integer(p_reader, &value);\n` +
+        `    *p_value = (${e}_t) value;\n` +
+        `    return valid;\n` +
+        `}\n`;
+    }).join('\n');
+}
+
+function generate_member_readers(members: any, structure_name: string, prefix='p_value->', top_level=true): string[] {
+    var retval: string[] = [];
+    Object.keys(members).forEach((key, index) => {
+        var type = members[key];
+        var field = prefix + key;
+        var field_setter = top_level ? [`p_value->valid_fields |= ${enum_field_name(structure_name, key)};`] : [];
+        var body: string[] = [];
+        if (typeof type === 'object') {
+            body.push(`if (json_reader_object_start(p_reader))`);
+            body.push(`{`);
+            body.push(`    while (json_reader_object_next(p_reader, &p_key))`);
+            body.push(`    {`);
+            body.push(...generate_member_readers(type, structure_name, field + '.', false).map(line => '        ' + line));
+            body.push(`    }`);
+            body.push(...field_setter.map(line => '    ' + line));
+            body.push(`}`);
+        }
+        else if (type === 'any') {
+            body.push(`${field} = json_reader_json(p_reader);`);
+            if (top_level) {
+                body.push(`if (${field})`);
+                body.push(`{`);
+                body.push(...field_setter.map(line => '    ' + line));
+                body.push(`}`);
+            }
+        }
+        else if (is_array(type)) {
+            var array = `${prefix}p_${key}`;
+            var count = `${field}_count`;
+            body.push(`if (json_reader_array_start(p_reader))`);
+            body.push(`{`);
+            body.push(`    while (json_reader_array_next(p_reader))`);
+            body.push(`    {`);
+            body.push(`        ${array} = read_array_reserve(${array}, ${count}, sizeof(${array}[0]));`);
+            body.push(`        if (read_${type.replace('[]', '')}(p_reader, &${array}[${count}]))`);
+            body.push(`        {`);
+            body.push(`            ${count}++;`);
+            body.push(`        }`);
+            body.push(`    }`);
+            body.push(...field_setter.map(line => '    ' + line));
+            body.push(`}`);
+        }
+        else {
+            var reader = `read_${type}(p_reader, &${field})`;
+            if (is_structure(type)) {
+                // Only count objects as present, even though the reader handles anything.
+                body.push(`if (json_reader_peek(p_reader) != JSON_READER_TYPE_OBJECT)`);
+                body.push(`{`);
+                body.push(`    json_reader_skip(p_reader);`);
+                body.push(`}`);
+                body.push(`else` + (top_level ? ` if (${reader})` : ''));
+                body.push(`{`);
+                body.push(...(top_level ? field_setter : [`${reader};`]).map(line => '    ' + line));
+                body.push(`}`);
+            }
+            else if (top_level) {
+                body.push(`if (${reader})`);
+                body.push(`{`);
+                body.push(...field_setter.map(line => '    ' + line));
+                body.push(`}`);
             }
             else {
-                setter += indent + `    ${retval}.${key} = decode_${members[key]}(p_${key}_json);\n`;
+                body.push(`${reader};`);
             }
-            if (retval === 'retval')
-                setter += field_setter;
-            setter += indent + `}\n`
         }
-        setter += '\n';
-
-        return setter;
-    }).join('');
+        retval.push(`${index === 0 ? 'if' : 'else if'} (strcmp(p_key, "${to_camelcase(key)}") == 0)`);
+        retval.push(`{`);
+        retval.push(...body.map(line => '    ' + line));
+        retval.push(`}`);
+    });
+    if (retval.length > 0) {
+        retval.push(`else`);
+        retval.push(`{`);
+        retval.push(`    json_reader_skip(p_reader);`);
+        retval.push(`}`);
+    }
+    else {
+        retval.push(`json_reader_skip(p_reader);`);
+    }
+    return retval;
 }
 
-function generate_decoder_declarations(): string {
+function generate_reader_declarations(): string {
     return groups.map(g => {
-        return `/* ${g.name} JSON decoders */\n` + g.structures.map(s => {
-            return `${s.name}_t decode_${s.name}(json_t * p_json);\n`;
+        return `/* ${g.name} JSON readers */\n` + g.structures.map(s => {
+            return `bool read_${s.name}(json_reader_t * p_reader, ${s.name}_t * p_value);\n`;
         }).join('');
     }).join('');
 }
 
-
-function generate_decoder_definitions(): string {
+function generate_reader_definitions(): string {
     return groups.map(g => {
-        return `/* ${g.name} JSON decoders */\n` + g.structures.map(s => {
+        return `/* ${g.name} JSON readers */\n` + g.structures.map(s => {
             var retval: string[] = [];
-            retval.push(`${s.name}_t decode_${s.name}(json_t * p_json)`)
+            retval.push(`bool read_${s.name}(json_reader_t * p_reader, ${s.name}_t * p_value)`)
             retval.push(`{`)
-            retval.push(`    ${s.name}_t retval;`)
-            retval.push(`    memset(&retval, 0, sizeof(retval));`)
+            retval.push(`    memset(p_value, 0, sizeof(${s.name}_t));`)
+            retval.push(``)
+            retval.push(`    if (json_reader_object_start(p_reader))`)
+            retval.push(`    {`)
+            retval.push(`        const char * p_key;`)
+            retval.push(`        while (json_reader_object_next(p_reader, &p_key))`)
+            retval.push(`        {`)
+            retval.push(...generate_member_readers(s.members, s.name).map(line => '            ' + line))
+            retval.push(`        }`)
+            retval.push(`    }`)
             retval.push(``)
-            retval.push(generate_member_decoders(s.members, s.name))
             if (s.required.length > 0) {
-                retval.push(`    if ((retval.valid_fields & ${enum_field_name(s.name, "REQUIRED")}) != ${enum_field_name(s.name, "REQUIRED")})`)
+                retval.push(`    if ((p_value->valid_fields & ${enum_field_name(s.name, "REQUIRED")}) != ${enum_field_name(s.name, "REQUIRED")})`)
                 retval.push(`    {`)
                 retval.push(`        m_error = DECODER_ERROR_MISSING_REQUIRED_FIELDS;`)
-                retval.push(`        LOG("Missing required parameters for ${s.name}: Got 0x%x, expected 0x%x\\n", retval.valid_fields, ${enum_field_name(s.name, "REQUIRED")});`)
+                retval.push(`        LOG("Missing required parameters for ${s.name}: Got 0x%x, expected 0x%x\\n", p_value->valid_fields, ${enum_field_name(s.name, "REQUIRED")});`)
                 retval.push(`    }`)
             }
-            retval.push(`    return retval;`)
+            retval.push(`    return !json_reader_error(p_reader);`)
             retval.push(`}`)
             retval.push(``)
             return retval.map(line => line + '\n').join('');
@@ -418,6 +539,64 @@ function generate_freer_definitions(): string {
     }).join('\n\n');
 }
 
+function is_releasable(type_name: string): boolean {
+    if (is_array(type_name) || type_name === 'uri' || type_name === 'any')
+        return true;
+    var structure = structures.find(s => s.name === type_name);
+    return !!structure && members_releasable(structure.members);
+}
+
+function members_releasable(members: any): boolean {
+    return Object.keys(members).some(key => {
+        return (typeof members[key] === 'object') ? members_releasable(members[key]) : is_releasable(members[key]);
+    });
+}
+
+function generate_member_releasers(members: any, prefix='p_value->'): string[] {
+    var retval: string[] = [];
+    Object.keys(members).forEach(key => {
+        var type = members[key];
+        if (typeof type === 'object') {
+            retval.push(...generate_member_releasers(type, prefix + key + '.'));
+        }
+        else if (type === 'any') {
+            retval.push(`json_decref(${prefix}${key});`);
+        }
+        else if (is_array(type)) {
+            if (is_releasable(type.replace('[]', ''))) {
+                retval.push(`for (uint32_t i = 0; i < ${prefix}${key}_count; ++i)`);
+                retval.push(`{`);
+                retval.push(`    release_${type.replace('[]', '')}(&${prefix}p_${key}[i]);`);
+                retval.push(`}`);
+            }
+            retval.push(`free(${prefix}p_${key});`);
+        }
+        else if (is_releasable(type)) {
+            retval.push(`release_${type}(&${prefix}${key});`);
+        }
+    });
+    return retval;
+}
+
+function generate_releaser_declarations(): string {
+    return groups.map(g => {
+        return `/* ${g.name} structure releasers */\n` + g.structures.map(s => {
+            return `void release_${s.name}(${s.name}_t * p_value);\n`;
+        }).join('');
+    }).join('');
+}
+
+function generate_releaser_definitions(): string {
+    return groups.map(g => {
+        return `/* ${g.name} structure releasers */\n` + g.structures.map(s => {
+            return `void release_${s.name}(${s.name}_t * p_value)\n` +
+            `{\n` +
+            generate_member_releasers(s.members).map(line => '    ' + line + '\n').join('') +
+            `}\n`;
+        }).join('\n');
+    }).join('\n\n');
+}
+
 function generate_request_handler_message_names(): string {
     return database.messages.server_requests.map(r => {
         return `#define LSP_REQUEST_${to_c_name(r.name).toUpperCase()} "${to_camelcase(r.name)}"\n`;
@@ -475,34 +654,60 @@ function generate_notification_handler_functions(): string {
     }).join('');
 }
 
-function generate_request_handlers(): string {
-    return database.messages.server_requests.map(r => {
+function document_path(parameters: string): string {
+    var structure = structures.find(s => s.name === parameters);
+    if (structure && typeof structure.members.text_document === 'string')
+        return 'p_params->text_document.uri.path';
+    // Completion items name the document they were completed in, in the data the server attached to them.
+    if (parameters === 'completion_item')
+        return 'json_string_value(json_object_get(p_params->data, "file"))';
+    return 'NULL';
+}
+
+function generate_params_readers(messages: { name: string, parameters: string }[], kind: string): string {
+    return messages.map(r => {
         var retval: string[] = [];
-        retval.push(`static void request_handler_${to_c_name(r.name)}(const char * p_method, json_t * p_params, json_t * p_response)`);
+        retval.push(`static void * ${kind}_params_read_${to_c_name(r.name)}(json_reader_t * p_reader, const char ** pp_document)`);
         retval.push(`{`);
-        retval.push(`    ${r.parameters}_t params = decode_${r.parameters}(p_params);`);
-        retval.push(`    if (decoder_error() == DECODER_ERROR_NONE)`);
+        retval.push(`    ${r.parameters}_t * p_params = MALLOC(sizeof(${r.parameters}_t));`);
+        retval.push(`    bool valid = read_${r.parameters}(p_reader, p_params);`);
+        retval.push(`    if (decoder_error() != DECODER_ERROR_NONE || !valid)`);
         retval.push(`    {`);
-        retval.push(`        mp_request_handler_${to_c_name(r.name)}(&params, p_response);`);
+        retval.push(`        release_${r.parameters}(p_params);`);
+        retval.push(`        FREE(p_params);`);
+        retval.push(`        return NULL;`);
         retval.push(`    }`);
-        retval.push(`    else`);
-        retval.push(`    {`);
-        retval.push(`        json_rpc_error_response_send(p_response, JSON_RPC_ERROR_INVALID_PARAMS, "Required parameters missing", NULL);`);
-        retval.push(`    }`);
-        retval.push(`    free_${r.parameters}(params);`);
+        retval.push(`    *pp_document = ${document_path(r.parameters)};`);
+        retval.push(`    return p_params;`);
+        retval.push(`}`);
+        retval.push(`static void ${kind}_params_free_${to_c_name(r.name)}(void * p_params)`);
+        retval.push(`{`);
+        retval.push(`    release_${r.parameters}(p_params);`);
+        retval.push(`    FREE(p_params);`);
+        retval.push(`}`);
+        return retval.map(line => line + '\n').join('');
+    }).join('');
+}
+
+function generate_request_handlers(): string {
+    return generate_params_readers(database.messages.server_requests, 'request') +
+    database.messages.server_requests.map(r => {
+        var retval: string[] = [];
+        retval.push(`static void request_handler_${to_c_name(r.name)}(const char * p_method, void * p_params, json_t * p_response)`);
+        retval.push(`{`);
+        retval.push(`    mp_request_handler_${to_c_name(r.name)}(p_params, p_response);`);
         retval.push(`}`);
         return retval.map(line => line + '\n').join('');
     }).join('');
 }
 
 function generate_notification_handlers(): string {
-    return database.messages.server_notifications.map(r => {
+    return generate_params_readers(database.messages.server_notifications, 'notification') +
+    database.messages.server_notifications.map(r => {
         var retval: string[] = [];
-        retval.push(`static void notification_handler_${to_c_name(r.name)}(const char * p_method, json_t * p_params)`);
+        retval.push(`static void notification_handler_${to_c_name(r.name)}(const char * p_method, void * p_params)`);
         retval.push(`{`);
-        retval.push(`    ${r.parameters}_t params = decode_${r.parameters}(p_params);`);
-        retval.push(`    mp_notification_handler_${to_c_name(r.name)}(&params);`);
-        retval.push(`    free_${r.parameters}(params);`);
+        retval.push(`    mp_notification_handler_${to_c_name(r.name)}(p_params);`);
         retval.push(`}`);
         return retval.map(line => line + '\n').join('');
     }).join('');
@@ -514,7 +719,10 @@ function generate_request_handler_registrator_definition(): string {
         retval.push(`void lsp_request_handler_${to_c_name(r.name)}_register(lsp_request_handler_${to_c_name(r.name)}_t handler)`);
         retval.push(`{`);
         retval.push(`    mp_request_handler_${to_c_name(r.name)} = handler;`)
-        retval.push(`    json_rpc_request_handler_add(LSP_REQUEST_${to_c_name(r.name).toUpperCase()}, request_handler_${to_c_name(r.name)});`)
+        retval.push(`    json_rpc_request_handler_add(LSP_REQUEST_${to_c_name(r.name).toUpperCase()},`)
+        retval.push(`                                 request_params_read_${to_c_name(r.name)},`)
+        retval.push(`                                 request_handler_${to_c_name(r.name)},`)
+        retval.push(`                                 request_params_free_${to_c_name(r.name)});`)
         retval.push(`}`)
         return retval.map(line => line + '\n').join('');
     }).join('');
@@ -526,7 +734,10 @@ function generate_notification_handler_registrator_definition(): string {
         retval.push(`void lsp_notification_handler_${to_c_name(r.name)}_register(lsp_notification_handler_${to_c_name(r.name)}_t handler)`);
         retval.push(`{`);
         retval.push(`    mp_notification_handler_${to_c_name(r.name)} = handler;`)
-        retval.push(`    json_rpc_notification_handler_add(LSP_NOTIFICATION_${to_c_name(r.name).toUpperCase()}, notification_handler_${to_c_name(r.name)});`)
+        retval.push(`    json_rpc_notification_handler_add(LSP_NOTIFICATION_${to_c_name(r.name).toUpperCase()},`)
+        retval.push(`                                      notification_params_read_${to_c_name(r.name)},`)
+        retval.push(`                                      notification_handler_${to_c_name(r.name)},`)
+        retval.push(`                                      notification_params_free_${to_c_name(r.name)});`)
         retval.push(`}`)
         return retval.map(line => line + '\n').join('');
     }).join('');
@@ -557,20 +768,27 @@ fs.writeFile('backend/include/protocol/encoders.h',
     '#pragma once\n' +
     header +
     generate_enum_encoders() +
-    generate_encoder_declarations());
+    generate_encoder_declarations() +
+    '\n' +
+    generate_enum_writers() +
+    generate_writer_declarations());
 
 fs.writeFile('backend/src/protocol/encoders.c',
     '#include "encoders.h"\n' +
     header +
-    generate_encoder_definitions());
+    generate_encoder_definitions() +
+    '\n\n' +
+    generate_writer_definitions());
 
 fs.writeFile('backend/include/protocol/decoders.h',
     '#pragma once\n' +
     header +
     generate_decoder_header_extras() +
-    code_separator('Decoders') +
-    generate_enum_decoders() +
-    generate_decoder_declarations() +
+    code_separator('Readers') +
+    generate_enum_readers() +
+    generate_reader_declarations() +
+    code_separator('Releasers') +
+    generate_releaser_declarations() +
     code_separator('Freers') +
     generate_freer_declarations());
 
@@ -579,8 +797,10 @@ fs.writeFile('backend/src/protocol/decoders.c',
     '#include "decoders.h"\n' +
     '#include "log.h"\n' +
     '\nstatic decoder_error_t m_error;\n' +
-    code_separator('Decoders') +
-    generate_decoder_definitions() +
+    code_separator('Readers') +
+    generate_reader_definitions() +
+    code_separator('Releasers') +
+    generate_releaser_definitions() +
     code_separator('Freers') +
     generate_freer_definitions() +
     '\n' +
@@ -591,6 +811,9 @@ fs.writeFile('backend/include/protocol/message_handling.h',
     header +
     code_separator('Outgoing messages') +
     generate_client_message_names() +
+    code_separator('Incoming messages') +
+    generate_request_handler_message_names() +
+    generate_notification_handler_message_names() +
     code_separator('Request handler types') +
     generate_request_handler_function_types() +
     code_separator('Notification handler types') +
@@ -610,9 +833,6 @@ header += '#include "message_handling.h"\n';
 
 fs.writeFile('backend/src/protocol/message_handling.c',
     header +
-    code_separator('Message names') +
-    generate_request_handler_message_names() +
-    generate_notification_handler_message_names() +
     code_separator('Handler function pointers') +
     generate_request_handler_functions() +
     generate_notification_handler_functions() +